@@ -32,10 +32,13 @@
 #include <inttypes.h>
 #include <simaai/simaai_memory.h>
 
+#include <algorithm>
 #include <cstddef>
+#include <deque>
 #include <mutex>
 #include <new>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "gstsimaaisegmentallocator.h"
@@ -54,6 +57,9 @@ G_DEFINE_TYPE_WITH_CODE (GstSimaaiSegmentAllocator, gst_simaai_segment_allocator
 struct segment {
   simaai_memory_t *memory;
   std::string name;
+  GstSimaaiSegmentId id;
+  gsize offset;            ///< offset from the start of the parent segment
+  gsize size;
 };
 
 /**
@@ -62,15 +68,208 @@ struct segment {
 struct GstSimaaiSegmentMemory {
   GstMemory mem;
   std::vector<segment> segments; ///< SiMa memory segment handles used by simamemlib
+  GstSimaaiSegmentId ids[MAX_ALLOCATION_SEGMENTS]; ///< Segment ids packed for lookup
   simaai_memory_t **alloc_segments;
   gpointer vaddr;          ///< SiMa memory block virtual address after mapping
   std::mutex map_mutex;    ///< Concurrent map/unmap protection
+  gsize dirty_begin;       ///< Range written by the CPU and not flushed yet
+  gsize dirty_end;
+  guint writers;           ///< Write maps of cached memory not unmapped yet
+  GstSimaaiSlab *slab;     ///< Slab the segments were carved from, or NULL
+  guint slab_slot;         ///< Buffer index in the slab
+};
+
+/**
+ * @brief Contiguous block of segments for several buffers.
+ * Buffer N owns handles [N * segments_per_buffer, (N + 1) * segments_per_buffer).
+ */
+struct _GstSimaaiSlab {
+  gint refcount;
+  simaai_memory_t **handles;
+  guint n_buffers;
+  gsize segments_per_buffer;
+  gsize stride;            ///< Buffer size rounded up to the buffer alignment
+  gpointer vaddr;          ///< Whole slab mapped through the first handle
+  std::mutex mutex;        ///< Protects free_slots
+  std::vector<guint> free_slots;
 };
 
 #define GST_SIMAAI_SEGMENT_MEMORY_CAST(mem)     ((GstSimaaiSegmentMemory *)(mem))
 
 #define GST_SIMAAI_ALLOCATION_PARAMS_CAST(params) ((GstSimaaiAllocationParams *)(params))
 
+/**
+ * @brief Process wide registry of interned segment names
+ */
+struct SegmentIdRegistry {
+  std::mutex mutex;
+  std::unordered_map<std::string, GstSimaaiSegmentId> ids;
+  std::deque<std::string> names;   ///< names by id - 2, stable addresses
+};
+
+static SegmentIdRegistry &
+segment_id_registry (void)
+{
+  static SegmentIdRegistry registry;
+  return registry;
+}
+
+/**
+ * @brief Id of an already registered name, GST_SIMAAI_SEGMENT_ID_INVALID if
+ *        no memory was allocated with it
+ */
+static GstSimaaiSegmentId
+segment_id_lookup (const gchar *name)
+{
+  if (name == NULL)
+    return GST_SIMAAI_SEGMENT_ID_PARENT;
+
+  SegmentIdRegistry & registry = segment_id_registry();
+  const std::lock_guard<std::mutex> guard(registry.mutex);
+  auto it = registry.ids.find(name);
+  return it == registry.ids.end() ? GST_SIMAAI_SEGMENT_ID_INVALID : it->second;
+}
+
+/**
+ * @brief Find segment by id, at most MAX_ALLOCATION_SEGMENTS integer compares
+ */
+static const segment *
+find_segment (const GstSimaaiSegmentMemory *mem, GstSimaaiSegmentId id)
+{
+  if (mem->segments.empty())
+    return NULL;
+  if (id == GST_SIMAAI_SEGMENT_ID_PARENT)
+    return &mem->segments[0];
+
+  for (size_t i = 0; i < mem->segments.size(); i++)
+    if (mem->ids[i] == id)
+      return &mem->segments[i];
+
+  return NULL;
+}
+
+enum class CacheOp { FLUSH, INVALIDATE };
+
+#if defined(__aarch64__)
+/**
+ * @brief Clean or clean+invalidate data cache lines of a virtual range.
+ *
+ * Linux allows DC CVAC and DC CIVAC from user space. Invalidation also
+ * cleans, so dirty CPU lines at the edges of the range are not lost.
+ *
+ * @return number of bytes in the touched cache lines
+ */
+static gsize
+cache_range_op (guint8 *start, gsize size, CacheOp op)
+{
+  static gsize line = 0;
+  if (line == 0) {
+    guint64 ctr;
+    asm volatile ("mrs %0, ctr_el0" : "=r" (ctr));
+    line = (gsize)4 << ((ctr >> 16) & 0xf);
+  }
+
+  guintptr addr = (guintptr)start & ~(guintptr)(line - 1);
+  const guintptr end = (guintptr)start + size;
+
+  for (guintptr p = addr; p < end; p += line) {
+    if (op == CacheOp::FLUSH)
+      asm volatile ("dc cvac, %0" : : "r" (p) : "memory");
+    else
+      asm volatile ("dc civac, %0" : : "r" (p) : "memory");
+  }
+  asm volatile ("dsb sy" : : : "memory");
+
+  return end - addr;
+}
+#define HAVE_CACHE_RANGE_OP 1
+#else
+#define HAVE_CACHE_RANGE_OP 0
+#endif
+
+/**
+ * @brief Flush or invalidate bytes [begin, end) of the memory. Parts covering
+ *        a whole segment use the simamemlib call of the segment.
+ */
+static void
+cache_sync (GstSimaaiSegmentMemory *mem, gsize begin, gsize end, CacheOp op)
+{
+  GstSimaaiSegmentAllocator *alloc =
+      (GstSimaaiSegmentAllocator *) GST_MEMORY_CAST(mem)->allocator;
+  gsize bytes = 0;
+
+  for (const auto& s : mem->segments) {
+    const gsize lo = std::max(begin, s.offset);
+    const gsize hi = std::min(end, s.offset + s.size);
+    if (lo >= hi)
+      continue;
+
+    if (!HAVE_CACHE_RANGE_OP || (lo == s.offset && hi == s.offset + s.size)) {
+      if (op == CacheOp::FLUSH)
+        simaai_memory_flush_cache(s.memory);
+      else
+        simaai_memory_invalidate_cache(s.memory);
+      bytes += s.size;
+    } else {
+#if HAVE_CACHE_RANGE_OP
+      bytes += cache_range_op((guint8 *)mem->vaddr + lo, hi - lo, op);
+#endif
+    }
+  }
+
+  GST_LOG_OBJECT(alloc, "%s %zu bytes at %p + %zu",
+                 op == CacheOp::FLUSH ? "Flush" : "Invalidate", bytes, mem->vaddr, begin);
+
+  GstSimaaiCacheStats *stats = &alloc->cache_stats;
+  if (op == CacheOp::FLUSH) {
+    __atomic_fetch_add(&stats->bytes_flushed, bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->flushes, 1, __ATOMIC_RELAXED);
+  } else {
+    __atomic_fetch_add(&stats->bytes_invalidated, bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->invalidations, 1, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * @brief Add a writer of [begin, end) to the dirty range, map_mutex must be held
+ */
+static void
+mark_dirty (GstSimaaiSegmentMemory *mem, gsize begin, gsize end)
+{
+  mem->writers++;
+  if (mem->dirty_begin >= mem->dirty_end) {
+    mem->dirty_begin = begin;
+    mem->dirty_end = end;
+  } else {
+    mem->dirty_begin = std::min(mem->dirty_begin, begin);
+    mem->dirty_end = std::max(mem->dirty_end, end);
+  }
+}
+
+/**
+ * @brief Remove a writer, map_mutex must be held
+ *
+ * Other writers may still write anywhere in the dirty range, so only the
+ * last one flushes it, all at once.
+ */
+static void
+flush_dirty (GstSimaaiSegmentMemory *mem)
+{
+  GstSimaaiSegmentAllocator *alloc =
+      (GstSimaaiSegmentAllocator *) GST_MEMORY_CAST(mem)->allocator;
+
+  if (mem->writers > 1 || mem->dirty_begin >= mem->dirty_end) {
+    if (mem->writers > 0)
+      mem->writers--;
+    __atomic_fetch_add(&alloc->cache_stats.flushes_skipped, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  cache_sync(mem, mem->dirty_begin, mem->dirty_end, CacheOp::FLUSH);
+  mem->dirty_begin = mem->dirty_end = 0;
+  mem->writers = 0;
+}
+
 /**
  * @brief Map simaai memory buffer
  *
@@ -86,11 +285,11 @@ mem_map_full (GstMemory *memory, GstMapInfo *info, gsize maxsize)
 
   GST_DEBUG_OBJECT(memory->allocator, "Map virt memory: %p with size=%zu", mem->vaddr, maxsize);
 
-  if ((info->flags & GST_MAP_READ) &&
-      (GST_MEMORY_FLAG_IS_SET(memory, GST_SIMAAI_MEMORY_FLAG_CACHED))) {
-    GST_DEBUG_OBJECT(memory->allocator, "simaai_memory_invalidate_cache at %p",
-                     mem->vaddr);
-    simaai_memory_invalidate_cache(mem->segments[0].memory);
+  if (GST_MEMORY_FLAG_IS_SET(memory, GST_SIMAAI_MEMORY_FLAG_CACHED)) {
+    if (info->flags & GST_MAP_READ)
+      cache_sync(mem, 0, memory->size, CacheOp::INVALIDATE);
+    if (info->flags & GST_MAP_WRITE)
+      mark_dirty(mem, 0, memory->size);
   }
 
   return mem->vaddr;
@@ -110,15 +309,71 @@ mem_unmap_full (GstMemory *memory, GstMapInfo *info)
   const std::lock_guard<std::mutex> guard(mem->map_mutex);
 
   if ((info->flags & GST_MAP_WRITE) &&
-      (GST_MEMORY_FLAG_IS_SET(memory, GST_SIMAAI_MEMORY_FLAG_CACHED))) {
-    GST_DEBUG_OBJECT(memory->allocator, "simaai_memory_flush_cache at %p",
-                     mem->vaddr);
-    simaai_memory_flush_cache(mem->segments[0].memory);
-  }
+      (GST_MEMORY_FLAG_IS_SET(memory, GST_SIMAAI_MEMORY_FLAG_CACHED)))
+    flush_dirty(mem);
 
   GST_DEBUG_OBJECT(memory->allocator, "Unmap virt memory: %p with size=%zu", mem->vaddr, info->size);
 }
 
+/**
+ * @brief Simaai memory target and region flags from the GstMemory flags.
+ * If several flags of a kind are set then the last one is applied.
+ */
+static void
+memory_target_flags (guint mem_flags, int *target, int *flags)
+{
+  *target = SIMAAI_MEM_TARGET_GENERIC;
+
+  if (mem_flags & GST_SIMAAI_MEMORY_TARGET_OCM)
+    *target = SIMAAI_MEM_TARGET_OCM;
+
+  if (mem_flags & GST_SIMAAI_MEMORY_TARGET_DMS0)
+    *target = SIMAAI_MEM_TARGET_DMS0;
+
+  if (mem_flags & GST_SIMAAI_MEMORY_TARGET_DMS1)
+    *target = SIMAAI_MEM_TARGET_DMS1;
+
+  if (mem_flags & GST_SIMAAI_MEMORY_TARGET_DMS2)
+    *target = SIMAAI_MEM_TARGET_DMS2;
+
+  if (mem_flags & GST_SIMAAI_MEMORY_TARGET_DMS3)
+    *target = SIMAAI_MEM_TARGET_DMS3;
+
+  if (mem_flags & GST_SIMAAI_MEMORY_TARGET_EV74)
+    *target = SIMAAI_MEM_TARGET_EV74;
+
+  *flags = SIMAAI_MEM_FLAG_DEFAULT;
+
+  if (mem_flags & GST_SIMAAI_MEMORY_FLAG_CACHED)
+    *flags = SIMAAI_MEM_FLAG_CACHED;
+
+  if (mem_flags & GST_SIMAAI_MEMORY_FLAG_RDONLY)
+    *flags = SIMAAI_MEM_FLAG_RDONLY;
+}
+
+/**
+ * @brief Take a free buffer of the slab. Returns FALSE when all are in use.
+ */
+static gboolean
+slab_take (GstSimaaiSlab *slab, guint *slot)
+{
+  std::lock_guard<std::mutex> lock(slab->mutex);
+
+  if (slab->free_slots.empty())
+    return FALSE;
+
+  *slot = slab->free_slots.back();
+  slab->free_slots.pop_back();
+  return TRUE;
+}
+
+static void
+slab_give (GstSimaaiSlab *slab, guint slot)
+{
+  std::lock_guard<std::mutex> lock(slab->mutex);
+  slab->free_slots.push_back(slot);
+}
+
 static GstMemory*
 gst_simaai_segment_allocator2_alloc (GstAllocator *allocator, gsize size,
                              GstAllocationParams *params)
@@ -126,6 +381,7 @@ gst_simaai_segment_allocator2_alloc (GstAllocator *allocator, gsize size,
   (void)size;
 
   GstSimaaiAllocationParams *alloc_params = GST_SIMAAI_ALLOCATION_PARAMS_CAST(params);
+  GstSimaaiSlab *slab = alloc_params->slab;
 
   if (alloc_params->num_of_segments < 1 || alloc_params->num_of_segments > MAX_ALLOCATION_SEGMENTS) {
     GST_ERROR_OBJECT (allocator, "ERROR: bad num_of_segments value: %zu",
@@ -133,6 +389,12 @@ gst_simaai_segment_allocator2_alloc (GstAllocator *allocator, gsize size,
     return NULL;
   }
 
+  if (slab && slab->segments_per_buffer != alloc_params->num_of_segments) {
+    GST_ERROR_OBJECT (allocator, "ERROR: slab has %zu segments per buffer, requested %zu",
+                      slab->segments_per_buffer, alloc_params->num_of_segments);
+    return NULL;
+  }
+
   gsize total_size = 0;
   for (size_t i = 0; i < alloc_params->num_of_segments; i++)
     total_size += alloc_params->segments[i].size;
@@ -148,75 +410,79 @@ gst_simaai_segment_allocator2_alloc (GstAllocator *allocator, gsize size,
   gst_memory_init (GST_MEMORY_CAST (mem), params->flags, allocator, nullptr,
                    maxsize, params->align, params->prefix, total_size);
 
-  // Set memory target region.
-  // If several flags are set then the last one is applied.
-  int target{SIMAAI_MEM_TARGET_GENERIC};
-
-  if (GST_MEMORY_FLAG_IS_SET (GST_MEMORY_CAST(mem), GST_SIMAAI_MEMORY_TARGET_OCM))
-    target = SIMAAI_MEM_TARGET_OCM;
-
-  if (GST_MEMORY_FLAG_IS_SET (GST_MEMORY_CAST(mem), GST_SIMAAI_MEMORY_TARGET_DMS0))
-    target = SIMAAI_MEM_TARGET_DMS0;
-
-  if (GST_MEMORY_FLAG_IS_SET (GST_MEMORY_CAST(mem), GST_SIMAAI_MEMORY_TARGET_DMS1))
-    target = SIMAAI_MEM_TARGET_DMS1;
-
-  if (GST_MEMORY_FLAG_IS_SET (GST_MEMORY_CAST(mem), GST_SIMAAI_MEMORY_TARGET_DMS2))
-    target = SIMAAI_MEM_TARGET_DMS2;
-
-  if (GST_MEMORY_FLAG_IS_SET (GST_MEMORY_CAST(mem), GST_SIMAAI_MEMORY_TARGET_DMS3))
-    target = SIMAAI_MEM_TARGET_DMS3;
+  int target, flags;
+  memory_target_flags (GST_MINI_OBJECT_FLAGS (mem), &target, &flags);
 
-  if (GST_MEMORY_FLAG_IS_SET (GST_MEMORY_CAST(mem), GST_SIMAAI_MEMORY_TARGET_EV74))
-    target = SIMAAI_MEM_TARGET_EV74;
+  mem->slab = nullptr;
+  mem->slab_slot = 0;
 
-  // Set memory region flags
-  // If several flags are set then the last one is applied.
-  int flags{SIMAAI_MEM_FLAG_DEFAULT};
-
-  if (GST_MEMORY_FLAG_IS_SET (GST_MEMORY_CAST(mem), GST_SIMAAI_MEMORY_FLAG_CACHED))
-    flags = SIMAAI_MEM_FLAG_CACHED;
-
-  if (GST_MEMORY_FLAG_IS_SET (GST_MEMORY_CAST(mem), GST_SIMAAI_MEMORY_FLAG_RDONLY))
-    flags = SIMAAI_MEM_FLAG_RDONLY;
+  if (slab) {
+    // Carve the next free buffer out of the slab. Its segments were allocated
+    // together with the segments of every other buffer of the slab.
+    guint slot;
+    if (!slab_take(slab, &slot)) {
+      GST_ERROR_OBJECT (allocator, "ERROR: all %u slab buffers are in use", slab->n_buffers);
+      delete mem;
+      return NULL;
+    }
 
-  // Allocate simaai memory segments
-  uint32_t segments[MAX_ALLOCATION_SEGMENTS];
-  memset(segments, 0, sizeof(segments));
+    mem->slab = gst_simaai_slab_ref(slab);
+    mem->slab_slot = slot;
+    mem->alloc_segments = &slab->handles[slot * slab->segments_per_buffer];
+  } else {
+    // Allocate simaai memory segments
+    uint32_t segments[MAX_ALLOCATION_SEGMENTS];
+    memset(segments, 0, sizeof(segments));
 
-  for (size_t i = 0; i < alloc_params->num_of_segments; i++)
-    segments[i] = alloc_params->segments[i].size;
+    for (size_t i = 0; i < alloc_params->num_of_segments; i++)
+      segments[i] = alloc_params->segments[i].size;
 
-  mem->alloc_segments = simaai_memory_alloc_segments_flags(segments,
-                                                           alloc_params->num_of_segments,
-                                                           target, flags);
+    mem->alloc_segments = simaai_memory_alloc_segments_flags(segments,
+                                                             alloc_params->num_of_segments,
+                                                             target, flags);
 
-  if (!mem->alloc_segments) {
-    GST_ERROR_OBJECT (allocator, "ERROR: allocating segments of memory");
-    delete mem;
-    return NULL;
+    if (!mem->alloc_segments) {
+      GST_ERROR_OBJECT (allocator, "ERROR: allocating segments of memory");
+      delete mem;
+      return NULL;
+    }
   }
 
+  // Segments follow each other in the block mapped through the parent segment
+  const guint64 parent_phys = simaai_memory_get_phys(mem->alloc_segments[0]);
   for (size_t i = 0; i < alloc_params->num_of_segments; i++) {
     segment s;
     s.memory = mem->alloc_segments[i];
     s.name = alloc_params->segments[i].name;
+    s.id = gst_simaai_segment_id_from_name(alloc_params->segments[i].name);
+    s.offset = simaai_memory_get_phys(s.memory) - parent_phys;
+    s.size = alloc_params->segments[i].size;
     mem->segments.push_back(s);
+    mem->ids[i] = s.id;
   }
+  mem->dirty_begin = mem->dirty_end = 0;
+  mem->writers = 0;
 
-  // Map the memory of the parent segment once to reuse the same virtual address
-  // until the memory is destroyed
-  mem->vaddr = simaai_memory_map(mem->segments[0].memory);
-  if (!mem->vaddr) {
-    GST_ERROR_OBJECT (allocator, "ERROR: mapping contiguous memory");
-    simaai_memory_free_segments(mem->alloc_segments, alloc_params->num_of_segments);
-    delete mem;
-    return NULL;
+  if (slab) {
+    // The slab is mapped once as a whole, buffers are windows into it
+    mem->vaddr = static_cast<guint8 *>(slab->vaddr) +
+                 (parent_phys - simaai_memory_get_phys(slab->handles[0]));
+  } else {
+    // Map the memory of the parent segment once to reuse the same virtual address
+    // until the memory is destroyed
+    mem->vaddr = simaai_memory_map(mem->segments[0].memory);
+    if (!mem->vaddr) {
+      GST_ERROR_OBJECT (allocator, "ERROR: mapping contiguous memory");
+      simaai_memory_free_segments(mem->alloc_segments, alloc_params->num_of_segments);
+      delete mem;
+      return NULL;
+    }
   }
 
   for (size_t i = 0; i < mem->segments.size(); i++) {
-    GST_DEBUG_OBJECT (allocator, "Allocate memory segment:%zu phys:0x%" PRIx64 " target:0x%08x flags:0x%08x size:%zu",
-                      i, simaai_memory_get_phys(mem->segments[i].memory), target, flags, simaai_memory_get_size(mem->segments[i].memory));
+    GST_DEBUG_OBJECT (allocator, "Allocate memory segment:%zu phys:0x%" PRIx64 " target:0x%08x flags:0x%08x size:%zu%s",
+                      i, simaai_memory_get_phys(mem->segments[i].memory), target, flags,
+                      simaai_memory_get_size(mem->segments[i].memory), slab ? " (slab)" : "");
   }
 
   return GST_MEMORY_CAST (mem);
@@ -230,8 +496,14 @@ gst_simaai_segment_allocator2_free (GstAllocator *allocator, GstMemory *memory)
   GST_DEBUG_OBJECT (allocator, "Free simaai phys memory: 0x%" PRIx64,
                     simaai_memory_get_phys(mem->segments[0].memory));
 
-  simaai_memory_unmap(mem->segments[0].memory);
-  simaai_memory_free_segments(mem->alloc_segments, mem->segments.size());
+  if (mem->slab) {
+    // Segments are freed with the slab
+    slab_give(mem->slab, mem->slab_slot);
+    gst_simaai_slab_unref(mem->slab);
+  } else {
+    simaai_memory_unmap(mem->segments[0].memory);
+    simaai_memory_free_segments(mem->alloc_segments, mem->segments.size());
+  }
   delete mem;
 }
 
@@ -322,27 +594,283 @@ gst_simaai_memory_allocation_params_add_segment (GstSimaaiAllocationParams * par
   return TRUE;
 }
 
+/// Buffers of a slab start at least at page boundaries
+#define SLAB_MIN_BUFFER_ALIGN 4096
+
+GstSimaaiSlab *
+gst_simaai_slab_new (const GstSimaaiAllocationParams * params, guint n_buffers)
+{
+  g_return_val_if_fail (params != NULL, NULL);
+  g_return_val_if_fail (n_buffers > 0, NULL);
+  g_return_val_if_fail (params->num_of_segments >= 1 &&
+                        params->num_of_segments <= MAX_ALLOCATION_SEGMENTS, NULL);
+
+  const gsize k = params->num_of_segments;
+  const gsize align = MAX ((gsize) SLAB_MIN_BUFFER_ALIGN, params->parent.align + 1);
+
+  gsize buffer_size = 0;
+  for (gsize i = 0; i < k; i++)
+    buffer_size += params->segments[i].size;
+
+  // Pad the last segment so the next buffer starts aligned
+  const gsize stride = (buffer_size + align - 1) / align * align;
+  const gsize pad = stride - buffer_size;
+  if (params->segments[k - 1].size + pad > G_MAXUINT32) {
+    GST_ERROR ("ERROR: slab segment size %zu is out of range", params->segments[k - 1].size + pad);
+    return NULL;
+  }
+
+  std::vector<uint32_t> sizes;
+  sizes.reserve(k * n_buffers);
+  for (guint n = 0; n < n_buffers; n++) {
+    for (gsize i = 0; i < k; i++)
+      sizes.push_back(params->segments[i].size + (i == k - 1 ? pad : 0));
+  }
+
+  int target, flags;
+  memory_target_flags (params->parent.flags, &target, &flags);
+
+  simaai_memory_t **handles = simaai_memory_alloc_segments_flags(sizes.data(), sizes.size(),
+                                                                 target, flags);
+  if (!handles) {
+    GST_WARNING ("Cannot allocate slab of %u x %zu bytes", n_buffers, stride);
+    return NULL;
+  }
+
+  gpointer vaddr = simaai_memory_map(handles[0]);
+  if (!vaddr) {
+    GST_ERROR ("ERROR: mapping slab memory");
+    simaai_memory_free_segments(handles, sizes.size());
+    return NULL;
+  }
+
+  GstSimaaiSlab *slab = new(std::nothrow) GstSimaaiSlab;
+  if (slab == nullptr) {
+    simaai_memory_unmap(handles[0]);
+    simaai_memory_free_segments(handles, sizes.size());
+    return NULL;
+  }
+
+  slab->refcount = 1;
+  slab->handles = handles;
+  slab->n_buffers = n_buffers;
+  slab->segments_per_buffer = k;
+  slab->stride = stride;
+  slab->vaddr = vaddr;
+  // Hand out the lowest addresses first
+  for (guint n = n_buffers; n > 0; n--)
+    slab->free_slots.push_back(n - 1);
+
+  GST_DEBUG ("Allocated slab phys:0x%" PRIx64 " buffers:%u stride:%zu target:0x%08x flags:0x%08x",
+             simaai_memory_get_phys(handles[0]), n_buffers, stride, target, flags);
+
+  return slab;
+}
+
+GstSimaaiSlab *
+gst_simaai_slab_ref (GstSimaaiSlab * slab)
+{
+  g_return_val_if_fail (slab != NULL, NULL);
+
+  __atomic_add_fetch (&slab->refcount, 1, __ATOMIC_RELAXED);
+  return slab;
+}
+
+void
+gst_simaai_slab_unref (GstSimaaiSlab * slab)
+{
+  g_return_if_fail (slab != NULL);
+
+  if (__atomic_sub_fetch (&slab->refcount, 1, __ATOMIC_ACQ_REL) != 0)
+    return;
+
+  GST_DEBUG ("Free slab phys:0x%" PRIx64, simaai_memory_get_phys(slab->handles[0]));
+
+  simaai_memory_unmap(slab->handles[0]);
+  simaai_memory_free_segments(slab->handles, slab->n_buffers * slab->segments_per_buffer);
+  delete slab;
+}
+
+gsize
+gst_simaai_slab_get_size (const GstSimaaiSlab * slab)
+{
+  g_return_val_if_fail (slab != NULL, 0);
+
+  return slab->stride * slab->n_buffers;
+}
+
+GstSimaaiSegmentId
+gst_simaai_segment_id_from_name (const gchar * name)
+{
+  if (name == NULL)
+    return GST_SIMAAI_SEGMENT_ID_PARENT;
+
+  SegmentIdRegistry & registry = segment_id_registry();
+  const std::lock_guard<std::mutex> guard(registry.mutex);
+
+  auto it = registry.ids.find(name);
+  if (it != registry.ids.end())
+    return it->second;
+
+  const GstSimaaiSegmentId id = registry.names.size() + 2;
+  registry.names.emplace_back(name);
+  registry.ids.emplace(registry.names.back(), id);
+  return id;
+}
+
+const gchar *
+gst_simaai_segment_id_to_name (GstSimaaiSegmentId id)
+{
+  SegmentIdRegistry & registry = segment_id_registry();
+  const std::lock_guard<std::mutex> guard(registry.mutex);
+
+  if (id < 2 || id - 2 >= registry.names.size())
+    return NULL;
+  return registry.names[id - 2].c_str();
+}
+
 void *
-gst_simaai_memory_get_segment (const GstMemory * memory, const gchar * name)
+gst_simaai_memory_get_segment_by_id (const GstMemory * memory, GstSimaaiSegmentId id)
 {
+  g_return_val_if_fail (memory != NULL, NULL);
+  g_return_val_if_fail (GST_IS_SIMAAI_SEGMENT_ALLOCATOR2(memory->allocator), NULL);
+
+  const segment *s = find_segment(GST_SIMAAI_SEGMENT_MEMORY_CAST(memory), id);
+  return s ? s->memory : NULL;
+}
+
+guintptr
+gst_simaai_memory_get_segment_phys_addr (const GstMemory * memory, GstSimaaiSegmentId id)
+{
+  g_return_val_if_fail (memory != NULL, 0);
+  g_return_val_if_fail (GST_IS_SIMAAI_SEGMENT_ALLOCATOR2(memory->allocator), 0);
+
+  const segment *s = find_segment(GST_SIMAAI_SEGMENT_MEMORY_CAST(memory), id);
+  return s ? simaai_memory_get_phys(s->memory) : 0;
+}
+
+gsize
+gst_simaai_memory_get_segment_size (const GstMemory * memory, GstSimaaiSegmentId id)
+{
+  g_return_val_if_fail (memory != NULL, 0);
+  g_return_val_if_fail (GST_IS_SIMAAI_SEGMENT_ALLOCATOR2(memory->allocator), 0);
+
+  const segment *s = find_segment(GST_SIMAAI_SEGMENT_MEMORY_CAST(memory), id);
+  return s ? s->size : 0;
+}
+
+gpointer
+gst_simaai_memory_get_segment_data (const GstMemory * memory, GstSimaaiSegmentId id)
+{
+  g_return_val_if_fail (memory != NULL, NULL);
   g_return_val_if_fail (GST_IS_SIMAAI_SEGMENT_ALLOCATOR2(memory->allocator), NULL);
 
   GstSimaaiSegmentMemory *mem = GST_SIMAAI_SEGMENT_MEMORY_CAST(memory);
-  simaai_memory_t *memory_t = NULL;
+  const segment *s = find_segment(mem, id);
+  return s ? (guint8 *)mem->vaddr + s->offset : NULL;
+}
 
-  g_return_val_if_fail (mem != NULL, NULL);
-  g_return_val_if_fail (mem->segments.size() > 0, NULL);
+void *
+gst_simaai_memory_get_segment (const GstMemory * memory, const gchar * name)
+{
+  g_return_val_if_fail (memory != NULL, NULL);
 
-  if (name == NULL) {
-    memory_t = mem->segments[0].memory;
-  } else {
-    for (const auto& s : mem->segments) {
-      if (s.name == name) {
-        memory_t = s.memory;
-        break;
-      }
+  return gst_simaai_memory_get_segment_by_id(memory, segment_id_lookup(name));
+}
+
+gboolean
+gst_simaai_memory_map_range (GstMemory * memory, const gchar * name,
+                             gsize offset, gssize size,
+                             GstSimaaiRangeMapInfo * info, GstMapFlags flags)
+{
+  g_return_val_if_fail (memory != NULL, FALSE);
+  g_return_val_if_fail (info != NULL, FALSE);
+  g_return_val_if_fail (GST_IS_SIMAAI_SEGMENT_ALLOCATOR2(memory->allocator), FALSE);
+
+  GstSimaaiSegmentMemory *mem = GST_SIMAAI_SEGMENT_MEMORY_CAST(memory);
+  gsize base = 0, limit = memory->size;
+
+  if (name != NULL) {
+    const segment *s = find_segment(mem, segment_id_lookup(name));
+    if (s == NULL) {
+      GST_ERROR_OBJECT (memory->allocator, "ERROR: no segment '%s' in memory", name);
+      return FALSE;
     }
+    base = s->offset;
+    limit = s->size;
+  }
+
+  if (offset > limit || (size >= 0 && (gsize)size > limit - offset)) {
+    GST_ERROR_OBJECT (memory->allocator, "ERROR: range %zu+%zd is out of %zu bytes",
+                      offset, size, limit);
+    return FALSE;
   }
 
-  return memory_t;
+  if (!gst_memory_lock (memory, (GstLockFlags) flags)) {
+    GST_ERROR_OBJECT (memory->allocator, "ERROR: memory is not writable");
+    return FALSE;
+  }
+
+  info->memory = memory;
+  info->flags = flags;
+  info->offset = base + offset;
+  info->size = size < 0 ? limit - offset : (gsize)size;
+  info->data = (guint8 *)mem->vaddr + info->offset;
+
+  if (GST_MEMORY_FLAG_IS_SET(memory, GST_SIMAAI_MEMORY_FLAG_CACHED) && info->size > 0) {
+    const std::lock_guard<std::mutex> guard(mem->map_mutex);
+    if (flags & GST_MAP_READ)
+      cache_sync(mem, info->offset, info->offset + info->size, CacheOp::INVALIDATE);
+    if (flags & GST_MAP_WRITE)
+      mark_dirty(mem, info->offset, info->offset + info->size);
+  }
+
+  return TRUE;
+}
+
+void
+gst_simaai_memory_unmap_range (GstSimaaiRangeMapInfo * info)
+{
+  g_return_if_fail (info != NULL && info->memory != NULL);
+
+  GstMemory *memory = info->memory;
+  GstSimaaiSegmentMemory *mem = GST_SIMAAI_SEGMENT_MEMORY_CAST(memory);
+
+  if ((info->flags & GST_MAP_WRITE) &&
+      GST_MEMORY_FLAG_IS_SET(memory, GST_SIMAAI_MEMORY_FLAG_CACHED) && info->size > 0) {
+    const std::lock_guard<std::mutex> guard(mem->map_mutex);
+    flush_dirty(mem);
+  }
+
+  gst_memory_unlock (memory, (GstLockFlags) info->flags);
+}
+
+void
+gst_simaai_segment_allocator_get_cache_stats (GstAllocator * allocator,
+                                              GstSimaaiCacheStats * stats)
+{
+  g_return_if_fail (GST_IS_SIMAAI_SEGMENT_ALLOCATOR2(allocator));
+  g_return_if_fail (stats != NULL);
+
+  GstSimaaiCacheStats *src = &GST_SIMAAI_SEGMENT_ALLOCATOR2(allocator)->cache_stats;
+
+  stats->bytes_flushed = __atomic_load_n(&src->bytes_flushed, __ATOMIC_RELAXED);
+  stats->bytes_invalidated = __atomic_load_n(&src->bytes_invalidated, __ATOMIC_RELAXED);
+  stats->flushes = __atomic_load_n(&src->flushes, __ATOMIC_RELAXED);
+  stats->invalidations = __atomic_load_n(&src->invalidations, __ATOMIC_RELAXED);
+  stats->flushes_skipped = __atomic_load_n(&src->flushes_skipped, __ATOMIC_RELAXED);
+}
+
+void
+gst_simaai_segment_allocator_reset_cache_stats (GstAllocator * allocator)
+{
+  g_return_if_fail (GST_IS_SIMAAI_SEGMENT_ALLOCATOR2(allocator));
+
+  GstSimaaiCacheStats *stats = &GST_SIMAAI_SEGMENT_ALLOCATOR2(allocator)->cache_stats;
+
+  __atomic_store_n(&stats->bytes_flushed, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&stats->bytes_invalidated, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&stats->flushes, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&stats->invalidations, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&stats->flushes_skipped, 0, __ATOMIC_RELAXED);
 }
@@ -78,13 +78,37 @@ simaai_target_mem_free(GstMemory * mem);
 G_DECLARE_FINAL_TYPE (GstSimaaiSegmentAllocator, gst_simaai_segment_allocator2,
                       GST, SIMAAI_SEGMENT_ALLOCATOR2, GstAllocator)
 
+/**
+ * GstSimaaiCacheStats:
+ *
+ * Cache maintenance done by a segment allocator on CPU maps of its memories.
+ * Byte counters include rounding of partial ranges to cache lines.
+ */
+typedef struct {
+  guint64 bytes_flushed;
+  guint64 bytes_invalidated;
+  guint64 flushes;
+  guint64 invalidations;
+  guint64 flushes_skipped;     ///< write unmaps with nothing left to flush
+} GstSimaaiCacheStats;
+
 struct _GstSimaaiSegmentAllocator
 {
   GstAllocator parent;
+  GstSimaaiCacheStats cache_stats;
 };
 
 typedef struct _GstSimaaiAllocationParams GstSimaaiAllocationParams;
 
+/**
+ * GstSimaaiSlab:
+ *
+ * One contiguous Simaai memory allocation carved into equal buffers. Every
+ * buffer has its own segment table. The slab is freed as a unit once it is
+ * unreferenced and all memories carved from it are freed.
+ */
+typedef struct _GstSimaaiSlab GstSimaaiSlab;
+
 /**
  * MAX_ALLOCATION_SEGMENTS:
  *
@@ -114,6 +138,8 @@ struct _GstSimaaiAllocationParams {
   GstAllocationParams parent;
   segment_t segments[MAX_ALLOCATION_SEGMENTS];
   gsize num_of_segments;
+  /// @brief If set, memories are carved from this slab instead of allocated
+  GstSimaaiSlab *slab;
 };
 
 /**
@@ -162,18 +188,195 @@ gboolean gst_simaai_memory_allocation_params_add_segment (GstSimaaiAllocationPar
                                                           const gsize size,
                                                           const gchar * name);
 
+/**
+ * gst_simaai_slab_new:
+ * @params: segments of every buffer and memory flags
+ * @n_buffers: number of buffers in the slab
+ *
+ * Allocate one contiguous Simaai memory block for @n_buffers buffers with the
+ * segments of @params. Every buffer starts at a page boundary, so buffers do
+ * not share cache lines. Set the slab in #GstSimaaiAllocationParams to carve
+ * memories from it with gst_allocator_alloc().
+ *
+ * Returns: (transfer full): a new slab, or NULL if the allocation failed.
+ */
+GstSimaaiSlab * gst_simaai_slab_new (const GstSimaaiAllocationParams * params, guint n_buffers);
+
+/**
+ * gst_simaai_slab_ref:
+ * @slab: a #GstSimaaiSlab
+ *
+ * Returns: (transfer full): @slab
+ */
+GstSimaaiSlab * gst_simaai_slab_ref (GstSimaaiSlab * slab);
+
+/**
+ * gst_simaai_slab_unref:
+ * @slab: (transfer full): a #GstSimaaiSlab
+ *
+ * Release a reference. Memories carved from the slab keep it alive.
+ */
+void gst_simaai_slab_unref (GstSimaaiSlab * slab);
+
+/**
+ * gst_simaai_slab_get_size:
+ * @slab: a #GstSimaaiSlab
+ *
+ * Returns: size of the contiguous block, including alignment padding.
+ */
+gsize gst_simaai_slab_get_size (const GstSimaaiSlab * slab);
+
+/**
+ * GstSimaaiSegmentId:
+ *
+ * Interned segment name. A name resolves to the same small integer in the
+ * whole process, so per frame lookups by id compare integers instead of
+ * strings. GST_SIMAAI_SEGMENT_ID_PARENT selects the parent segment.
+ */
+typedef guint32 GstSimaaiSegmentId;
+
+#define GST_SIMAAI_SEGMENT_ID_INVALID 0
+#define GST_SIMAAI_SEGMENT_ID_PARENT  1
+
+/**
+ * gst_simaai_segment_id_from_name:
+ * @name: a name of the Simaai memory segment, or NULL for the parent segment
+ *
+ * Resolve a segment name to its id, registering the name on first use.
+ * Takes a lock, call it once at configuration time and keep the id.
+ *
+ * Returns: the segment id.
+ */
+GstSimaaiSegmentId gst_simaai_segment_id_from_name (const gchar * name);
+
+/**
+ * gst_simaai_segment_id_to_name:
+ * @id: a segment id
+ *
+ * Returns: the registered name of @id, or NULL for the parent or an unknown id.
+ */
+const gchar * gst_simaai_segment_id_to_name (GstSimaaiSegmentId id);
+
+/**
+ * gst_simaai_memory_get_segment_by_id:
+ * @memory: a #GstMemory
+ * @id: a segment id from gst_simaai_segment_id_from_name()
+ *
+ * Returns: a pointer to the Simaai memory segment, or NULL if @memory has no
+ *          segment with this id.
+ */
+void * gst_simaai_memory_get_segment_by_id (const GstMemory * memory, GstSimaaiSegmentId id);
+
+/**
+ * gst_simaai_memory_get_segment_phys_addr:
+ * @memory: a #GstMemory
+ * @id: a segment id
+ *
+ * Returns: physical address of the segment, or 0 if there is no such segment.
+ */
+guintptr gst_simaai_memory_get_segment_phys_addr (const GstMemory * memory, GstSimaaiSegmentId id);
+
+/**
+ * gst_simaai_memory_get_segment_size:
+ * @memory: a #GstMemory
+ * @id: a segment id
+ *
+ * Returns: size of the segment, or 0 if there is no such segment.
+ */
+gsize gst_simaai_memory_get_segment_size (const GstMemory * memory, GstSimaaiSegmentId id);
+
+/**
+ * gst_simaai_memory_get_segment_data:
+ * @memory: a #GstMemory
+ * @id: a segment id
+ *
+ * Get the virtual address of a segment in the mapping of the memory. No cache
+ * maintenance is done, use gst_memory_map() or gst_simaai_memory_map_range()
+ * to access cached memory from the CPU.
+ *
+ * Returns: virtual address of the segment, or NULL if there is no such segment.
+ */
+gpointer gst_simaai_memory_get_segment_data (const GstMemory * memory, GstSimaaiSegmentId id);
+
 /**
  * gst_simaai_memory_get_segment:
  * @memory: a #GstMemory
  * @name: a name of the Simaai memory segment to get.
  *        If NULL then to get the parent segment.
  *
- * Get the pointer to the Simaai memory segment by a name.
+ * Get the pointer to the Simaai memory segment by a name. Same as
+ * gst_simaai_memory_get_segment_by_id() with the id of @name.
  *
  * Returns: a pointer to the Simaai memory segment.
  */
 void * gst_simaai_memory_get_segment (const GstMemory * memory, const gchar * name);
 
+/**
+ * GstSimaaiRangeMapInfo:
+ * @memory: a pointer to the mapped memory
+ * @flags: flags used when mapping the memory
+ * @data: a pointer to the mapped range
+ * @offset: offset of the range from the start of @memory
+ * @size: size of the mapped range
+ *
+ * A structure containing the result of a range map operation.
+ */
+typedef struct {
+  GstMemory *memory;
+  GstMapFlags flags;
+  guint8 *data;
+  gsize offset;
+  gsize size;
+} GstSimaaiRangeMapInfo;
+
+/**
+ * gst_simaai_memory_map_range:
+ * @memory: a #GstMemory of the segment allocator
+ * @name: a name of the Simaai memory segment, or NULL for the whole memory
+ * @offset: offset of the range in the segment
+ * @size: size of the range, or -1 for the rest of the segment
+ * @info: a #GstSimaaiRangeMapInfo to fill
+ * @flags: mapping flags
+ *
+ * Map a byte range of one segment. For cached memory only the range is
+ * invalidated on GST_MAP_READ, and GST_MAP_WRITE marks only the range dirty,
+ * so the matching unmap flushes only the range. Ranges that do not cover a
+ * whole segment are maintained by cache line where the CPU allows it, and by
+ * the whole segment otherwise.
+ *
+ * Returns: TRUE if the range was mapped.
+ */
+gboolean gst_simaai_memory_map_range (GstMemory * memory, const gchar * name,
+                                      gsize offset, gssize size,
+                                      GstSimaaiRangeMapInfo * info, GstMapFlags flags);
+
+/**
+ * gst_simaai_memory_unmap_range:
+ * @info: a #GstSimaaiRangeMapInfo filled by gst_simaai_memory_map_range()
+ *
+ * Unmap a range. If the range was mapped for writing and no other write map of
+ * the memory is left, everything written through all of them is flushed.
+ */
+void gst_simaai_memory_unmap_range (GstSimaaiRangeMapInfo * info);
+
+/**
+ * gst_simaai_segment_allocator_get_cache_stats:
+ * @allocator: a segment #GstAllocator
+ * @stats: a #GstSimaaiCacheStats to fill
+ *
+ * Get cache maintenance counters of the allocator.
+ */
+void gst_simaai_segment_allocator_get_cache_stats (GstAllocator * allocator,
+                                                   GstSimaaiCacheStats * stats);
+
+/**
+ * gst_simaai_segment_allocator_reset_cache_stats:
+ * @allocator: a segment #GstAllocator
+ *
+ * Reset cache maintenance counters of the allocator.
+ */
+void gst_simaai_segment_allocator_reset_cache_stats (GstAllocator * allocator);
+
 G_END_DECLS
 
 #endif
@@ -116,7 +116,93 @@ main (int argc, char **argv)
   g_assert_true(memcmp(info.data, &test1, sizeof(test1)) == 0);
   gst_memory_unmap (mem, &info);
 
+  // Segment ids
+  GstSimaaiSegmentId seg2_id = gst_simaai_segment_id_from_name("seg2");
+  g_assert_true(seg2_id == gst_simaai_segment_id_from_name("seg2"));
+  g_assert_true(seg2_id != gst_simaai_segment_id_from_name("seg1"));
+  g_assert_true(gst_simaai_memory_get_segment_by_id(mem, seg2_id) ==
+                gst_simaai_memory_get_segment(mem, "seg2"));
+  g_assert_true(gst_simaai_memory_get_segment_size(mem, seg2_id) == seg2_size);
+  g_assert_true(gst_simaai_memory_get_segment_phys_addr(mem, seg2_id) ==
+                gst_simaai_memory_get_segment_phys_addr(mem, GST_SIMAAI_SEGMENT_ID_PARENT) + seg1_size);
+  g_assert_true(gst_simaai_memory_get_segment_by_id(mem, gst_simaai_segment_id_from_name("seg3")) == NULL);
+
+  // Range maps
+  g_message("Testing range maps of %s allocator", GST_ALLOCATOR_SIMAAI_SEGMENT);
+
+  GstSimaaiCacheStats stats;
+  GstSimaaiRangeMapInfo range;
+  gst_simaai_segment_allocator_reset_cache_stats(alloc);
+
+  g_assert_true(gst_simaai_memory_map_range(mem, "seg2", 64, 256, &range, GST_MAP_WRITE));
+  g_assert_true(range.offset == seg1_size + 64 && range.size == 256);
+  memset(range.data, 0x5a, range.size);
+  gst_simaai_memory_unmap_range(&range);
+
+  g_assert_true(gst_simaai_memory_map_range(mem, "seg2", 0, -1, &range, GST_MAP_READ));
+  g_assert_true(range.size == seg2_size);
+  g_assert_true(range.data[64] == 0x5a && range.data[64 + 255] == 0x5a);
+  gst_simaai_memory_unmap_range(&range);
+
+  g_assert_false(gst_simaai_memory_map_range(mem, "seg2", seg2_size - 8, 16, &range, GST_MAP_READ));
+  g_assert_false(gst_simaai_memory_map_range(mem, "seg3", 0, -1, &range, GST_MAP_READ));
+
+  gst_simaai_segment_allocator_get_cache_stats(alloc, &stats);
+  g_message("flushed %" G_GUINT64_FORMAT " bytes, invalidated %" G_GUINT64_FORMAT " bytes",
+            stats.bytes_flushed, stats.bytes_invalidated);
+  g_assert_true(stats.flushes == 1 && stats.invalidations == 1);
+  g_assert_true(stats.bytes_flushed >= 256 && stats.bytes_flushed <= seg2_size);
+  g_assert_true(stats.bytes_invalidated == seg2_size);
+
+  // only the last of two writers flushes, including what the first one wrote last
+  gst_simaai_segment_allocator_reset_cache_stats(alloc);
+  gst_memory_map (mem, &info, GST_MAP_WRITE);
+  g_assert_true(gst_simaai_memory_map_range(mem, "seg2", 64, 256, &range, GST_MAP_WRITE));
+  gst_simaai_memory_unmap_range(&range);
+  info.data[0] = 0xa5;
+  gst_memory_unmap (mem, &info);
+  gst_simaai_segment_allocator_get_cache_stats(alloc, &stats);
+  g_assert_true(stats.flushes == 1 && stats.flushes_skipped == 1);
+  g_assert_true(stats.bytes_flushed == total_size);
+
   gst_memory_unref (mem);
+
+  // Slab carving
+  g_message("Testing slab of %s allocator", GST_ALLOCATOR_SIMAAI_SEGMENT);
+
+  const guint slab_buffers = 3;
+  GstSimaaiSlab *slab = gst_simaai_slab_new(&seg_params, slab_buffers);
+  g_assert_true(slab != NULL);
+  g_assert_true(gst_simaai_slab_get_size(slab) >= slab_buffers * total_size);
+  seg_params.slab = slab;
+
+  GstMemory *slab_mems[slab_buffers];
+  for (guint i = 0; i < slab_buffers; i++) {
+    slab_mems[i] = gst_allocator_alloc (alloc, total_size, (GstAllocationParams *)(&seg_params));
+    g_assert_true(slab_mems[i] != NULL);
+    g_assert_true(gst_simaai_memory_get_segment_size(slab_mems[i], seg2_id) == seg2_size);
+    g_assert_true((gst_simaai_memory_get_phys_addr(slab_mems[i]) & 4095) == 0);
+  }
+  // every buffer of the slab is in use
+  g_assert_true(gst_allocator_alloc (alloc, total_size, (GstAllocationParams *)(&seg_params)) == NULL);
+
+  // buffers do not overlap
+  gst_memory_map (slab_mems[0], &info, GST_MAP_WRITE);
+  memset(info.data, 0x11, info.size);
+  gst_memory_unmap (slab_mems[0], &info);
+  gst_memory_map (slab_mems[1], &info, GST_MAP_WRITE);
+  memset(info.data, 0x22, info.size);
+  gst_memory_unmap (slab_mems[1], &info);
+  gst_memory_map (slab_mems[0], &info, GST_MAP_READ);
+  g_assert_true(info.data[info.size - 1] == 0x11);
+  gst_memory_unmap (slab_mems[0], &info);
+
+  // memories keep the slab alive
+  seg_params.slab = NULL;
+  gst_simaai_slab_unref(slab);
+  for (guint i = 0; i < slab_buffers; i++)
+    gst_memory_unref (slab_mems[i]);
+
   gst_object_unref (alloc);
 
   // Segmented memory API
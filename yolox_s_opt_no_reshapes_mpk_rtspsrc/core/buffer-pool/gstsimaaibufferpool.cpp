@@ -28,6 +28,8 @@
 //
 //**************************************************************************
 
+#include <string.h>
+
 #include "gstsimaaibufferpool.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_simaai_buffer_pool_debug);
@@ -41,53 +43,319 @@ G_DEFINE_TYPE_WITH_CODE (GstSimaaiBufferPool, gst_simaai_buffer_pool, GST_TYPE_B
 #define GST_SIMAAI_BUFFER_POOL_LOCK(pool)   (g_rec_mutex_lock(&pool->priv->rec_lock))
 #define GST_SIMAAI_BUFFER_POOL_UNLOCK(pool) (g_rec_mutex_unlock(&pool->priv->rec_lock))
 
+enum {
+  PROP_0,
+  PROP_PREALLOCATE,
+  PROP_SLAB,
+  PROP_STATS,
+};
+
+#define DEFAULT_PREALLOCATE TRUE
+#define DEFAULT_SLAB        TRUE
+
 /*
- * @brief virtuall function to allocate buffer in buffer pool
+ * @brief virtuall function to set config of buffer pool. Allocator and
+ *        allocation params are parsed here once instead of per buffer.
  */
-static GstFlowReturn gst_simaai_buffer_pool_alloc_buffer (GstBufferPool * pool, 
-                                                          GstBuffer ** buffer,
-                                                          GstBufferPoolAcquireParams * params)
+static gboolean gst_simaai_buffer_pool_set_config (GstBufferPool * pool,
+                                                   GstStructure * config)
 {
   GstSimaaiBufferPool *buffer_pool = GST_SIMAAI_BUFFER_POOL(pool);
-
-  GstAllocator * allocator;
+  GstCaps *caps;
+  guint size, min_buffers, max_buffers;
+  GstAllocator *allocator = NULL;
   GstAllocationParams allocation_params;
-  GstStructure * config = gst_buffer_pool_get_config(pool);
 
-  gst_buffer_pool_config_get_allocator(config, &allocator, &allocation_params);
+  if (!gst_buffer_pool_config_get_params(config, &caps, &size, &min_buffers, &max_buffers) ||
+      !gst_buffer_pool_config_get_allocator(config, &allocator, &allocation_params)) {
+    GST_ERROR_OBJECT(buffer_pool, "invalid config %" GST_PTR_FORMAT, config);
+    return FALSE;
+  }
+
+  // all buffers are allocated in start() when min == max
+  if (buffer_pool->preallocate && max_buffers > min_buffers) {
+    GST_DEBUG_OBJECT(buffer_pool, "preallocating %u buffers instead of %u",
+                     max_buffers, min_buffers);
+    min_buffers = max_buffers;
+    gst_buffer_pool_config_set_params(config, caps, size, min_buffers, max_buffers);
+  }
+
+  if (buffer_pool->allocator)
+    gst_object_unref(buffer_pool->allocator);
+  buffer_pool->allocator = allocator ? (GstAllocator *) gst_object_ref(allocator) : NULL;
 
-  GstSimaaiAllocationParams sima_params;
+  GstSimaaiAllocationParams & sima_params = buffer_pool->alloc_params;
   sima_params.parent = allocation_params;
   sima_params.num_of_segments = buffer_pool->number_of_segments;
-  gsize total_size = 0;
+  sima_params.slab = NULL;
+  buffer_pool->max_buffers = max_buffers;
+  buffer_pool->buffer_size = 0;
   for (int i = 0; i < buffer_pool->number_of_segments; i++) {
     sima_params.segments[i] = buffer_pool->segments[i];
-    total_size += buffer_pool->segments[i].size;
+    buffer_pool->buffer_size += buffer_pool->segments[i].size;
   }
-    
 
-  //GstMemory *mem = gst_allocator_alloc(allocator, 1024, (GstAllocationParams *)(&sima_params));
-  //g_assert_true(mem != NULL);
+  return GST_BUFFER_POOL_CLASS(parent_class)->set_config(pool, config);
+}
 
-  GST_DEBUG_OBJECT(buffer_pool, "GstSimaaiBufferPool: allocating a buffer with size %zu", total_size);
-  *buffer = gst_buffer_new_allocate(allocator, 
-                                    total_size, 
-                                    (GstAllocationParams *)(&sima_params));
+/*
+ * @brief virtuall function to allocate buffer in buffer pool
+ */
+static GstFlowReturn gst_simaai_buffer_pool_alloc_buffer (GstBufferPool * pool, 
+                                                          GstBuffer ** buffer,
+                                                          GstBufferPoolAcquireParams * params)
+{
+  GstSimaaiBufferPool *buffer_pool = GST_SIMAAI_BUFFER_POOL(pool);
 
-  if (!*buffer)
+  GST_DEBUG_OBJECT(buffer_pool, "GstSimaaiBufferPool: allocating a buffer with size %zu",
+                   buffer_pool->buffer_size);
+  *buffer = gst_buffer_new_allocate(buffer_pool->allocator,
+                                    buffer_pool->buffer_size,
+                                    (GstAllocationParams *)(&buffer_pool->alloc_params));
+
+  GST_OBJECT_LOCK(buffer_pool);
+  if (*buffer)
+    buffer_pool->stats.allocated++;
+  else
+    buffer_pool->stats.alloc_failures++;
+  GST_OBJECT_UNLOCK(buffer_pool);
+
+  if (!*buffer) {
+    GST_WARNING_OBJECT(buffer_pool, "failed to allocate a buffer with size %zu",
+                       buffer_pool->buffer_size);
     return GST_FLOW_ERROR;
+  }
 
   return GST_FLOW_OK;
 }
 
+/*
+ * @brief virtuall function to free buffer of buffer pool
+ */
+static void gst_simaai_buffer_pool_free_buffer (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstSimaaiBufferPool *buffer_pool = GST_SIMAAI_BUFFER_POOL(pool);
+
+  GST_OBJECT_LOCK(buffer_pool);
+  buffer_pool->stats.allocated--;
+  GST_OBJECT_UNLOCK(buffer_pool);
+
+  GST_BUFFER_POOL_CLASS(parent_class)->free_buffer(pool, buffer);
+}
+
+/*
+ * @brief virtuall function to start buffer pool, counters restart with it
+ */
+static gboolean gst_simaai_buffer_pool_start (GstBufferPool * pool)
+{
+  GstSimaaiBufferPool *buffer_pool = GST_SIMAAI_BUFFER_POOL(pool);
+
+  GST_OBJECT_LOCK(buffer_pool);
+  memset(&buffer_pool->stats, 0, sizeof(buffer_pool->stats));
+  GST_OBJECT_UNLOCK(buffer_pool);
+
+  // One contiguous allocation for the whole pool when its size is bounded.
+  // The slab is sized once here, buffers are carved from it in alloc_buffer.
+  if (buffer_pool->slab && buffer_pool->max_buffers > 0 &&
+      buffer_pool->allocator && GST_IS_SIMAAI_SEGMENT_ALLOCATOR2(buffer_pool->allocator)) {
+    buffer_pool->active_slab = gst_simaai_slab_new(&buffer_pool->alloc_params,
+                                                   buffer_pool->max_buffers);
+    if (buffer_pool->active_slab) {
+      GST_DEBUG_OBJECT(buffer_pool, "carving %u buffers from a %zu bytes slab",
+                       buffer_pool->max_buffers,
+                       gst_simaai_slab_get_size(buffer_pool->active_slab));
+    } else {
+      GST_WARNING_OBJECT(buffer_pool, "slab allocation failed, allocating buffers separately");
+    }
+    buffer_pool->alloc_params.slab = buffer_pool->active_slab;
+  }
+
+  gboolean res = GST_BUFFER_POOL_CLASS(parent_class)->start(pool);
+
+  // buffers allocated in start are released to the pool, none is in use
+  GST_OBJECT_LOCK(buffer_pool);
+  buffer_pool->stats.in_use = 0;
+  GST_OBJECT_UNLOCK(buffer_pool);
+
+  GST_DEBUG_OBJECT(buffer_pool, "started with %u buffers", buffer_pool->stats.allocated);
+  return res;
+}
+
+/*
+ * @brief virtuall function to stop buffer pool, the slab is released after all
+ *        its buffers are freed
+ */
+static gboolean gst_simaai_buffer_pool_stop (GstBufferPool * pool)
+{
+  GstSimaaiBufferPool *buffer_pool = GST_SIMAAI_BUFFER_POOL(pool);
+
+  gboolean res = GST_BUFFER_POOL_CLASS(parent_class)->stop(pool);
+
+  buffer_pool->alloc_params.slab = NULL;
+  if (buffer_pool->active_slab) {
+    gst_simaai_slab_unref(buffer_pool->active_slab);
+    buffer_pool->active_slab = NULL;
+  }
+
+  return res;
+}
+
+/*
+ * @brief virtuall function to acquire buffer, measures time spent waiting
+ */
+static GstFlowReturn gst_simaai_buffer_pool_acquire_buffer (GstBufferPool * pool,
+                                                            GstBuffer ** buffer,
+                                                            GstBufferPoolAcquireParams * params)
+{
+  GstSimaaiBufferPool *buffer_pool = GST_SIMAAI_BUFFER_POOL(pool);
+
+  gint64 t0 = g_get_monotonic_time();
+  GstFlowReturn ret = GST_BUFFER_POOL_CLASS(parent_class)->acquire_buffer(pool, buffer, params);
+  guint64 wait = (guint64)(g_get_monotonic_time() - t0);
+
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  GstSimaaiBufferPoolStats & stats = buffer_pool->stats;
+  GST_OBJECT_LOCK(buffer_pool);
+  stats.acquired++;
+  stats.acquire_wait_us += wait;
+  stats.acquire_wait_max_us = MAX(stats.acquire_wait_max_us, wait);
+  stats.in_use++;
+  stats.peak_in_use = MAX(stats.peak_in_use, stats.in_use);
+  GST_OBJECT_UNLOCK(buffer_pool);
+
+  return ret;
+}
+
+/*
+ * @brief virtuall function to release buffer back to buffer pool
+ */
+static void gst_simaai_buffer_pool_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstSimaaiBufferPool *buffer_pool = GST_SIMAAI_BUFFER_POOL(pool);
+
+  GST_OBJECT_LOCK(buffer_pool);
+  buffer_pool->stats.in_use--;
+  GST_OBJECT_UNLOCK(buffer_pool);
+
+  GST_BUFFER_POOL_CLASS(parent_class)->release_buffer(pool, buffer);
+}
+
+void gst_simaai_buffer_pool_get_stats (GstSimaaiBufferPool * pool,
+                                       GstSimaaiBufferPoolStats * stats)
+{
+  g_return_if_fail (GST_IS_SIMAAI_BUFFER_POOL(pool));
+  g_return_if_fail (stats != NULL);
+
+  GST_OBJECT_LOCK(pool);
+  *stats = pool->stats;
+  GST_OBJECT_UNLOCK(pool);
+}
+
+static void gst_simaai_buffer_pool_set_property (GObject * object, guint prop_id,
+                                                 const GValue * value, GParamSpec * pspec)
+{
+  GstSimaaiBufferPool *pool = GST_SIMAAI_BUFFER_POOL(object);
+
+  switch (prop_id) {
+    case PROP_PREALLOCATE:
+      pool->preallocate = g_value_get_boolean(value);
+      break;
+    case PROP_SLAB:
+      pool->slab = g_value_get_boolean(value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+}
+
+static void gst_simaai_buffer_pool_get_property (GObject * object, guint prop_id,
+                                                 GValue * value, GParamSpec * pspec)
+{
+  GstSimaaiBufferPool *pool = GST_SIMAAI_BUFFER_POOL(object);
+
+  switch (prop_id) {
+    case PROP_PREALLOCATE:
+      g_value_set_boolean(value, pool->preallocate);
+      break;
+    case PROP_SLAB:
+      g_value_set_boolean(value, pool->slab);
+      break;
+    case PROP_STATS: {
+      GstSimaaiBufferPoolStats stats;
+      gst_simaai_buffer_pool_get_stats(pool, &stats);
+      g_value_take_boxed(value,
+          gst_structure_new("application/x-simaai-buffer-pool-stats",
+                            "acquired", G_TYPE_UINT64, stats.acquired,
+                            "acquire-wait-us", G_TYPE_UINT64, stats.acquire_wait_us,
+                            "acquire-wait-max-us", G_TYPE_UINT64, stats.acquire_wait_max_us,
+                            "in-use", G_TYPE_INT, stats.in_use,
+                            "peak-in-use", G_TYPE_INT, stats.peak_in_use,
+                            "allocated", G_TYPE_UINT, stats.allocated,
+                            "alloc-failures", G_TYPE_UINT, stats.alloc_failures,
+                            NULL));
+      break;
+    }
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+}
+
+static void gst_simaai_buffer_pool_finalize (GObject * object)
+{
+  GstSimaaiBufferPool *pool = GST_SIMAAI_BUFFER_POOL(object);
+
+  if (pool->allocator)
+    gst_object_unref(pool->allocator);
+  if (pool->active_slab)
+    gst_simaai_slab_unref(pool->active_slab);
+
+  G_OBJECT_CLASS(parent_class)->finalize(object);
+}
+
 /*
  * @brief virtuall function to initialize GstSimaaiBufferPool class
  */
 static void gst_simaai_buffer_pool_class_init (GstSimaaiBufferPoolClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GstBufferPoolClass *parent_klass = GST_BUFFER_POOL_CLASS (klass);
 
+  gobject_class->set_property = gst_simaai_buffer_pool_set_property;
+  gobject_class->get_property = gst_simaai_buffer_pool_get_property;
+  gobject_class->finalize = gst_simaai_buffer_pool_finalize;
+
+  parent_klass->set_config = gst_simaai_buffer_pool_set_config;
+  parent_klass->start = gst_simaai_buffer_pool_start;
+  parent_klass->stop = gst_simaai_buffer_pool_stop;
   parent_klass->alloc_buffer = gst_simaai_buffer_pool_alloc_buffer;
+  parent_klass->free_buffer = gst_simaai_buffer_pool_free_buffer;
+  parent_klass->acquire_buffer = gst_simaai_buffer_pool_acquire_buffer;
+  parent_klass->release_buffer = gst_simaai_buffer_pool_release_buffer;
+
+  g_object_class_install_property (gobject_class, PROP_PREALLOCATE,
+      g_param_spec_boolean ("preallocate", "Preallocate",
+          "Allocate max-buffers on activation instead of min-buffers, so no "
+          "buffer is allocated while streaming. Applies to the next set_config",
+          DEFAULT_PREALLOCATE,
+          (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_SLAB,
+      g_param_spec_boolean ("slab", "Slab",
+          "Carve all buffers of a pool with max-buffers set from one contiguous "
+          "allocation that is freed as a unit. Applies to the next activation",
+          DEFAULT_SLAB,
+          (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Counters since activation: acquired, acquire-wait-us, "
+          "acquire-wait-max-us, in-use, peak-in-use, allocated, alloc-failures",
+          GST_TYPE_STRUCTURE,
+          (GParamFlags)(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
 }
 
 /*
@@ -100,6 +368,14 @@ static void gst_simaai_buffer_pool_init (GstSimaaiBufferPool *pool)
     pool->segments[i].size = 0;
     pool->segments[i].name = NULL;
   }
+  pool->preallocate = DEFAULT_PREALLOCATE;
+  pool->slab = DEFAULT_SLAB;
+  pool->allocator = NULL;
+  pool->buffer_size = 0;
+  pool->max_buffers = 0;
+  pool->active_slab = NULL;
+  memset(&pool->alloc_params, 0, sizeof(pool->alloc_params));
+  memset(&pool->stats, 0, sizeof(pool->stats));
 }
 
 /**
@@ -245,6 +521,17 @@ GstBufferPool *gst_simaai_allocate_buffer_pool(GstObject *object,
 gboolean gst_simaai_free_buffer_pool(GstBufferPool *pool)
 {
   g_return_val_if_fail (pool != NULL, FALSE);
+
+  if (GST_IS_SIMAAI_BUFFER_POOL(pool)) {
+    GstSimaaiBufferPoolStats stats;
+    gst_simaai_buffer_pool_get_stats(GST_SIMAAI_BUFFER_POOL(pool), &stats);
+    GST_INFO_OBJECT(pool, "acquired %" G_GUINT64_FORMAT " buffers, wait %" G_GUINT64_FORMAT
+                    " us (max %" G_GUINT64_FORMAT " us), peak in use %d of %u, "
+                    "%u allocation failures", stats.acquired, stats.acquire_wait_us,
+                    stats.acquire_wait_max_us, stats.peak_in_use, stats.allocated,
+                    stats.alloc_failures);
+  }
+
   g_return_val_if_fail (gst_buffer_pool_set_active (pool, FALSE), FALSE);
   gst_object_unref (pool);
 
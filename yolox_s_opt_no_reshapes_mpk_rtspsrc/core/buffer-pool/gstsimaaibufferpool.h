@@ -52,6 +52,25 @@ G_DECLARE_FINAL_TYPE (GstSimaaiBufferPool, gst_simaai_buffer_pool,
 #define GST_SIMAAI_BUFFER_POOL_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST ((klass), GST_TYPE_SIMAAI_BUFFER_POOL, GstSimaaiBufferPoolClass))
 #define GST_SIMAAI_BUFFER_POOL_CAST(obj)            ((GstSimaaiBufferPool *)(obj))
 
+/**
+ * GstSimaaiBufferPoolStats:
+ *
+ * Counters of a #GstSimaaiBufferPool since its last activation.
+ */
+typedef struct {
+  /// @brief Buffers acquired from the pool
+  guint64 acquired;
+  /// @brief Total and longest time spent in gst_buffer_pool_acquire_buffer, us
+  guint64 acquire_wait_us;
+  guint64 acquire_wait_max_us;
+  /// @brief Buffers currently acquired and the highest value seen
+  gint in_use;
+  gint peak_in_use;
+  /// @brief Buffers allocated by the pool and failed allocations
+  guint allocated;
+  guint alloc_failures;
+} GstSimaaiBufferPoolStats;
+
 struct _GstSimaaiBufferPool 
 {
   GstBufferPool parent;
@@ -62,6 +81,22 @@ struct _GstSimaaiBufferPool
   
   /// @brief Number of memories to allocate
   int number_of_segments;
+
+  /// @brief Allocate max buffers on activation instead of min buffers
+  gboolean preallocate;
+
+  /// @brief Carve all buffers from one contiguous slab when max buffers is set
+  gboolean slab;
+
+  /*< private >*/
+  /// @brief Allocator and params parsed once in set_config
+  GstAllocator *allocator;
+  GstSimaaiAllocationParams alloc_params;
+  gsize buffer_size;
+  guint max_buffers;
+  GstSimaaiSlab *active_slab;
+
+  GstSimaaiBufferPoolStats stats;
 };
 
 /**
@@ -71,6 +106,17 @@ struct _GstSimaaiBufferPool
  */
 GstSimaaiBufferPool * gst_simaai_buffer_pool_new (void);
 
+/**
+ * gst_simaai_buffer_pool_get_stats:
+ * @pool: a #GstSimaaiBufferPool
+ * @stats: (out): counters of the pool
+ *
+ * Get counters of the pool. The same values are available as a
+ * #GstStructure in the "stats" property.
+ */
+void gst_simaai_buffer_pool_get_stats (GstSimaaiBufferPool * pool,
+                                       GstSimaaiBufferPoolStats * stats);
+
 /**
  * gst_simaai_allocate_buffer_pool:
  * @object: the #GstObject parent structure or NULL if none
@@ -28,28 +28,229 @@
 //
 //**************************************************************************
 
+#include <errno.h>
+
+#include <glib/gstdio.h>
 #include <gst/base/gstaggregator.h>
 
 #include "gstsimaaicaps.h"
 
+struct _GstSimaaiConfig {
+    gint ref_count;
+    gchar *path;
+    gchar *text;
+    gsize length;
+    JsonNode *root;
+    /* views of consumers, see gst_simaai_config_set_view */
+    GMutex lock;
+    GData *views;
+    /* file state the config was parsed from */
+    gint64 mtime;
+    goffset size;
+};
+
+/* path -> GstSimaaiConfig, the table holds a reference */
+G_LOCK_DEFINE_STATIC(config_cache);
+static GHashTable *config_cache = NULL;
+
+static GstSimaaiConfig *
+config_load(const gchar *path, const GStatBuf *st, GError **error)
+{
+    GstSimaaiConfig *config;
+    JsonParser *parser;
+    gchar *text;
+    gsize length;
+
+    if (!g_file_get_contents(path, &text, &length, error))
+        return NULL;
+
+    /* nodes of an immutable parser are sealed and safe to share */
+    parser = json_parser_new_immutable();
+    if (!json_parser_load_from_data(parser, text, length, error)) {
+        g_object_unref(parser);
+        g_free(text);
+        return NULL;
+    }
+
+    config = g_new0(GstSimaaiConfig, 1);
+    config->ref_count = 1;
+    config->path = g_strdup(path);
+    config->text = text;
+    config->length = length;
+    config->root = json_node_ref(json_parser_get_root(parser));
+    g_mutex_init(&config->lock);
+    g_datalist_init(&config->views);
+    config->mtime = st->st_mtime;
+    config->size = st->st_size;
+
+    g_object_unref(parser);
+
+    GST_DEBUG("Parsed config `%s`, %" G_GSIZE_FORMAT " bytes", path, length);
+
+    return config;
+}
+
+GstSimaaiConfig *
+gst_simaai_config_get(const gchar *path, GError **error)
+{
+    GstSimaaiConfig *config;
+    GStatBuf st;
+
+    g_return_val_if_fail(path != NULL, NULL);
+
+    if (g_stat(path, &st) != 0) {
+        int err = errno;
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(err),
+            "Cannot access `%s`: %s", path, g_strerror(err));
+        return NULL;
+    }
+
+    G_LOCK(config_cache);
+    if (!config_cache)
+        config_cache = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+            (GDestroyNotify) gst_simaai_config_unref);
+
+    config = g_hash_table_lookup(config_cache, path);
+    if (config && config->mtime == st.st_mtime && config->size == st.st_size) {
+        gst_simaai_config_ref(config);
+        G_UNLOCK(config_cache);
+        return config;
+    }
+    G_UNLOCK(config_cache);
+
+    /* parsed without the lock, elements with other configs do not wait */
+    config = config_load(path, &st, error);
+    if (!config)
+        return NULL;
+
+    G_LOCK(config_cache);
+    g_hash_table_replace(config_cache, config->path,
+        gst_simaai_config_ref(config));
+    G_UNLOCK(config_cache);
+
+    return config;
+}
+
+GstSimaaiConfig *
+gst_simaai_config_ref(GstSimaaiConfig *config)
+{
+    g_return_val_if_fail(config != NULL, NULL);
+
+    g_atomic_int_inc(&config->ref_count);
+    return config;
+}
+
+void
+gst_simaai_config_unref(GstSimaaiConfig *config)
+{
+    g_return_if_fail(config != NULL);
+
+    if (!g_atomic_int_dec_and_test(&config->ref_count))
+        return;
+
+    g_datalist_clear(&config->views);
+    g_mutex_clear(&config->lock);
+    json_node_unref(config->root);
+    g_free(config->text);
+    g_free(config->path);
+    g_free(config);
+}
+
+JsonNode *
+gst_simaai_config_get_root(const GstSimaaiConfig *config)
+{
+    g_return_val_if_fail(config != NULL, NULL);
+
+    return config->root;
+}
+
+const gchar *
+gst_simaai_config_get_text(const GstSimaaiConfig *config, gsize *length)
+{
+    g_return_val_if_fail(config != NULL, NULL);
+
+    if (length)
+        *length = config->length;
+    return config->text;
+}
+
+const gchar *
+gst_simaai_config_get_path(const GstSimaaiConfig *config)
+{
+    g_return_val_if_fail(config != NULL, NULL);
+
+    return config->path;
+}
+
+gpointer
+gst_simaai_config_get_view(GstSimaaiConfig *config, GQuark key)
+{
+    gpointer view;
+
+    g_return_val_if_fail(config != NULL, NULL);
+
+    g_mutex_lock(&config->lock);
+    view = g_datalist_id_get_data(&config->views, key);
+    g_mutex_unlock(&config->lock);
+
+    return view;
+}
+
+gpointer
+gst_simaai_config_set_view(GstSimaaiConfig *config, GQuark key,
+                           gpointer view, GDestroyNotify destroy)
+{
+    gpointer current;
+
+    g_return_val_if_fail(config != NULL && view != NULL, NULL);
+
+    /* elements brought to READY in parallel may race on the first view */
+    g_mutex_lock(&config->lock);
+    current = g_datalist_id_get_data(&config->views, key);
+    if (!current)
+        g_datalist_id_set_data_full(&config->views, key, view, destroy);
+    g_mutex_unlock(&config->lock);
+
+    if (current) {
+        if (destroy)
+            destroy(view);
+        return current;
+    }
+
+    return view;
+}
+
+/* Top level config field, negotiated values take precedence over the file */
+static JsonNode *
+get_field(GstSimaaiCaps *simaai_caps, JsonObject *root, const gchar *json_field)
+{
+    if (json_object_has_member(simaai_caps->overrides, json_field))
+        return json_object_get_member(simaai_caps->overrides, json_field);
+
+    return json_object_get_member(root, json_field);
+}
+
 static gboolean
-fixate_caps(GString *caps, JsonObject *root, const gchar *name,
-    const gchar *type, const gchar *json_field)
+fixate_caps(GString *caps, JsonNode *field, const gchar *name,
+    const gchar *type)
 {
     JsonArray *values_arr;
     guint8 i;
 
-    values_arr = json_object_get_array_member(root, json_field);
+    if (!field)
+        return FALSE;
+
+    values_arr = JSON_NODE_HOLDS_ARRAY(field) ? json_node_get_array(field) : NULL;
     if (!values_arr)
         if (g_strcmp0(type, "int") == 0)
             g_string_append_printf(caps, ", %s=(%s)%ld", name, type,
-                json_object_get_int_member(root, json_field));
+                json_node_get_int(field));
         else if (g_strcmp0(type, "float") == 0)
             g_string_append_printf(caps, ", %s=(%s)%f", name, type,
-                json_object_get_double_member(root, json_field));
+                json_node_get_double(field));
         else if (g_strcmp0(type, "string") == 0)
             g_string_append_printf(caps, ", %s=(%s)%s", name, type,
-                json_object_get_string_member(root, json_field));
+                json_node_get_string(field));
         else
             return FALSE;
     else
@@ -70,66 +271,81 @@ fixate_caps(GString *caps, JsonObject *root, const gchar *name,
 }
 
 static gboolean
-write_values(JsonObject *root, const gchar *json_field, const gchar *name,
-    const gchar *type, JsonArray *values, GstStructure *s)
+set_value(JsonNode *node, const gchar *type, const GValue *caps_value)
 {
-    const GValue *caps_value;
-    guint8 i;
     const gchar *value_str;
+
+    if (g_strcmp0(type, "int") == 0) {
+        json_node_set_int(node, g_value_get_int(caps_value));
+    } else if (g_strcmp0(type, "float") == 0) {
+        json_node_set_double(node, g_value_get_double(caps_value));
+    } else if (g_strcmp0(type, "string") == 0) {
+        value_str = g_value_get_string(caps_value);
+        if (g_strcmp0(value_str, "I420") == 0)
+            json_node_set_string(node, "IYUV");
+        else
+            json_node_set_string(node, value_str);
+    } else {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Store negotiated values of a field in the override layer. Array fields get
+ * one value per element, the config itself is left untouched.
+ */
+static gboolean
+write_values(JsonObject *overrides, const gchar *json_field, const gchar *name,
+    const gchar *type, JsonNode *field, GstStructure *s)
+{
+    const GValue *caps_value;
+    guint8 i, length;
     gchar *element_name_str;
     JsonNode *node;
+    JsonArray *values;
 
-    if (!values) {
+    if (!field || !JSON_NODE_HOLDS_ARRAY(field)) {
         caps_value = gst_structure_get_value(s, name);
         if (!caps_value) {
             GST_ERROR("<%s>: Error retrieving a value for %s", G_STRFUNC, name);
             return FALSE;
         }
 
-        if (g_strcmp0(type, "int") == 0) {
-            json_object_set_int_member(root, json_field,
-                g_value_get_int(caps_value));
-        } else if (g_strcmp0(type, "float") == 0) {
-            json_object_set_double_member(root, json_field,
-                g_value_get_double(caps_value));
-        } else if (g_strcmp0(type, "string") == 0) {
-            value_str = g_value_get_string(caps_value);
-            if (g_strcmp0(value_str, "I420") == 0)
-                json_object_set_string_member(root, json_field, "IYUV");
-            else
-                json_object_set_string_member(root, json_field, value_str);
-        } else {
+        node = json_node_new(JSON_NODE_VALUE);
+        if (!set_value(node, type, caps_value)) {
+            json_node_unref(node);
             return FALSE;
         }
+        json_object_set_member(overrides, json_field, node);
     } else {
-        for (i = 0; i < json_array_get_length(values); ++i) {
+        length = json_array_get_length(json_node_get_array(field));
+        values = json_array_sized_new(length);
+
+        for (i = 0; i < length; ++i) {
             element_name_str = g_strdup_printf("%s__%hhu", name, i);
 
             caps_value = gst_structure_get_value(s, element_name_str);
             if (!caps_value) {
                 GST_ERROR("<%s>: Error retrieving a value for %s", G_STRFUNC,
                     element_name_str);
+                g_free(element_name_str);
+                json_array_unref(values);
                 return FALSE;
             }
+            g_free(element_name_str);
 
-            node = json_array_get_element(values, i);
-
-            if (g_strcmp0(type, "int") == 0) {
-                json_node_set_int(node, g_value_get_int(caps_value));
-            } else if (g_strcmp0(type, "float") == 0) {
-                json_node_set_double(node, g_value_get_double(caps_value));
-            } else if (g_strcmp0(type, "string") == 0) {
-                value_str = g_value_get_string(caps_value);
-                if (g_strcmp0(value_str, "I420") == 0)
-                    json_node_set_string(node, "IYUV");
-                else
-                    json_node_set_string(node, value_str);
-            } else {
+            node = json_node_new(JSON_NODE_VALUE);
+            if (!set_value(node, type, caps_value)) {
+                json_node_unref(node);
+                json_array_unref(values);
                 return FALSE;
             }
-
-            g_free(element_name_str);
+            json_array_add_element(values, node);
         }
+
+        json_object_set_array_member(overrides, json_field, values);
     }
 
     return TRUE;
@@ -303,11 +519,15 @@ gst_simaai_caps_process_sink_caps(GstElement *element,
     GstStructure *s = NULL;
     JsonNode *root;
     JsonObject *root_obj, *caps_obj, *pad_obj, *param_obj;
-    JsonArray *pads_arr, *params_arr, *values_arr;
+    JsonArray *pads_arr, *params_arr;
     const gchar *media_type_peer_str;
     guint8 i, j;
     const gchar *media_type_str, *type_str, *name_str, *json_field_str;
-    JsonGenerator *generator = json_generator_new();
+
+    if (!simaai_caps->parsed) {
+        GST_ERROR_OBJECT(element, "<%s>: No config parsed", G_STRFUNC);
+        return FALSE;
+    }
 
     gst_event_parse_caps(event, &caps);
     if (!caps) {
@@ -323,7 +543,7 @@ gst_simaai_caps_process_sink_caps(GstElement *element,
         return FALSE;
     }
 
-    root = json_parser_get_root(simaai_caps->parser);
+    root = gst_simaai_config_get_root(simaai_caps->parsed);
     if (!JSON_NODE_HOLDS_OBJECT(root)) {
         GST_ERROR_OBJECT(element, "<%s>: Error retrieving a top level node",
             G_STRFUNC);
@@ -407,9 +627,8 @@ gst_simaai_caps_process_sink_caps(GstElement *element,
                 return FALSE;
             }
 
-            values_arr = json_object_get_array_member(root_obj, json_field_str);
-            if (!write_values(root_obj, json_field_str, name_str, type_str,
-                values_arr, s)) {
+            if (!write_values(simaai_caps->overrides, json_field_str, name_str,
+                type_str, get_field(simaai_caps, root_obj, json_field_str), s)) {
                 GST_ERROR_OBJECT(element, "<%s>: Error processing the `%s` "
                     "parameter type", G_STRFUNC, type_str);
                 return FALSE;
@@ -417,18 +636,6 @@ gst_simaai_caps_process_sink_caps(GstElement *element,
         }
     }
 
-    json_generator_set_root(generator, root);
-
-    json_generator_set_pretty(generator, TRUE);
-    json_generator_set_indent(generator, 4);
-
-    if (!json_generator_to_file(generator, simaai_caps->config, NULL)) {
-        GST_ERROR_OBJECT(element, "<%s>: Error writing to `%s`", G_STRFUNC,
-            simaai_caps->config);
-    }
-
-    g_object_unref(generator);
-
     GST_WARNING_OBJECT(element, "<%s>: Processed caps: %s", G_STRFUNC,
         gst_caps_to_string(caps));
 
@@ -449,7 +656,12 @@ gst_simaai_caps_fixate_src_caps(GstElement *element, GstSimaaiCaps *simaai_caps,
     guint8 i;
     gchar **tokens;
 
-    root = json_parser_get_root(simaai_caps->parser);
+    if (!simaai_caps->parsed) {
+        GST_ERROR_OBJECT(element, "<%s>: No config parsed", G_STRFUNC);
+        return NULL;
+    }
+
+    root = gst_simaai_config_get_root(simaai_caps->parsed);
     if (!JSON_NODE_HOLDS_OBJECT(root)) {
         GST_ERROR_OBJECT(element, "<%s>: Error retrieving a top level node",
             G_STRFUNC);
@@ -545,8 +757,8 @@ gst_simaai_caps_fixate_src_caps(GstElement *element, GstSimaaiCaps *simaai_caps,
             continue;
         }
 
-        if (!fixate_caps(caps_str, root_obj, name_str, type_str,
-            json_field_str)) {
+        if (!fixate_caps(caps_str, get_field(simaai_caps, root_obj,
+            json_field_str), name_str, type_str)) {
             GST_ERROR_OBJECT(element, "<%s>: Error processing the `%s` "
                     "parameter type", G_STRFUNC, type_str);
             goto fixate_src_caps_out;
@@ -653,14 +865,26 @@ gst_simaai_caps_parse_config(GstElement *element, GstSimaaiCaps *simaai_caps,
 {
     JsonNode *root;
     JsonObject *root_obj, *caps_obj;
-
-    if (!json_parser_load_from_file(simaai_caps->parser, config, NULL)) {
-        GST_ERROR_OBJECT(element, "<%s>: Error loading a JSON stream",
-            G_STRFUNC);
+    GstSimaaiConfig *parsed;
+    GError *error = NULL;
+
+    parsed = gst_simaai_config_get(config, &error);
+    if (!parsed) {
+        GST_ERROR_OBJECT(element, "<%s>: Error loading a JSON stream: %s",
+            G_STRFUNC, error->message);
+        g_clear_error(&error);
         return FALSE;
     }
 
-    root = json_parser_get_root(simaai_caps->parser);
+    if (simaai_caps->parsed)
+        gst_simaai_config_unref(simaai_caps->parsed);
+    simaai_caps->parsed = parsed;
+
+    /* values negotiated with a previous config do not apply */
+    json_object_unref(simaai_caps->overrides);
+    simaai_caps->overrides = json_object_new();
+
+    root = gst_simaai_config_get_root(simaai_caps->parsed);
     if (!JSON_NODE_HOLDS_OBJECT(root)) {
         GST_ERROR_OBJECT(element, "<%s>: Error retrieving a top level node",
             G_STRFUNC);
@@ -681,11 +905,98 @@ gst_simaai_caps_parse_config(GstElement *element, GstSimaaiCaps *simaai_caps,
         GST_WARNING_OBJECT(element, "<%s>: Failed to parse source caps from "
             "JSON", G_STRFUNC);
 
+    g_free(simaai_caps->config);
     simaai_caps->config = g_strdup(config);
 
     return TRUE;
 }
 
+gchar *
+gst_simaai_caps_get_effective_config(GstSimaaiCaps *simaai_caps, gsize *length)
+{
+    JsonNode *root, *merged;
+    JsonObject *root_obj, *merged_obj;
+    JsonGenerator *generator;
+    GList *members, *l;
+    const gchar *text;
+    gsize text_length;
+    gchar *result;
+
+    if (!simaai_caps->parsed)
+        return NULL;
+
+    if (!gst_simaai_caps_has_overrides(simaai_caps)) {
+        text = gst_simaai_config_get_text(simaai_caps->parsed, &text_length);
+        if (length)
+            *length = text_length;
+        return g_strndup(text, text_length);
+    }
+
+    root = gst_simaai_config_get_root(simaai_caps->parsed);
+    if (!JSON_NODE_HOLDS_OBJECT(root))
+        return NULL;
+    root_obj = json_node_get_object(root);
+
+    /* shallow merge, overridden values are top level fields */
+    merged_obj = json_object_new();
+
+    members = json_object_get_members(root_obj);
+    for (l = members; l; l = l->next)
+        json_object_set_member(merged_obj, l->data,
+            json_node_copy(json_object_get_member(root_obj, l->data)));
+    g_list_free(members);
+
+    members = json_object_get_members(simaai_caps->overrides);
+    for (l = members; l; l = l->next)
+        json_object_set_member(merged_obj, l->data,
+            json_node_copy(json_object_get_member(simaai_caps->overrides,
+                l->data)));
+    g_list_free(members);
+
+    merged = json_node_init_object(json_node_alloc(), merged_obj);
+    json_object_unref(merged_obj);
+
+    generator = json_generator_new();
+    json_generator_set_root(generator, merged);
+    json_generator_set_pretty(generator, TRUE);
+    json_generator_set_indent(generator, 4);
+
+    result = json_generator_to_data(generator, length);
+
+    g_object_unref(generator);
+    json_node_unref(merged);
+
+    return result;
+}
+
+gchar *
+gst_simaai_caps_get_overrides(GstSimaaiCaps *simaai_caps, gsize *length)
+{
+    JsonGenerator *generator;
+    JsonNode *node;
+    gchar *result;
+
+    if (!gst_simaai_caps_has_overrides(simaai_caps))
+        return NULL;
+
+    node = json_node_init_object(json_node_alloc(), simaai_caps->overrides);
+
+    generator = json_generator_new();
+    json_generator_set_root(generator, node);
+    result = json_generator_to_data(generator, length);
+
+    g_object_unref(generator);
+    json_node_unref(node);
+
+    return result;
+}
+
+gboolean
+gst_simaai_caps_has_overrides(GstSimaaiCaps *simaai_caps)
+{
+    return json_object_get_size(simaai_caps->overrides) > 0;
+}
+
 GstSimaaiCaps *
 gst_simaai_caps_init(void)
 {
@@ -694,7 +1005,7 @@ gst_simaai_caps_init(void)
     simaai_caps->sink_caps = gst_caps_new_any();
     simaai_caps->src_caps = gst_caps_new_any();
 
-    simaai_caps->parser = json_parser_new();
+    simaai_caps->overrides = json_object_new();
 
     return simaai_caps;
 }
@@ -704,7 +1015,9 @@ gst_simaai_caps_free(GstSimaaiCaps *simaai_caps)
 {
     g_free(simaai_caps->config);
 
-    g_object_unref(simaai_caps->parser);
+    if (simaai_caps->parsed)
+        gst_simaai_config_unref(simaai_caps->parsed);
+    json_object_unref(simaai_caps->overrides);
 
     gst_caps_unref(simaai_caps->sink_caps);
     gst_caps_unref(simaai_caps->src_caps);
@@ -46,11 +46,45 @@
 
 G_BEGIN_DECLS
 
+/*
+ * Immutable parsed config file, shared by every element that uses the same
+ * file. Configs are cached by path and parsed again only if the file changed.
+ */
+typedef struct _GstSimaaiConfig GstSimaaiConfig;
+
+GstSimaaiConfig *gst_simaai_config_get(const gchar *path, GError **error);
+
+GstSimaaiConfig *gst_simaai_config_ref(GstSimaaiConfig *config);
+
+void gst_simaai_config_unref(GstSimaaiConfig *config);
+
+/* Sealed root node, must not be modified */
+JsonNode *gst_simaai_config_get_root(const GstSimaaiConfig *config);
+
+/* File contents, for consumers that use another JSON parser */
+const gchar *gst_simaai_config_get_text(const GstSimaaiConfig *config,
+                                        gsize *length);
+
+const gchar *gst_simaai_config_get_path(const GstSimaaiConfig *config);
+
+/*
+ * Consumer's own parsed form of the config, e.g. the tree of another JSON
+ * library, kept with the config and shared by every element using the file.
+ * The first view set for key is kept: set_view destroys a later view and
+ * returns the one set before. Views are destroyed with the config.
+ */
+gpointer gst_simaai_config_get_view(GstSimaaiConfig *config, GQuark key);
+
+gpointer gst_simaai_config_set_view(GstSimaaiConfig *config, GQuark key,
+                                    gpointer view, GDestroyNotify destroy);
+
 typedef struct _GstSimaaiCaps GstSimaaiCaps;
 struct _GstSimaaiCaps {
     gchar *config;
 
-    JsonParser *parser;
+    /* Shared config and top level fields set from negotiated sink caps */
+    GstSimaaiConfig *parsed;
+    JsonObject *overrides;
 
     GstCaps *sink_caps;
     GstCaps *src_caps;
@@ -76,6 +110,24 @@ gboolean gst_simaai_caps_parse_config(GstElement *element,
                                       GstSimaaiCaps *simaai_caps,
                                       const gchar *config);
 
+/*
+ * Config with negotiated values applied, serialized. The file itself is never
+ * rewritten. Returns NULL if no config was parsed, free with g_free().
+ */
+gchar *gst_simaai_caps_get_effective_config(GstSimaaiCaps *simaai_caps,
+                                            gsize *length);
+
+/*
+ * Top level fields set from negotiated caps, serialized as one object, for
+ * consumers that apply them to their own view of the config. Returns NULL
+ * without overrides, free with g_free().
+ */
+gchar *gst_simaai_caps_get_overrides(GstSimaaiCaps *simaai_caps,
+                                     gsize *length);
+
+/* TRUE if negotiated caps changed a value of the config */
+gboolean gst_simaai_caps_has_overrides(GstSimaaiCaps *simaai_caps);
+
 GstSimaaiCaps *gst_simaai_caps_init(void);
 
 void gst_simaai_caps_free(GstSimaaiCaps *simaai_caps);
@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch_planner.h"
+
+uint32_t batch_plan_tensors(uint32_t frames, uint32_t model_batch,
+                            batch_remainder_e remainder)
+{
+    if (frames == 0 || model_batch == 0)
+        return 0;
+
+    if (remainder == BATCH_REMAINDER_SPLIT)
+        return frames;
+
+    return ((frames + model_batch - 1) / model_batch) * model_batch;
+}
+
+int batch_remainder_from_string(const char * name, batch_remainder_e * remainder)
+{
+    if (name == NULL || strcmp(name, "split") == 0) {
+        *remainder = BATCH_REMAINDER_SPLIT;
+        return 0;
+    }
+
+    if (strcmp(name, "pad") == 0) {
+        *remainder = BATCH_REMAINDER_PAD;
+        return 0;
+    }
+
+    return -1;
+}
+
+int batch_plan_alloc(batch_plan_t * plan, uint32_t tensors)
+{
+    batch_plan_free(plan);
+    if (tensors == 0)
+        return 0;
+
+    // A run has one tensor at least, so there are no more runs than tensors
+    plan->runs = calloc(tensors, sizeof(*plan->runs));
+    plan->in_addr = calloc(tensors, sizeof(*plan->in_addr));
+    plan->out_addr = calloc(tensors, sizeof(*plan->out_addr));
+    if (plan->runs == NULL || plan->in_addr == NULL || plan->out_addr == NULL) {
+        batch_plan_free(plan);
+        return -1;
+    }
+
+    plan->capacity = tensors;
+    return 0;
+}
+
+void batch_plan_free(batch_plan_t * plan)
+{
+    free(plan->runs);
+    free(plan->in_addr);
+    free(plan->out_addr);
+    memset(plan, 0, sizeof(*plan));
+}
+
+int batch_plan_build(batch_plan_t * plan,
+                     uint64_t in_addr,
+                     uint64_t out_addr,
+                     uint32_t frames,
+                     uint32_t model_batch,
+                     size_t in_tensor_size,
+                     size_t out_tensor_size,
+                     batch_remainder_e remainder)
+{
+    uint32_t tensors = batch_plan_tensors(frames, model_batch, remainder);
+
+    plan->n_runs = 0;
+    if (tensors == 0 || tensors > plan->capacity)
+        return -1;
+
+    plan->in_tensor_size = in_tensor_size;
+    plan->out_tensor_size = out_tensor_size;
+
+    uint32_t frame = 0;
+    uint32_t tensor = 0;
+    while (frame < frames) {
+        batch_run_t * run = &plan->runs[plan->n_runs++];
+        uint32_t left = frames - frame;
+
+        run->first = tensor;
+        run->frames = (left < model_batch) ? left : model_batch;
+        run->batch = (remainder == BATCH_REMAINDER_PAD) ? model_batch : run->frames;
+        run->run_us = 0;
+
+        for (uint32_t i = 0; i < run->batch; i++) {
+            // Padding slots read and write the last frame of the run again
+            uint32_t src = frame + ((i < run->frames) ? i : run->frames - 1);
+            plan->in_addr[tensor] = in_addr + (uint64_t) src * in_tensor_size;
+            plan->out_addr[tensor] = out_addr + (uint64_t) src * out_tensor_size;
+            tensor++;
+        }
+        frame += run->frames;
+    }
+
+    return 0;
+}
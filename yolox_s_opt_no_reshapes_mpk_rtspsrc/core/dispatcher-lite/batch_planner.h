@@ -0,0 +1,70 @@
+#ifndef DISPATCHER_BATCH_PLANNER_H_
+#define DISPATCHER_BATCH_PLANNER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    // Remainder runs with the model batch, padding slots repeat the last
+    // frame and write its output again. For runtimes that only run the
+    // compiled batch, selected with "pad"
+    BATCH_REMAINDER_PAD = 0,
+    // Remainder runs as a smaller batch, as before there was a planner. The
+    // default
+    BATCH_REMAINDER_SPLIT
+} batch_remainder_e;
+
+typedef struct batch_run_s {
+    uint32_t first;  // index of the first tensor of the run in the plan lists
+    uint32_t frames; // frames of the request in the run
+    uint32_t batch;  // batch the model runs with, frames and padding
+    int64_t run_us;  // execution time, set by the runner
+} batch_run_t;
+
+/* Sub-batches of one request. All address lists are built before the first
+ * run, so nothing is set up between runs. Lists are allocated once, for the
+ * tensors of the configured batch, and reused for every request */
+typedef struct batch_plan_s {
+    uint32_t n_runs;
+    uint32_t capacity; // tensors the lists hold
+    size_t in_tensor_size;
+    size_t out_tensor_size;
+    batch_run_t * runs;
+    uint64_t * in_addr;
+    uint64_t * out_addr;
+} batch_plan_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tensors a plan of frames addresses, 0 on invalid sizes
+uint32_t batch_plan_tensors(uint32_t frames, uint32_t model_batch,
+                            batch_remainder_e remainder);
+
+// Parse "pad" or "split", NULL selects split. Returns -1 on unknown names
+int batch_remainder_from_string(const char * name, batch_remainder_e * remainder);
+
+// Allocate lists for plans of up to tensors tensors, see batch_plan_tensors().
+// Returns -1 if out of memory
+int batch_plan_alloc(batch_plan_t * plan, uint32_t tensors);
+
+// Release the lists, the plan holds nothing after
+void batch_plan_free(batch_plan_t * plan);
+
+// Build runs and address lists of frames consecutive tensors.
+// Returns 0 on success, -1 on invalid sizes or if the plan does not fit
+int batch_plan_build(batch_plan_t * plan,
+                     uint64_t in_addr,
+                     uint64_t out_addr,
+                     uint32_t frames,
+                     uint32_t model_batch,
+                     size_t in_tensor_size,
+                     size_t out_tensor_size,
+                     batch_remainder_e remainder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPATCHER_BATCH_PLANNER_H_
@@ -9,8 +9,10 @@
 #include <simaai/platform/simaevxxipc.h>
 #include <simaai/platform/simahostops.h>
 #include <simaai/gstsimaaiallocator.h>
+#include <simaai/gstsimaaimeta.h>
 
 #include "dispatcher_common.h"
+#include "dispatcher_ring.h"
 #include "simamm.h"
 #include "utils.h"
 
@@ -25,6 +27,23 @@ static GParamSpec *obj_properties[N_PROPERTIES] = { NULL};
 #define GST_CAT_DEFAULT buffer_data_exchanger_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 
+/* Request in flight. Slots live as long as the dispatcher, the EVXX message
+ * and the MLA batch plan are reused for every frame */
+typedef struct dispatcher_request_s {
+    GstBuffer * inbuf; // held until the device is done reading it
+    GstBuffer * outbuf;
+    GstSimaaiFrameInfo info;
+    uint64_t iaddr;
+    uint64_t oaddr;
+    size_t in_size;
+    int32_t result;
+    sgp_ev_req_t ev_req;
+    batch_plan_t plan; // MLA sub-batches, planned on submit, lists sized at init
+} dispatcher_request_t;
+
+static gboolean dispatcher_requests_init(BufferDataExchanger * self);
+static void dispatcher_requests_free(BufferDataExchanger * self);
+
 G_DEFINE_TYPE_WITH_CODE(BufferDataExchanger,
                         buffer_data_exchanger,
                         GST_TYPE_ELEMENT,
@@ -56,6 +75,9 @@ buffer_data_exchanger_finalize (GObject *object)
 
     self->is_initialized = FALSE;
 
+    // Slots hold pool buffers, release them first
+    dispatcher_requests_free(self);
+
     if (self->pool) {
         free_simaai_memory_buffer_pool(self->pool);
         self->pool = NULL;
@@ -113,11 +135,17 @@ buffer_data_exchanger_init (BufferDataExchanger *self)
     self->pool = NULL;
     self->mem_flags = GST_SIMAAI_MEMORY_FLAG_CACHED;
     self->frame_id = 0;
+    self->next_req_id = 0;
+    self->dump_data = FALSE;
+    self->node_quark = 0;
     self->batch_size = 0;
     self->batch_size_model = 0;
+    self->batch_remainder = BATCH_REMAINDER_SPLIT;
     self->in_tensor_size = 0;
     self->out_tensor_size = 0;
     self->type = NULL;
+    self->ring = NULL;
+    memset(&self->stats, 0, sizeof(self->stats));
 
     g_mutex_init(&self->dispatcher_mutex);
 }
@@ -129,6 +157,8 @@ gboolean dispatcher_init(BufferDataExchanger * self, simaai_params_t * params)
     // Only get CPU to decide the path here, rest move it to dispatcher
     self->cpu = *((int *)parser_get_int(params, "cpu"));
     self->params = params;
+    self->dump_data = *((int *)parser_get_int(params, "dump_data")) != 0;
+    self->node_quark = g_quark_from_string(params->node_name);
     self->type = (sgp_cpu_variant_t *) g_malloc0(sizeof(sgp_cpu_variant_t));
 
     // Initialize communication with dispatcher
@@ -178,6 +208,12 @@ gboolean dispatcher_init(BufferDataExchanger * self, simaai_params_t * params)
         self->in_tensor_size = *((int *)parser_get_int(params, "in_tensor_sz"));
         self->out_tensor_size = *((int *)parser_get_int(params, "out_tensor_sz"));
 
+        if (batch_remainder_from_string(parser_get_string(params, "batch_remainder"),
+                                        &self->batch_remainder) != 0) {
+            GST_ERROR_OBJECT(self, "Unknown batch_remainder, use \"pad\" or \"split\"");
+            return FALSE;
+        }
+
         ret = mla_client_init(self);
         break;
         // Development only
@@ -186,198 +222,376 @@ gboolean dispatcher_init(BufferDataExchanger * self, simaai_params_t * params)
         return ret;
     }
 
+    if (ret == TRUE && self->ring == NULL)
+        ret = dispatcher_requests_init(self);
+
     return ret;
 }
 
-GstFlowReturn buffer_data_dispatcher_send(BufferDataExchanger *self,
-                                          GstBuffer * buffer)
+gboolean dispatcher_init_loopback(BufferDataExchanger * self, const char * node_name,
+                                  guint out_size, guint no_of_bufs)
+{
+    // Host requests have no device work in the request path
+    self->cpu = SIMA_CPU_A65;
+    self->params = NULL;
+    self->dump_data = FALSE;
+    self->node_quark = g_quark_from_string(node_name);
+
+    self->pool = allocate_simaai_memory_buffer_pool(GST_OBJECT(self), out_size,
+                                                    no_of_bufs, no_of_bufs,
+                                                    GST_SIMAAI_MEMORY_FLAG_DEFAULT);
+    if (self->pool == NULL)
+        return FALSE;
+
+    return dispatcher_requests_init(self);
+}
+
+/*
+ * Blocking part of a request. EVXX is posted on submit and only waited for
+ * here, MLA runs are synchronous calls, so they run here completely.
+ * Called from the completion thread only, in submission order.
+ */
+static int32_t dispatcher_complete_request(BufferDataExchanger * self,
+                                           dispatcher_request_t * req)
+{
+    int32_t ret = 0;
+
+    switch (self->cpu) {
+    case SIMA_CPU_EVXX: {
+        GST_DEBUG_OBJECT(self, "wait done for request id:0x%x", req->ev_req.req_id);
+        sgp_ev_resp_t resp = WAIT_DONE(EVXX, self, req->ev_req.req_id);
+        ret = resp.op_result;
+        break;
+    }
+    case SIMA_CPU_MOSAIC:
+    case SIMA_CPU_MLA: {
+        GST_DEBUG_OBJECT(self, "iaddr = %u oaddr = %u", (uint32_t) req->iaddr, (uint32_t) req->oaddr);
+
+        ret = RUN_MODEL(MLA, self, (uint32_t) req->iaddr, (uint32_t) req->oaddr);
+        if (ret != 0)
+            GST_ERROR("Failed to run model ret:0x%x", ret);
+        break;
+    }
+    case SIMA_CPU_DEV:
+        ret = mla_client_run_model(self, req->iaddr, req->oaddr, &req->plan);
+        if (ret != 0)
+            GST_ERROR("Failed to run model ret:0x%x", ret);
+        break;
+    default:
+        break;
+    }
+
+    return ret;
+}
+
+static void dispatcher_request_complete(gpointer slot, gpointer data)
+{
+    dispatcher_request_t * req = slot;
+
+    req->result = dispatcher_complete_request(GST_BUFFERDATAEXCHANGER(data), req);
+}
+
+static void dispatcher_request_clear(gpointer slot, gpointer data)
+{
+    dispatcher_request_t * req = slot;
+
+    if (req->inbuf)
+        gst_buffer_unref(req->inbuf);
+    if (req->outbuf)
+        gst_buffer_unref(req->outbuf);
+    batch_plan_free(&req->plan);
+}
+
+static void dispatcher_request_alloc_plan(gpointer slot, gpointer data)
+{
+    dispatcher_request_t * req = slot;
+    uint32_t * tensors = data;
+
+    // A zero count marks a failed allocation, the other slots are skipped
+    if (*tensors != 0 && batch_plan_alloc(&req->plan, *tensors) != 0)
+        *tensors = 0;
+}
+
+static gboolean dispatcher_requests_init(BufferDataExchanger * self)
+{
+    self->ring = dispatcher_ring_new(DISPATCHER_RING_SIZE, sizeof(dispatcher_request_t),
+                                     dispatcher_request_complete, self);
+    if (self->ring == NULL) {
+        GST_ERROR_OBJECT(self, "Failed to start completion thread");
+        return FALSE;
+    }
+
+    // Only batched MLA runs have a plan, its size is known from the config
+    if (self->cpu == SIMA_CPU_DEV &&
+        (self->batch_size > 1 || self->batch_size_model > 1)) {
+        uint32_t tensors = batch_plan_tensors(self->batch_size, self->batch_size_model,
+                                              self->batch_remainder);
+        if (tensors == 0) {
+            GST_ERROR_OBJECT(self, "Invalid batch size %d of model batch %d",
+                             self->batch_size, self->batch_size_model);
+            dispatcher_requests_free(self);
+            return FALSE;
+        }
+
+        dispatcher_ring_foreach(self->ring, dispatcher_request_alloc_plan, &tensors);
+        if (tensors == 0) {
+            GST_ERROR_OBJECT(self, "Failed to allocate plans of batch %d",
+                             self->batch_size);
+            dispatcher_requests_free(self);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static void dispatcher_requests_free(BufferDataExchanger * self)
+{
+    // Requests in flight are finished first, the device owns their buffers
+    dispatcher_ring_free(self->ring, dispatcher_request_clear, self);
+    self->ring = NULL;
+}
+
+GstFlowReturn buffer_data_dispatcher_submit(BufferDataExchanger *self,
+                                            GstBuffer * buffer)
 {
     // Request to h/w flow ends here
     // Call from the global dispatchers
-    int32_t ret = 0;
+    dispatcher_ring_t * ring = self->ring;
+    dispatcher_request_t * req;
     gint64 in_buf_id = 0;
     gint64 in_buf_offset = 0;
-    gint64 in_pcie_buf_id = 0;
-    gboolean is_pcie = FALSE;
-    gchar* stream_id;
-    guint64 timestamp;
-    
-    int dump_data = *((int *)parser_get_int(self->params, "dump_data"));
-    GstMapInfo map;
-    gst_buffer_map(buffer, &map, GST_MAP_READ);
-    
-    GstCustomMeta * meta = gst_buffer_get_custom_meta(buffer, "GstSimaMeta");
-    if (meta != NULL) {
-	 GstStructure * s = gst_custom_meta_get_structure(meta);
-	 if (s == NULL) {
-	      g_message("Returning from ");
-	      return GST_FLOW_OK;
-	 } else {
-        
+
+    if (ring == NULL) {
+        GST_ERROR_OBJECT(self, "Dispatcher is not initialized");
+        return GST_FLOW_ERROR;
+    }
+
+    req = dispatcher_ring_reserve(ring);
+    if (req == NULL)
+        return DISPATCHER_FLOW_RING_FULL;
+
+    if (!gst_buffer_get_simaai_frame_info(buffer, &req->info)) {
+        memset(&req->info, 0, sizeof(req->info));
+        req->info.frame_id = self->frame_id;
+    } else {
         // Check if PCIe related metadta exists
-        if ((gst_structure_get_int64(s, "pcie-buffer-id", &in_pcie_buf_id) == TRUE)) {
-            is_pcie = TRUE;
-            GST_DEBUG("[process2] pcie-buffer-id = %ld", in_pcie_buf_id);
-        }
+        if (req->info.flags & GST_SIMAAI_FRAME_META_FLAG_PCIE)
+            GST_DEBUG("[process2] pcie-buffer-id = %ld", req->info.pcie_buffer_id);
 
-	    if ((gst_structure_get_int64(s, "buffer-id", &in_buf_id) == TRUE) &&
-		(gst_structure_get_int64(s, "frame-id", &self->frame_id) == TRUE) &&
-		(gst_structure_get_int64(s, "buffer-offset", &in_buf_offset) == TRUE) &&
-        (gst_structure_get_uint64(s, "timestamp", &timestamp) == TRUE))
-        {
-            stream_id = (gchar *)gst_structure_get_string(s, "stream-id");
-            GST_DEBUG("Copied metadata, in_buf_offset %ld", in_buf_offset);
-        }
-	 }
+        in_buf_id = req->info.buffer_id;
+        in_buf_offset = req->info.buffer_offset;
+        self->frame_id = req->info.frame_id;
+        GST_DEBUG("Copied metadata, in_buf_offset %ld", in_buf_offset);
     }
 
-    GstBuffer * outbuf;
-    GstFlowReturn res = gst_buffer_pool_acquire_buffer(self->pool, &outbuf, NULL);
+    GstFlowReturn res = gst_buffer_pool_acquire_buffer(self->pool, &req->outbuf, NULL);
 
     if (G_LIKELY (res == GST_FLOW_OK)) {
-      GST_DEBUG_OBJECT (self, "Output buffer from pool: %p", outbuf);
+      GST_DEBUG_OBJECT (self, "Output buffer from pool: %p", req->outbuf);
     } else {
       GST_ERROR_OBJECT (self, "Failed to allocate buffer");
-      gst_buffer_unmap(buffer, &map);
+      req->outbuf = NULL;
       return res;
     }
 
-    guintptr out_buf_id = gst_simaai_memory_get_phys_addr(gst_buffer_peek_memory(outbuf, 0));
+    guintptr out_buf_id = gst_simaai_memory_get_phys_addr(gst_buffer_peek_memory(req->outbuf, 0));
+
+    req->inbuf = gst_buffer_ref(buffer);
+    req->in_size = gst_buffer_get_size(buffer);
+    req->oaddr = out_buf_id;
+    req->result = 0;
 
-    // TODO: Cleanup
     switch (self->cpu) {
     case SIMA_CPU_EVXX: {
-	 uint32_t no_of_bufs = get_num_of_outbufs(self->params);
-
-         // build the evxx specific request message
-	 sgp_ev_req_t * req = (sgp_ev_req_t *) g_malloc(sizeof(sgp_ev_req_t));
-	 sgp_ev_resp_t resp;
-	 memset(req, 0, sizeof(sgp_ev_req_t));
-
-	 // Build the request specific message
-	 req->magic = SGPMSG_REQMAGIC;
-	 req->graph_id = *((uint8_t *)parser_get_int(self->params, "graph_id"));
-	 // Update frame from message;
-	 req->req_id = self->frame_id;
+	 // The message is zeroed once with the ring, every field set here is
+	 // set for every request, so there is nothing to clear
+	 sgp_ev_req_t * ev_req = &req->ev_req;
+
+	 ev_req->magic = SGPMSG_REQMAGIC;
+	 ev_req->graph_id = *((uint8_t *)parser_get_int(self->params, "graph_id"));
+	 // Frame ids repeat without frame meta, responses are matched by request
+	 ev_req->req_id = self->next_req_id++;
 	 // Pre-allocated
-	 req->osize = get_output_sz(self->params);
-
-         req->oaddr = out_buf_id;
-	 req->in_img_addr = buffer_id_to_paddr(self->in_buf_id);
-	 req->in_img_size = map.size; // get_img_sz(self->params);
-	 req->iaddr = buffer_id_to_paddr(self->in_buf_id); // get_iaddr(self->ev_ki, self->params, msg);
-	 req->request_type = SGP_REQUEST_DATA;
-	 
-	 // TODO: Dynamically calculate this
-	 // No need of this when you are not allocating
-	 // req->isize = get_input_sz(self->params);
+	 ev_req->osize = get_output_sz(self->params);
+
+	 ev_req->oaddr = out_buf_id;
+	 ev_req->in_img_addr = buffer_id_to_paddr(self->in_buf_id);
+	 ev_req->in_img_size = req->in_size; // get_img_sz(self->params);
+	 ev_req->iaddr = buffer_id_to_paddr(self->in_buf_id); // get_iaddr(self->ev_ki, self->params, msg);
+	 ev_req->request_type = SGP_REQUEST_DATA;
+
 	 GST_DEBUG_OBJECT(self, "Posting work to evxx graph_id:0x%x, iaddr:0x%x, oaddr:0x%x, imgaddr:0x%x, req:0x%x",
-			  req->graph_id, req->iaddr, req->in_img_addr, req->oaddr, req);
-	 GST_DEBUG_OBJECT(self, "Request id:0x%x, msg_frame:0x%x, msg addr:0x%x",
-			  req->req_id, self->frame_id, map);
-
-	 // Post work to dispatcher
-	 POST(EVXX, self, req);
-
-	 // Wait for graph to be done
-	 GST_DEBUG_OBJECT(self, "wait done for request id:0x%x", req->req_id);
-	 resp = WAIT_DONE(EVXX, self, req->req_id);
-	 if (resp.op_result != 0) {
-	      g_free(req);
-	      goto drop_and_continue;
-	 }
-	 
-	 if (dump_data) {
-	      ret = GET_OUTBUF(EVXX, self, self->frame_id, outbuf);
-	      if (ret != 0)
-		   goto drop_and_continue;
-	 }
-	 g_free(req);
+			  ev_req->graph_id, ev_req->iaddr, ev_req->in_img_addr, ev_req->oaddr, ev_req);
+	 GST_DEBUG_OBJECT(self, "Request id:0x%lx, msg_frame:0x%lx",
+			  ev_req->req_id, req->info.frame_id);
+
+	 // Post work to dispatcher, completion thread waits for it
+	 POST(EVXX, self, ev_req);
 	 break;
     }
     case SIMA_CPU_MOSAIC:
-    case SIMA_CPU_MLA: {
-        uint32_t iaddr = buffer_id_to_paddr(in_buf_id);
-        uint32_t oaddr = out_buf_id;
-
-        g_message("iaddr = %u oaddr = %u", iaddr, oaddr);
-
-        ret = RUN_MODEL(MLA, self, (iaddr + in_buf_offset), oaddr);
-        if (ret != 0) {
-            GST_ERROR("Failed to run model ret:0x%x", ret);
-            goto drop_and_continue;
-        }
-
-        if (dump_data) {
-            ret = GET_OUTBUF(MLA, self, self->frame_id, outbuf);
-            if (ret != 0)
-                goto drop_and_continue;
+    case SIMA_CPU_MLA:
+        req->iaddr = (uint32_t) buffer_id_to_paddr(in_buf_id) + in_buf_offset;
+        break;
+    case SIMA_CPU_DEV:
+        req->iaddr = in_buf_id;
+        if (get_output_sz(self->params) <= 0) {
+            GST_ERROR("Out Size is defined zero");
+            req->result = -1;
+            break;
         }
+        // Address setup runs here, while the device runs earlier requests
+        req->result = mla_client_plan_model(self, req->iaddr, req->oaddr,
+                                            req->in_size, &req->plan);
+        break;
+    default:
         break;
     }
-    case SIMA_CPU_DEV: {
-        uint64_t iaddr = in_buf_id;
-        uint64_t oaddr = out_buf_id;
-        size_t out_sz = get_output_sz(self->params);
 
-        if (out_sz <= 0) {
-            GST_ERROR("Out Size is defined zero");
-            goto drop_and_continue;
-        }
+    // Failed requests skip the device and are dropped in order on poll
+    dispatcher_ring_commit(ring, req->result == 0);
 
-        ret = mla_client_run_model(self, iaddr, oaddr, map.size);
-        if (ret != 0) {
-            GST_ERROR("Failed to run model ret:0x%x", ret);
-            goto drop_and_continue;
-        }
+    return GST_FLOW_OK;
+}
+
+static GstFlowReturn dispatcher_deliver_request(BufferDataExchanger * self,
+                                                dispatcher_request_t * req)
+{
+    GstBuffer * outbuf = req->outbuf;
+    GstSimaaiFrameInfo * info = &req->info;
+    int32_t ret = req->result;
+
+    req->outbuf = NULL;
+    gst_buffer_unref(req->inbuf);
+    req->inbuf = NULL;
+
+    if (ret != 0)
+        goto drop_and_continue;
 
-        if (dump_data) {
-	    ret = mla_client_write_output_buffer(self, self->frame_id, outbuf);
-            if (ret != 0)
-                goto drop_and_continue;
+    if (self->dump_data) {
+        switch (self->cpu) {
+        case SIMA_CPU_EVXX:
+            ret = GET_OUTBUF(EVXX, self, info->frame_id, outbuf);
+            break;
+        case SIMA_CPU_MOSAIC:
+        case SIMA_CPU_MLA:
+            ret = GET_OUTBUF(MLA, self, info->frame_id, outbuf);
+            break;
+        case SIMA_CPU_DEV:
+            ret = mla_client_write_output_buffer(self, info->frame_id, outbuf);
+            break;
+        default:
+            break;
         }
-	break;
-    }
-    default:
-        break;
+        if (ret != 0)
+            goto drop_and_continue;
     }
 
     /* // Update metadata */
-    GstCustomMeta * meta2 = gst_buffer_add_custom_meta(outbuf, "GstSimaMeta");
-    if (meta2 == NULL) {
+    // stream id, timestamp and PCIe id of the input are forwarded as is
+    info->buffer_id = req->oaddr;
+    info->buffer_name = self->node_quark;
+    info->buffer_offset = 0;
+    if (gst_buffer_add_simaai_frame_meta(outbuf, info) == NULL) {
 	 GST_ERROR("Unable to add metadata info to the buffer");
+	 gst_buffer_unref(outbuf);
 	 return GST_FLOW_ERROR;
     }
 
-    GstStructure *s = gst_custom_meta_get_structure (meta2);
-    if (s != NULL) {
-        gst_structure_set (s,
-            "buffer-id", G_TYPE_INT64, out_buf_id,
-			"buffer-name", G_TYPE_STRING, self->params->node_name,
-			"buffer-offset", G_TYPE_INT64, (gint64)0,
-			"frame-id", G_TYPE_INT64, self->frame_id,
-            "stream-id", G_TYPE_STRING, stream_id,
-            "timestamp", G_TYPE_UINT64, timestamp, NULL);
-        
-        // Add PCIe metadata if exists
-        if (is_pcie) {
-            gst_structure_set(s, "pcie-buffer-id", G_TYPE_INT64, in_pcie_buf_id, NULL);
-        }
-    
-	 GST_DEBUG_OBJECT(self, "Attaching meta information out_buf_id:[%lld], node_name:[%s], frame_id:[%lld], stream_id[%s], timestamp:[%ld]",
-                          out_buf_id, self->params->node_name, self->frame_id, stream_id, timestamp);
-    }
+    GST_DEBUG_OBJECT(self, "Attaching meta information out_buf_id:[%lld], node_name:[%s], frame_id:[%lld], stream_id[%s], timestamp:[%ld]",
+                     req->oaddr, g_quark_to_string(self->node_quark), info->frame_id,
+                     gst_simaai_frame_info_get_stream_id(info), info->timestamp);
 
-    gst_buffer_unmap(buffer, &map);
     return buffer_data_dispatcher_recv(self, outbuf);
 
 drop_and_continue:
-    /* GST_INFO("Something's wrong for frame_id: 0x%x, dropping & continuing", msg->frame_seq); */
-    gst_buffer_unmap(buffer, &map);
+    GST_INFO_OBJECT(self, "Something's wrong for frame_id: %ld, dropping & continuing",
+                    info->frame_id);
     gst_buffer_unref(outbuf);
     return GST_FLOW_OK;
 }
 
+GstFlowReturn buffer_data_dispatcher_poll(BufferDataExchanger *self,
+                                          gboolean wait,
+                                          guint * completed)
+{
+    dispatcher_ring_t * ring = self->ring;
+    GstFlowReturn res = GST_FLOW_OK;
+    guint n = 0;
+
+    if (completed)
+        *completed = 0;
+
+    if (ring == NULL)
+        return GST_FLOW_ERROR;
+
+    while (res == GST_FLOW_OK) {
+        // Block for the oldest request only, deliver the rest if done
+        dispatcher_request_t * req = dispatcher_ring_peek_done(ring, wait && n == 0);
+        if (req == NULL)
+            break;
+
+        // Callback runs unlocked, so it may submit again
+        res = dispatcher_deliver_request(self, req);
+        n++;
+
+        dispatcher_ring_release(ring);
+    }
+
+    if (completed)
+        *completed = n;
+
+    return res;
+}
+
+guint buffer_data_dispatcher_in_flight(BufferDataExchanger *self)
+{
+    if (self->ring == NULL)
+        return 0;
+
+    return dispatcher_ring_count(self->ring);
+}
+
+void buffer_data_dispatcher_get_stats(BufferDataExchanger *self,
+                                      dispatcher_stats_t * stats)
+{
+    stats->runs = __atomic_load_n(&self->stats.runs, __ATOMIC_RELAXED);
+    stats->frames = __atomic_load_n(&self->stats.frames, __ATOMIC_RELAXED);
+    stats->padded = __atomic_load_n(&self->stats.padded, __ATOMIC_RELAXED);
+    stats->run_us = __atomic_load_n(&self->stats.run_us, __ATOMIC_RELAXED);
+    stats->max_run_us = __atomic_load_n(&self->stats.max_run_us, __ATOMIC_RELAXED);
+}
+
+void buffer_data_dispatcher_reset_stats(BufferDataExchanger *self)
+{
+    __atomic_store_n(&self->stats.runs, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->stats.frames, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->stats.padded, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->stats.run_us, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->stats.max_run_us, 0, __ATOMIC_RELAXED);
+}
+
+GstFlowReturn buffer_data_dispatcher_send(BufferDataExchanger *self,
+                                          GstBuffer * buffer)
+{
+    GstFlowReturn res;
+
+    // Requests submitted before are delivered first, keeps the output order
+    while ((res = buffer_data_dispatcher_submit(self, buffer)) == DISPATCHER_FLOW_RING_FULL) {
+        res = buffer_data_dispatcher_poll(self, TRUE, NULL);
+        if (res != GST_FLOW_OK)
+            return res;
+    }
+    if (res != GST_FLOW_OK)
+        return res;
+
+    while (res == GST_FLOW_OK && buffer_data_dispatcher_in_flight(self) > 0)
+        res = buffer_data_dispatcher_poll(self, TRUE, NULL);
+
+    return res;
+}
+
 GstFlowReturn buffer_data_dispatcher_recv(BufferDataExchanger *self,
                                           GstBuffer * buffer)
 {
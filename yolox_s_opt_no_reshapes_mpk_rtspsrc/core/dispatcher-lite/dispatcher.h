@@ -15,6 +15,8 @@
 #include <simaai/gst-api.h>
 
 #include "handlers.h"
+#include "batch_planner.h"
+#include "dispatcher_ring.h"
 
 G_BEGIN_DECLS
 
@@ -67,6 +69,20 @@ typedef struct mla_client_hdl_s {
 #define MAX_BUFS 5
 #define MIN_POOL_SIZE 2
 
+// Requests one dispatcher keeps in flight, slots are allocated once at init
+#define DISPATCHER_RING_SIZE 8
+// buffer_data_dispatcher_submit(): ring is full, poll and submit again
+#define DISPATCHER_FLOW_RING_FULL GST_FLOW_CUSTOM_SUCCESS
+
+// Batched MLA runs, see buffer_data_dispatcher_get_stats()
+typedef struct dispatcher_stats_s {
+    guint64 runs;       // model runs of batched requests
+    guint64 frames;     // frames of the requests in those runs
+    guint64 padded;     // padding slots run with them
+    guint64 run_us;     // execution time of all runs
+    guint64 max_run_us; // longest run
+} dispatcher_stats_t;
+
 struct _BufferDataExchanger {
     GstElement element;
     /* Other members, including private data. */
@@ -93,11 +109,18 @@ struct _BufferDataExchanger {
     GstSimaaiMemoryFlags mem_flags;
 
     gint64 frame_id;
+    sgp_req_id_t next_req_id; // id of the next EVXX request, unique per dispatcher
+    gboolean dump_data;
+    GQuark node_quark;
     
     gint batch_size;        // batch size requested by user
     gint batch_size_model;  // batch size the particular model supports
+    batch_remainder_e batch_remainder; // how batch_size % batch_size_model frames run
     size_t in_tensor_size;  // input tensor size. For example, tensor with shape "100:3:128:256" will have size: 100*3*128*256 = 9830400
     size_t out_tensor_size; // output tensor size. For example, tensor with shape "96:2048" = 96*2048 = 196608;
+
+    dispatcher_ring_t * ring; // preallocated requests in flight
+    dispatcher_stats_t stats; // written by the completion thread only
 };
 
 BufferDataExchanger *buffer_data_exchanger_new (BufferDataExchangerCallback *callback);
@@ -105,13 +128,35 @@ BufferDataExchanger *buffer_data_exchanger_new (BufferDataExchangerCallback *cal
 // Init
 gboolean dispatcher_init(BufferDataExchanger * self, simaai_params_t * params);
 /* gboolean dispatcher_pt_init(BufferDataExchanger * self); */
+// Development only: requests skip the device and outputs of out_size bytes
+// from a pool of no_of_bufs are delivered in order, for tests without a device
+gboolean dispatcher_init_loopback(BufferDataExchanger * self, const char * node_name,
+                                  guint out_size, guint no_of_bufs);
 // Deinit
 void deinit_dispatcher(sima_cpu_e cpu);
 
 // Data
-// Send
+// Send, blocks until the output of buffer is delivered to the callback
 GstFlowReturn buffer_data_dispatcher_send(BufferDataExchanger * self, GstBuffer * buffer);
 
+// Submit without waiting for the device. Returns DISPATCHER_FLOW_RING_FULL
+// if DISPATCHER_RING_SIZE requests are in flight already. Single submitter,
+// call from one thread only, it may be the polling one
+GstFlowReturn buffer_data_dispatcher_submit(BufferDataExchanger * self, GstBuffer * buffer);
+
+// Deliver outputs of finished requests to the callback, in submission order.
+// With wait, blocks until the oldest request in flight is finished. Call from
+// one thread only
+GstFlowReturn buffer_data_dispatcher_poll(BufferDataExchanger * self, gboolean wait,
+                                          guint * completed);
+
+// Requests submitted and not delivered yet
+guint buffer_data_dispatcher_in_flight(BufferDataExchanger * self);
+
+// Counters of batched MLA runs since init or the last reset, from any thread
+void buffer_data_dispatcher_get_stats(BufferDataExchanger * self, dispatcher_stats_t * stats);
+void buffer_data_dispatcher_reset_stats(BufferDataExchanger * self);
+
 // Receive
 GstFlowReturn buffer_data_dispatcher_recv(BufferDataExchanger * self, GstBuffer * buffer);
 
@@ -0,0 +1,194 @@
+#include "dispatcher_ring.h"
+
+typedef enum {
+    DISPATCHER_SLOT_FREE = 0,
+    DISPATCHER_SLOT_POSTED,
+    DISPATCHER_SLOT_DONE
+} dispatcher_slot_state_t;
+
+struct dispatcher_ring_s {
+    guint8 * slots;
+    dispatcher_slot_state_t * state;
+    guint n_slots;
+    gsize slot_size;
+    guint head;     // oldest slot not released
+    guint count;    // slots committed and not released
+    guint wait_idx; // next slot the completion thread finishes
+    guint posted;   // slots committed and not finished
+    GMutex lock;
+    GCond cond;
+    GThread * completion_thread;
+    gboolean stop;
+    dispatcher_ring_complete_func complete;
+    gpointer user_data;
+};
+
+static inline gpointer dispatcher_ring_slot(dispatcher_ring_t * ring, guint idx)
+{
+    return ring->slots + (gsize) idx * ring->slot_size;
+}
+
+static gpointer dispatcher_ring_completion_loop(gpointer data)
+{
+    dispatcher_ring_t * ring = data;
+
+    g_mutex_lock(&ring->lock);
+    for (;;) {
+        if (ring->posted == 0) {
+            // Stop only with nothing posted, the device may still use
+            // buffers of a posted slot
+            if (ring->stop)
+                break;
+            g_cond_wait(&ring->cond, &ring->lock);
+            continue;
+        }
+
+        // Slots failed on submit are done already
+        guint idx = ring->wait_idx;
+        if (ring->state[idx] == DISPATCHER_SLOT_POSTED) {
+            g_mutex_unlock(&ring->lock);
+
+            ring->complete(dispatcher_ring_slot(ring, idx), ring->user_data);
+
+            g_mutex_lock(&ring->lock);
+            ring->state[idx] = DISPATCHER_SLOT_DONE;
+        }
+        ring->wait_idx = (ring->wait_idx + 1) % ring->n_slots;
+        ring->posted--;
+        g_cond_broadcast(&ring->cond);
+    }
+    g_mutex_unlock(&ring->lock);
+
+    return NULL;
+}
+
+dispatcher_ring_t * dispatcher_ring_new(guint n_slots, gsize slot_size,
+                                        dispatcher_ring_complete_func complete,
+                                        gpointer user_data)
+{
+    dispatcher_ring_t * ring;
+
+    g_return_val_if_fail(n_slots > 0 && complete != NULL, NULL);
+
+    ring = g_new0(dispatcher_ring_t, 1);
+    ring->slots = g_malloc0(n_slots * slot_size);
+    ring->state = g_new0(dispatcher_slot_state_t, n_slots);
+    ring->n_slots = n_slots;
+    ring->slot_size = slot_size;
+    ring->complete = complete;
+    ring->user_data = user_data;
+    g_mutex_init(&ring->lock);
+    g_cond_init(&ring->cond);
+
+    ring->completion_thread = g_thread_try_new("dispatcher-done",
+                                               dispatcher_ring_completion_loop,
+                                               ring, NULL);
+    if (ring->completion_thread == NULL) {
+        dispatcher_ring_free(ring, NULL, NULL);
+        return NULL;
+    }
+
+    return ring;
+}
+
+void dispatcher_ring_free(dispatcher_ring_t * ring, GFunc clear_slot,
+                          gpointer user_data)
+{
+    if (ring == NULL)
+        return;
+
+    if (ring->completion_thread) {
+        g_mutex_lock(&ring->lock);
+        ring->stop = TRUE;
+        g_cond_broadcast(&ring->cond);
+        g_mutex_unlock(&ring->lock);
+        // Returns once every posted slot is finished
+        g_thread_join(ring->completion_thread);
+    }
+
+    if (clear_slot) {
+        for (guint i = 0; i < ring->n_slots; i++)
+            clear_slot(dispatcher_ring_slot(ring, i), user_data);
+    }
+
+    g_cond_clear(&ring->cond);
+    g_mutex_clear(&ring->lock);
+    g_free(ring->state);
+    g_free(ring->slots);
+    g_free(ring);
+}
+
+void dispatcher_ring_foreach(dispatcher_ring_t * ring, GFunc func, gpointer user_data)
+{
+    g_mutex_lock(&ring->lock);
+    g_assert(ring->count == 0);
+    g_mutex_unlock(&ring->lock);
+
+    for (guint i = 0; i < ring->n_slots; i++)
+        func(dispatcher_ring_slot(ring, i), user_data);
+}
+
+gpointer dispatcher_ring_reserve(dispatcher_ring_t * ring)
+{
+    gpointer slot = NULL;
+
+    // head + count does not move while the poller releases, only on commit
+    g_mutex_lock(&ring->lock);
+    if (ring->count < ring->n_slots)
+        slot = dispatcher_ring_slot(ring, (ring->head + ring->count) % ring->n_slots);
+    g_mutex_unlock(&ring->lock);
+
+    return slot;
+}
+
+void dispatcher_ring_commit(dispatcher_ring_t * ring, gboolean post)
+{
+    g_mutex_lock(&ring->lock);
+    g_assert(ring->count < ring->n_slots);
+    ring->state[(ring->head + ring->count) % ring->n_slots] =
+        post ? DISPATCHER_SLOT_POSTED : DISPATCHER_SLOT_DONE;
+    ring->count++;
+    ring->posted++;
+    g_cond_broadcast(&ring->cond);
+    g_mutex_unlock(&ring->lock);
+}
+
+gpointer dispatcher_ring_peek_done(dispatcher_ring_t * ring, gboolean wait)
+{
+    gpointer slot = NULL;
+
+    g_mutex_lock(&ring->lock);
+    while (ring->count > 0) {
+        if (ring->state[ring->head] == DISPATCHER_SLOT_DONE) {
+            slot = dispatcher_ring_slot(ring, ring->head);
+            break;
+        }
+        if (!wait)
+            break;
+        g_cond_wait(&ring->cond, &ring->lock);
+    }
+    g_mutex_unlock(&ring->lock);
+
+    return slot;
+}
+
+void dispatcher_ring_release(dispatcher_ring_t * ring)
+{
+    g_mutex_lock(&ring->lock);
+    g_assert(ring->count > 0 && ring->state[ring->head] == DISPATCHER_SLOT_DONE);
+    ring->state[ring->head] = DISPATCHER_SLOT_FREE;
+    ring->head = (ring->head + 1) % ring->n_slots;
+    ring->count--;
+    g_mutex_unlock(&ring->lock);
+}
+
+guint dispatcher_ring_count(dispatcher_ring_t * ring)
+{
+    guint count;
+
+    g_mutex_lock(&ring->lock);
+    count = ring->count;
+    g_mutex_unlock(&ring->lock);
+
+    return count;
+}
@@ -0,0 +1,53 @@
+#ifndef DISPATCHER_RING_H_
+#define DISPATCHER_RING_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Fixed ring of requests in flight, device independent. Slots are allocated
+ * zeroed once and reused. A committed slot is either posted, finished by the
+ * completion thread in submission order, or done already (failed on submit).
+ * Slots are delivered in submission order as they are done.
+ *
+ * One thread submits (reserve + commit) and one thread delivers (peek_done
+ * + release), they may be the same.
+ */
+typedef struct dispatcher_ring_s dispatcher_ring_t;
+
+// Blocking part of a posted slot, runs on the completion thread unlocked
+typedef void (*dispatcher_ring_complete_func)(gpointer slot, gpointer user_data);
+
+dispatcher_ring_t * dispatcher_ring_new(guint n_slots, gsize slot_size,
+                                        dispatcher_ring_complete_func complete,
+                                        gpointer user_data);
+
+// Finishes every posted slot, stops the completion thread, then calls
+// clear_slot, if set, on every slot
+void dispatcher_ring_free(dispatcher_ring_t * ring, GFunc clear_slot,
+                          gpointer user_data);
+
+// Calls func on every slot, with none in flight
+void dispatcher_ring_foreach(dispatcher_ring_t * ring, GFunc func, gpointer user_data);
+
+// Next free slot, NULL if every slot is in flight. Nothing changes until commit
+gpointer dispatcher_ring_reserve(dispatcher_ring_t * ring);
+
+// Queues the reserved slot, post hands it to the completion thread, without
+// it the slot is done as is
+void dispatcher_ring_commit(dispatcher_ring_t * ring, gboolean post);
+
+// Oldest slot if done, NULL if none in flight or the oldest is not done.
+// With wait, blocks until the oldest is done
+gpointer dispatcher_ring_peek_done(dispatcher_ring_t * ring, gboolean wait);
+
+// Frees the slot returned by dispatcher_ring_peek_done()
+void dispatcher_ring_release(dispatcher_ring_t * ring);
+
+// Slots committed and not released
+guint dispatcher_ring_count(dispatcher_ring_t * ring);
+
+G_END_DECLS
+
+#endif // DISPATCHER_RING_H_
@@ -63,63 +63,12 @@ int32_t mla_client_prepare_out_buff(BufferDataExchanger * self)
   return res;
 }
 
-static void mla_client_build_addr_list (uint64_t addr_list[],
-                                        uint64_t start_addr,
-                                        size_t size_of_each_chunk,
-                                        int batch_size) {
-    size_t offset = 0;
-    for (int i = 0; i < batch_size; i++) {
-        offset = i * size_of_each_chunk;
-        addr_list[i] = start_addr + offset;
-        /* fprintf(stderr, "start_addr:0x%lx, offset: %ld, chunk_size: %ld, in_addr:0x%lx, batch_size:%d\n", */
-        /*         start_addr, offset, size_of_each_chunk, addr_list[i], batch_size); */
-    }
-}
-
-/**
- * @brief helper to run mla in batched mode
- * @return 0 on success. -1 on failure 
-*/
-int8_t mla_run_batch(mla_client_hdl_t *mla_hdl,
-                      uint64_t in_addr,
-                      uint64_t out_addr, 
-                      size_t batch_size,
-                      size_t in_tensor_size,
-                      size_t out_tensor_size) 
+int32_t mla_client_plan_model(BufferDataExchanger * self,
+                              uint64_t in_addr,
+                              uint64_t out_addr,
+                              size_t in_data_sz,
+                              batch_plan_t * plan)
 {
-  uint64_t * in_addr_list = malloc(sizeof(uint64_t) * batch_size);
-  uint64_t * out_addr_list = malloc(sizeof(uint64_t) * batch_size);
-
-  mla_client_build_addr_list(in_addr_list, 
-                              in_addr, 
-                              in_tensor_size, 
-                              batch_size);
-  mla_client_build_addr_list(out_addr_list, 
-                              out_addr, 
-                              out_tensor_size, 
-                              batch_size);
-
-  if (mla_run_batch_model_phys((mla_model_p) mla_hdl->mla_model,
-                               batch_size,
-                               in_addr_list , in_tensor_size,
-                               out_addr_list, out_tensor_size) != 0) {
-      g_message("Model run failed");
-      free(in_addr_list);
-      free(out_addr_list);
-      return -1;
-  }
-  free(in_addr_list);
-  free(out_addr_list);
-  return 0;
-}
-
-int32_t mla_client_run_model(BufferDataExchanger * self,
-			     uint64_t in_addr,
-			     uint64_t out_addr,
-			     size_t in_data_sz)
-{
-  GST_DEBUG("in_addr: %p, out_addr: %p, model: 0x%x", in_addr, out_addr, self->mla_hdl.mla_model);
-
   if (self->batch_size < 1)
   {
     g_message("Invalid value for parameter \"batch_size\": %d", self->batch_size);
@@ -128,79 +77,81 @@ int32_t mla_client_run_model(BufferDataExchanger * self,
 
   if (self->batch_size_model < 1)
   {
-    g_message("Invalid value for parameter \"batch_size_model\": %d", self->batch_size);
+    g_message("Invalid value for parameter \"batch_size_model\": %d", self->batch_size_model);
     return -1;
   }
-  
-  // Define the strategy if batch processing is requested
-  if (self->batch_size == 1)
+
+  plan->n_runs = 0;
+
+  // No batching
+  if (self->batch_size == 1 && self->batch_size_model == 1)
+    return 0;
+
+  // Tensor sizes from the config, else the request split evenly
+  size_t in_tensor_sz = self->in_tensor_size ?
+    self->in_tensor_size : in_data_sz / self->batch_size;
+  size_t out_tensor_sz = self->out_tensor_size ?
+    self->out_tensor_size : get_output_sz(self->params) / self->batch_size;
+
+  if (batch_plan_build(plan, in_addr, out_addr,
+                       self->batch_size, self->batch_size_model,
+                       in_tensor_sz, out_tensor_sz,
+                       self->batch_remainder) != 0) {
+    GST_ERROR("Failed to plan batch %d of model batch %d",
+              self->batch_size, self->batch_size_model);
+    return -1;
+  }
+
+  GST_DEBUG("Planned %u runs for batch %d, model batch %d",
+            plan->n_runs, self->batch_size, self->batch_size_model);
+  return 0;
+}
+
+int32_t mla_client_run_model(BufferDataExchanger * self,
+			     uint64_t in_addr,
+			     uint64_t out_addr,
+			     batch_plan_t * plan)
+{
+  GST_DEBUG("in_addr: %p, out_addr: %p, model: 0x%x", in_addr, out_addr, self->mla_hdl.mla_model);
+
+  if (plan->n_runs == 0)
   {
     // No batching
     if (mla_run_model_phys((mla_model_p) self->mla_hdl.mla_model, in_addr , out_addr) != 0)
     {
       g_message("Model run failed");
     }
+    return 0;
   }
-  else
-  {
-    // Use native batching
-    if (self->batch_size <= self->batch_size_model)
-    {
-      if (mla_run_batch(&self->mla_hdl,
-                        in_addr, 
-                        out_addr,
-                        self->batch_size,
-                        in_data_sz / self->batch_size,
-                        get_output_sz(self->params) / self->batch_size))
-        return -1;
-    }
-    // User requested more batches to process than current model supports
-    else
-    {
-      int run_cnt = 0;
-      int completed = 0;
-
-
-      run_cnt = self->batch_size / self->batch_size_model;
-      
-      uint64_t in_addr_offseted = in_addr;
-      uint64_t out_addr_offseted = out_addr;
-
-      for (int i = 0; i < run_cnt; i++) {
-        if (mla_run_batch(&self->mla_hdl,
-                        in_addr_offseted, 
-                        out_addr_offseted,
-                        self->batch_size_model,
-                        self->in_tensor_size,
-                        self->out_tensor_size)) {
-          return -1;
-        }
-        GST_DEBUG("Run:[%d], in_addr_offset: 0x%lx, out_addr_offset: 0x%lx\n", i, in_addr_offseted, out_addr_offseted);
-
-        completed += self->batch_size_model;
-
-        in_addr_offseted += self->in_tensor_size * self->batch_size_model;
-        out_addr_offseted += self->out_tensor_size * self->batch_size_model;
-      }
-
-      GST_DEBUG("\n Called mla_run_model : %d times\n", completed);
-    
-      if (completed < self->batch_size) {
-        int left_over_batch = self->batch_size - completed;
-        
-        if (mla_run_batch(&self->mla_hdl,
-                        in_addr_offseted, 
-                        out_addr_offseted,
-                        left_over_batch,
-                        self->in_tensor_size,
-                        self->out_tensor_size)) {
-          return -1;
-        }
-        GST_DEBUG("\n Called the left over mla_run_model : %d \n", left_over_batch);
-      }
+
+  // Address lists of all runs are ready, runs go back to back
+  for (uint32_t i = 0; i < plan->n_runs; i++) {
+    batch_run_t * run = &plan->runs[i];
+    gint64 start = g_get_monotonic_time();
+
+    if (mla_run_batch_model_phys((mla_model_p) self->mla_hdl.mla_model,
+                                 run->batch,
+                                 &plan->in_addr[run->first], plan->in_tensor_size,
+                                 &plan->out_addr[run->first], plan->out_tensor_size) != 0) {
+      g_message("Model run failed");
+      return -1;
     }
+
+    run->run_us = g_get_monotonic_time() - start;
+
+    dispatcher_stats_t * stats = &self->stats;
+    __atomic_fetch_add(&stats->runs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->frames, run->frames, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->padded, run->batch - run->frames, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->run_us, run->run_us, __ATOMIC_RELAXED);
+    if ((guint64) run->run_us > __atomic_load_n(&stats->max_run_us, __ATOMIC_RELAXED))
+        __atomic_store_n(&stats->max_run_us, run->run_us, __ATOMIC_RELAXED);
+
+    GST_DEBUG("Run:[%u/%u], frames: %u, batch: %u, in_addr: 0x%lx, out_addr: 0x%lx, %ld us",
+              i + 1, plan->n_runs, run->frames, run->batch,
+              plan->in_addr[run->first], plan->out_addr[run->first], run->run_us);
   }
-  
+
   return 0;
 }
 
@@ -18,10 +18,18 @@ gboolean mla_client_load_model(BufferDataExchanger * self);
 
 int32_t mla_client_prepare_out_buff(BufferDataExchanger * self);
 
+// Split a request into sub-batches of the model batch, no device access
+int32_t mla_client_plan_model(BufferDataExchanger * self,
+                              uint64_t in_addr,
+                              uint64_t out_addr,
+                              size_t in_data_sz,
+                              batch_plan_t * plan);
+
+// Run the planned sub-batches, sets run_us of every run
 int32_t mla_client_run_model(BufferDataExchanger * self,
 			     uint64_t in_addr,
 			     uint64_t out_addr,
-			     size_t in_data_sz);
+			     batch_plan_t * plan);
 
 gboolean mla_client_init(BufferDataExchanger * self);
 
@@ -8,7 +8,7 @@ typedef struct {
 } buffer_mapping;
 
 static buffer_mapping mappings[sizeof(uint64_t) * 8] = {{ .id = -1, .addr = 0 }};
-static int64_t current_mappings = 0;
+static uint64_t current_mappings = 0;
 static pthread_mutex_t mapping_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 simaai_memory_t *allocate_memory(unsigned int size, int target) {
@@ -72,7 +72,7 @@ uint64_t buffer_id_to_paddr(unsigned int id)
     pthread_mutex_lock(&mapping_mutex);
 
     for(i = 0; i < (sizeof(mappings) / sizeof(mappings[0])); i++) {
-        if((id == mappings[i].id) && (current_mappings & (1 << i))) {
+        if((id == mappings[i].id) && (current_mappings & (UINT64_C(1) << i))) {
             res = mappings[i].addr;
             break;
         }
@@ -80,11 +80,11 @@ uint64_t buffer_id_to_paddr(unsigned int id)
 
     if(res == 0) {
         for(i = 0; i < (sizeof(mappings) / sizeof(mappings[0])); i++) {
-            if(!(current_mappings & (1 << i))) {
+            if(!(current_mappings & (UINT64_C(1) << i))) {
                 m = simaai_memory_attach(id);
                 mappings[i].addr = simaai_memory_get_phys(m);
                 mappings[i].id = id;
-                current_mappings |= 1 << i;
+                current_mappings |= UINT64_C(1) << i;
                 GST_INFO("Storing new mapping of %#x to %#lx at index %d", mappings[i].id, mappings[i].addr, i);
                 res = mappings[i].addr;
                 simaai_memory_free(m);
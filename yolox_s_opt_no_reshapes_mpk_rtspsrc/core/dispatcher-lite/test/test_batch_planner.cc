@@ -0,0 +1,155 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * Test of the MLA sub-batch planner: runs, padding and address lists for
+ * batch sizes that do and do not divide by the model batch.
+ */
+
+#include <stdio.h>
+
+#include "batch_planner.h"
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      return 1;                                                         \
+    }                                                                   \
+  } while (0)
+
+static const uint64_t kIn = 0x10000;
+static const uint64_t kOut = 0x80000;
+static const size_t kInSize = 0x100;
+static const size_t kOutSize = 0x40;
+
+static int test_even()
+{
+  batch_plan_t plan = {};
+  CHECK(batch_plan_alloc(&plan, 8) == 0);
+
+  CHECK(batch_plan_build(&plan, kIn, kOut, 8, 4, kInSize, kOutSize,
+                         BATCH_REMAINDER_PAD) == 0);
+  CHECK(plan.n_runs == 2);
+  CHECK(plan.runs[1].first == 4 && plan.runs[1].frames == 4 && plan.runs[1].batch == 4);
+  for (uint32_t i = 0; i < 8; i++) {
+    CHECK(plan.in_addr[i] == kIn + i * kInSize);
+    CHECK(plan.out_addr[i] == kOut + i * kOutSize);
+  }
+
+  batch_plan_free(&plan);
+  return 0;
+}
+
+static int test_pad()
+{
+  batch_plan_t plan = {};
+  CHECK(batch_plan_alloc(&plan, 8) == 0);
+
+  // 5 frames on a batch 2 model: 2 + 2 + 1 padded to 2
+  CHECK(batch_plan_tensors(5, 2, BATCH_REMAINDER_PAD) == 6);
+  CHECK(batch_plan_build(&plan, kIn, kOut, 5, 2, kInSize, kOutSize,
+                         BATCH_REMAINDER_PAD) == 0);
+  CHECK(plan.n_runs == 3);
+  CHECK(plan.runs[2].first == 4 && plan.runs[2].frames == 1 && plan.runs[2].batch == 2);
+  CHECK(plan.in_addr[4] == kIn + 4 * kInSize && plan.in_addr[5] == plan.in_addr[4]);
+  CHECK(plan.out_addr[5] == kOut + 4 * kOutSize);
+
+  // fewer frames than the model batch
+  CHECK(batch_plan_build(&plan, kIn, kOut, 3, 8, kInSize, kOutSize,
+                         BATCH_REMAINDER_PAD) == 0);
+  CHECK(plan.n_runs == 1 && plan.runs[0].frames == 3 && plan.runs[0].batch == 8);
+  CHECK(plan.out_addr[7] == kOut + 2 * kOutSize);
+
+  batch_plan_free(&plan);
+  return 0;
+}
+
+static int test_split()
+{
+  batch_plan_t plan = {};
+  CHECK(batch_plan_alloc(&plan, 5) == 0);
+
+  CHECK(batch_plan_tensors(5, 2, BATCH_REMAINDER_SPLIT) == 5);
+  CHECK(batch_plan_build(&plan, kIn, kOut, 5, 2, kInSize, kOutSize,
+                         BATCH_REMAINDER_SPLIT) == 0);
+  CHECK(plan.n_runs == 3);
+  CHECK(plan.runs[2].first == 4 && plan.runs[2].frames == 1 && plan.runs[2].batch == 1);
+  CHECK(plan.in_addr[4] == kIn + 4 * kInSize);
+
+  batch_plan_free(&plan);
+  return 0;
+}
+
+static int test_large()
+{
+  batch_plan_t plan = {};
+
+  // No fixed limit, the lists are sized for the configured batch
+  uint32_t tensors = batch_plan_tensors(100, 3, BATCH_REMAINDER_PAD);
+  CHECK(tensors == 102);
+  CHECK(batch_plan_alloc(&plan, tensors) == 0 && plan.capacity == tensors);
+  CHECK(batch_plan_build(&plan, kIn, kOut, 100, 3, kInSize, kOutSize,
+                         BATCH_REMAINDER_PAD) == 0);
+  CHECK(plan.n_runs == 34);
+  CHECK(plan.runs[33].first == 99 && plan.runs[33].frames == 1 && plan.runs[33].batch == 3);
+  CHECK(plan.in_addr[101] == kIn + 99 * kInSize);
+
+  // Plans of fewer frames reuse the lists
+  CHECK(batch_plan_build(&plan, kIn, kOut, 7, 3, kInSize, kOutSize,
+                         BATCH_REMAINDER_PAD) == 0);
+  CHECK(plan.n_runs == 3);
+
+  batch_plan_free(&plan);
+  CHECK(plan.capacity == 0 && plan.runs == NULL);
+  return 0;
+}
+
+static int test_invalid()
+{
+  batch_plan_t plan = {};
+  batch_remainder_e remainder;
+
+  CHECK(batch_plan_alloc(&plan, 32) == 0);
+
+  CHECK(batch_plan_build(&plan, kIn, kOut, 0, 2, kInSize, kOutSize,
+                         BATCH_REMAINDER_PAD) != 0);
+  CHECK(batch_plan_build(&plan, kIn, kOut, 4, 0, kInSize, kOutSize,
+                         BATCH_REMAINDER_PAD) != 0);
+  // 31 frames pad to 33 tensors on a batch 3 model, more than allocated
+  CHECK(batch_plan_build(&plan, kIn, kOut, 31, 3, kInSize, kOutSize,
+                         BATCH_REMAINDER_PAD) != 0);
+  CHECK(batch_plan_build(&plan, kIn, kOut, 31, 3, kInSize, kOutSize,
+                         BATCH_REMAINDER_SPLIT) == 0);
+
+  // the remainder runs as a smaller batch unless padding is asked for
+  CHECK(batch_remainder_from_string(NULL, &remainder) == 0 &&
+        remainder == BATCH_REMAINDER_SPLIT);
+  CHECK(batch_remainder_from_string("pad", &remainder) == 0 &&
+        remainder == BATCH_REMAINDER_PAD);
+  CHECK(batch_remainder_from_string("split", &remainder) == 0 &&
+        remainder == BATCH_REMAINDER_SPLIT);
+  CHECK(batch_remainder_from_string("drop", &remainder) != 0);
+
+  batch_plan_free(&plan);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  if (test_even())
+    return 1;
+  if (test_pad())
+    return 1;
+  if (test_split())
+    return 1;
+  if (test_large())
+    return 1;
+  if (test_invalid())
+    return 1;
+
+  printf("test_batch_planner: OK\n");
+  return 0;
+}
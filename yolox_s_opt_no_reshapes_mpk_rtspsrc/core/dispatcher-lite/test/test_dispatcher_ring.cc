@@ -0,0 +1,259 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * Test of buffer_data_dispatcher_submit(), buffer_data_dispatcher_poll() and
+ * buffer_data_dispatcher_in_flight() on a loopback dispatcher: delivery order
+ * across wrap-around and full ring. The ring behind them is tested directly
+ * for what needs a slow device: requests failed on submit and shutdown with
+ * requests in flight.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <vector>
+
+#include "dispatcher.h"
+#include "dispatcher_ring.h"
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      return 1;                                                         \
+    }                                                                   \
+  } while (0)
+
+static const guint kSlots = 4;
+
+struct Request {
+  int id;
+  int completed;  // times the completion thread ran it
+  int cleared;    // times freed with the ring
+  bool done_at_clear;
+};
+
+struct Device {
+  gulong latency_us = 0;
+  std::atomic<int> runs { 0 };
+};
+
+// Frame ids of the outputs delivered by the dispatcher, in order
+static void received(gpointer buffer, void * priv)
+{
+  std::vector<gint64> * frames = static_cast<std::vector<gint64> *>(priv);
+  GstSimaaiFrameInfo info;
+
+  frames->push_back(gst_buffer_get_simaai_frame_info(GST_BUFFER(buffer), &info) ?
+                    info.frame_id : -1);
+  gst_buffer_unref(GST_BUFFER(buffer));
+}
+
+static GstFlowReturn submit_frame(BufferDataExchanger * dispatcher, gint64 frame_id)
+{
+  GstBuffer * buffer = gst_buffer_new_allocate(NULL, 64, NULL);
+  GstSimaaiFrameInfo info;
+
+  memset(&info, 0, sizeof(info));
+  info.frame_id = frame_id;
+  gst_buffer_add_simaai_frame_meta(buffer, &info);
+
+  // the dispatcher holds its own reference while the request is in flight
+  GstFlowReturn res = buffer_data_dispatcher_submit(dispatcher, buffer);
+  gst_buffer_unref(buffer);
+  return res;
+}
+
+static int test_dispatcher_wrap_around()
+{
+  std::vector<gint64> frames;
+  BufferDataExchangerCallback callback = { received, &frames };
+  BufferDataExchanger * dispatcher = buffer_data_exchanger_new(&callback);
+  CHECK(dispatcher_init_loopback(dispatcher, "loopback", 4096, DISPATCHER_RING_SIZE + 1));
+
+  // Three in flight at a time, the ring indices wrap several times
+  gint64 next = 0;
+  for (int round = 0; round < 10; round++) {
+    for (int i = 0; i < 3; i++)
+      CHECK(submit_frame(dispatcher, next++) == GST_FLOW_OK);
+    CHECK(buffer_data_dispatcher_in_flight(dispatcher) <= 3);
+
+    while (buffer_data_dispatcher_in_flight(dispatcher) > 0)
+      CHECK(buffer_data_dispatcher_poll(dispatcher, TRUE, NULL) == GST_FLOW_OK);
+  }
+
+  CHECK(frames.size() == 30);
+  for (gint64 i = 0; i < 30; i++)
+    CHECK(frames[i] == i);
+
+  gst_object_unref(dispatcher);
+  return 0;
+}
+
+static int test_dispatcher_ring_full()
+{
+  std::vector<gint64> frames;
+  BufferDataExchangerCallback callback = { received, &frames };
+  BufferDataExchanger * dispatcher = buffer_data_exchanger_new(&callback);
+  CHECK(dispatcher_init_loopback(dispatcher, "loopback", 4096, DISPATCHER_RING_SIZE + 1));
+
+  // Nothing is delivered without a poll, so the ring fills up
+  for (gint64 i = 0; i < DISPATCHER_RING_SIZE; i++)
+    CHECK(submit_frame(dispatcher, i) == GST_FLOW_OK);
+  CHECK(buffer_data_dispatcher_in_flight(dispatcher) == DISPATCHER_RING_SIZE);
+  CHECK(submit_frame(dispatcher, DISPATCHER_RING_SIZE) == DISPATCHER_FLOW_RING_FULL);
+  CHECK(frames.empty());
+
+  // A blocking poll delivers at least the oldest, its slot is free again
+  guint completed = 0;
+  CHECK(buffer_data_dispatcher_poll(dispatcher, TRUE, &completed) == GST_FLOW_OK);
+  CHECK(completed >= 1 && frames.size() == completed && frames[0] == 0);
+  CHECK(submit_frame(dispatcher, DISPATCHER_RING_SIZE) == GST_FLOW_OK);
+
+  // Submitted after wrapping, delivered after the ones before
+  while (buffer_data_dispatcher_in_flight(dispatcher) > 0)
+    CHECK(buffer_data_dispatcher_poll(dispatcher, TRUE, NULL) == GST_FLOW_OK);
+  CHECK(frames.size() == DISPATCHER_RING_SIZE + 1);
+  for (gint64 i = 0; i <= DISPATCHER_RING_SIZE; i++)
+    CHECK(frames[i] == i);
+
+  // Nothing in flight, poll does not block
+  CHECK(buffer_data_dispatcher_poll(dispatcher, TRUE, &completed) == GST_FLOW_OK);
+  CHECK(completed == 0);
+
+  gst_object_unref(dispatcher);
+  return 0;
+}
+
+static void complete(gpointer slot, gpointer data)
+{
+  Device * device = static_cast<Device *>(data);
+  Request * req = static_cast<Request *>(slot);
+
+  if (device->latency_us)
+    g_usleep(device->latency_us);
+  req->completed++;
+  device->runs++;
+}
+
+static void clear(gpointer slot, gpointer)
+{
+  Request * req = static_cast<Request *>(slot);
+
+  req->cleared++;
+  req->done_at_clear = req->completed > 0;
+}
+
+// Ring side of buffer_data_dispatcher_submit()
+static bool ring_submit(dispatcher_ring_t * ring, int id, bool post = true)
+{
+  Request * req = static_cast<Request *>(dispatcher_ring_reserve(ring));
+  if (req == NULL)
+    return false;
+
+  req->id = id;
+  req->completed = 0;
+  dispatcher_ring_commit(ring, post);
+  return true;
+}
+
+// Ring side of buffer_data_dispatcher_poll(), ids delivered to out
+static guint ring_poll(dispatcher_ring_t * ring, bool wait, int * out, int * completed = NULL)
+{
+  guint n = 0;
+  Request * req;
+
+  while ((req = static_cast<Request *>(dispatcher_ring_peek_done(ring, wait && n == 0)))) {
+    out[n] = req->id;
+    if (completed)
+      completed[n] = req->completed;
+    n++;
+    dispatcher_ring_release(ring);
+  }
+  return n;
+}
+
+static int test_failed_submit()
+{
+  Device device;
+  device.latency_us = 1000;
+  dispatcher_ring_t * ring = dispatcher_ring_new(kSlots, sizeof(Request), complete, &device);
+  CHECK(ring != NULL);
+
+  // A failed request is done at once, but stays behind the posted one
+  CHECK(ring_submit(ring, 0));
+  CHECK(ring_submit(ring, 1, false));
+  CHECK(ring_submit(ring, 2));
+
+  int out[kSlots], completed[kSlots];
+  guint n = 0;
+  while (n < 3)
+    n += ring_poll(ring, true, out + n, completed + n);
+  CHECK(out[0] == 0 && out[1] == 1 && out[2] == 2);
+  CHECK(completed[0] == 1 && completed[1] == 0 && completed[2] == 1);
+  CHECK(device.runs == 2);
+
+  // Nothing in flight, poll does not block
+  CHECK(ring_poll(ring, true, out) == 0);
+
+  dispatcher_ring_free(ring, NULL, NULL);
+  return 0;
+}
+
+static int test_shutdown_in_flight()
+{
+  Device device;
+  device.latency_us = 5000;
+  dispatcher_ring_t * ring = dispatcher_ring_new(kSlots, sizeof(Request), complete, &device);
+  CHECK(ring != NULL);
+
+  // Wrap once so the in-flight requests straddle the end of the ring
+  int out[kSlots];
+  CHECK(ring_submit(ring, 0) && ring_submit(ring, 1) && ring_submit(ring, 2));
+  guint n = 0;
+  while (n < 3)
+    n += ring_poll(ring, true, out + n);
+
+  for (guint i = 0; i < kSlots; i++)
+    CHECK(ring_submit(ring, 10 + i, i != 1));
+  CHECK(dispatcher_ring_count(ring) == kSlots);
+
+  // Freed while the device still works on them: every posted request runs
+  // to the end before its slot is cleared
+  Request cleared[kSlots] = {};
+  dispatcher_ring_free(ring, [](gpointer slot, gpointer data) {
+      Request * req = static_cast<Request *>(slot);
+      clear(slot, NULL);
+      static_cast<Request *>(data)[req->id - 10] = *req;
+    }, cleared);
+
+  CHECK(device.runs == 3 + 3);
+  for (guint i = 0; i < kSlots; i++) {
+    CHECK(cleared[i].cleared == 1);
+    CHECK(cleared[i].done_at_clear == (i != 1));
+  }
+
+  return 0;
+}
+
+int main(int argc, char ** argv)
+{
+  int failed = 0;
+
+  gst_init(&argc, &argv);
+
+  failed |= test_dispatcher_wrap_around();
+  failed |= test_dispatcher_ring_full();
+  failed |= test_failed_submit();
+  failed |= test_shutdown_in_flight();
+
+  if (failed)
+    return 1;
+
+  printf("dispatcher ring test passed\n");
+  return 0;
+}
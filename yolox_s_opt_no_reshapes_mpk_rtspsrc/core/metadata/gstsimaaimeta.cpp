@@ -29,6 +29,8 @@
 //**************************************************************************
 #include "gstsimaaimeta.h"
 
+#include <string.h>
+
 GType
 gst_simaai_allocation_meta_api_get_type (void)
 {
@@ -109,4 +111,189 @@ gst_buffer_add_simaai_allocation_meta (GstBuffer   *buffer,
   meta->memory_flags = g_strdup (memory_flags);
 
   return meta;
-}
\ No newline at end of file
+}
+
+GType
+gst_simaai_frame_meta_api_get_type (void)
+{
+  static GType type;
+  static const gchar *tags[] = { NULL };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("GstSimaaiFrameMetaAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+static gboolean
+gst_simaai_frame_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
+{
+  GstSimaaiFrameMeta *fmeta = (GstSimaaiFrameMeta *) meta;
+
+  memset (&fmeta->info, 0, sizeof (fmeta->info));
+
+  return TRUE;
+}
+
+static gboolean
+gst_simaai_frame_meta_transform (GstBuffer * transbuf, GstMeta * meta,
+    GstBuffer * buffer, GQuark type, gpointer data)
+{
+  GstSimaaiFrameMeta *fmeta = (GstSimaaiFrameMeta *) meta;
+  GstSimaaiFrameMeta *tmeta;
+
+  // plain values only, the copy never allocates. The legacy structure (if any)
+  // is transformed by the custom meta itself
+  tmeta = (GstSimaaiFrameMeta *) gst_buffer_add_meta (transbuf,
+      GST_SIMAAI_FRAME_META_INFO, NULL);
+  if (tmeta == NULL)
+    return FALSE;
+
+  tmeta->info = fmeta->info;
+
+  return TRUE;
+}
+
+const GstMetaInfo *
+gst_simaai_frame_meta_get_info (void)
+{
+  static const GstMetaInfo *meta_info = NULL;
+
+  if (g_once_init_enter (&meta_info)) {
+    const GstMetaInfo *mi = gst_meta_register (GST_SIMAAI_FRAME_META_API_TYPE,
+        "GstSimaaiFrameMeta",
+        sizeof (GstSimaaiFrameMeta),
+        gst_simaai_frame_meta_init,
+        NULL,
+        gst_simaai_frame_meta_transform);
+    g_once_init_leave (&meta_info, mi);
+  }
+  return meta_info;
+}
+
+gboolean
+gst_simaai_frame_meta_legacy_enabled (void)
+{
+  static gsize enabled = 0;
+
+  if (g_once_init_enter (&enabled)) {
+    const gchar *env = g_getenv (GST_SIMAAI_FRAME_META_LEGACY_ENV);
+    gsize value = (env != NULL && g_strcmp0 (env, "0") == 0) ? 1 : 2;
+
+    if (value == 2 && gst_meta_get_info (GST_SIMAAI_FRAME_META_LEGACY_STR) == NULL) {
+      static const gchar *tags[] = { NULL };
+      gst_meta_register_custom (GST_SIMAAI_FRAME_META_LEGACY_STR, tags, NULL, NULL, NULL);
+    }
+    g_once_init_leave (&enabled, value);
+  }
+  return enabled == 2;
+}
+
+const gchar *
+gst_simaai_frame_info_get_stream_id (const GstSimaaiFrameInfo *info)
+{
+  return GST_SIMAAI_QUARK_STR (info->stream_id);
+}
+
+const gchar *
+gst_simaai_frame_info_get_buffer_name (const GstSimaaiFrameInfo *info)
+{
+  return GST_SIMAAI_QUARK_STR (info->buffer_name);
+}
+
+void
+gst_simaai_frame_info_to_structure (const GstSimaaiFrameInfo *info,
+                                    GstStructure *s)
+{
+  gst_structure_set (s,
+                     "buffer-id", G_TYPE_INT64, info->buffer_id,
+                     "buffer-name", G_TYPE_STRING, gst_simaai_frame_info_get_buffer_name (info),
+                     "buffer-offset", G_TYPE_INT64, info->buffer_offset,
+                     "frame-id", G_TYPE_INT64, info->frame_id,
+                     "stream-id", G_TYPE_STRING, gst_simaai_frame_info_get_stream_id (info),
+                     "timestamp", G_TYPE_UINT64, info->timestamp,
+                     NULL);
+
+  if (info->flags & GST_SIMAAI_FRAME_META_FLAG_PCIE)
+    gst_structure_set (s, "pcie-buffer-id", G_TYPE_INT64, info->pcie_buffer_id, NULL);
+}
+
+gboolean
+gst_simaai_frame_info_from_structure (const GstStructure *s,
+                                      GstSimaaiFrameInfo *info)
+{
+  memset (info, 0, sizeof (*info));
+
+  if (!gst_structure_get_int64 (s, "buffer-id", &info->buffer_id) ||
+      !gst_structure_get_int64 (s, "frame-id", &info->frame_id) ||
+      !gst_structure_get_int64 (s, "buffer-offset", &info->buffer_offset) ||
+      !gst_structure_get_uint64 (s, "timestamp", &info->timestamp))
+    return FALSE;
+
+  info->buffer_name = g_quark_from_string (gst_structure_get_string (s, "buffer-name"));
+  info->stream_id = g_quark_from_string (gst_structure_get_string (s, "stream-id"));
+
+  if (gst_structure_get_int64 (s, "pcie-buffer-id", &info->pcie_buffer_id))
+    info->flags |= GST_SIMAAI_FRAME_META_FLAG_PCIE;
+
+  return TRUE;
+}
+
+GstSimaaiFrameMeta *
+gst_buffer_add_simaai_frame_meta (GstBuffer *buffer,
+                                  const GstSimaaiFrameInfo *info)
+{
+  GstSimaaiFrameMeta *meta;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (info != NULL, NULL);
+
+  meta = gst_buffer_get_simaai_frame_meta (buffer);
+  if (meta == NULL) {
+    meta = (GstSimaaiFrameMeta *) gst_buffer_add_meta (buffer,
+        GST_SIMAAI_FRAME_META_INFO, NULL);
+    if (meta == NULL)
+      return NULL;
+  }
+
+  meta->info = *info;
+
+  if (gst_simaai_frame_meta_legacy_enabled ()) {
+    GstCustomMeta *cmeta = gst_buffer_get_custom_meta (buffer, GST_SIMAAI_FRAME_META_LEGACY_STR);
+    if (cmeta == NULL)
+      cmeta = gst_buffer_add_custom_meta (buffer, GST_SIMAAI_FRAME_META_LEGACY_STR);
+    if (cmeta != NULL)
+      gst_simaai_frame_info_to_structure (info, gst_custom_meta_get_structure (cmeta));
+  }
+
+  return meta;
+}
+
+gboolean
+gst_buffer_get_simaai_frame_info (GstBuffer *buffer,
+                                  GstSimaaiFrameInfo *info)
+{
+  GstSimaaiFrameMeta *meta;
+  GstCustomMeta *cmeta;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (info != NULL, FALSE);
+
+  meta = gst_buffer_get_simaai_frame_meta (buffer);
+  if (meta != NULL) {
+    *info = meta->info;
+    return TRUE;
+  }
+
+  // buffer comes from an element that only knows the legacy structure
+  cmeta = gst_buffer_get_custom_meta (buffer, GST_SIMAAI_FRAME_META_LEGACY_STR);
+  if (cmeta == NULL)
+    return FALSE;
+
+  GstStructure *s = gst_custom_meta_get_structure (cmeta);
+  if (s == NULL)
+    return FALSE;
+
+  return gst_simaai_frame_info_from_structure (s, info);
+}
@@ -32,6 +32,8 @@
 
 #include <gst/gst.h>
 
+G_BEGIN_DECLS
+
 // ************************************************************************************
 // This library provides a SiMa specific Metadata API types that can be used by GStreamer
 // You can extend this library by adding a new API types for your needs
@@ -73,4 +75,79 @@ const GstMetaInfo *gst_simaai_allocation_meta_get_info (void);
 
 GstSimaaiAllocationMeta * gst_buffer_add_simaai_allocation_meta (GstBuffer *buffer, const gchar *memory_type, const gchar *memory_flags);
 
-#endif
\ No newline at end of file
+// Frame Meta API
+// Carries the per-frame fields that SiMa elements forward from input to output
+// buffer. The fields are stored as plain values, stream id and buffer name are
+// interned as GQuarks, so reading and copying the meta does not allocate.
+// The same fields are also published as the legacy 'GstSimaMeta' custom meta
+// (a #GstStructure), which elements such as simaaiencoder still read. That
+// costs a structure allocation and string copies per buffer, pipelines
+// without such readers can turn it off with SIMAAI_META_LEGACY=0. Readers
+// prefer the typed meta and fall back to the legacy structure for buffers
+// produced by elements that only write that one.
+
+#define GST_SIMAAI_FRAME_META_LEGACY_STR                "GstSimaMeta"
+#define GST_SIMAAI_FRAME_META_LEGACY_ENV                "SIMAAI_META_LEGACY"
+
+typedef enum {
+  GST_SIMAAI_FRAME_META_FLAG_NONE = 0,
+  /// pcie_buffer_id is valid
+  GST_SIMAAI_FRAME_META_FLAG_PCIE = (1 << 0),
+} GstSimaaiFrameMetaFlags;
+
+// Plain values of the frame meta. Layout is mirrored by the python plugin
+// template, keep both in sync.
+typedef struct _GstSimaaiFrameInfo {
+  gint64       buffer_id;
+  gint64       buffer_offset;
+  gint64       frame_id;
+  gint64       pcie_buffer_id;
+  guint64      timestamp;
+  GQuark       buffer_name;
+  GQuark       stream_id;
+  guint32      flags;
+} GstSimaaiFrameInfo;
+
+typedef struct _GstSimaaiFrameMeta GstSimaaiFrameMeta;
+
+struct _GstSimaaiFrameMeta {
+  GstMeta            meta;
+
+  GstSimaaiFrameInfo info;
+};
+
+GType gst_simaai_frame_meta_api_get_type (void);
+#define GST_SIMAAI_FRAME_META_API_TYPE (gst_simaai_frame_meta_api_get_type())
+
+#define gst_buffer_get_simaai_frame_meta(b) \
+  ((GstSimaaiFrameMeta*)gst_buffer_get_meta((b),GST_SIMAAI_FRAME_META_API_TYPE))
+
+const GstMetaInfo *gst_simaai_frame_meta_get_info (void);
+#define GST_SIMAAI_FRAME_META_INFO (gst_simaai_frame_meta_get_info())
+
+// Attach @info to @buffer, also writes the legacy structure if it is enabled
+GstSimaaiFrameMeta * gst_buffer_add_simaai_frame_meta (GstBuffer *buffer, const GstSimaaiFrameInfo *info);
+
+// Read frame info of @buffer from the typed meta or from the legacy structure.
+// Returns FALSE if the buffer carries neither of them
+gboolean gst_buffer_get_simaai_frame_info (GstBuffer *buffer, GstSimaaiFrameInfo *info);
+
+// String of an interned field, "" if not set
+#define GST_SIMAAI_QUARK_STR(q) ((q) != 0 ? g_quark_to_string (q) : "")
+
+// Strings of the interned fields, "" if not set
+const gchar * gst_simaai_frame_info_get_stream_id (const GstSimaaiFrameInfo *info);
+const gchar * gst_simaai_frame_info_get_buffer_name (const GstSimaaiFrameInfo *info);
+
+// Fill @s with the legacy 'GstSimaMeta' fields of @info
+void gst_simaai_frame_info_to_structure (const GstSimaaiFrameInfo *info, GstStructure *s);
+
+// Parse legacy 'GstSimaMeta' fields of @s into @info
+gboolean gst_simaai_frame_info_from_structure (const GstStructure *s, GstSimaaiFrameInfo *info);
+
+// Whether the legacy structure is written next to the typed meta
+gboolean gst_simaai_frame_meta_legacy_enabled (void);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,331 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+#include "job_replay.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * File layout, host byte order:
+ *   FileHeader
+ *   records: RecordHeader, then n_inputs + n_outputs buffers of
+ *            BufferHeader, name and data, each padded to 8 bytes
+ */
+
+namespace {
+
+const char kMagic[8] = { 'S', 'I', 'M', 'A', 'R', 'E', 'C', '1' };
+const size_t kInitialCapacity = 16 << 20;
+
+struct FileHeader {
+  char magic[8];
+  uint64_t count;
+  uint64_t used;
+};
+
+struct RecordHeader {
+  uint64_t size;
+  int64_t latency_us;
+  uint32_t n_inputs;
+  uint32_t n_outputs;
+};
+
+struct BufferHeader {
+  uint32_t name_len;
+  uint32_t reserved;
+  uint64_t size;
+};
+
+size_t align8(size_t size)
+{
+  return (size + 7) & ~(size_t)7;
+}
+
+size_t buffers_size(const std::vector<JobReplayBuffer> & buffers)
+{
+  size_t size = 0;
+  for (auto & buffer : buffers)
+    size += sizeof(BufferHeader) + align8(buffer.name.size()) + align8(buffer.size);
+  return size;
+}
+
+uint8_t * write_buffers(uint8_t * dst, const std::vector<JobReplayBuffer> & buffers)
+{
+  for (auto & buffer : buffers) {
+    BufferHeader header = { (uint32_t)buffer.name.size(), 0, buffer.size };
+    memcpy(dst, &header, sizeof(header));
+    dst += sizeof(header);
+    memcpy(dst, buffer.name.data(), buffer.name.size());
+    dst += align8(buffer.name.size());
+    memcpy(dst, buffer.data, buffer.size);
+    dst += align8(buffer.size);
+  }
+  return dst;
+}
+
+} // namespace
+
+JobReplaySettings JobReplaySettings::from_env()
+{
+  JobReplaySettings settings;
+
+  const char * mode = getenv(JOB_REPLAY_MODE_ENV);
+  if (mode != nullptr && strcmp(mode, "record") == 0)
+    settings.mode = JobReplayMode::RECORD;
+  else if (mode != nullptr && strcmp(mode, "replay") == 0)
+    settings.mode = JobReplayMode::REPLAY;
+  else if (mode != nullptr && strcmp(mode, "dry") == 0)
+    settings.mode = JobReplayMode::DRY;
+
+  const char * dir = getenv(JOB_REPLAY_DIR_ENV);
+  if (dir != nullptr && dir[0] != '\0')
+    settings.dir = dir;
+
+  const char * latency = getenv(JOB_REPLAY_LATENCY_ENV);
+  if (latency != nullptr && latency[0] != '\0')
+    settings.latency_us = strtoll(latency, nullptr, 0);
+
+  return settings;
+}
+
+std::string JobReplaySettings::path(const std::string & graph) const
+{
+  return dir + "/" + graph + ".rec";
+}
+
+JobRecorder::~JobRecorder()
+{
+  close();
+}
+
+bool JobRecorder::open(const std::string & path, std::string & error)
+{
+  close();
+
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    error = "cannot create " + path + ": " + strerror(errno);
+    return false;
+  }
+
+  used_ = sizeof(FileHeader);
+  if (!reserve(kInitialCapacity)) {
+    error = "cannot map " + path + ": " + strerror(errno);
+    close();
+    return false;
+  }
+
+  FileHeader header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.count = 0;
+  header.used = used_;
+  memcpy(map_, &header, sizeof(header));
+
+  return true;
+}
+
+void JobRecorder::close()
+{
+  if (map_ != nullptr) {
+    msync(map_, used_, MS_SYNC);
+    munmap(map_, capacity_);
+    map_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    // drop the unused tail of the last growth, the header is valid without
+    int res = ftruncate(fd_, used_);
+    (void)res;
+    ::close(fd_);
+    fd_ = -1;
+  }
+  capacity_ = 0;
+  used_ = 0;
+}
+
+bool JobRecorder::reserve(size_t size)
+{
+  if (size <= capacity_)
+    return true;
+
+  size_t capacity = capacity_ ? capacity_ : kInitialCapacity;
+  while (capacity < size)
+    capacity *= 2;
+
+  if (map_ != nullptr) {
+    munmap(map_, capacity_);
+    map_ = nullptr;
+    capacity_ = 0;
+  }
+
+  if (ftruncate(fd_, capacity) != 0)
+    return false;
+
+  void * map = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (map == MAP_FAILED)
+    return false;
+
+  map_ = (uint8_t *)map;
+  capacity_ = capacity;
+  return true;
+}
+
+bool JobRecorder::append(const std::vector<JobReplayBuffer> & inputs,
+                         const std::vector<JobReplayBuffer> & outputs,
+                         int64_t latency_us)
+{
+  const std::lock_guard<std::mutex> lk(mtx_);
+
+  if (fd_ < 0)
+    return false;
+
+  RecordHeader record = { 0, latency_us, (uint32_t)inputs.size(), (uint32_t)outputs.size() };
+  record.size = sizeof(record) + buffers_size(inputs) + buffers_size(outputs);
+
+  if (!reserve(used_ + record.size))
+    return false;
+
+  uint8_t * dst = map_ + used_;
+  memcpy(dst, &record, sizeof(record));
+  dst = write_buffers(dst + sizeof(record), inputs);
+  write_buffers(dst, outputs);
+  used_ += record.size;
+
+  FileHeader * header = (FileHeader *)map_;
+  header->count++;
+  header->used = used_;
+
+  return true;
+}
+
+uint64_t JobRecorder::count()
+{
+  const std::lock_guard<std::mutex> lk(mtx_);
+  return map_ ? ((FileHeader *)map_)->count : 0;
+}
+
+JobPlayer::~JobPlayer()
+{
+  close();
+}
+
+bool JobPlayer::open(const std::string & path, std::string & error)
+{
+  close();
+
+  fd_ = ::open(path.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    error = "cannot open " + path + ": " + strerror(errno);
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd_, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)) {
+    error = path + " is not a record file";
+    close();
+    return false;
+  }
+
+  size_ = st.st_size;
+  void * map = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+  if (map == MAP_FAILED) {
+    error = "cannot map " + path + ": " + strerror(errno);
+    size_ = 0;
+    close();
+    return false;
+  }
+  map_ = (const uint8_t *)map;
+
+  FileHeader header;
+  memcpy(&header, map_, sizeof(header));
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.used > size_) {
+    error = path + " is not a record file";
+    close();
+    return false;
+  }
+
+  // index records, a truncated last record is ignored
+  size_t offset = sizeof(FileHeader);
+  for (uint64_t i = 0; i < header.count; i++) {
+    RecordHeader record;
+    if (offset + sizeof(record) > header.used)
+      break;
+    memcpy(&record, map_ + offset, sizeof(record));
+    if (record.size < sizeof(record) || offset + record.size > header.used)
+      break;
+    records_.push_back(offset);
+    offset += record.size;
+  }
+
+  if (records_.empty()) {
+    error = path + " has no recorded jobs";
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void JobPlayer::close()
+{
+  if (map_ != nullptr) {
+    munmap((void *)map_, size_);
+    map_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  size_ = 0;
+  records_.clear();
+  next_ = 0;
+}
+
+int64_t JobPlayer::next(std::vector<JobReplayBuffer> & outputs)
+{
+  if (records_.empty())
+    return -1;
+
+  const size_t offset = records_[next_.fetch_add(1) % records_.size()];
+  const uint8_t * end = map_ + offset;
+  RecordHeader record;
+  memcpy(&record, end, sizeof(record));
+  end += record.size;
+
+  // skip inputs, then match outputs by name
+  const uint8_t * src = map_ + offset + sizeof(record);
+  size_t matched = 0;
+  for (uint32_t i = 0; i < record.n_inputs + record.n_outputs; i++) {
+    BufferHeader header;
+    if (src + sizeof(header) > end)
+      return -1;
+    memcpy(&header, src, sizeof(header));
+    const char * name = (const char *)src + sizeof(header);
+    const uint8_t * data = src + sizeof(header) + align8(header.name_len);
+    src = data + align8(header.size);
+    if (src > end)
+      return -1;
+
+    if (i < record.n_inputs)
+      continue;
+
+    for (auto & output : outputs) {
+      if (output.name.size() != header.name_len ||
+          memcmp(output.name.data(), name, header.name_len) != 0)
+        continue;
+      if (output.size != header.size)
+        return -1;
+      memcpy(output.data, data, header.size);
+      matched++;
+    }
+  }
+
+  return matched == outputs.size() ? record.latency_us : -1;
+}
@@ -0,0 +1,137 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * @file job_replay.h
+ * @brief Record and replay of accelerator jobs.
+ *
+ * In record mode the inputs and outputs of every job a graph runs are
+ * appended to a memory-mapped file. In replay mode the recorded outputs are
+ * written to the job buffers without an accelerator, after the recorded or a
+ * configured latency. In dry mode jobs only take the configured latency.
+ * Nothing here depends on GStreamer or a device, test/ covers it on a host.
+ */
+
+#ifndef JOB_REPLAY_H_
+#define JOB_REPLAY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Mode: `record`, `replay`, `dry`, anything else or unset disables all
+#define JOB_REPLAY_MODE_ENV "SIMAAI_REPLAY_MODE"
+/// Directory of the record files, one `<graph>.rec` per graph
+#define JOB_REPLAY_DIR_ENV "SIMAAI_REPLAY_DIR"
+/// Replay latency per job in microseconds, recorded latency if unset
+#define JOB_REPLAY_LATENCY_ENV "SIMAAI_REPLAY_LATENCY_US"
+
+#define JOB_REPLAY_DEFAULT_DIR "/tmp/simaai-replay"
+
+/// DRY: jobs are not run and outputs are left as they are, for startup
+/// profiling and pipeline tests without an accelerator or record files
+enum class JobReplayMode { OFF, RECORD, REPLAY, DRY };
+
+/**
+ * @brief Settings of the process, from the environment, so the same
+ *        application.json runs on the board and on a host
+ */
+struct JobReplaySettings {
+  JobReplayMode mode = JobReplayMode::OFF;
+  std::string dir = JOB_REPLAY_DEFAULT_DIR;
+  /// Negative: replay with the recorded latency
+  int64_t latency_us = -1;
+
+  static JobReplaySettings from_env();
+
+  /// Jobs run on the accelerator, so models are loaded
+  bool uses_accelerator() const
+  {
+    return mode == JobReplayMode::OFF || mode == JobReplayMode::RECORD;
+  }
+
+  /// Record file of a graph, the element name
+  std::string path(const std::string & graph) const;
+};
+
+/**
+ * @brief Named buffer of a job, input or output
+ */
+struct JobReplayBuffer {
+  std::string name;
+  void * data = nullptr;
+  size_t size = 0;
+};
+
+/**
+ * @brief Appends jobs to a record file. The file is mapped and grows by
+ *        doubling, the header is updated after every job, so a file of a
+ *        killed process is valid up to the last complete job.
+ */
+class JobRecorder {
+public:
+  JobRecorder() = default;
+  ~JobRecorder();
+  JobRecorder(const JobRecorder &) = delete;
+  JobRecorder & operator=(const JobRecorder &) = delete;
+
+  bool open(const std::string & path, std::string & error);
+  void close();
+
+  /// Appends one job, can be called from several threads
+  bool append(const std::vector<JobReplayBuffer> & inputs,
+              const std::vector<JobReplayBuffer> & outputs,
+              int64_t latency_us);
+
+  uint64_t count();
+
+private:
+  bool reserve(size_t size);
+
+  std::mutex mtx_;
+  int fd_ = -1;
+  uint8_t * map_ = nullptr;
+  size_t capacity_ = 0;
+  size_t used_ = 0;
+};
+
+/**
+ * @brief Plays a record file back. Jobs are returned in recorded order and
+ *        start over after the last one, so a short recording drives a
+ *        pipeline for any number of frames.
+ */
+class JobPlayer {
+public:
+  JobPlayer() = default;
+  ~JobPlayer();
+  JobPlayer(const JobPlayer &) = delete;
+  JobPlayer & operator=(const JobPlayer &) = delete;
+
+  bool open(const std::string & path, std::string & error);
+  void close();
+
+  size_t count() const { return records_.size(); }
+
+  /**
+   * @brief Copies outputs of the next recorded job into buffers of the same
+   *        name, can be called from several threads
+   * @return recorded latency in microseconds, or -1 if a buffer has no
+   *         recorded output or its size differs
+   */
+  int64_t next(std::vector<JobReplayBuffer> & outputs);
+
+private:
+  int fd_ = -1;
+  const uint8_t * map_ = nullptr;
+  size_t size_ = 0;
+  std::vector<size_t> records_;
+  std::atomic<uint64_t> next_{0};
+};
+
+#endif // JOB_REPLAY_H_
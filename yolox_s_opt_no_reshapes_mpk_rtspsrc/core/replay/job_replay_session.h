@@ -0,0 +1,173 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * @file job_replay_session.h
+ * @brief Record and replay of dispatcher jobs of one graph. Buffers of the
+ *        job are simaai memories, mapped per job the same way the host
+ *        backend of processcvu does.
+ */
+
+#ifndef JOB_REPLAY_SESSION_H_
+#define JOB_REPLAY_SESSION_H_
+
+#include <errno.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <simaai/simaai_memory.h>
+
+#include "job_replay.h"
+
+/**
+ * @brief Records or replays jobs of one graph, selected by the settings
+ * @tparam Job dispatcher job type with `buffers` map of simaai memories
+ */
+template <typename Job>
+class JobReplaySession {
+public:
+  using Clock = std::chrono::steady_clock;
+  using KernelTime = std::pair<Clock::time_point, Clock::time_point>;
+
+  /**
+   * @brief Opens the record file of graph, created in record mode
+   * @param outputs dispatcher names of graph outputs, every other job buffer
+   *        is recorded as input
+   */
+  bool open(const JobReplaySettings & settings, const std::string & graph,
+            const std::vector<std::string> & outputs, std::string & error)
+  {
+    settings_ = settings;
+    outputs_ = outputs;
+
+    switch (settings_.mode) {
+      case JobReplayMode::RECORD:
+        return recorder_.open(settings_.path(graph), error);
+      case JobReplayMode::REPLAY:
+        return player_.open(settings_.path(graph), error);
+      default:
+        return true;
+    }
+  }
+
+  JobReplayMode mode() const { return settings_.mode; }
+  bool uses_accelerator() const { return settings_.uses_accelerator(); }
+
+  /**
+   * @brief Appends a job that ran, with the kernel time measured by the
+   *        dispatcher as latency
+   * @return 0 on success or errno code
+   */
+  int record(Job & job, const KernelTime & tp)
+  {
+    std::vector<JobReplayBuffer> inputs, outputs;
+    std::vector<simaai_memory_t *> mapped;
+    int res = map_buffers(job, inputs, outputs, mapped, true);
+
+    if (res == 0) {
+      int64_t latency_us =
+          std::chrono::duration_cast<std::chrono::microseconds>(tp.second - tp.first).count();
+      if (!recorder_.append(inputs, outputs, latency_us))
+        res = EIO;
+    }
+
+    unmap_buffers(mapped);
+    return res;
+  }
+
+  /**
+   * @brief Writes outputs of the next recorded job to the job buffers and
+   *        waits for the recorded or configured latency. In dry mode the
+   *        buffers are not touched and only the configured latency is waited.
+   * @return 0 on success or errno code, same as dispatcher run
+   */
+  int replay(Job & job, KernelTime & tp)
+  {
+    std::vector<JobReplayBuffer> inputs, outputs;
+    std::vector<simaai_memory_t *> mapped;
+
+    tp.first = Clock::now();
+    if (settings_.mode == JobReplayMode::DRY) {
+      if (settings_.latency_us > 0)
+        std::this_thread::sleep_until(tp.first + std::chrono::microseconds(settings_.latency_us));
+      tp.second = Clock::now();
+      return 0;
+    }
+
+    int res = map_buffers(job, inputs, outputs, mapped, false);
+
+    int64_t latency_us = -1;
+    if (res == 0) {
+      latency_us = player_.next(outputs);
+      if (latency_us < 0)
+        res = EIO;
+    }
+
+    for (auto memory : mapped)
+      simaai_memory_flush_cache(memory);
+    unmap_buffers(mapped);
+
+    if (res == 0) {
+      if (settings_.latency_us >= 0)
+        latency_us = settings_.latency_us;
+      std::this_thread::sleep_until(tp.first + std::chrono::microseconds(latency_us));
+    }
+    tp.second = Clock::now();
+
+    return res;
+  }
+
+private:
+  bool is_output(const std::string & name) const
+  {
+    return std::find(outputs_.begin(), outputs_.end(), name) != outputs_.end();
+  }
+
+  /// Maps outputs, and inputs if with_inputs, in job buffer order
+  int map_buffers(Job & job, std::vector<JobReplayBuffer> & inputs,
+                  std::vector<JobReplayBuffer> & outputs,
+                  std::vector<simaai_memory_t *> & mapped, bool with_inputs)
+  {
+    for (auto & [ name, segment ] : job.buffers) {
+      bool output = is_output(name);
+      if (!output && !with_inputs)
+        continue;
+
+      simaai_memory_t * memory = (simaai_memory_t *)segment;
+      if (memory == nullptr)
+        continue;
+
+      void * data = simaai_memory_map(memory);
+      if (data == nullptr)
+        return EBADFD;
+      mapped.push_back(memory);
+      simaai_memory_invalidate_cache(memory);
+
+      JobReplayBuffer buffer = { name, data, simaai_memory_get_size(memory) };
+      (output ? outputs : inputs).push_back(std::move(buffer));
+    }
+
+    return 0;
+  }
+
+  static void unmap_buffers(std::vector<simaai_memory_t *> & mapped)
+  {
+    for (auto memory : mapped)
+      simaai_memory_unmap(memory);
+    mapped.clear();
+  }
+
+  JobReplaySettings settings_;
+  std::vector<std::string> outputs_;
+  JobRecorder recorder_;
+  JobPlayer player_;
+};
+
+#endif // JOB_REPLAY_SESSION_H_
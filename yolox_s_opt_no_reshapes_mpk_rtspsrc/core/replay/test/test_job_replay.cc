@@ -0,0 +1,146 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * Test of job record and replay: jobs are recorded, played back in order and
+ * from the start again, outputs are matched by name and size.
+ *
+ * Usage: test_job_replay [record file]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "job_replay.h"
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      return 1;                                                         \
+    }                                                                   \
+  } while (0)
+
+static int test_record_replay(const std::string & path)
+{
+  std::string error;
+  std::vector<uint8_t> input(100), output(37), big(3 << 20);
+
+  {
+    JobRecorder recorder;
+    CHECK(recorder.open(path, error));
+
+    for (int job = 0; job < 3; job++) {
+      memset(input.data(), job, input.size());
+      memset(output.data(), 0x10 + job, output.size());
+      std::vector<JobReplayBuffer> inputs = { { "ifm0", input.data(), input.size() } };
+      std::vector<JobReplayBuffer> outputs = { { "ofm0", output.data(), output.size() } };
+      CHECK(recorder.append(inputs, outputs, 100 + job));
+    }
+
+    // grows the mapping past the initial capacity
+    for (int job = 0; job < 8; job++) {
+      std::vector<JobReplayBuffer> outputs = { { "big", big.data(), big.size() } };
+      CHECK(recorder.append({}, outputs, 0));
+    }
+    CHECK(recorder.count() == 11);
+  }
+
+  JobPlayer player;
+  CHECK(player.open(path, error));
+  CHECK(player.count() == 11);
+
+  std::vector<uint8_t> replayed(output.size());
+  std::vector<JobReplayBuffer> outputs = { { "ofm0", replayed.data(), replayed.size() } };
+  for (int job = 0; job < 3; job++) {
+    CHECK(player.next(outputs) == 100 + job);
+    CHECK(replayed[0] == 0x10 + job && replayed[36] == 0x10 + job);
+  }
+
+  // recorded jobs without the buffer do not match
+  CHECK(player.next(outputs) == -1);
+  for (int job = 1; job < 8; job++)
+    player.next(outputs);
+
+  // starts over
+  CHECK(player.next(outputs) == 100);
+
+  // size must match the recording
+  std::vector<uint8_t> small(10);
+  std::vector<JobReplayBuffer> wrong = { { "ofm0", small.data(), small.size() } };
+  CHECK(player.next(wrong) == -1);
+
+  return 0;
+}
+
+static int test_invalid(const std::string & path)
+{
+  std::string error;
+  JobPlayer player;
+
+  CHECK(!player.open(path + ".missing", error));
+
+  FILE * fp = fopen(path.c_str(), "w");
+  CHECK(fp != nullptr);
+  fputs("not a record file, not a record file", fp);
+  fclose(fp);
+  CHECK(!player.open(path, error));
+
+  // empty recording
+  {
+    JobRecorder recorder;
+    CHECK(recorder.open(path, error));
+  }
+  CHECK(!player.open(path, error));
+
+  return 0;
+}
+
+static int test_settings()
+{
+  setenv(JOB_REPLAY_MODE_ENV, "replay", 1);
+  setenv(JOB_REPLAY_DIR_ENV, "/data/rec", 1);
+  setenv(JOB_REPLAY_LATENCY_ENV, "250", 1);
+  JobReplaySettings settings = JobReplaySettings::from_env();
+  CHECK(settings.mode == JobReplayMode::REPLAY);
+  CHECK(settings.latency_us == 250);
+  CHECK(settings.path("simaaiprocessmla0") == "/data/rec/simaaiprocessmla0.rec");
+  CHECK(!settings.uses_accelerator());
+
+  setenv(JOB_REPLAY_MODE_ENV, "dry", 1);
+  settings = JobReplaySettings::from_env();
+  CHECK(settings.mode == JobReplayMode::DRY);
+  CHECK(!settings.uses_accelerator());
+
+  setenv(JOB_REPLAY_MODE_ENV, "none", 1);
+  unsetenv(JOB_REPLAY_LATENCY_ENV);
+  settings = JobReplaySettings::from_env();
+  CHECK(settings.mode == JobReplayMode::OFF);
+  CHECK(settings.latency_us < 0);
+  CHECK(settings.uses_accelerator());
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  std::string path = argc > 1 ? argv[1] : "/tmp/test_job_replay.rec";
+
+  if (test_record_replay(path))
+    return 1;
+  if (test_invalid(path))
+    return 1;
+  if (test_settings())
+    return 1;
+
+  unlink(path.c_str());
+  printf("test_job_replay: OK\n");
+  return 0;
+}
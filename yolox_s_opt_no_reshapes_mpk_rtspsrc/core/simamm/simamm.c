@@ -1,16 +1,51 @@
+#include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 #include "simamm.h"
 
-typedef struct {
+/*
+ * Cache of buffer id -> physical and virtual address mappings.
+ *
+ * Entries are spread over SIMAMM_CACHE_SHARDS shards by hash of the buffer
+ * id. Every shard has its own lock and hash index, so threads looking up
+ * different buffers do not contend. Callers keep using a returned address
+ * without telling the cache, so a mapping is never evicted: it stays until
+ * simamm_cache_release() or simamm_cache_clear(). Capacity sizes the index
+ * and is the number of mappings expected at most; a lookup beyond it is
+ * still cached, counted as overflow and warned about.
+ */
+#define SIMAMM_CACHE_SHARDS_BITS 4
+#define SIMAMM_CACHE_SHARDS (1 << SIMAMM_CACHE_SHARDS_BITS)
+#define SIMAMM_CACHE_DEFAULT_CAPACITY 256
+#define SIMAMM_CACHE_CAPACITY_ENV "SIMAMM_CACHE_CAPACITY"
+
+typedef struct buffer_mapping {
     unsigned int id;
     uint64_t paddr;
     void* vaddr;
+    simaai_memory_t *memory;
+    /* next entry in the hash bucket */
+    struct buffer_mapping *hnext;
 } buffer_mapping;
 
-static buffer_mapping mappings[sizeof(uint64_t) * 8] = {{ .id = -1, .paddr = 0, .vaddr = NULL }};
-static int64_t current_mappings = 0;
-static pthread_mutex_t mapping_mutex = PTHREAD_MUTEX_INITIALIZER;
+typedef struct {
+    pthread_mutex_t mutex;
+    buffer_mapping **buckets;
+    uint32_t bucket_mask;
+    uint32_t count;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t overflows;
+    uint64_t failures;
+} mapping_shard;
+
+static mapping_shard shards[SIMAMM_CACHE_SHARDS];
+static pthread_once_t cache_once = PTHREAD_ONCE_INIT;
+static atomic_uint cache_capacity;
+/* entries of all shards */
+static atomic_uint cache_count;
 
 simaai_memory_t *allocate_memory(unsigned int size, int target) {
 
@@ -64,66 +99,275 @@ simaai_memory_t *attach_to_memory(unsigned int buffer_id) {
 	return memory;
 }
 
-static int32_t find_buffer_by_id(unsigned int id)
+static inline uint32_t hash_id(unsigned int id)
+{
+    /* buffer ids are physical addresses, the low bits carry no information */
+    return (uint32_t)id * 2654435761u;
+}
+
+static inline mapping_shard *shard_of(uint32_t hash)
+{
+    return &shards[hash >> (32 - SIMAMM_CACHE_SHARDS_BITS)];
+}
+
+/* Unmap and free entry, shard lock must be held */
+static void shard_release_entry(mapping_shard *shard, buffer_mapping **link)
+{
+    buffer_mapping *e = *link;
+
+    *link = e->hnext;
+    simaai_memory_unmap(e->memory);
+    simaai_memory_free(e->memory);
+    free(e);
+
+    shard->count--;
+    atomic_fetch_sub(&cache_count, 1);
+}
+
+/* Drop all mappings of shard, shard lock must be held */
+static void shard_clear(mapping_shard *shard)
+{
+    uint32_t b;
+
+    for(b = 0; shard->buckets && b <= shard->bucket_mask; b++) {
+        while(shard->buckets[b])
+            shard_release_entry(shard, &shard->buckets[b]);
+    }
+}
+
+/*
+ * Index shard for its share of capacity, entries are moved over and stay
+ * mapped. Shard lock must be held. On failure the old index is kept.
+ */
+static int shard_resize(mapping_shard *shard, uint32_t capacity)
 {
-    int32_t i;
-    simaai_memory_t * m;
-
-    pthread_mutex_lock(&mapping_mutex);
-    for(i = 0; i < (sizeof(mappings) / sizeof(mappings[0])); i++) {
-        if((id == mappings[i].id) && (current_mappings & (1 << i))) {
-            pthread_mutex_unlock(&mapping_mutex);
-            return i;
+    buffer_mapping **buckets, *e;
+    uint32_t b, mask, nbuckets = 1;
+
+    /* keep load factor of the index at or below 0.5 while shards fill evenly,
+     * a crowded shard only gets longer chains */
+    while(nbuckets < capacity * 2)
+        nbuckets <<= 1;
+
+    buckets = calloc(nbuckets, sizeof(buffer_mapping *));
+    if(!buckets)
+        return -1;
+    mask = nbuckets - 1;
+
+    for(b = 0; shard->buckets && b <= shard->bucket_mask; b++) {
+        while((e = shard->buckets[b])) {
+            shard->buckets[b] = e->hnext;
+            e->hnext = buckets[hash_id(e->id) & mask];
+            buckets[hash_id(e->id) & mask] = e;
         }
     }
 
-    for(i = 0; i < (sizeof(mappings) / sizeof(mappings[0])); i++) {
-        if(!(current_mappings & (1 << i))) {
-            m = simaai_memory_attach(id);
-            mappings[i].paddr = simaai_memory_get_phys(m);
-            mappings[i].vaddr = simaai_memory_map(m);
-            mappings[i].id = id;
-            current_mappings |= 1 << i;
-            GST_INFO("Storing new mapping of %#x to %#lx(%#lx) at index %d", mappings[i].id,
-                      mappings[i].paddr, (uint64_t)(mappings[i].vaddr), i);
-            pthread_mutex_unlock(&mapping_mutex);
-            return i;
+    free(shard->buckets);
+    shard->buckets = buckets;
+    shard->bucket_mask = mask;
+    return 0;
+}
+
+static void set_capacity_locked(uint32_t capacity)
+{
+    uint32_t per_shard, s;
+
+    if(capacity < 1)
+        capacity = 1;
+    per_shard = (capacity + SIMAMM_CACHE_SHARDS - 1) / SIMAMM_CACHE_SHARDS;
+
+    for(s = 0; s < SIMAMM_CACHE_SHARDS; s++) {
+        pthread_mutex_lock(&shards[s].mutex);
+        if(shard_resize(&shards[s], per_shard) < 0)
+            GST_ERROR("ERROR: allocating mapping cache index of %u entries", per_shard);
+        pthread_mutex_unlock(&shards[s].mutex);
+    }
+    atomic_store(&cache_capacity, capacity);
+
+    GST_INFO("Mapping cache capacity %u in %d shards", capacity, SIMAMM_CACHE_SHARDS);
+}
+
+static void cache_init(void)
+{
+    uint32_t s, capacity = SIMAMM_CACHE_DEFAULT_CAPACITY;
+    const char *env = getenv(SIMAMM_CACHE_CAPACITY_ENV);
+
+    if(env) {
+        long value = strtol(env, NULL, 0);
+        if(value > 0)
+            capacity = (uint32_t)value;
+        else
+            GST_WARNING("Ignoring invalid %s=%s", SIMAMM_CACHE_CAPACITY_ENV, env);
+    }
+
+    for(s = 0; s < SIMAMM_CACHE_SHARDS; s++)
+        pthread_mutex_init(&shards[s].mutex, NULL);
+
+    set_capacity_locked(capacity);
+}
+
+/*
+ * Find mapping of buffer id, attaching to and mapping the buffer on a miss.
+ * Returns 0 on success, -1 if the buffer can not be attached or mapped.
+ */
+static int find_buffer_by_id(unsigned int id, uint64_t *paddr, void **vaddr)
+{
+    uint32_t hash = hash_id(id);
+    mapping_shard *shard;
+    buffer_mapping *e;
+    simaai_memory_t *m;
+    void *virt;
+
+    pthread_once(&cache_once, cache_init);
+    shard = shard_of(hash);
+
+    pthread_mutex_lock(&shard->mutex);
+    for(e = shard->buckets ? shard->buckets[hash & shard->bucket_mask] : NULL; e; e = e->hnext) {
+        if(e->id == id) {
+            shard->hits++;
+            *paddr = e->paddr;
+            *vaddr = e->vaddr;
+            pthread_mutex_unlock(&shard->mutex);
+            return 0;
         }
     }
+    shard->misses++;
+
+    m = simaai_memory_attach(id);
+    if(!m) {
+        shard->failures++;
+        pthread_mutex_unlock(&shard->mutex);
+        GST_ERROR("ERROR: attaching to memory of buffer id %#x", id);
+        return -1;
+    }
+
+    virt = simaai_memory_map(m);
+    if(!virt) {
+        simaai_memory_free(m);
+        shard->failures++;
+        pthread_mutex_unlock(&shard->mutex);
+        GST_ERROR("ERROR: mapping memory of buffer id %#x", id);
+        return -1;
+    }
+
+    e = shard->buckets ? calloc(1, sizeof(buffer_mapping)) : NULL;
+    if(!e) {
+        /* cache storage could not be allocated, hand out the mapping uncached */
+        shard->failures++;
+        pthread_mutex_unlock(&shard->mutex);
+        *paddr = simaai_memory_get_phys(m);
+        *vaddr = virt;
+        return 0;
+    }
+
+    if(atomic_fetch_add(&cache_count, 1) >= atomic_load(&cache_capacity)) {
+        shard->overflows++;
+        GST_WARNING("Mapping cache is over capacity %u, mapping of %#x is kept "
+                    "until released", atomic_load(&cache_capacity), id);
+    }
 
-    pthread_mutex_unlock(&mapping_mutex);
-    return -1;
+    e->id = id;
+    e->memory = m;
+    e->paddr = simaai_memory_get_phys(m);
+    e->vaddr = virt;
+    e->hnext = shard->buckets[hash & shard->bucket_mask];
+    shard->buckets[hash & shard->bucket_mask] = e;
+    shard->count++;
+
+    GST_INFO("Storing new mapping of %#x to %#lx(%#lx)", e->id, e->paddr, (uint64_t)(e->vaddr));
+
+    *paddr = e->paddr;
+    *vaddr = e->vaddr;
+    pthread_mutex_unlock(&shard->mutex);
+    return 0;
 }
+
 uint64_t buffer_id_to_paddr(unsigned int id)
 {
-    simaai_memory_t * m;
-    uint64_t res;
-    int32_t i = find_buffer_by_id(id);
-
-    if(i >= 0)
-        res = mappings[i].paddr;
-    else {
-        GST_WARNING("Ran out of space to store buffer address, this may have impact on performance or stability");
-        m = simaai_memory_attach(id);
-        res = simaai_memory_get_phys(m);
-    }
+    uint64_t paddr = 0;
+    void *vaddr = NULL;
 
-    return res;
+    find_buffer_by_id(id, &paddr, &vaddr);
+    return paddr;
 }
 
 void* buffer_id_to_vaddr(unsigned int id)
 {
-    simaai_memory_t * m;
-    void *res;
-    int32_t i = find_buffer_by_id(id);
-
-    if(i >= 0)
-        res = mappings[i].vaddr;
-    else {
-        GST_WARNING("Ran out of space to store buffer address, this may have impact on performance or stability");
-        m = simaai_memory_attach(id);
-        res = simaai_memory_get_virt(m);
+    uint64_t paddr = 0;
+    void *vaddr = NULL;
+
+    find_buffer_by_id(id, &paddr, &vaddr);
+    return vaddr;
+}
+
+void simamm_cache_release(unsigned int id)
+{
+    uint32_t hash = hash_id(id);
+    mapping_shard *shard;
+    buffer_mapping **link;
+
+    pthread_once(&cache_once, cache_init);
+    shard = shard_of(hash);
+
+    pthread_mutex_lock(&shard->mutex);
+    for(link = shard->buckets ? &shard->buckets[hash & shard->bucket_mask] : NULL;
+        link && *link; link = &(*link)->hnext) {
+        if((*link)->id == id) {
+            shard_release_entry(shard, link);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&shard->mutex);
+}
+
+void simamm_cache_clear(void)
+{
+    uint32_t s;
+
+    pthread_once(&cache_once, cache_init);
+    for(s = 0; s < SIMAMM_CACHE_SHARDS; s++) {
+        pthread_mutex_lock(&shards[s].mutex);
+        shard_clear(&shards[s]);
+        pthread_mutex_unlock(&shards[s].mutex);
     }
+}
+
+void simamm_cache_set_capacity(unsigned int capacity)
+{
+    pthread_once(&cache_once, cache_init);
+    set_capacity_locked(capacity);
+}
 
-    return res;
+void simamm_cache_get_stats(simamm_cache_stats_t *stats)
+{
+    uint32_t s;
+
+    if(!stats)
+        return;
+
+    pthread_once(&cache_once, cache_init);
+    memset(stats, 0, sizeof(*stats));
+    stats->capacity = atomic_load(&cache_capacity);
+    for(s = 0; s < SIMAMM_CACHE_SHARDS; s++) {
+        pthread_mutex_lock(&shards[s].mutex);
+        stats->hits += shards[s].hits;
+        stats->misses += shards[s].misses;
+        stats->overflows += shards[s].overflows;
+        stats->failures += shards[s].failures;
+        stats->entries += shards[s].count;
+        pthread_mutex_unlock(&shards[s].mutex);
+    }
+}
+
+void simamm_cache_reset_stats(void)
+{
+    uint32_t s;
+
+    pthread_once(&cache_once, cache_init);
+    for(s = 0; s < SIMAMM_CACHE_SHARDS; s++) {
+        pthread_mutex_lock(&shards[s].mutex);
+        shards[s].hits = shards[s].misses = 0;
+        shards[s].overflows = shards[s].failures = 0;
+        pthread_mutex_unlock(&shards[s].mutex);
+    }
 }
@@ -14,6 +14,35 @@ void deallocate_memory(simaai_memory_t *memory);
 simaai_memory_t *attach_to_memory(unsigned int buffer_id);
 uint64_t buffer_id_to_paddr(unsigned int id);
 void* buffer_id_to_vaddr(unsigned int id);
+
+/*
+ * buffer_id_to_paddr() and buffer_id_to_vaddr() keep the buffer attached and
+ * mapped in a cache, so only the first lookup of a buffer pays for the
+ * attach and mmap. An address returned by a lookup stays valid until the
+ * mapping is released or the cache is cleared, it is never evicted. The
+ * capacity of 256 mappings, set with the SIMAMM_CACHE_CAPACITY environment
+ * variable or simamm_cache_set_capacity(), should cover all buffers live at
+ * the same time; mappings beyond it are kept too and counted as overflows.
+ */
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    /* misses stored while the cache was at capacity */
+    uint64_t overflows;
+    /* lookups of buffers that could not be attached or mapped */
+    uint64_t failures;
+    uint32_t entries;
+    uint32_t capacity;
+} simamm_cache_stats_t;
+
+/* Resize the index of the cache, current mappings stay valid */
+void simamm_cache_set_capacity(unsigned int capacity);
+/* Drop mapping of a buffer, e.g. before the buffer is freed */
+void simamm_cache_release(unsigned int id);
+/* Drop all mappings */
+void simamm_cache_clear(void);
+void simamm_cache_get_stats(simamm_cache_stats_t *stats);
+void simamm_cache_reset_stats(void);
 #ifdef __cplusplus
 }
 #endif /* extern "C" { */
@@ -0,0 +1,115 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * Test of the simamm mapping cache on target: more buffers than cache
+ * capacity are looked up in rounds, addresses must match the allocation,
+ * every buffer must miss once only and mappings beyond capacity must be kept
+ * and counted as overflows.
+ *
+ * Usage: test_simamm_cache [buffers] [capacity]
+ */
+
+#include <gst/gst.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include <simaai/simaai_memory.h>
+
+#include "../simamm.h"
+
+/**
+ * @brief Look up all buffers in three rounds with the given cache capacity
+ */
+static void
+run_rounds (const std::vector<simaai_memory_t *> & memories, unsigned int capacity)
+{
+  const guint64 buffers = memories.size();
+  simamm_cache_stats_t stats;
+
+  simamm_cache_clear();
+  simamm_cache_set_capacity(capacity);
+  simamm_cache_reset_stats();
+
+  // first round misses, every later round hits as mappings are never evicted
+  for (int round = 0; round < 3; round++) {
+    for (guint32 i = 0; i < buffers; i++) {
+      unsigned int id = simaai_memory_get_phys(memories[i]);
+      g_assert(buffer_id_to_paddr(id) == simaai_memory_get_phys(memories[i]));
+      guint32 * vaddr = (guint32 *)buffer_id_to_vaddr(id);
+      g_assert(vaddr != NULL && *vaddr == i);
+    }
+  }
+
+  simamm_cache_get_stats(&stats);
+  g_message("capacity %u: hits %" G_GUINT64_FORMAT " misses %" G_GUINT64_FORMAT
+            " overflows %" G_GUINT64_FORMAT " entries %u",
+            stats.capacity, stats.hits, stats.misses, stats.overflows, stats.entries);
+
+  g_assert(stats.capacity >= capacity);
+  g_assert(stats.failures == 0);
+  g_assert(stats.hits + stats.misses == 6 * buffers);
+  g_assert(stats.misses == buffers);
+  g_assert(stats.entries == buffers);
+  // capacity is shared by the shards, however unevenly they fill
+  g_assert(stats.overflows == buffers - MIN(buffers, stats.capacity));
+}
+
+/**
+ * @brief Resize the cache with all buffers mapped, lookups must keep hitting
+ */
+static void
+resize_keeps_mappings (const std::vector<simaai_memory_t *> & memories)
+{
+  simamm_cache_stats_t stats;
+
+  simamm_cache_set_capacity(1);
+  simamm_cache_reset_stats();
+  for (guint32 i = 0; i < memories.size(); i++) {
+    guint32 * vaddr = (guint32 *)buffer_id_to_vaddr(simaai_memory_get_phys(memories[i]));
+    g_assert(vaddr != NULL && *vaddr == i);
+  }
+
+  simamm_cache_get_stats(&stats);
+  g_assert(stats.misses == 0);
+  g_assert(stats.hits == memories.size());
+}
+
+int
+main (int argc, char **argv)
+{
+  gst_init(&argc, &argv);
+
+  const unsigned int buffers = argc > 1 ? atoi(argv[1]) : 128;
+  std::vector<simaai_memory_t *> memories;
+
+  for (guint32 i = 0; i < buffers; i++) {
+    simaai_memory_t * m = allocate_memory(4096, SIMAAI_MEM_TARGET_GENERIC);
+    g_assert(m != NULL);
+    // tag every buffer to check virtual addresses of the cache
+    *(guint32 *)simaai_memory_map(m) = i;
+    simaai_memory_flush_cache(m);
+    memories.push_back(m);
+  }
+
+  // all buffers just fit, then the cache overflows
+  run_rounds(memories, buffers);
+  run_rounds(memories, 16);
+  resize_keeps_mappings(memories);
+
+  for (auto m : memories) {
+    simamm_cache_release(simaai_memory_get_phys(m));
+    deallocate_memory(m);
+  }
+
+  simamm_cache_stats_t stats;
+  simamm_cache_get_stats(&stats);
+  g_assert(stats.entries == 0);
+
+  g_message("test_simamm_cache: OK");
+  return 0;
+}
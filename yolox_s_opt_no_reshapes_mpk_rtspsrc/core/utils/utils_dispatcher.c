@@ -0,0 +1,16 @@
+#include <pthread.h>
+
+#include "utils_dispatcher.h"
+
+// One instance in the process, both plugins link this library
+static pthread_mutex_t dispatcher_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void utils_dispatcher_lock(void)
+{
+  pthread_mutex_lock(&dispatcher_lock);
+}
+
+void utils_dispatcher_unlock(void)
+{
+  pthread_mutex_unlock(&dispatcher_lock);
+}
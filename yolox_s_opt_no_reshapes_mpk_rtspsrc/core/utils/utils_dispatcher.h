@@ -0,0 +1,31 @@
+#ifndef _UTILS_DISPATCHER
+#define _UTILS_DISPATCHER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Take the process wide lock of the dispatcher factory. Elements of
+///        every plugin may reach READY in parallel and
+///        DispatcherFactory::getDispatcher() is not thread safe. Only the
+///        factory call is locked, every element loads its model into and
+///        deletes its own dispatcher without it.
+void utils_dispatcher_lock(void);
+
+/// @brief Release the lock taken with utils_dispatcher_lock()
+void utils_dispatcher_unlock(void);
+
+#ifdef __cplusplus
+}
+
+/// @brief utils_dispatcher_lock() for a scope
+class UtilsDispatcherGuard {
+ public:
+  UtilsDispatcherGuard() { utils_dispatcher_lock(); }
+  ~UtilsDispatcherGuard() { utils_dispatcher_unlock(); }
+  UtilsDispatcherGuard(const UtilsDispatcherGuard &) = delete;
+  UtilsDispatcherGuard & operator=(const UtilsDispatcherGuard &) = delete;
+};
+#endif
+
+#endif // _UTILS_DISPATCHER
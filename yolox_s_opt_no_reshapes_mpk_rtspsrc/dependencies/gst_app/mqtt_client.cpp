@@ -26,13 +26,15 @@ MQTTClient::~MQTTClient() {
     mosquitto_lib_cleanup();
 }
 
-bool MQTTClient::connect(const std::string& host, int port, int keepalive) {
+bool MQTTClient::connect(const std::string& host, int port, int keepalive, bool threaded) {
     if (mosquitto_connect(mosq_, host.c_str(), port, keepalive) != MOSQ_ERR_SUCCESS) {
         simaailog(SIMAAILOG_ERR, "Failed to connect to the broker.");
         std::cerr << "Unable to connect to MQTT broker" << std::endl;
         return false;
     }
-    mosquitto_loop_start(mosq_);
+    if (threaded) {
+        mosquitto_loop_start(mosq_);
+    }
     return true;
 }
 
@@ -41,6 +43,30 @@ void MQTTClient::disconnect() {
     mosquitto_loop_stop(mosq_, true);
 }
 
+int MQTTClient::socket() {
+    return mosquitto_socket(mosq_);
+}
+
+bool MQTTClient::want_write() {
+    return mosquitto_want_write(mosq_);
+}
+
+int MQTTClient::loop_read() {
+    return mosquitto_loop_read(mosq_, 1);
+}
+
+int MQTTClient::loop_write() {
+    return mosquitto_loop_write(mosq_, 1);
+}
+
+int MQTTClient::loop_misc() {
+    return mosquitto_loop_misc(mosq_);
+}
+
+int MQTTClient::reconnect() {
+    return mosquitto_reconnect(mosq_);
+}
+
 // Unusable
 bool MQTTClient::publish(const std::string& topic, const json& message) {
     std::string payload = message.dump();
@@ -19,13 +19,27 @@ public:
     MQTTClient(const std::string& clientId = "", void* context=nullptr);
     ~MQTTClient();
 
-    bool connect(const std::string& host, int port, int keepalive);
+    /// @brief Connects to the broker. With threaded, network traffic is served
+    ///        by a mosquitto thread, else by the caller through the loop_* calls.
+    bool connect(const std::string& host, int port, int keepalive, bool threaded = true);
     void disconnect();
     bool publish(const std::string& topic, const json& message);
     bool subscribe(const std::string& topic);
     void set_message_callback(void (*callback)(struct mosquitto *, void *, const struct mosquitto_message *)); // allow the callback to be defined within the template, so that its easier to process the payload. 
     void stop_listener();
 
+    // Network traffic of a client connected without thread, served from the
+    // event loop of the caller. Each returns a mosquitto error code.
+    /// @brief Socket to watch, -1 when not connected
+    int socket();
+    /// @brief True when there is queued outgoing data, watch socket for writing
+    bool want_write();
+    int loop_read();
+    int loop_write();
+    /// @brief Keepalive and retries, to be called about once per second
+    int loop_misc();
+    int reconnect();
+
 private:
     static void on_connect(struct mosquitto* mosq, void* obj, int rc);
     static void on_log(struct mosquitto* mosq, void* obj, int level, const char* str);
@@ -0,0 +1,345 @@
+#include <multi_stream.h>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+
+static std::string unquote(const std::string& value) {
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        return value.substr(1, value.size() - 2);
+    }
+    return value;
+}
+
+/// @brief Splits on whitespace, keeping double quoted parts in one token
+static std::vector<std::string> tokenize(const std::string& str) {
+    std::vector<std::string> tokens;
+    std::string token;
+    bool quoted = false;
+
+    for (char ch : str) {
+        if (ch == '"') {
+            quoted = !quoted;
+        }
+        if (!quoted && std::isspace((unsigned char)ch)) {
+            if (!token.empty()) {
+                tokens.push_back(token);
+                token.clear();
+            }
+            continue;
+        }
+        token += ch;
+    }
+    if (!token.empty()) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+static GstNode make_node(const std::string& token) {
+    GstNode node;
+    std::size_t eq = token.find('=');
+    std::size_t slash = token.find('/');
+    std::size_t dot = token.find('.');
+
+    if (slash != std::string::npos && (eq == std::string::npos || slash < eq)) {
+        node.kind = GstNode::CAPS;
+        node.factory = token;
+    } else if (dot != std::string::npos && eq == std::string::npos) {
+        node.kind = GstNode::REFERENCE;
+        node.factory = token.substr(0, dot);
+        node.pad = token.substr(dot + 1);
+    } else {
+        node.factory = token;
+    }
+    return node;
+}
+
+std::string GstNode::get(const std::string& key) const {
+    for (auto& prop : props) {
+        if (prop.first == key) {
+            return unquote(prop.second);
+        }
+    }
+    return "";
+}
+
+void GstNode::set(const std::string& key, const std::string& value) {
+    for (auto& prop : props) {
+        if (prop.first == key) {
+            prop.second = value;
+            return;
+        }
+    }
+    props.emplace_back(key, value);
+}
+
+std::string GstNode::to_string() const {
+    if (kind == REFERENCE) {
+        return factory + "." + pad;
+    }
+
+    std::string str = factory;
+    for (auto& prop : props) {
+        str += " " + prop.first + "=" + prop.second;
+    }
+    return str;
+}
+
+std::vector<GstChain> MultiStreamComposer::parse(const std::string& gst_string) {
+    std::vector<GstChain> chains;
+    GstChain chain;
+    bool expect_node = true;
+
+    for (auto& token : tokenize(gst_string)) {
+        if (token == "!") {
+            expect_node = true;
+            continue;
+        }
+
+        if (expect_node) {
+            chain.push_back(make_node(token));
+            expect_node = false;
+            continue;
+        }
+
+        GstNode& node = chain.back();
+        std::size_t eq = token.find('=');
+        if (node.kind == GstNode::CAPS) {
+            node.factory += " " + token;
+        } else if (node.kind == GstNode::ELEMENT && eq != std::string::npos && eq > 0) {
+            node.props.emplace_back(token.substr(0, eq), token.substr(eq + 1));
+        } else {
+            // element or reference not preceded by '!' starts a new chain
+            chains.push_back(chain);
+            chain = { make_node(token) };
+        }
+    }
+
+    if (!chain.empty()) {
+        chains.push_back(chain);
+    }
+    return chains;
+}
+
+MultiStreamComposer::MultiStreamComposer(const std::string& gst_string) {
+    chains = parse(gst_string);
+
+    for (size_t c = 0; c < chains.size() && shared_chain < 0; c++) {
+        const GstChain& chain = chains[c];
+        for (size_t i = 0; i < chain.size(); i++) {
+            if (chain[i].kind != GstNode::ELEMENT || chain[i].factory != "simaaiprocessmla") {
+                continue;
+            }
+
+            // per stream front-end is needed ahead of the shared elements
+            if (i == 0) {
+                break;
+            }
+
+            shared_chain = c;
+            shared_begin = i;
+            shared_end = i + 1;
+            while (shared_end < chain.size() && chain[shared_end].kind == GstNode::ELEMENT &&
+                   (chain[shared_end].factory == "simaaiprocessmla" ||
+                    chain[shared_end].factory == "simaaiprocesscvu")) {
+                shared_end++;
+            }
+            break;
+        }
+    }
+}
+
+std::string MultiStreamComposer::shared_mla_config() const {
+    return valid() ? chains[shared_chain][shared_begin].get("config") : "";
+}
+
+std::map<std::string, std::string> MultiStreamComposer::stream_renames(int stream) const {
+    std::map<std::string, std::string> renames;
+
+    for (size_t c = 0; c < chains.size(); c++) {
+        for (size_t i = 0; i < chains[c].size(); i++) {
+            bool shared = (int)c == shared_chain && i >= shared_begin && i < shared_end;
+            const GstNode& node = chains[c][i];
+            std::string name = node.get("name");
+            if (!shared && node.kind == GstNode::ELEMENT && !name.empty()) {
+                renames[name] = name + "_" + std::to_string(stream);
+            }
+        }
+    }
+    return renames;
+}
+
+GstNode MultiStreamComposer::stream_node(const GstNode& node, int stream,
+                                         const std::map<std::string, std::string>& renames) const {
+    GstNode out = node;
+
+    if (out.kind == GstNode::REFERENCE) {
+        auto it = renames.find(out.factory);
+        if (it != renames.end()) {
+            out.factory = it->second;
+        }
+        return out;
+    }
+
+    if (out.kind != GstNode::ELEMENT) {
+        return out;
+    }
+
+    for (auto& prop : out.props) {
+        auto it = renames.find(unquote(prop.second));
+        if (it != renames.end()) {
+            prop.second = it->second;
+        }
+    }
+
+    // e.g. frame-name of the overlay defaults to the decoder buffer name
+    if (property_defaults) {
+        for (auto& [ key, value ] : property_defaults(out.factory)) {
+            auto it = renames.find(value);
+            if (it != renames.end() && out.get(key).empty()) {
+                out.set(key, it->second);
+            }
+        }
+    }
+
+    std::string config = out.get("config");
+    if (config_rewriter && !config.empty()) {
+        out.set("config", config_rewriter(config, stream, renames));
+    }
+
+    return out;
+}
+
+std::string MultiStreamComposer::to_string(const std::vector<GstChain>& chains) {
+    std::string gst;
+    for (auto& chain : chains) {
+        for (size_t i = 0; i < chain.size(); i++) {
+            gst += chain[i].to_string();
+            gst += i + 1 < chain.size() ? " ! " : " ";
+        }
+    }
+    if (!gst.empty()) {
+        gst.pop_back();
+    }
+    return gst;
+}
+
+std::string MultiStreamComposer::compose(const std::vector<std::string>& rtsp_urls,
+                                         const std::vector<std::string>& host_ips,
+                                         const std::vector<std::string>& host_ports,
+                                         int batch_size) const {
+    if (!valid()) {
+        return "";
+    }
+
+    const size_t num_streams = rtsp_urls.size();
+    std::string gst = compose_shared(batch_size);
+    for (size_t s = 0; s < num_streams; s++) {
+        gst += " " + compose_stream(s, rtsp_urls[s],
+                                    host_ips.size() == num_streams ? host_ips[s] : "",
+                                    host_ports.size() == num_streams ? host_ports[s] : "",
+                                    true);
+    }
+    return gst;
+}
+
+std::string MultiStreamComposer::compose_shared(int batch_size) const {
+    if (!valid()) {
+        return "";
+    }
+
+    const GstChain& shared = chains[shared_chain];
+    GstChain middle;
+
+    GstNode batcher;
+    batcher.factory = "simaaibatcher";
+    batcher.set("name", MULTI_STREAM_BATCHER_NAME);
+    batcher.set("batch-size", std::to_string(batch_size));
+    middle.push_back(batcher);
+    middle.insert(middle.end(), shared.begin() + shared_begin, shared.begin() + shared_end);
+    GstNode unbatcher;
+    unbatcher.factory = "simaaiunbatcher";
+    unbatcher.set("name", MULTI_STREAM_UNBATCHER_NAME);
+    middle.push_back(unbatcher);
+
+    return to_string({ middle });
+}
+
+std::string MultiStreamComposer::compose_stream(int stream, const std::string& rtsp_url,
+                                                const std::string& host_ip,
+                                                const std::string& host_port,
+                                                bool linked) const {
+    if (!valid()) {
+        return "";
+    }
+
+    const GstChain& shared = chains[shared_chain];
+    auto renames = stream_renames(stream);
+    std::vector<GstChain> stream_chains;
+
+    GstChain front;
+    for (size_t i = 0; i < shared_begin; i++) {
+        front.push_back(stream_node(shared[i], stream, renames));
+    }
+    if (linked) {
+        GstNode to_batcher;
+        to_batcher.kind = GstNode::REFERENCE;
+        to_batcher.factory = MULTI_STREAM_BATCHER_NAME;
+        to_batcher.pad = "sink_" + std::to_string(stream);
+        front.push_back(to_batcher);
+    }
+    stream_chains.push_back(front);
+
+    // results of streams without back-end are dropped by the unbatcher
+    if (has_back_end()) {
+        GstChain back;
+        if (linked) {
+            GstNode from_unbatcher;
+            from_unbatcher.kind = GstNode::REFERENCE;
+            from_unbatcher.factory = MULTI_STREAM_UNBATCHER_NAME;
+            from_unbatcher.pad = "src_" + std::to_string(stream);
+            back.push_back(from_unbatcher);
+        }
+        GstNode queue;
+        queue.factory = "queue2";
+        back.push_back(queue);
+        for (size_t i = shared_end; i < shared.size(); i++) {
+            back.push_back(stream_node(shared[i], stream, renames));
+        }
+        stream_chains.push_back(back);
+    }
+
+    for (size_t c = 0; c < chains.size(); c++) {
+        if ((int)c == shared_chain) {
+            continue;
+        }
+        GstChain chain;
+        for (auto& node : chains[c]) {
+            chain.push_back(stream_node(node, stream, renames));
+        }
+        stream_chains.push_back(chain);
+    }
+
+    for (auto& chain : stream_chains) {
+        for (auto& node : chain) {
+            if (node.kind != GstNode::ELEMENT) {
+                continue;
+            }
+            if (node.factory == "rtspsrc") {
+                node.set("location", rtsp_url);
+            } else if (node.factory == "udpsink") {
+                if (!host_ip.empty()) {
+                    node.set("host", host_ip);
+                }
+                std::string port = node.get("port");
+                if (!host_port.empty()) {
+                    node.set("port", host_port);
+                } else if (!port.empty() && std::isdigit((unsigned char)port[0])) {
+                    node.set("port", std::to_string(std::atoi(port.c_str()) + stream));
+                }
+            }
+        }
+    }
+
+    return to_string(stream_chains);
+}
@@ -0,0 +1,105 @@
+#ifndef MULTI_STREAM_H
+#define MULTI_STREAM_H
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#define MULTI_STREAM_BATCHER_NAME           "multistream_batcher"
+#define MULTI_STREAM_UNBATCHER_NAME         "multistream_unbatcher"
+
+/// @brief One element, caps filter or `name.pad` reference of a gst-launch chain
+struct GstNode {
+    enum Kind { ELEMENT, CAPS, REFERENCE };
+
+    Kind kind = ELEMENT;
+    /// @brief Factory name of an element, element name of a reference, caps string
+    std::string factory;
+    /// @brief Pad of a reference, may be empty
+    std::string pad;
+    /// @brief Properties of an element in gst string order
+    std::vector<std::pair<std::string, std::string>> props;
+
+    std::string get(const std::string& key) const;
+    void set(const std::string& key, const std::string& value);
+    std::string to_string() const;
+};
+
+using GstChain = std::vector<GstNode>;
+
+/// @brief Builds a multi-stream gst string from the gst string of one stream.
+///
+/// The chain holding `simaaiprocessmla` is cut around the run of MLA and CVU
+/// elements starting there. That run is instantiated once, behind a
+/// `simaaibatcher` fed by every stream, and followed by a `simaaiunbatcher`
+/// with one src pad per stream. Everything else - source, decoder,
+/// preprocess, overlay, encoder, sink and side branches - is repeated per
+/// stream, with element names suffixed by `_<stream>`.
+///
+/// Buffer names of SiMa elements are their element names, so references to
+/// renamed elements are renamed too: in references, in string properties of
+/// the gst string, in string property defaults of the factory, and in
+/// configs through `rewrite_config`.
+class MultiStreamComposer {
+    public:
+        /// @brief Returns string property defaults of a factory, as name, value
+        using PropertyDefaults = std::function<std::vector<std::pair<std::string, std::string>>(const std::string& factory)>;
+        /// @brief Rewrites a config of stream with renamed buffers, returns path to use
+        using ConfigRewriter = std::function<std::string(const std::string& config_path,
+                                                         int stream,
+                                                         const std::map<std::string, std::string>& renames)>;
+
+        explicit MultiStreamComposer(const std::string& gst_string);
+
+        /// @return false if there is no `simaaiprocessmla` to share
+        bool valid() const { return shared_chain >= 0; }
+        /// @brief Config path of the shared `simaaiprocessmla`, empty if not set
+        std::string shared_mla_config() const;
+
+        void set_property_defaults(PropertyDefaults defaults) { property_defaults = defaults; }
+        void set_config_rewriter(ConfigRewriter rewriter) { config_rewriter = rewriter; }
+
+        /// @brief Composes the gst string for one stream per RTSP url.
+        /// @param host_ips, host_ports one per stream, else udpsink host is kept
+        ///        and port is incremented by the stream index
+        std::string compose(const std::vector<std::string>& rtsp_urls,
+                            const std::vector<std::string>& host_ips,
+                            const std::vector<std::string>& host_ports,
+                            int batch_size) const;
+
+        /// @brief Composes batcher, shared elements and unbatcher
+        std::string compose_shared(int batch_size) const;
+
+        /// @brief Composes front-end and back-end of one stream.
+        /// @param host_ip, host_port udpsink host and port, empty keeps the host
+        ///        and increments the port by the stream index
+        /// @param linked if true, front-end ends in the batcher and back-end starts
+        ///        at the unbatcher, else their pads are left unlinked, to be
+        ///        ghosted by gst_parse_bin_from_description()
+        std::string compose_stream(int stream, const std::string& rtsp_url,
+                                   const std::string& host_ip,
+                                   const std::string& host_port,
+                                   bool linked) const;
+
+        /// @return true if streams have elements after the shared ones
+        bool has_back_end() const { return valid() && shared_end < chains[shared_chain].size(); }
+
+        /// @brief Splits a gst-launch string to chains of nodes
+        static std::vector<GstChain> parse(const std::string& gst_string);
+        /// @brief Joins chains back to a gst-launch string
+        static std::string to_string(const std::vector<GstChain>& chains);
+
+    private:
+        std::vector<GstChain> chains;
+        /// @brief Chain and node range [shared_begin, shared_end) of shared elements
+        int shared_chain = -1;
+        size_t shared_begin = 0, shared_end = 0;
+        PropertyDefaults property_defaults;
+        ConfigRewriter config_rewriter;
+
+        std::map<std::string, std::string> stream_renames(int stream) const;
+        GstNode stream_node(const GstNode& node, int stream,
+                            const std::map<std::string, std::string>& renames) const;
+};
+
+#endif // MULTI_STREAM_H
@@ -10,22 +10,43 @@
 #include <set>
 #include <regex>
 #include <string_utils.h>
+#include <multi_stream.h>
+#include <fstream>
 #include <sys/types.h>
 #include <unistd.h>
 #include <sstream>
+#include <csignal>
+#include <ctime>
+#include <glib-unix.h>
+#include <algorithm>
+#include <cstdlib>
+#include <job_replay.h>
 
 #include <live_trace_reader_api.h>
 
-Pipeline::Pipeline(const std::string& manifest_json_path,
-                const std::string& gst_string,
-                const std::vector<std::string>& rtsp_urls_vec,
-                const std::vector<std::string>& host_ips_vec,
-                const std::vector<std::string>& host_ports_vec,
-                json &gst_replacement_json,
-                bool enable_lttng_param) {
-    gst_init(nullptr, nullptr);
-    this->manifest_json_path = manifest_json_path;
-    this->gst_string = utils::StringUtils::remove_single_quotes(gst_string);
+/// @brief Period of MQTT keepalive and reconnect handling
+#define MQTT_MISC_INTERVAL_SEC 1
+/// @brief Time a removed stream gets to drain before its bin is dropped
+#define STREAM_REMOVE_TIMEOUT_MS 3000
+
+static gint64 thread_cpu_time_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (gint64)ts.tv_sec * G_USEC_PER_SEC + ts.tv_nsec / 1000;
+}
+
+Pipeline::Pipeline(const utils::CmdLineOptions& options) {
+    // plugins read the replay mode when brought to READY
+    if (options.dry_startup) {
+        setenv(JOB_REPLAY_MODE_ENV, "dry", 1);
+    }
+
+    {
+        StartupProfiler::Scope phase(profiler, "gst_init");
+        gst_init(nullptr, nullptr);
+    }
+    this->manifest_json_path = options.manifest_json_path;
+    this->gst_string = utils::StringUtils::remove_single_quotes(options.gst_string);
 
     //check if file exists
     if (!std::filesystem::exists(this->manifest_json_path)) {
@@ -48,11 +69,16 @@ Pipeline::Pipeline(const std::string& manifest_json_path,
     simaailog_init(pipeline_name.c_str());
 
     //init members
-    this->rtsp_urls = rtsp_urls_vec;
-    this->host_ips = host_ips_vec;
-    this->host_ports = host_ports_vec;
-    this->gst_replacement_json = gst_replacement_json;
-    this->enable_lttng = enable_lttng_param;
+    this->rtsp_urls = options.rtsp_urls;
+    this->host_ips = options.host_ips;
+    this->host_ports = options.host_ports;
+    this->gst_replacement_json = options.gst_replacement_json;
+    this->enable_lttng = options.enable_lttng;
+    this->measure_cpu_interval = options.measure_cpu_interval;
+    this->multi_stream = options.multi_stream;
+    this->warm_start_frames = options.warm_start_frames;
+    this->init_threads = options.init_threads > 0 ? options.init_threads : std::max(1u, std::thread::hardware_concurrency());
+    this->dry_startup = options.dry_startup;
 
     this->client = nullptr;
     this->lttng_session = nullptr;
@@ -62,6 +88,9 @@ Pipeline::Pipeline(const std::string& manifest_json_path,
 }
 
 Pipeline::~Pipeline() {
+    // removes its probes before the pipeline stops
+    warm_start.reset();
+
     if (client) {
         delete client;
     }
@@ -74,11 +103,23 @@ Pipeline::~Pipeline() {
         gst_object_unref(bus);
     }
 
+    for (auto &[ index, branch ] : streams) {
+        if (branch.batcher_pad) gst_object_unref(branch.batcher_pad);
+        if (branch.unbatcher_pad) gst_object_unref(branch.unbatcher_pad);
+    }
+    if (batcher) gst_object_unref(batcher);
+    if (unbatcher) gst_object_unref(unbatcher);
+
     if (pipeline) {
         std::cout << "Destructor called." << std::endl;
         gst_element_set_state(pipeline, GST_STATE_NULL);
         gst_object_unref(pipeline);
     }
+
+    if (!multi_stream_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::remove_all(multi_stream_dir, ec);
+    }
 }
 
 bool Pipeline::initMQTTClient() {
@@ -87,7 +128,8 @@ bool Pipeline::initMQTTClient() {
     std::cout << "Initializing MQTT Client with ClientId: " << clientId.str() << std::endl;
 
     client = new MQTTClient(clientId.str(), this);
-    if (!client->connect(SIMAAI_MQTT_HOST, SIMAAI_MQTT_PORT, SIMAAI_MQTT_KEEPALIVE)) {
+    // network traffic is served by the driver loop, see update_mqtt_watch()
+    if (!client->connect(SIMAAI_MQTT_HOST, SIMAAI_MQTT_PORT, SIMAAI_MQTT_KEEPALIVE, false)) {
         std::cerr << "MQTT Client couldn't connect" << std::endl;
         simaailog(SIMAAILOG_ERR, "PipelineId: [%s] MQTT client init failed", pipeline_name.c_str());
         return false;
@@ -129,9 +171,19 @@ void Pipeline::init_signals() {
     );
 }
 
+/// @brief True for children of root and of its multi-stream stream bins
+static bool is_app_element(GstElement *root, GstElement *element) {
+    GstObject *parent = GST_OBJECT_PARENT(element);
+    if (parent == GST_OBJECT(root)) {
+        return true;
+    }
+    return parent && GST_OBJECT_PARENT(parent) == GST_OBJECT(root) &&
+           g_str_has_prefix(GST_OBJECT_NAME(parent), "stream_");
+}
+
 //TODO: Look into how this can be better implemented. Pass a callback for each item?
 void Pipeline::parse_pipeline() {
-    GstIterator *it = gst_bin_iterate_elements(GST_BIN(pipeline));
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN(pipeline));
     gboolean done = FALSE;
     int transmit_count = 0;
     int overlay_count = 0;
@@ -145,6 +197,10 @@ void Pipeline::parse_pipeline() {
         switch (gst_iterator_next(it, &item)) {
             case GST_ITERATOR_OK: {
                 GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+                if (!is_app_element(pipeline, element)) {
+                    g_value_reset(&item);
+                    break;
+                }
                 const gchar *element_name = gst_element_get_name(element);
 
                 std::cout << "Element Name: " << element_name << std::endl;
@@ -222,17 +278,65 @@ void Pipeline::parse_pipeline() {
 
 
 void Pipeline::pipeline_driver(){
+    driver_start_us = g_get_monotonic_time();
+
     //build pipeline from gst_string
-    if(!buildPipeline()){
+    gint64 parse_begin_us = g_get_monotonic_time();
+    gboolean built = buildPipeline();
+    profiler.add_phase("parse_launch", parse_begin_us, g_get_monotonic_time());
+    if(!built){
         std::cerr << "Error building pipeline, exiting..." << std::endl;
         simaailog(SIMAAILOG_ERR,"PipelineID: [%s] Error building pipeline", pipeline_name.c_str());
         return;
     }
 
-    parse_pipeline();
+    if (multi_stream) {
+        StartupProfiler::Scope phase(profiler, "add_streams");
+        // streams are bins of their own, to be added and removed at runtime
+        g_object_set(pipeline, "message-forward", TRUE, NULL);
+        batcher = gst_bin_get_by_name(GST_BIN(pipeline), MULTI_STREAM_BATCHER_NAME);
+        unbatcher = gst_bin_get_by_name(GST_BIN(pipeline), MULTI_STREAM_UNBATCHER_NAME);
+
+        for (size_t i = 0; i < rtsp_urls.size(); i++) {
+            json report;
+            std::string host_ip = host_ips.size() == rtsp_urls.size() ? host_ips[i] : "";
+            std::string host_port = host_ports.size() == rtsp_urls.size() ? host_ports[i] : "";
+            if (add_stream(rtsp_urls[i], host_ip, host_port, report) < 0) {
+                std::cerr << "Error adding stream " << rtsp_urls[i] << ", exiting..." << std::endl;
+                return;
+            }
+        }
+    }
+
+    {
+        StartupProfiler::Scope phase(profiler, "parse_pipeline");
+        parse_pipeline();
+    }
+
+    // stand-in dispatchers run no jobs, startup is profiled up to READY
+    if (dry_startup) {
+        if (ready_pipeline()) {
+            publish_report("Startup", profiler.report());
+        }
+        return;
+    }
+
+    // multi-stream mode reports the first result of each stream instead
+    if (!warm_start_attach.empty()) {
+        StartupProfiler::Scope phase(profiler, "warm_start_setup");
+        warm_start = std::make_unique<WarmStart>(pipeline, warm_start_attach, warm_start_frames, driver_start_us,
+                                                 [this](const json& report) { publish_report("Warm start", report); });
+        std::string warm_start_error;
+        if (!warm_start->setup(warm_start_error)) {
+            std::cerr << "Warm start and first result report disabled: " << warm_start_error << std::endl;
+            simaailog(SIMAAILOG_WARNING, "PipelineId: [%s] Warm start and first result report disabled: %s", pipeline_name.c_str(), warm_start_error.c_str());
+            warm_start.reset();
+        }
+    }
 
     std::string session_url;
-    if (this->enable_lttng) {
+    // MQTT carries KPI requests, and stream commands in multi-stream mode
+    if (this->enable_lttng || this->multi_stream) {
         //Connect to the Mqtt broker
         if(!initMQTTClient()) {
             std::cerr << "Error connecting to the MQTT client, exiting..." << std::endl;
@@ -242,7 +346,9 @@ void Pipeline::pipeline_driver(){
 
         //register calback function
         client->set_message_callback(mqtt_callback);
+    }
 
+    if (this->enable_lttng) {
         pid_t pipeline_pid = getpid();
         this->lttng_session = new utils::LttngSession(this->pipeline_name.c_str(), pipeline_pid);
         if (this->lttng_session == nullptr) {
@@ -264,63 +370,623 @@ void Pipeline::pipeline_driver(){
 
     init_signals();
 
-    //start playing the pipeline
-    start_pipeline();
-
     //initialize GstBus
     initBus();
 
-    //loop to drive the code
-    while(!terminate){
-        msg = gst_bus_pop_filtered(bus, static_cast<GstMessageType>(GST_MESSAGE_ERROR | GST_MESSAGE_EOS | GST_MESSAGE_APPLICATION));
-        if (msg==NULL) continue;
-        switch(GST_MESSAGE_TYPE(msg)) {
-            case GST_MESSAGE_ERROR:
+    //start playing the pipeline
+    if (!start_pipeline()) {
+        std::cerr << "Error starting pipeline, exiting..." << std::endl;
+        return;
+    }
+    if (warm_start) {
+        warm_start->start();
+    }
+
+    //serve bus, MQTT, signals and timers until EOS, error or termination
+    loop = g_main_loop_new(nullptr, FALSE);
+    add_loop_sources();
+
+    cpu_start_us = cpu_last_us = thread_cpu_time_us();
+    wall_start_us = wall_last_us = g_get_monotonic_time();
+
+    if (!terminate) {
+        g_main_loop_run(loop);
+    }
+
+    if (measure_cpu_interval > 0) {
+        report_cpu(true);
+    }
+
+    remove_loop_sources();
+    g_main_loop_unref(loop);
+    loop = nullptr;
+
+    g_signal_emit (pipeline, signals[SIGNAL_PIPELINE_STOP], 0);
+
+    return;
+}
+
+void Pipeline::terminate_pipeline(){
+    std::cout << "Terminating pipeline ..." << std::endl;
+    terminate = TRUE;
+    live_trace_reader_set_running_status(LIVE_TRACE_READER_RUNNING_STATUS_STOP);
+    if (loop) {
+        g_main_loop_quit(loop);
+    }
+}
+
+void Pipeline::add_loop_sources() {
+    bus_watch_id = gst_bus_add_watch(bus, bus_callback, this);
+
+    const int signums[] = { SIGINT, SIGTERM, SIGUSR1, SIGUSR2 };
+    for (guint i = 0; i < G_N_ELEMENTS(signums); i++) {
+        signal_watches[i].self = this;
+        signal_watches[i].signum = signums[i];
+        signal_watches[i].id = g_unix_signal_add(signums[i], signal_callback, &signal_watches[i]);
+    }
+
+    if (client) {
+        update_mqtt_watch();
+        mqtt_timer_id = g_timeout_add_seconds(MQTT_MISC_INTERVAL_SEC, mqtt_timer_callback, this);
+    }
+
+    if (measure_cpu_interval > 0) {
+        cpu_timer_id = g_timeout_add_seconds(measure_cpu_interval, cpu_timer_callback, this);
+    }
+}
+
+void Pipeline::remove_loop_sources() {
+    guint *ids[] = { &bus_watch_id, &mqtt_watch_id, &mqtt_timer_id, &cpu_timer_id,
+                     &signal_watches[0].id, &signal_watches[1].id,
+                     &signal_watches[2].id, &signal_watches[3].id };
+    for (guint *id : ids) {
+        if (*id) {
+            g_source_remove(*id);
+            *id = 0;
+        }
+    }
+    mqtt_watch_fd = -1;
+
+    for (auto &[ index, branch ] : streams) {
+        if (branch.remove_timeout_id) {
+            g_source_remove(branch.remove_timeout_id);
+            branch.remove_timeout_id = 0;
+        }
+    }
+}
+
+gboolean Pipeline::bus_callback(GstBus *gst_bus, GstMessage *message, gpointer data) {
+    Pipeline *self = static_cast<Pipeline *>(data);
+    self->loop_dispatches++;
+    self->handle_bus_message(message);
+    return G_SOURCE_CONTINUE;
+}
+
+void Pipeline::handle_bus_message(GstMessage *msg) {
+    switch(GST_MESSAGE_TYPE(msg)) {
+        case GST_MESSAGE_ERROR: {
+            // an error of one stream removes that stream, if others are left
+            int stream = multi_stream ? find_stream(GST_MESSAGE_SRC(msg)) : -1;
+            if (stream >= 0 && streams.size() > 1) {
                 gst_message_parse_error(msg, &error, &debug_info);
-                std::cerr << "Error received from element " << GST_OBJECT_NAME(msg->src) << ": " << error->message << std::endl;
-                std::cerr << "Debugging information: " << (debug_info ? debug_info : "none") << std::endl;
-                simaailog(SIMAAILOG_ERR, "PipelineId: [%s] Error received from element: %s, debug info: %s", pipeline_name.c_str(), GST_OBJECT_NAME(msg->src), (debug_info ? debug_info : "none"));
+                std::cerr << "Error received from element " << GST_OBJECT_NAME(msg->src) << " of stream " << stream << ": " << error->message << std::endl;
+                simaailog(SIMAAILOG_ERR, "PipelineId: [%s] Error received from element: %s of stream %d, debug info: %s", pipeline_name.c_str(), GST_OBJECT_NAME(msg->src), stream, (debug_info ? debug_info : "none"));
                 g_clear_error(&error);
                 g_free(debug_info);
-                terminate = TRUE;
-                live_trace_reader_set_running_status(LIVE_TRACE_READER_RUNNING_STATUS_STOP);
+                debug_info = nullptr;
+                finish_stream_removal(stream, "error");
                 break;
+            }
 
-            case GST_MESSAGE_EOS: {
-                simaailog(SIMAAILOG_INFO, "PipelineId: [%s] End of Stream reached.", pipeline_name.c_str());
-                terminate = TRUE;
-                live_trace_reader_set_running_status(LIVE_TRACE_READER_RUNNING_STATUS_STOP);
+            gst_message_parse_error(msg, &error, &debug_info);
+            std::cerr << "Error received from element " << GST_OBJECT_NAME(msg->src) << ": " << error->message << std::endl;
+            std::cerr << "Debugging information: " << (debug_info ? debug_info : "none") << std::endl;
+            simaailog(SIMAAILOG_ERR, "PipelineId: [%s] Error received from element: %s, debug info: %s", pipeline_name.c_str(), GST_OBJECT_NAME(msg->src), (debug_info ? debug_info : "none"));
+            g_clear_error(&error);
+            g_free(debug_info);
+            debug_info = nullptr;
+            terminate = TRUE;
+            live_trace_reader_set_running_status(LIVE_TRACE_READER_RUNNING_STATUS_STOP);
+            g_main_loop_quit(loop);
+            break;
+        }
+
+        case GST_MESSAGE_ELEMENT: {
+            // with message-forward, EOS of a stream bin arrives wrapped
+            const GstStructure *structure = gst_message_get_structure(msg);
+            if (!multi_stream || !structure || !gst_structure_has_name(structure, "GstBinForwarded")) {
+                break;
+            }
 
-                if (this->ltr.valid()) {
-                    int ltr_ret = this->ltr.get();
-                    if (ltr_ret) {
-                        std::cerr << "Live trace reader finished with code: " << ltr_ret << std::endl;
+            GstMessage *forwarded = nullptr;
+            gst_structure_get(structure, "message", GST_TYPE_MESSAGE, &forwarded, NULL);
+            if (forwarded) {
+                if (GST_MESSAGE_TYPE(forwarded) == GST_MESSAGE_EOS) {
+                    for (auto &[ index, branch ] : streams) {
+                        if (GST_MESSAGE_SRC(forwarded) == GST_OBJECT(branch.bin) && branch.remove_us) {
+                            finish_stream_removal(index, "drained");
+                            break;
+                        }
                     }
                 }
-                break;
+                gst_message_unref(forwarded);
             }
+            break;
+        }
 
-            case GST_MESSAGE_APPLICATION: {
-                // FIXME: Currently ignoring this
-                break;
+        case GST_MESSAGE_EOS: {
+            simaailog(SIMAAILOG_INFO, "PipelineId: [%s] End of Stream reached.", pipeline_name.c_str());
+            terminate = TRUE;
+            live_trace_reader_set_running_status(LIVE_TRACE_READER_RUNNING_STATUS_STOP);
+
+            if (this->ltr.valid()) {
+                int ltr_ret = this->ltr.get();
+                if (ltr_ret) {
+                    std::cerr << "Live trace reader finished with code: " << ltr_ret << std::endl;
+                }
             }
+            g_main_loop_quit(loop);
+            break;
+        }
 
-            default:
-                simaailog(SIMAAILOG_INFO, "PipelineId: [%s] Unexpeted message received.", pipeline_name.c_str());
-                std::cerr << "Unexpected message received." << std::endl;
-                break;
+        case GST_MESSAGE_APPLICATION: {
+            // FIXME: Currently ignoring this
+            break;
         }
-        gst_message_unref(msg);
+
+        default:
+            // state changes, stream status, qos and the like are not handled
+            break;
     }
-    g_signal_emit (pipeline, signals[SIGNAL_PIPELINE_STOP], 0);
+}
 
-    return;
+gboolean Pipeline::signal_callback(gpointer data) {
+    SignalWatch *watch = static_cast<SignalWatch *>(data);
+    watch->self->loop_dispatches++;
+    std::cout << "Interrupt signal code received: " << watch->signum << std::endl;
+    watch->self->terminate_pipeline();
+    return G_SOURCE_CONTINUE;
 }
 
-void Pipeline::terminate_pipeline(){
-    std::cout << "Terminating pipeline ..." << std::endl;
-    terminate = TRUE;
-    live_trace_reader_set_running_status(LIVE_TRACE_READER_RUNNING_STATUS_STOP);
+gboolean Pipeline::mqtt_io_callback(gint fd, GIOCondition condition, gpointer data) {
+    Pipeline *self = static_cast<Pipeline *>(data);
+    self->loop_dispatches++;
+
+    int ret = MOSQ_ERR_SUCCESS;
+    if (condition & (G_IO_IN | G_IO_HUP | G_IO_ERR)) {
+        // message callback, handle_callback(), runs from here
+        ret = self->client->loop_read();
+    }
+    if (ret == MOSQ_ERR_SUCCESS && (condition & G_IO_OUT)) {
+        ret = self->client->loop_write();
+    }
+    if (ret != MOSQ_ERR_SUCCESS) {
+        simaailog(SIMAAILOG_ERR, "PipelineId: [%s] MQTT connection lost: %s", self->pipeline_name.c_str(), mosquitto_strerror(ret));
+    }
+
+    // removes this watch when the socket changed or was closed
+    self->update_mqtt_watch();
+    return G_SOURCE_CONTINUE;
+}
+
+gboolean Pipeline::mqtt_timer_callback(gpointer data) {
+    Pipeline *self = static_cast<Pipeline *>(data);
+    self->loop_dispatches++;
+
+    if (self->client->socket() < 0) {
+        int ret = self->client->reconnect();
+        if (ret != MOSQ_ERR_SUCCESS) {
+            simaailog(SIMAAILOG_DEBUG, "PipelineId: [%s] MQTT reconnect failed: %s", self->pipeline_name.c_str(), mosquitto_strerror(ret));
+        }
+    }
+    self->client->loop_misc();
+
+    self->update_mqtt_watch();
+    return G_SOURCE_CONTINUE;
+}
+
+void Pipeline::update_mqtt_watch() {
+    int fd = client->socket();
+    GIOCondition condition = (GIOCondition)(G_IO_IN | G_IO_HUP | G_IO_ERR);
+    if (client->want_write()) {
+        condition = (GIOCondition)(condition | G_IO_OUT);
+    }
+
+    if (mqtt_watch_id && fd == mqtt_watch_fd && condition == mqtt_watch_condition) {
+        return;
+    }
+
+    if (mqtt_watch_id) {
+        g_source_remove(mqtt_watch_id);
+        mqtt_watch_id = 0;
+    }
+
+    mqtt_watch_fd = fd;
+    mqtt_watch_condition = condition;
+    if (fd >= 0) {
+        mqtt_watch_id = g_unix_fd_add(fd, condition, mqtt_io_callback, this);
+    }
+}
+
+gboolean Pipeline::cpu_timer_callback(gpointer data) {
+    Pipeline *self = static_cast<Pipeline *>(data);
+    self->loop_dispatches++;
+    self->report_cpu(false);
+    return G_SOURCE_CONTINUE;
+}
+
+void Pipeline::report_cpu(bool final) {
+    gint64 cpu_us = thread_cpu_time_us();
+    gint64 wall_us = g_get_monotonic_time();
+
+    gint64 cpu_delta = final ? cpu_us - cpu_start_us : cpu_us - cpu_last_us;
+    gint64 wall_delta = final ? wall_us - wall_start_us : wall_us - wall_last_us;
+    guint64 dispatches = final ? loop_dispatches : loop_dispatches - loop_dispatches_last;
+    double percent = wall_delta > 0 ? 100.0 * cpu_delta / wall_delta : 0.0;
+
+    std::stringstream ss;
+    ss << "Driver CPU" << (final ? " total" : "") << ": " << cpu_delta / 1000.0
+       << " ms in " << wall_delta / 1000000.0 << " s (" << percent << "% of a core), "
+       << dispatches << " dispatches";
+    std::cout << ss.str() << std::endl;
+    simaailog(SIMAAILOG_INFO, "PipelineId: [%s] %s", pipeline_name.c_str(), ss.str().c_str());
+
+    cpu_last_us = cpu_us;
+    wall_last_us = wall_us;
+    loop_dispatches_last = loop_dispatches;
+}
+
+static double elapsed_ms(gint64 from_us, gint64 to_us) {
+    return (to_us - from_us) / 1000.0;
+}
+
+int Pipeline::add_stream(const std::string& url, const std::string& host_ip,
+                         const std::string& host_port, json& report) {
+    gint64 start_us = g_get_monotonic_time();
+    int stream = next_stream;
+
+    report["stream"] = stream;
+    report["url"] = url;
+
+    std::string description = composer->compose_stream(stream, url, host_ip, host_port, false);
+    GError *err = nullptr;
+    GstElement *bin = gst_parse_bin_from_description(description.c_str(), TRUE, &err);
+    if (err) {
+        std::cerr << "Error building stream " << stream << ": " << err->message << std::endl;
+        simaailog(SIMAAILOG_ERR, "PipelineId: [%s] Error building stream %d: %s", pipeline_name.c_str(), stream, err->message);
+        report["error"] = err->message;
+        g_clear_error(&err);
+        if (bin) {
+            gst_object_unref(bin);
+        }
+        return -1;
+    }
+    next_stream++;
+
+    std::string bin_name = "stream_" + std::to_string(stream);
+    gst_object_set_name(GST_OBJECT(bin), bin_name.c_str());
+    gint64 built_us = g_get_monotonic_time();
+
+    StreamBranch branch;
+    branch.bin = bin;
+    branch.url = url;
+    branch.added_us = start_us;
+    gst_bin_add(GST_BIN(pipeline), bin);
+
+    // unlinked pads of front-end and back-end were ghosted as "src" and "sink"
+    gboolean linked = TRUE;
+    GstPad *src = gst_element_get_static_pad(bin, "src");
+    std::string batcher_pad_name = "sink_" + std::to_string(stream);
+    branch.batcher_pad = gst_element_request_pad_simple(batcher, batcher_pad_name.c_str());
+    linked &= src && branch.batcher_pad && gst_pad_link(src, branch.batcher_pad) == GST_PAD_LINK_OK;
+
+    GstPad *sink = gst_element_get_static_pad(bin, "sink");
+    if (sink) {
+        std::string unbatcher_pad_name = "src_" + std::to_string(stream);
+        branch.unbatcher_pad = gst_element_request_pad_simple(unbatcher, unbatcher_pad_name.c_str());
+        linked &= branch.unbatcher_pad && gst_pad_link(branch.unbatcher_pad, sink) == GST_PAD_LINK_OK;
+    }
+    gint64 linked_us = g_get_monotonic_time();
+
+    // first result of the stream closes the add latency
+    GstPad *result_pad = sink ? sink : src;
+    if (linked && result_pad) {
+        StreamEvent *event = g_new0(StreamEvent, 1);
+        event->self = this;
+        event->stream = stream;
+        gst_pad_add_probe(result_pad, GST_PAD_PROBE_TYPE_BUFFER,
+                          stream_first_result_probe, event, g_free);
+    }
+    if (src) gst_object_unref(src);
+    if (sink) gst_object_unref(sink);
+
+    streams[stream] = branch;
+    if (!linked) {
+        std::cerr << "Error linking stream " << stream << std::endl;
+        simaailog(SIMAAILOG_ERR, "PipelineId: [%s] Error linking stream %d", pipeline_name.c_str(), stream);
+        report["error"] = "link failed";
+        finish_stream_removal(stream, "link failed");
+        return -1;
+    }
+
+    if (transmit_value) {
+        set_property("transmit", transmit_value, bin);
+    }
+    gst_element_sync_state_with_parent(bin);
+    gint64 started_us = g_get_monotonic_time();
+
+    report["build_ms"] = elapsed_ms(start_us, built_us);
+    report["link_ms"] = elapsed_ms(built_us, linked_us);
+    report["start_ms"] = elapsed_ms(linked_us, started_us);
+    report["total_ms"] = elapsed_ms(start_us, started_us);
+
+    std::stringstream ss;
+    ss << "Stream " << stream << " added: " << url << ", build " << report["build_ms"] << " ms, link "
+       << report["link_ms"] << " ms, start " << report["start_ms"] << " ms";
+    std::cout << ss.str() << std::endl;
+    simaailog(SIMAAILOG_INFO, "PipelineId: [%s] %s", pipeline_name.c_str(), ss.str().c_str());
+    return stream;
+}
+
+GstPadProbeReturn Pipeline::stream_first_result_probe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+    StreamEvent *event = static_cast<StreamEvent *>(data);
+    StreamEvent *copy = g_new(StreamEvent, 1);
+    *copy = *event;
+    copy->time_us = g_get_monotonic_time();
+
+    // streaming thread, the report is made on the driver loop
+    g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT, [](gpointer data) -> gboolean {
+        StreamEvent *event = static_cast<StreamEvent *>(data);
+        Pipeline *self = event->self;
+        auto it = self->streams.find(event->stream);
+        if (it != self->streams.end()) {
+            json report = { { "event", "first-result" }, { "stream", event->stream },
+                            { "first_result_ms", elapsed_ms(it->second.added_us, event->time_us) } };
+            self->publish_report("Stream control", report);
+        }
+        return G_SOURCE_REMOVE;
+    }, copy, g_free);
+
+    return GST_PAD_PROBE_REMOVE;
+}
+
+/// @brief Drops data of a source pad being ended and sends EOS downstream of it
+static gboolean end_source_pad(GstElement *element, GstPad *pad, gpointer data) {
+    gboolean *sent = static_cast<gboolean *>(data);
+
+    gst_pad_add_probe(pad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                      [](GstPad *, GstPadProbeInfo *, gpointer) { return GST_PAD_PROBE_DROP; },
+                      nullptr, nullptr);
+
+    GstPad *peer = gst_pad_get_peer(pad);
+    if (peer) {
+        *sent |= gst_pad_send_event(peer, gst_event_new_eos());
+        gst_object_unref(peer);
+    }
+    return TRUE;
+}
+
+bool Pipeline::remove_stream(int stream, json& report) {
+    report["stream"] = stream;
+
+    auto it = streams.find(stream);
+    if (it == streams.end()) {
+        report["error"] = "no such stream";
+        return false;
+    }
+
+    StreamBranch &branch = it->second;
+    if (branch.remove_us) {
+        report["error"] = "stream is being removed";
+        return false;
+    }
+
+    // EOS of every sink would end the whole pipeline
+    int active = 0;
+    for (auto &[ index, other ] : streams) {
+        active += other.remove_us == 0;
+    }
+    if (active <= 1) {
+        report["error"] = "last stream, stop the pipeline instead";
+        return false;
+    }
+
+    branch.remove_us = g_get_monotonic_time();
+    std::cout << "Removing stream " << stream << ": " << branch.url << std::endl;
+    simaailog(SIMAAILOG_INFO, "PipelineId: [%s] Removing stream %d", pipeline_name.c_str(), stream);
+
+    StreamEvent *event = g_new0(StreamEvent, 1);
+    event->self = this;
+    event->stream = stream;
+    branch.remove_timeout_id = g_timeout_add_full(G_PRIORITY_DEFAULT, STREAM_REMOVE_TIMEOUT_MS,
+                                                  stream_remove_timeout, event, g_free);
+
+    // EOS leaving the front-end ends the stream at the batcher
+    GstPad *src = gst_element_get_static_pad(branch.bin, "src");
+    if (src) {
+        event = g_new0(StreamEvent, 1);
+        event->self = this;
+        event->stream = stream;
+        gst_pad_add_probe(src, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+                          stream_front_eos_probe, event, g_free);
+        gst_object_unref(src);
+    }
+
+    // EOS only from the sources of this bin, shared elements never see it
+    gboolean sent = FALSE;
+    GstIterator *sources = gst_bin_iterate_sources(GST_BIN(branch.bin));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(sources, &item) == GST_ITERATOR_OK) {
+        gst_element_foreach_src_pad(GST_ELEMENT(g_value_get_object(&item)), end_source_pad, &sent);
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(sources);
+
+    // a source that never got data, e.g. unreachable camera, has nothing to drain
+    if (!sent) {
+        finish_stream_removal(stream, "no data");
+    }
+    return true;
+}
+
+GstPadProbeReturn Pipeline::stream_front_eos_probe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+    GstEvent *gst_event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(gst_event) != GST_EVENT_EOS) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    StreamEvent *copy = g_new(StreamEvent, 1);
+    *copy = *static_cast<StreamEvent *>(data);
+    copy->time_us = g_get_monotonic_time();
+    g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT, [](gpointer data) -> gboolean {
+        StreamEvent *event = static_cast<StreamEvent *>(data);
+        event->self->stream_front_eos(event->stream, event->time_us);
+        return G_SOURCE_REMOVE;
+    }, copy, g_free);
+
+    return GST_PAD_PROBE_OK;
+}
+
+void Pipeline::stream_front_eos(int stream, gint64 time_us) {
+    auto it = streams.find(stream);
+    if (it == streams.end() || it->second.front_eos_us) {
+        return;
+    }
+    StreamBranch &branch = it->second;
+    branch.front_eos_us = time_us;
+
+    // results still in flight are dropped by the unbatcher, the back-end gets EOS
+    if (branch.unbatcher_pad) {
+        GstPad *sink = gst_element_get_static_pad(branch.bin, "sink");
+        gst_pad_unlink(branch.unbatcher_pad, sink);
+        gst_element_release_request_pad(unbatcher, branch.unbatcher_pad);
+        gst_object_unref(branch.unbatcher_pad);
+        branch.unbatcher_pad = nullptr;
+        gst_pad_send_event(sink, gst_event_new_eos());
+        gst_object_unref(sink);
+    }
+
+    // bin without sinks posts no EOS
+    if (!GST_OBJECT_FLAG_IS_SET(branch.bin, GST_ELEMENT_FLAG_SINK)) {
+        finish_stream_removal(stream, "drained");
+    }
+}
+
+gboolean Pipeline::stream_remove_timeout(gpointer data) {
+    StreamEvent *event = static_cast<StreamEvent *>(data);
+    auto it = event->self->streams.find(event->stream);
+    if (it != event->self->streams.end()) {
+        it->second.remove_timeout_id = 0;
+        event->self->finish_stream_removal(event->stream, "timeout");
+    }
+    return G_SOURCE_REMOVE;
+}
+
+void Pipeline::finish_stream_removal(int stream, const char *reason) {
+    auto it = streams.find(stream);
+    if (it == streams.end()) {
+        return;
+    }
+    StreamBranch &branch = it->second;
+    gint64 start_us = g_get_monotonic_time();
+
+    if (branch.remove_timeout_id) {
+        g_source_remove(branch.remove_timeout_id);
+        branch.remove_timeout_id = 0;
+    }
+
+    // releasing the batcher pad also wakes a front-end blocked on it
+    if (branch.unbatcher_pad) {
+        GstPad *sink = gst_element_get_static_pad(branch.bin, "sink");
+        if (sink) {
+            gst_pad_unlink(branch.unbatcher_pad, sink);
+            gst_object_unref(sink);
+        }
+        gst_element_release_request_pad(unbatcher, branch.unbatcher_pad);
+        gst_object_unref(branch.unbatcher_pad);
+        branch.unbatcher_pad = nullptr;
+    }
+    if (branch.batcher_pad) {
+        GstPad *src = gst_element_get_static_pad(branch.bin, "src");
+        if (src) {
+            gst_pad_unlink(src, branch.batcher_pad);
+            gst_object_unref(src);
+        }
+        gst_element_release_request_pad(batcher, branch.batcher_pad);
+        gst_object_unref(branch.batcher_pad);
+        branch.batcher_pad = nullptr;
+    }
+
+    gst_element_set_state(branch.bin, GST_STATE_NULL);
+    gst_bin_remove(GST_BIN(pipeline), branch.bin);
+    gint64 end_us = g_get_monotonic_time();
+
+    json report = { { "event", "stream-removed" }, { "stream", stream }, { "url", branch.url },
+                    { "reason", reason }, { "teardown_ms", elapsed_ms(start_us, end_us) } };
+    if (branch.remove_us) {
+        report["total_ms"] = elapsed_ms(branch.remove_us, end_us);
+        if (branch.front_eos_us) {
+            report["front_eos_ms"] = elapsed_ms(branch.remove_us, branch.front_eos_us);
+        }
+    }
+
+    streams.erase(it);
+    publish_report("Stream control", report);
+}
+
+int Pipeline::find_stream(GstObject *object) {
+    for (GstObject *parent = object; parent; parent = GST_OBJECT_PARENT(parent)) {
+        for (auto &[ index, branch ] : streams) {
+            if (parent == GST_OBJECT(branch.bin)) {
+                return index;
+            }
+        }
+    }
+    return -1;
+}
+
+void Pipeline::handle_stream_command(const json& message, const std::string& command) {
+    json report = { { "event", command } };
+
+    if (!multi_stream) {
+        report["error"] = "gst_app is not in multi-stream mode";
+    } else if (command == "add-stream") {
+        std::string url = message.value("url", "");
+        std::string host = message.value("host", "");
+        std::string port;
+        if (message.contains("port")) {
+            port = message["port"].is_string() ? message["port"].get<std::string>() : message["port"].dump();
+        }
+        if (url.empty()) {
+            report["error"] = "'url' parameter not found";
+        } else {
+            add_stream(url, host, port, report);
+        }
+    } else {
+        int stream = message.value("stream", -1);
+        remove_stream(stream, report);
+    }
+
+    publish_report("Stream control", report);
+}
+
+void Pipeline::publish_report(const char *label, const json& report) {
+    json message = report;
+    message["pipeline_id"] = pipeline_name;
+    message["pid"] = gstAppPid;
+    message["status"] = report.contains("error") ? "error" : "ok";
+
+    std::cout << label << ": " << message.dump() << std::endl;
+    simaailog(message.contains("error") ? SIMAAILOG_ERR : SIMAAILOG_INFO,
+              "PipelineId: [%s] %s: %s", pipeline_name.c_str(), label, message.dump().c_str());
+
+    if (client) {
+        std::stringstream topic;
+        topic << SIMAAI_MQTT_KPI_RES_TOPIC << "/" << gstAppPid;
+        client->publish(topic.str(), message);
+        update_mqtt_watch();
+    }
 }
 
 void Pipeline::handle_callback( const struct mosquitto_message *message) {
@@ -354,7 +1020,10 @@ void Pipeline::handle_callback( const struct mosquitto_message *message) {
     std::cout << "JSON Message ProcessId: " << jsonMsgPid << std::endl;
     std::cout << "JSON Message Command: " << jsonMsgCmd << std::endl;
 
-    if(jsonMessage["pipeline_id"] == pipeline_name && jsonMsgPid == gstAppPid) {
+    if(jsonMessage["pipeline_id"] == pipeline_name && jsonMsgPid == gstAppPid &&
+       (jsonMsgCmd == "add-stream" || jsonMsgCmd == "remove-stream")) {
+        handle_stream_command(jsonMessage, jsonMsgCmd);
+    } else if(jsonMessage["pipeline_id"] == pipeline_name && jsonMsgPid == gstAppPid) {
         gboolean property_value = jsonMessage["command"] == "start-kpis";
         set_transmit_property(property_value);
         std::cout << "Set transmit parameter value to '" << property_value << "'" << std::endl;
@@ -371,13 +1040,18 @@ void Pipeline::mqtt_callback(struct mosquitto *mosq, void * obj,  const struct m
     }
 }
 
-void Pipeline::set_property(const char *name, gboolean value) {
+void Pipeline::set_property(const char *name, gboolean value, GstElement *root) {
     if (!GST_IS_PIPELINE(pipeline)) {
         std::cerr << "The provided GstElement is not a pipeline." << std::endl;
         return;
     }
 
-    GstIterator *iter = gst_bin_iterate_elements(GST_BIN(pipeline));
+    if (!root) {
+        root = pipeline;
+    }
+
+    // stream bins of multi-stream mode are walked too, not the internals of other bins
+    GstIterator *iter = gst_bin_iterate_recurse(GST_BIN(root));
     GValue item = G_VALUE_INIT;
     gboolean done = FALSE;
     GError *err = NULL;
@@ -388,6 +1062,10 @@ void Pipeline::set_property(const char *name, gboolean value) {
                 GstElement *element = GST_ELEMENT(g_value_get_object(&item));
                 GParamSpec *property = g_object_class_find_property(G_OBJECT_GET_CLASS(element), name);
 
+                if (!is_app_element(root, element)) {
+                    property = nullptr;
+                }
+
                 if (property && G_IS_PARAM_SPEC_BOOLEAN(property)) {
                     g_object_set(element, name, value, NULL);
                     std::cout << "Set '" << name << "' property to " << (value ? "TRUE" : "FALSE") << " for element: " << GST_ELEMENT_NAME(element) << std::endl;
@@ -420,6 +1098,7 @@ void Pipeline::set_property(const char *name, gboolean value) {
 }
 
 void Pipeline::set_transmit_property(gboolean transmit_value) {
+    this->transmit_value = transmit_value;
     set_property("transmit", transmit_value);
 }
 
@@ -528,14 +1207,207 @@ void Pipeline::replace_configs() {
 }
 
 void Pipeline::process_gst_string() {
-    replace_json_tags();
-    replace_vector_tags();
-    replace_configs();
+    {
+        StartupProfiler::Scope phase(profiler, "replace_json_tags");
+        replace_json_tags();
+    }
+    // in multi-stream mode urls, ips and ports are set per stream by the composer
+    if (!multi_stream) {
+        StartupProfiler::Scope phase(profiler, "replace_vector_tags");
+        replace_vector_tags();
+    }
+    {
+        StartupProfiler::Scope phase(profiler, "replace_configs");
+        replace_configs();
+    }
+    if (multi_stream) {
+        StartupProfiler::Scope phase(profiler, "compose_multi_stream");
+        compose_multi_stream();
+    }
+    {
+        StartupProfiler::Scope phase(profiler, "prepare_warm_start");
+        prepare_warm_start();
+    }
     std::cout << "\n\n Finall GST string: \n" << this->gst_string << std::endl;
 }
 
-void Pipeline::start_pipeline(){
-    //TODO: Move this to a function, check status after playing and communate back to the PH
-    gst_element_set_state(pipeline, GST_STATE_PLAYING); 
+/// @brief String property defaults of a factory, used to follow renamed buffer names
+static std::vector<std::pair<std::string, std::string>> factory_string_defaults(const std::string& name) {
+    std::vector<std::pair<std::string, std::string>> defaults;
+
+    GstElementFactory *factory = gst_element_factory_find(name.c_str());
+    if (!factory) {
+        return defaults;
+    }
+
+    GstPluginFeature *loaded = gst_plugin_feature_load(GST_PLUGIN_FEATURE(factory));
+    gst_object_unref(factory);
+    if (!loaded) {
+        return defaults;
+    }
+
+    gpointer klass = g_type_class_ref(gst_element_factory_get_element_type(GST_ELEMENT_FACTORY(loaded)));
+    guint n_specs = 0;
+    GParamSpec **specs = g_object_class_list_properties(G_OBJECT_CLASS(klass), &n_specs);
+    for (guint i = 0; i < n_specs; i++) {
+        if (G_IS_PARAM_SPEC_STRING(specs[i])) {
+            const gchar *value = G_PARAM_SPEC_STRING(specs[i])->default_value;
+            if (value) {
+                defaults.emplace_back(g_param_spec_get_name(specs[i]), value);
+            }
+        }
+    }
+
+    g_free(specs);
+    g_type_class_unref(klass);
+    gst_object_unref(loaded);
+    return defaults;
+}
+
+/// @brief Replaces string values of json that are in renames, returns true if any
+static bool rename_json_strings(json &node, const std::map<std::string, std::string>& renames) {
+    bool changed = false;
+
+    if (node.is_string()) {
+        auto it = renames.find(node.get<std::string>());
+        if (it != renames.end()) {
+            node = it->second;
+            changed = true;
+        }
+    } else if (node.is_structured()) {
+        for (auto &child : node) {
+            changed |= rename_json_strings(child, renames);
+        }
+    }
+    return changed;
+}
+
+std::string Pipeline::write_stream_config(const std::string& config_path, int stream,
+                                          const std::map<std::string, std::string>& renames) {
+    json config;
+    try {
+        std::ifstream ifs(config_path);
+        config = json::parse(ifs);
+    }
+    catch (...) {
+        std::cerr << "Cannot read config " << config_path << ", used unchanged for stream " << stream << std::endl;
+        simaailog(SIMAAILOG_ERR, "PipelineId: [%s] Cannot read config %s for stream %d", pipeline_name.c_str(), config_path.c_str(), stream);
+        return config_path;
+    }
+
+    // input buffers of a config are named after the element producing them
+    if (!rename_json_strings(config, renames)) {
+        return config_path;
+    }
+
+    // keep the file name, KPI plugin mapping is done by config name
+    std::filesystem::path stream_path(multi_stream_dir);
+    stream_path /= "stream_" + std::to_string(stream);
+    std::filesystem::create_directories(stream_path);
+    stream_path /= parser.parse_json_name(config_path);
+
+    std::ofstream ofs(stream_path);
+    ofs << config.dump(2);
+    if (!ofs) {
+        std::cerr << "Cannot write config " << stream_path << std::endl;
+        simaailog(SIMAAILOG_ERR, "PipelineId: [%s] Cannot write config %s", pipeline_name.c_str(), stream_path.c_str());
+        exit(-1);
+    }
+    return stream_path.string();
+}
+
+void Pipeline::compose_multi_stream() {
+    if (rtsp_urls.empty()) {
+        std::cerr << "Multi-stream mode needs RTSP urls, one per stream" << std::endl;
+        simaailog(SIMAAILOG_ERR, "PipelineId: [%s] Multi-stream mode without RTSP urls", pipeline_name.c_str());
+        exit(-1);
+    }
+
+    composer = std::make_unique<MultiStreamComposer>(gst_string);
+    if (!composer->valid()) {
+        std::cerr << "Multi-stream mode needs a simaaiprocessmla fed by a per stream front-end" << std::endl;
+        simaailog(SIMAAILOG_ERR, "PipelineId: [%s] No simaaiprocessmla to share between streams", pipeline_name.c_str());
+        exit(-1);
+    }
+
+    // batcher fills the batch the shared model runs, batch_size of its config
+    int batch_size = 1;
+    std::string mla_config = composer->shared_mla_config();
+    if (!mla_config.empty()) {
+        try {
+            std::ifstream ifs(mla_config);
+            json config = json::parse(ifs);
+            batch_size = config["simaai__params"].value("batch_size", 1);
+        }
+        catch (...) {
+            std::cerr << "Cannot read batch_size from " << mla_config << ", using 1" << std::endl;
+        }
+    }
+
+    multi_stream_dir = (std::filesystem::path(g_get_tmp_dir()) /
+                        ("gst_app_" + pipeline_name + "_" + std::to_string(gstAppPid))).string();
+
+    composer->set_property_defaults(factory_string_defaults);
+    composer->set_config_rewriter([this](const std::string& config_path, int stream,
+                                        const std::map<std::string, std::string>& renames) {
+        return write_stream_config(config_path, stream, renames);
+    });
+
+    // streams are added as bins by pipeline_driver(), see add_stream()
+    gst_string = composer->compose_shared(batch_size);
+
+    std::stringstream ss;
+    ss << "Multi-stream mode: " << rtsp_urls.size() << " streams, batch size " << batch_size;
+    std::cout << ss.str() << std::endl;
+    simaailog(SIMAAILOG_INFO, "PipelineId: [%s] %s", pipeline_name.c_str(), ss.str().c_str());
+}
+
+void Pipeline::prepare_warm_start() {
+    // streams are added as bins, they report their own first result
+    if (multi_stream) {
+        if (warm_start_frames > 0) {
+            std::cerr << "Warm start is not supported in multi-stream mode, running without" << std::endl;
+            warm_start_frames = 0;
+        }
+        return;
+    }
+
+    if (warm_start_frames == 0) {
+        // time to first result is still reported
+        warm_start_attach = WarmStart::find_attach_name(gst_string);
+        return;
+    }
+
+    std::string new_gst_string = WarmStart::insert_selector(gst_string, warm_start_attach);
+    if (new_gst_string.empty()) {
+        std::cerr << "Warm start needs a named " << WARM_START_ATTACH_FACTORY << ", running without" << std::endl;
+        simaailog(SIMAAILOG_WARNING, "PipelineId: [%s] No named %s for warm start", pipeline_name.c_str(), WARM_START_ATTACH_FACTORY);
+        warm_start_frames = 0;
+        warm_start_attach = WarmStart::find_attach_name(gst_string);
+        return;
+    }
+    gst_string = new_gst_string;
+}
+
+bool Pipeline::ready_pipeline(){
+    // model load, config parsing and pool preallocation of elements overlap
+    std::string ready_error;
+    if (!profiler.set_ready(pipeline, init_threads, ready_error)) {
+        std::cerr << "Error bringing pipeline to READY: " << ready_error << std::endl;
+        simaailog(SIMAAILOG_ERR, "PipelineId: [%s] Error bringing pipeline to READY: %s", pipeline_name.c_str(), ready_error.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Pipeline::start_pipeline(){
+    if (!ready_pipeline()) {
+        return false;
+    }
+
+    //TODO: check status after playing and communate back to the PH
+    profiler.set_state(pipeline, GST_STATE_PLAYING, "playing");
     terminate = FALSE;
+    publish_report("Startup", profiler.report());
+    return true;
 }
@@ -10,22 +10,24 @@
 
 #include <lttng_session.h>
 #include <future>
+#include <memory>
+#include <multi_stream.h>
+#include <startup_profiler.h>
+#include <warm_start.h>
+#include <cmdline_utils.h>
 
 using json = nlohmann::json;
 
 /// @brief pipeline class
 class Pipeline {
     public: 
-        Pipeline(const std::string& manifest_json_path, 
-                const std::string& gst_string,
-                const std::vector<std::string>& rtsp_urls_vec,
-                const std::vector<std::string>& host_ips_vec,
-                const std::vector<std::string>& host_ports_vec,
-                json &gst_replacement_json,
-                bool enable_lttng_param);
+        explicit Pipeline(const utils::CmdLineOptions& options);
         ~Pipeline();
-        /// @brief This function will orchestrate the loginc of building and running the pipeline
+        /// @brief This function will orchestrate the loginc of building and running the pipeline.
+        ///        Bus messages, MQTT traffic, signals and timers are served by one
+        ///        GMainLoop, which sleeps while there is nothing to do.
         void pipeline_driver();
+        /// @brief Stops the driver loop, safe to call from any thread
         void terminate_pipeline();
     private:
         enum
@@ -34,10 +36,35 @@ class Pipeline {
             LAST_SIGNAL
         };
 
+        /// @brief Bin of one stream in multi-stream mode, linked to batcher and unbatcher
+        struct StreamBranch {
+            GstElement *bin = nullptr;
+            std::string url;
+            /// @brief Requested batcher `sink_N` and unbatcher `src_N`, null without back-end
+            GstPad *batcher_pad = nullptr;
+            GstPad *unbatcher_pad = nullptr;
+            /// @brief Monotonic time of add, of remove request and of front-end EOS, 0 if none
+            gint64 added_us = 0, remove_us = 0, front_eos_us = 0;
+            guint remove_timeout_id = 0;
+        };
+
+        /// @brief Event of a stream posted from a streaming thread to the driver loop
+        struct StreamEvent {
+            Pipeline *self;
+            int stream;
+            gint64 time_us;
+        };
+
+        /// @brief Unix signal served by the driver loop
+        struct SignalWatch {
+            Pipeline *self;
+            int signum;
+            guint id;
+        };
+
         // data members
         GstElement *pipeline=nullptr;
         GstBus *bus=nullptr;
-        GstMessage *msg = nullptr;
         gboolean terminate;
         GError *error = nullptr;
         gchar *debug_info = nullptr;
@@ -60,9 +87,51 @@ class Pipeline {
         pid_t gstAppPid;
         int transmit_plugin_count = 0;
         bool enable_lttng;
+        /// @brief One front-end and back-end per RTSP url around shared MLA and postprocess
+        bool multi_stream = false;
+        /// @brief Per stream configs written for multi-stream mode, removed on exit
+        std::string multi_stream_dir;
+        std::unique_ptr<MultiStreamComposer> composer;
+        GstElement *batcher = nullptr, *unbatcher = nullptr;
+        std::map<int, StreamBranch> streams;
+        int next_stream = 0;
+        /// @brief Last value set to `transmit`, applied to streams added later
+        gboolean transmit_value = FALSE;
+        /// @brief Synthetic frames to preroll inference with, 0 disables warm start
+        int warm_start_frames = 0;
+        /// @brief Decoder the synthetic frames are injected after, empty if none
+        std::string warm_start_attach;
+        std::unique_ptr<WarmStart> warm_start;
+        /// @brief Monotonic time the driver started, time to first result is measured from
+        gint64 driver_start_us = 0;
+        /// @brief Phases from construction to PLAYING, and element init times
+        StartupProfiler profiler;
+        /// @brief Threads elements are brought to READY on, 1 is serial
+        unsigned init_threads = 1;
+        /// @brief Stand-in dispatchers run no jobs, the pipeline is brought to READY and left
+        bool dry_startup = false;
+
+        // driver loop
+        GMainLoop *loop = nullptr;
+        guint bus_watch_id = 0;
+        guint mqtt_watch_id = 0;
+        int mqtt_watch_fd = -1;
+        GIOCondition mqtt_watch_condition = (GIOCondition)0;
+        guint mqtt_timer_id = 0;
+        SignalWatch signal_watches[4] = {};
+        /// @brief Interval of driver CPU time reports in seconds, 0 disables them
+        int measure_cpu_interval = 0;
+        guint cpu_timer_id = 0;
+        /// @brief Driver thread CPU and monotonic time in us, at loop start and last report
+        gint64 cpu_start_us = 0, cpu_last_us = 0, wall_start_us = 0, wall_last_us = 0;
+        /// @brief Callbacks dispatched by the driver loop, wakeups doing work
+        guint64 loop_dispatches = 0, loop_dispatches_last = 0;
 
         // private member functions
-        void start_pipeline();
+        /// @brief Brings elements to READY in parallel, see StartupProfiler
+        bool ready_pipeline();
+        /// @brief Sets the pipeline to PLAYING and reports the startup profile
+        bool start_pipeline();
         /// @brief Performs all replacements in gst string
         void process_gst_string();
         /// @brief Replaces all `tags` to `replacements` described in `gst_replacement_json`
@@ -74,6 +143,13 @@ class Pipeline {
         ///        sets config property if it is not provided in gst-string 
         /// @return true on success, false if gst-string is not valid
         void replace_configs();
+        /// @brief Rebuilds gst string for one stream per RTSP url, see MultiStreamComposer
+        void compose_multi_stream();
+        /// @brief Puts the warm start source after the decoder, see WarmStart
+        void prepare_warm_start();
+        /// @brief Writes config of stream with renamed buffer names, returns path to use
+        std::string write_stream_config(const std::string& config_path, int stream,
+                                        const std::map<std::string, std::string>& renames);
         gboolean buildPipeline();
         void parse_pipeline(); // create a map from json pluginId to gstId
         void initBus();
@@ -81,10 +157,43 @@ class Pipeline {
         static void mqtt_callback(struct mosquitto *mosq, void * obj,  const struct mosquitto_message *message);
         void handle_callback( const struct mosquitto_message *message);
         //TODO: This should be generalized, take 2 params: property, and the value to be set.
-        void set_property(const char *name, gboolean value);
+        void set_property(const char *name, gboolean value, GstElement *root = nullptr);
         void set_transmit_property(gboolean transmit_value);
         void init_signals();
 
+        // driver loop sources
+        void add_loop_sources();
+        void remove_loop_sources();
+        static gboolean bus_callback(GstBus *gst_bus, GstMessage *message, gpointer data);
+        void handle_bus_message(GstMessage *message);
+        static gboolean signal_callback(gpointer data);
+        static gboolean mqtt_io_callback(gint fd, GIOCondition condition, gpointer data);
+        static gboolean mqtt_timer_callback(gpointer data);
+        /// @brief Watches the MQTT socket for reading, and writing while data is queued
+        void update_mqtt_watch();
+        static gboolean cpu_timer_callback(gpointer data);
+        /// @brief Prints driver CPU time since last report, and since loop start if final
+        void report_cpu(bool final);
+
+        // runtime stream control in multi-stream mode, on the driver loop
+        /// @brief Builds, links and starts the bin of a new stream
+        /// @return stream index, -1 on failure. Timings are added to report
+        int add_stream(const std::string& url, const std::string& host_ip,
+                       const std::string& host_port, json& report);
+        /// @brief Starts removal of a stream: EOS is sent from its sources, the
+        ///        bin is dropped once it drained or STREAM_REMOVE_TIMEOUT_MS passed
+        bool remove_stream(int stream, json& report);
+        void stream_front_eos(int stream, gint64 time_us);
+        void finish_stream_removal(int stream, const char *reason);
+        /// @return stream of the bin holding object, -1 if none
+        int find_stream(GstObject *object);
+        void handle_stream_command(const json& message, const std::string& command);
+        /// @brief Prints a report and publishes it on the MQTT response topic
+        void publish_report(const char *label, const json& report);
+        static GstPadProbeReturn stream_first_result_probe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+        static GstPadProbeReturn stream_front_eos_probe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+        static gboolean stream_remove_timeout(gpointer data);
+
 };
 
 #endif // PIPELINE_H
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include <startup_profiler.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+static double elapsed_ms(gint64 from_us, gint64 to_us) {
+    return (to_us - from_us) / 1000.0;
+}
+
+StartupProfiler::Scope::Scope(StartupProfiler& profiler, const std::string& name)
+    : profiler(profiler), name(name), begin_us(g_get_monotonic_time()) {
+}
+
+StartupProfiler::Scope::~Scope() {
+    profiler.add_phase(name, begin_us, g_get_monotonic_time());
+}
+
+StartupProfiler::StartupProfiler() : start_us(g_get_monotonic_time()) {
+}
+
+void StartupProfiler::add_phase(const std::string& name, gint64 begin_us, gint64 end_us) {
+    std::lock_guard<std::mutex> lock(mtx);
+    phases.push_back({ name, begin_us, end_us });
+}
+
+StartupProfiler::Element& StartupProfiler::element(GstElement *gst_element) {
+    std::string name = GST_OBJECT_NAME(gst_element);
+    auto it = elements.find(name);
+    if (it != elements.end()) {
+        return it->second;
+    }
+
+    GstElementFactory *factory = gst_element_get_factory(gst_element);
+    Element& entry = elements[name];
+    entry.factory = factory ? GST_OBJECT_NAME(factory) : "";
+    order.push_back(name);
+    return entry;
+}
+
+bool StartupProfiler::set_ready(GstElement *pipeline, unsigned threads, std::string& error) {
+    gint64 begin_us = g_get_monotonic_time();
+
+    // bins only forward to their children, they are set once those are READY
+    std::vector<GstElement *> children;
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN(pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+        GstElement *child = GST_ELEMENT(g_value_get_object(&item));
+        if (!GST_IS_BIN(child) && !gst_element_is_locked_state(child)) {
+            children.push_back(GST_ELEMENT(gst_object_ref(child)));
+        }
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+
+    // iterator returns the children added last first, gst_parse_launch adds in string order
+    std::reverse(children.begin(), children.end());
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (GstElement *child : children) {
+            element(child);
+        }
+    }
+
+    ready_threads = std::max(1u, std::min<unsigned>(threads, children.size()));
+    std::vector<GstStateChangeReturn> results(children.size(), GST_STATE_CHANGE_FAILURE);
+    std::vector<gint64> ready_us(children.size(), 0), ready_at_us(children.size(), 0);
+    std::atomic<size_t> next { 0 };
+
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next++) < children.size()) {
+            gint64 t0 = g_get_monotonic_time();
+            results[i] = gst_element_set_state(children[i], GST_STATE_READY);
+            ready_at_us[i] = g_get_monotonic_time();
+            ready_us[i] = ready_at_us[i] - t0;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < ready_threads; t++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    bool ok = true;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (size_t i = 0; i < children.size(); i++) {
+            Element& entry = element(children[i]);
+            entry.ready_us = ready_us[i];
+            entry.ready_at_us = ready_at_us[i];
+            if (results[i] == GST_STATE_CHANGE_FAILURE && ok) {
+                error = std::string("Element ") + GST_OBJECT_NAME(children[i]) + " failed to reach READY";
+                ok = false;
+            }
+        }
+    }
+
+    for (GstElement *child : children) {
+        gst_object_unref(child);
+    }
+
+    if (ok && gst_element_set_state(pipeline, GST_STATE_READY) == GST_STATE_CHANGE_FAILURE) {
+        error = "Pipeline failed to reach READY";
+        ok = false;
+    }
+
+    add_phase("ready", begin_us, g_get_monotonic_time());
+    return ok;
+}
+
+GstStateChangeReturn StartupProfiler::set_state(GstElement *pipeline, GstState state, const std::string& phase) {
+    Scope scope(*this, phase);
+
+    // state changes are posted from the thread setting the state, ones that
+    // complete asynchronously after the call are not timed
+    GstBus *bus = gst_element_get_bus(pipeline);
+    gst_bus_set_sync_handler(bus, sync_handler, this, nullptr);
+    GstStateChangeReturn ret = gst_element_set_state(pipeline, state);
+    gst_bus_set_sync_handler(bus, nullptr, nullptr, nullptr);
+    gst_object_unref(bus);
+
+    return ret;
+}
+
+GstBusSyncReply StartupProfiler::sync_handler(GstBus *bus, GstMessage *message, gpointer data) {
+    StartupProfiler *self = static_cast<StartupProfiler *>(data);
+
+    if (GST_MESSAGE_TYPE(message) != GST_MESSAGE_STATE_CHANGED || !GST_IS_ELEMENT(GST_MESSAGE_SRC(message)) ||
+        GST_IS_BIN(GST_MESSAGE_SRC(message))) {
+        return GST_BUS_PASS;
+    }
+
+    GstState new_state;
+    gst_message_parse_state_changed(message, nullptr, &new_state, nullptr);
+    gint64 now_us = g_get_monotonic_time();
+
+    std::lock_guard<std::mutex> lock(self->mtx);
+    Element& entry = self->element(GST_ELEMENT(GST_MESSAGE_SRC(message)));
+    if (new_state == GST_STATE_PAUSED && !entry.paused_at_us) {
+        entry.paused_at_us = now_us;
+    } else if (new_state == GST_STATE_PLAYING && !entry.playing_at_us) {
+        entry.playing_at_us = now_us;
+    }
+    return GST_BUS_PASS;
+}
+
+json StartupProfiler::report() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    json report;
+    gint64 end_us = start_us;
+
+    report["phases"] = json::array();
+    for (auto& phase : phases) {
+        report["phases"].push_back({ { "name", phase.name },
+                                     { "start_ms", elapsed_ms(start_us, phase.begin_us) },
+                                     { "ms", elapsed_ms(phase.begin_us, phase.end_us) } });
+        end_us = std::max(end_us, phase.end_us);
+    }
+    report["total_ms"] = elapsed_ms(start_us, end_us);
+
+    // serial_ms against the ready phase shows what running in parallel saved
+    gint64 serial_us = 0, slowest_us = -1;
+    std::string slowest;
+    report["elements"] = json::array();
+    for (auto& name : order) {
+        const Element& entry = elements.at(name);
+        json element = { { "name", name }, { "factory", entry.factory } };
+        if (entry.ready_at_us) {
+            element["ready_ms"] = entry.ready_us / 1000.0;
+            element["ready_at_ms"] = elapsed_ms(start_us, entry.ready_at_us);
+            serial_us += entry.ready_us;
+            if (entry.ready_us > slowest_us) {
+                slowest_us = entry.ready_us;
+                slowest = name;
+            }
+        }
+        if (entry.paused_at_us) {
+            element["paused_at_ms"] = elapsed_ms(start_us, entry.paused_at_us);
+        }
+        if (entry.playing_at_us) {
+            element["playing_at_ms"] = elapsed_ms(start_us, entry.playing_at_us);
+        }
+        report["elements"].push_back(element);
+    }
+
+    if (ready_threads) {
+        report["ready"] = { { "threads", ready_threads },
+                            { "serial_ms", serial_us / 1000.0 },
+                            { "slowest", slowest } };
+    }
+    return report;
+}
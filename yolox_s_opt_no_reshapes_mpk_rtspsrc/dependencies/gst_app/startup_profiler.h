@@ -0,0 +1,70 @@
+#ifndef STARTUP_PROFILER_H
+#define STARTUP_PROFILER_H
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <gst/gst.h>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/// @brief Startup phases and element initialization times of a pipeline.
+///
+/// Elements are brought to READY in parallel, so model load, config parsing
+/// and pool preallocation of independent elements overlap. READY to PLAYING
+/// is left to the pipeline, in order, since elements push events downstream
+/// on READY to PAUSED. Times are monotonic, reported relative to the
+/// profiler start.
+class StartupProfiler {
+    public:
+        /// @brief Times a phase from construction to destruction
+        class Scope {
+            public:
+                Scope(StartupProfiler& profiler, const std::string& name);
+                ~Scope();
+            private:
+                StartupProfiler& profiler;
+                std::string name;
+                gint64 begin_us;
+        };
+
+        StartupProfiler();
+
+        void add_phase(const std::string& name, gint64 begin_us, gint64 end_us);
+        /// @brief Brings every element of pipeline to READY on up to threads
+        ///        threads, then the bins
+        /// @return false with error set if an element failed
+        bool set_ready(GstElement *pipeline, unsigned threads, std::string& error);
+        /// @brief Sets state of pipeline as one phase, with the time each
+        ///        element reached PAUSED and PLAYING
+        GstStateChangeReturn set_state(GstElement *pipeline, GstState state, const std::string& phase);
+        json report() const;
+
+    private:
+        struct Phase {
+            std::string name;
+            gint64 begin_us, end_us;
+        };
+
+        struct Element {
+            std::string factory;
+            /// @brief Duration of NULL to READY, and time READY was reached, 0 if not timed
+            gint64 ready_us = 0, ready_at_us = 0;
+            /// @brief Time PAUSED and PLAYING were reached, 0 if not seen
+            gint64 paused_at_us = 0, playing_at_us = 0;
+        };
+
+        gint64 start_us;
+        unsigned ready_threads = 0;
+        std::vector<Phase> phases;
+        mutable std::mutex mtx;
+        /// @brief Elements in pipeline order
+        std::vector<std::string> order;
+        std::map<std::string, Element> elements;
+
+        Element& element(GstElement *gst_element);
+        static GstBusSyncReply sync_handler(GstBus *bus, GstMessage *message, gpointer data);
+};
+
+#endif // STARTUP_PROFILER_H
@@ -7,18 +7,15 @@
 
 int main(int argc, char *argv[]){
 
-    std::string gst_string, manifest_json_path;
-    std::vector<std::string> rtsp_urls, host_ips, host_ports;
-    json gst_replacement_json;
-    bool enable_lttng;
+    utils::CmdLineOptions options;
 
-    utils::CmdLineUtils::parse_cmdline_args(argc, argv, manifest_json_path, gst_string, rtsp_urls, host_ips, host_ports, gst_replacement_json, enable_lttng);
+    utils::CmdLineUtils::parse_cmdline_args(argc, argv, options);
 
-    if(! utils::CmdLineUtils::check_required_params(manifest_json_path, gst_string)){
+    if(! utils::CmdLineUtils::check_required_params(options.manifest_json_path, options.gst_string)){
         return 1;
     }
 
-    utils::CmdLineUtils::print_parsed_values(gst_string, manifest_json_path, rtsp_urls, host_ips, host_ports, gst_replacement_json, enable_lttng);
+    utils::CmdLineUtils::print_parsed_values(options);
 
     exit(0);
 
@@ -0,0 +1,50 @@
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <gst/gst.h>
+#include <multi_stream.h>
+#include <string_utils.h>
+
+int main(int argc, char *argv[]){
+    std::string gst_string;
+    std::vector<std::string> rtsp_urls;
+    gst_init(nullptr, nullptr);
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --gst-string=<gst string> --rtsp-url=\"url1 url2\"" << std::endl;
+        return -1;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--gst-string=", 13) == 0) {
+            gst_string = argv[i] + 13;
+        }
+        else if (std::strncmp(argv[i], "--rtsp-url=", 11) == 0) {
+            rtsp_urls = utils::StringUtils::split(argv[i] + 11, ' ');
+        }
+        else {
+            std::cout << "Args have not been passed properly, please check usage." << std::endl;
+        }
+    }
+
+    gst_string = utils::StringUtils::remove_single_quotes(gst_string);
+    MultiStreamComposer composer(gst_string);
+    if (!composer.valid()) {
+        std::cerr << "No simaaiprocessmla fed by a front-end in gst-string" << std::endl;
+        return -1;
+    }
+
+    std::string multi_gst_string = composer.compose(rtsp_urls, {}, {}, 1);
+    std::cout << "Multi-stream gst-string: " << multi_gst_string << std::endl;
+
+    GError *error = nullptr;
+    GstElement *pipeline = gst_parse_launch(multi_gst_string.c_str(), &error);
+    if (error) {
+        std::cerr << "Error: " << error->message << std::endl;
+        g_clear_error(&error);
+        return -1;
+    }
+    std::cout << "Pipeline created successfully." << std::endl;
+    gst_object_unref(pipeline);
+    return 0;
+}
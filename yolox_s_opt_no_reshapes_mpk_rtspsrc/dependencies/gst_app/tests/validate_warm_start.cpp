@@ -0,0 +1,61 @@
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <gst/gst.h>
+#include <warm_start.h>
+#include <string_utils.h>
+
+int main(int argc, char *argv[]){
+    std::string gst_string;
+    gst_init(nullptr, nullptr);
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " --gst-string=<gst string>" << std::endl;
+        return -1;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--gst-string=", 13) == 0) {
+            gst_string = argv[i] + 13;
+        }
+        else {
+            std::cout << "Args have not been passed properly, please check usage." << std::endl;
+        }
+    }
+
+    gst_string = utils::StringUtils::remove_single_quotes(gst_string);
+    std::string attach_name;
+    std::string warm_gst_string = WarmStart::insert_selector(gst_string, attach_name);
+    if (warm_gst_string.empty()) {
+        std::cerr << "No named " << WARM_START_ATTACH_FACTORY << " in gst-string" << std::endl;
+        return -1;
+    }
+    std::cout << "Warm start after: " << attach_name << std::endl;
+    std::cout << "Warm start gst-string: " << warm_gst_string << std::endl;
+
+    GError *error = nullptr;
+    GstElement *pipeline = gst_parse_launch(warm_gst_string.c_str(), &error);
+    if (error) {
+        std::cerr << "Error: " << error->message << std::endl;
+        g_clear_error(&error);
+        return -1;
+    }
+
+    // the synthetic and the live branch must both reach the selector
+    GstElement *selector = gst_bin_get_by_name(GST_BIN(pipeline), WARM_START_SELECTOR_NAME);
+    int ret = 0;
+    for (const char *name : { "sink_0", "sink_1" }) {
+        GstPad *pad = selector ? gst_element_get_static_pad(selector, name) : nullptr;
+        if (!pad || !gst_pad_is_linked(pad)) {
+            std::cerr << "Selector pad " << name << " is not linked" << std::endl;
+            ret = -1;
+        }
+        if (pad) gst_object_unref(pad);
+    }
+    if (selector) gst_object_unref(selector);
+
+    if (ret == 0) {
+        std::cout << "Pipeline created successfully." << std::endl;
+    }
+    gst_object_unref(pipeline);
+    return ret;
+}
@@ -7,18 +7,30 @@ using json = nlohmann::json;
 
 namespace utils {
 
+/// @brief Values of the command line options, defaults for options not given
+struct CmdLineOptions {
+    std::string manifest_json_path;
+    std::string gst_string;
+    std::vector<std::string> rtsp_urls;
+    std::vector<std::string> host_ips;
+    std::vector<std::string> host_ports;
+    json gst_replacement_json;
+    bool enable_lttng = true;
+    /// @brief Seconds between CPU time reports, 0 disables them
+    int measure_cpu_interval = 0;
+    bool multi_stream = false;
+    /// @brief Synthetic frames to preroll inference with, 0 disables warm start
+    int warm_start_frames = 0;
+    /// @brief Threads bringing elements to READY, 0 is one per CPU
+    int init_threads = 0;
+    bool dry_startup = false;
+};
+
 namespace CmdLineUtils {
 
     void print_usage();
 
-    void parse_cmdline_args(int argc, char *argv[],
-                            std::string &manifest_json_path,
-                            std::string &gst_string,
-                            std::vector<std::string> &rtsp_urls,
-                            std::vector<std::string> &host_ips,
-                            std::vector<std::string> &host_ports,
-                            json &gst_replacement_json,
-                            bool &enable_lttng);
+    void parse_cmdline_args(int argc, char *argv[], CmdLineOptions &options);
 
     bool validate_required_parameters(const std::string &gst_string,
                                       const std::string &manifest_json_path);
@@ -28,13 +40,7 @@ namespace CmdLineUtils {
     bool check_required_params( const std::string &gst_string,
                                 const std::string &manifest_json_path);
 
-    void print_parsed_values( const std::string &gst_string,
-                              const std::string &manifest_json_path,
-                              const std::vector<std::string> &rtsp_urls,
-                              const std::vector<std::string> &host_ips,
-                              const std::vector<std::string> &host_ports,
-                              json &gst_replacement_json,
-                              bool enable_lttng);
+    void print_parsed_values(const CmdLineOptions &options);
 
 } // namespace CmdLineUtils
 } // namespace utils
@@ -2,6 +2,7 @@
 #include <getopt.h>
 #include <sstream>
 #include <vector>
+#include <cstdlib>
 #include <cmdline_utils.h>
 #include <string_utils.h>
 #include <nlohmann/json.hpp>
@@ -22,6 +23,11 @@ namespace CmdLineUtils {
                   << "  --host-port <ports>     \"port1 port2 port3\" Space-separated list of host port numbers (optional)\n"
                   << "  --gst_string_replacements <jsonStr> Gst string replacement json string (optional)\n"
                   << "  --disable-lttng         disable lttng-session creation and LTR starting\n"
+                  << "  --measure-cpu <sec>     Report CPU time of the control loop every <sec> seconds (optional)\n"
+                  << "  --multi-stream          Run one stream per RTSP URL with shared MLA and postprocess (optional)\n"
+                  << "  --warm-start <frames>   Preroll inference with up to <frames> synthetic frames before the live source (optional)\n"
+                  << "  --init-threads <n>      Bring elements to READY on <n> threads, 1 is serial. Default: one per CPU (optional)\n"
+                  << "  --dry-startup           Profile startup up to READY with stand-in dispatchers, then exit (optional)\n"
                   << std::endl;
     }
 
@@ -33,14 +39,7 @@ namespace CmdLineUtils {
         std::cout << "\n\n";
     }
 
-    void parse_cmdline_args(int argc, char *argv[],
-                            std::string &manifest_json_path,
-                            std::string &gst_string,
-                            std::vector<std::string> &rtsp_urls,
-                            std::vector<std::string> &host_ips,
-                            std::vector<std::string> &host_ports,
-                            json &gst_replacement_json,
-                            bool &enable_lttng)
+    void parse_cmdline_args(int argc, char *argv[], CmdLineOptions &options)
     {
 
         struct option cmdline_options[] = {
@@ -52,6 +51,11 @@ namespace CmdLineUtils {
             {"gst_string_replacements", required_argument, 0, 'a'},
             {"instance_id", required_argument, 0, 'n'},
             {"disable-lttng", no_argument, 0, 'l'},
+            {"measure-cpu", required_argument, 0, 'c'},
+            {"multi-stream", no_argument, 0, 's'},
+            {"warm-start", required_argument, 0, 'w'},
+            {"init-threads", required_argument, 0, 't'},
+            {"dry-startup", no_argument, 0, 'd'},
             {0,0,0,0}
         };
 
@@ -59,33 +63,63 @@ namespace CmdLineUtils {
         int option_index = 0;
         std::string instance_id;
 
-        while((opt = getopt_long(argc, argv, "m:g:r:i:p:a:n:",
+        while((opt = getopt_long(argc, argv, "m:g:r:i:p:a:n:c:w:t:",
                                  cmdline_options, &option_index)) != -1) {
             switch(opt) {
                 case 'm':
-                    manifest_json_path = optarg;
+                    options.manifest_json_path = optarg;
                     break;
                 case 'g':
-                    gst_string = optarg;
+                    options.gst_string = optarg;
                     break;
                 case 'r':
-                    rtsp_urls = utils::StringUtils::split(optarg, ' ');
+                    options.rtsp_urls = utils::StringUtils::split(optarg, ' ');
                     break;
                 case 'i':  
-                    host_ips = utils::StringUtils::split(optarg, ' ');
+                    options.host_ips = utils::StringUtils::split(optarg, ' ');
                     break;
                 case 'p':
-                    host_ports = utils::StringUtils::split(optarg, ' ');
+                    options.host_ports = utils::StringUtils::split(optarg, ' ');
                     break;
                 case 'a':
-                    gst_replacement_json = utils::StringUtils::string_to_json(optarg);
+                    options.gst_replacement_json = utils::StringUtils::string_to_json(optarg);
                     break;
                 case 'n':
                     instance_id = optarg;
                     std::cout << "Application Instance Id: " << instance_id << std::endl;
                     break;
                 case 'l':
-                    enable_lttng = false;
+                    options.enable_lttng = false;
+                    break;
+                case 'c':
+                    options.measure_cpu_interval = std::atoi(optarg);
+                    if (options.measure_cpu_interval <= 0) {
+                        std::cerr << "Error: --measure-cpu expects a positive number of seconds\n";
+                        print_usage();
+                        exit(1);
+                    }
+                    break;
+                case 's':
+                    options.multi_stream = true;
+                    break;
+                case 'w':
+                    options.warm_start_frames = std::atoi(optarg);
+                    if (options.warm_start_frames <= 0) {
+                        std::cerr << "Error: --warm-start expects a positive number of frames\n";
+                        print_usage();
+                        exit(1);
+                    }
+                    break;
+                case 't':
+                    options.init_threads = std::atoi(optarg);
+                    if (options.init_threads <= 0) {
+                        std::cerr << "Error: --init-threads expects a positive number of threads\n";
+                        print_usage();
+                        exit(1);
+                    }
+                    break;
+                case 'd':
+                    options.dry_startup = true;
                     break;
                 default:
                     print_usage();
@@ -107,39 +141,53 @@ namespace CmdLineUtils {
         return true;
     }
 
-    void print_parsed_values(const std::string &gst_string,
-                         const std::string &manifest_json_path,
-                         const std::vector<std::string> &rtsp_urls,
-                         const std::vector<std::string> &host_ips,
-                         const std::vector<std::string> &host_ports,
-                         json &gst_replacement_json,
-                         bool enable_lttng)
+    void print_parsed_values(const CmdLineOptions &options)
     {
 
-        std::cout << "gst-string: " << gst_string << std::endl;
-        std::cout << "manifest-json: " << manifest_json_path << std::endl;
+        std::cout << "gst-string: " << options.gst_string << std::endl;
+        std::cout << "manifest-json: " << options.manifest_json_path << std::endl;
 
-        if (!rtsp_urls.empty()) {
+        if (!options.rtsp_urls.empty()) {
             std::cout << "Rtsp URLs: \n";
-            print_vector(rtsp_urls);
+            print_vector(options.rtsp_urls);
         }
 
-        if (!host_ips.empty()) {
+        if (!options.host_ips.empty()) {
             std::cout << "Host IPs: \n";
-            print_vector(host_ips);
+            print_vector(options.host_ips);
         }
 
-        if (!host_ports.empty()) {
+        if (!options.host_ports.empty()) {
             std::cout << "Host Ports: \n";
-            print_vector(host_ports);
+            print_vector(options.host_ports);
         }
 
-        if (gst_replacement_json.size()){
-            std::cout << "Gst Replacement Json: " << gst_replacement_json 
+        if (options.gst_replacement_json.size()){
+            std::cout << "Gst Replacement Json: " << options.gst_replacement_json 
                       << std::endl;
         }
 
-        std::cout << "LTTNG enable: " << enable_lttng << std::endl;
+        std::cout << "LTTNG enable: " << options.enable_lttng << std::endl;
+
+        if (options.measure_cpu_interval > 0) {
+            std::cout << "Measure CPU interval: " << options.measure_cpu_interval << " s" << std::endl;
+        }
+
+        if (options.multi_stream) {
+            std::cout << "Multi-stream: " << options.rtsp_urls.size() << " streams" << std::endl;
+        }
+
+        if (options.warm_start_frames > 0) {
+            std::cout << "Warm start: up to " << options.warm_start_frames << " frames" << std::endl;
+        }
+
+        if (options.init_threads > 0) {
+            std::cout << "Init threads: " << options.init_threads << std::endl;
+        }
+
+        if (options.dry_startup) {
+            std::cout << "Dry startup: profile up to READY with stand-in dispatchers" << std::endl;
+        }
     }
 
 
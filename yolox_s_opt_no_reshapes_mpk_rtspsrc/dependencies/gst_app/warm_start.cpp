@@ -0,0 +1,575 @@
+#include <warm_start.h>
+#include <multi_stream.h>
+#include <cstring>
+#include <fstream>
+
+#include <gstsimaaiallocator.h>
+#include <gstsimaaibufferpool.h>
+#include <gstsimaaimeta.h>
+
+/// @brief Period of synthetic frames, also of the warm start checks
+#define WARM_START_FRAME_INTERVAL_MS 33
+/// @brief Time the last synthetic frame gets to reach every tracked element
+#define WARM_START_GRACE_MS 2000
+/// @brief Synthetic frames in flight at most
+#define WARM_START_POOL_SIZE 4
+
+static double elapsed_ms(gint64 from_us, gint64 to_us) {
+    return (to_us - from_us) / 1000.0;
+}
+
+static GstNode reference(const std::string& element, const std::string& pad) {
+    GstNode node;
+    node.kind = GstNode::REFERENCE;
+    node.factory = element;
+    node.pad = pad;
+    return node;
+}
+
+std::string WarmStart::find_attach_name(const std::string& gst_string) {
+    for (auto& chain : MultiStreamComposer::parse(gst_string)) {
+        for (auto& node : chain) {
+            if (node.kind == GstNode::ELEMENT && node.factory == WARM_START_ATTACH_FACTORY) {
+                return node.get("name");
+            }
+        }
+    }
+    return "";
+}
+
+std::string WarmStart::insert_selector(const std::string& gst_string, std::string& attach_name) {
+    std::vector<GstChain> chains = MultiStreamComposer::parse(gst_string);
+    attach_name = find_attach_name(gst_string);
+    if (attach_name.empty()) {
+        return "";
+    }
+
+    // branches taken from the attach element by reference now start at the selector
+    for (auto& chain : chains) {
+        for (auto& node : chain) {
+            if (node.kind == GstNode::REFERENCE && node.factory == attach_name) {
+                node.factory = WARM_START_SELECTOR_NAME;
+            }
+        }
+    }
+
+    for (size_t c = 0; c < chains.size(); c++) {
+        for (size_t i = 0; i < chains[c].size(); i++) {
+            const GstNode& node = chains[c][i];
+            if (node.kind != GstNode::ELEMENT || node.factory != WARM_START_ATTACH_FACTORY) {
+                continue;
+            }
+
+            GstNode selector;
+            selector.factory = "input-selector";
+            selector.set("name", WARM_START_SELECTOR_NAME);
+            // frames of the inactive pad are dropped, not held back
+            selector.set("sync-streams", "false");
+            GstChain live_out = { selector };
+            live_out.insert(live_out.end(), chains[c].begin() + i + 1, chains[c].end());
+
+            chains[c].resize(i + 1);
+            chains[c].push_back(reference(WARM_START_SELECTOR_NAME, "sink_1"));
+
+            GstNode src;
+            src.factory = "appsrc";
+            src.set("name", WARM_START_SRC_NAME);
+            src.set("is-live", "true");
+            src.set("format", "time");
+            src.set("do-timestamp", "true");
+            GstChain synthetic = { src, reference(WARM_START_SELECTOR_NAME, "sink_0") };
+
+            chains.insert(chains.begin() + c + 1, { synthetic, live_out });
+            return MultiStreamComposer::to_string(chains);
+        }
+    }
+    return "";
+}
+
+WarmStart::WarmStart(GstElement *pipeline, const std::string& attach_name, int frames,
+                     gint64 start_us, Reporter reporter)
+    : pipeline(pipeline), attach_name(attach_name), frames(frames),
+      start_us(start_us), reporter(reporter) {
+    stream_quark = g_quark_from_static_string(WARM_START_STREAM_ID);
+}
+
+WarmStart::~WarmStart() {
+    if (push_timer_id) {
+        g_source_remove(push_timer_id);
+    }
+    remove_probes();
+
+    if (pool) {
+        gst_simaai_free_buffer_pool(pool);
+    }
+    if (warm_pad) gst_object_unref(warm_pad);
+    if (live_pad) gst_object_unref(live_pad);
+    if (appsrc) gst_object_unref(appsrc);
+    if (selector) gst_object_unref(selector);
+}
+
+int WarmStart::track(GstElement *element, int upstream) {
+    GParamSpec *transmit = g_object_class_find_property(G_OBJECT_GET_CLASS(element), "transmit");
+    if (!transmit || !G_IS_PARAM_SPEC_BOOLEAN(transmit) || element->numsrcpads == 0) {
+        return -1;
+    }
+
+    int index = tracked.size();
+    auto entry = std::make_unique<Tracked>();
+    entry->name = GST_OBJECT_NAME(element);
+    entry->upstream = upstream;
+    tracked.push_back(std::move(entry));
+
+    GstIterator *pads = gst_element_iterate_src_pads(element);
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(pads, &item) == GST_ITERATOR_OK) {
+        GstPad *pad = GST_PAD(g_value_get_object(&item));
+        ProbeData *data = g_new(ProbeData, 1);
+        data->self = this;
+        data->index = index;
+        gulong id = gst_pad_add_probe(pad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                                      output_probe, data, g_free);
+        probes.emplace_back(GST_PAD(gst_object_ref(pad)), id);
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(pads);
+
+    return index;
+}
+
+void WarmStart::walk(GstElement *element, int upstream, std::set<GstElement *>& visited) {
+    GstIterator *pads = gst_element_iterate_src_pads(element);
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(pads, &item) == GST_ITERATOR_OK) {
+        GstPad *peer = gst_pad_get_peer(GST_PAD(g_value_get_object(&item)));
+        g_value_reset(&item);
+        if (!peer) {
+            continue;
+        }
+
+        GstElement *next = gst_pad_get_parent_element(peer);
+        if (!next) {
+            gst_object_unref(peer);
+            continue;
+        }
+        if (visited.insert(next).second) {
+            int index = track(next, upstream);
+            if (frames > 0 && index < 0 && upstream >= 0 && tracked[upstream]->name == GST_OBJECT_NAME(element)) {
+                // synthetic frames leave the inference path here, encoder and sink never see them
+                ProbeData *data = g_new(ProbeData, 1);
+                data->self = this;
+                data->index = upstream;
+                gulong id = gst_pad_add_probe(peer, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                                              drop_probe, data, g_free);
+                probes.emplace_back(GST_PAD(gst_object_ref(peer)), id);
+            }
+            walk(next, index >= 0 ? index : upstream, visited);
+        }
+        gst_object_unref(peer);
+        gst_object_unref(next);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(pads);
+}
+
+bool WarmStart::read_frame_config(std::string& error) {
+    // the config reading the attach element output gives its caps and segments
+    GstIterator *it = gst_bin_iterate_elements(GST_BIN(pipeline));
+    GValue item = G_VALUE_INIT;
+    std::string segment;
+
+    while (width == 0 && gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+        GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+        GParamSpec *pspec = g_object_class_find_property(G_OBJECT_GET_CLASS(element), "config");
+        gchar *config_path = nullptr;
+        if (pspec && G_IS_PARAM_SPEC_STRING(pspec)) {
+            g_object_get(element, "config", &config_path, NULL);
+        }
+        g_value_reset(&item);
+        if (!config_path) {
+            continue;
+        }
+
+        json config;
+        try {
+            std::ifstream ifs(config_path);
+            config = json::parse(ifs);
+        } catch (const std::exception &e) {
+            g_free(config_path);
+            continue;
+        }
+        g_free(config_path);
+
+        if (!config.contains("input_buffers") || !config["input_buffers"].is_array()) {
+            continue;
+        }
+        for (auto& input : config["input_buffers"]) {
+            if (input.value("name", "") != attach_name || !input.contains("memories") ||
+                input["memories"].size() != 1) {
+                continue;
+            }
+            segment = input["memories"][0].value("segment_name", "");
+            width = config.value("input_width", 0);
+            height = config.value("input_height", 0);
+            format = config.value("input_img_type", "");
+            break;
+        }
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+
+    if (width <= 0 || height <= 0 || segment.empty()) {
+        error = "no config with input buffer '" + attach_name + "' of one segment and input_width/input_height";
+        return false;
+    }
+
+    if (format == "NV12" || format == "I420") {
+        frame_size = (gsize)width * height * 3 / 2;
+    } else if (format == "RGB" || format == "BGR") {
+        frame_size = (gsize)width * height * 3;
+    } else if (format == "GRAY") {
+        frame_size = (gsize)width * height;
+    } else {
+        error = "input_img_type '" + format + "' is not supported";
+        return false;
+    }
+
+    gst_simaai_segment_memory_init_once();
+    gsize segment_sizes[1] = { frame_size };
+    const gchar *segment_names[1] = { segment.c_str() };
+    // same memory the preprocess asks the decoder for
+    GstMemoryFlags flags = static_cast<GstMemoryFlags>(GST_SIMAAI_MEMORY_TARGET_EV74 |
+                                                       GST_SIMAAI_MEMORY_FLAG_CACHED);
+    pool = gst_simaai_allocate_buffer_pool2(GST_OBJECT(appsrc),
+                                            gst_simaai_memory_get_segment_allocator(),
+                                            1, WARM_START_POOL_SIZE, flags, 1,
+                                            segment_sizes, segment_names);
+    if (!pool) {
+        error = "cannot allocate synthetic frames";
+        return false;
+    }
+    return true;
+}
+
+bool WarmStart::prepare_frames(std::string& error) {
+    appsrc = gst_bin_get_by_name(GST_BIN(pipeline), WARM_START_SRC_NAME);
+    selector = gst_bin_get_by_name(GST_BIN(pipeline), WARM_START_SELECTOR_NAME);
+    if (!appsrc || !selector) {
+        error = "warm start elements are missing";
+        return false;
+    }
+    warm_pad = gst_element_get_static_pad(selector, "sink_0");
+    live_pad = gst_element_get_static_pad(selector, "sink_1");
+    if (!warm_pad || !live_pad) {
+        error = "warm start selector is not linked";
+        return false;
+    }
+
+    // without an active pad the first pad with data, likely live, would win
+    g_object_set(selector, "active-pad", warm_pad, NULL);
+
+    if (!read_frame_config(error)) {
+        return false;
+    }
+
+    GstCaps *caps = gst_caps_new_simple("video/x-raw",
+                                        "format", G_TYPE_STRING, format.c_str(),
+                                        "width", G_TYPE_INT, width,
+                                        "height", G_TYPE_INT, height,
+                                        "framerate", GST_TYPE_FRACTION, 1000 / WARM_START_FRAME_INTERVAL_MS, 1,
+                                        NULL);
+    g_object_set(appsrc, "caps", caps, NULL);
+    gst_caps_unref(caps);
+
+    ProbeData *data = g_new(ProbeData, 1);
+    data->self = this;
+    data->index = -1;
+    gulong id = gst_pad_add_probe(live_pad, GST_PAD_PROBE_TYPE_BUFFER, live_in_probe, data, g_free);
+    probes.emplace_back(GST_PAD(gst_object_ref(live_pad)), id);
+    return true;
+}
+
+bool WarmStart::setup(std::string& error) {
+    GstElement *attach = gst_bin_get_by_name(GST_BIN(pipeline), attach_name.c_str());
+    if (!attach) {
+        error = "element '" + attach_name + "' not found";
+        return false;
+    }
+
+    std::set<GstElement *> visited = { attach };
+    walk(attach, -1, visited);
+
+    if (frames == 0) {
+        // live frames enter at the attach element itself
+        GstIterator *pads = gst_element_iterate_src_pads(attach);
+        GValue item = G_VALUE_INIT;
+        while (gst_iterator_next(pads, &item) == GST_ITERATOR_OK) {
+            GstPad *pad = GST_PAD(g_value_get_object(&item));
+            ProbeData *data = g_new(ProbeData, 1);
+            data->self = this;
+            data->index = -1;
+            gulong id = gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, live_in_probe, data, g_free);
+            probes.emplace_back(GST_PAD(gst_object_ref(pad)), id);
+            g_value_reset(&item);
+        }
+        g_value_unset(&item);
+        gst_iterator_free(pads);
+        switched = true;
+    }
+    gst_object_unref(attach);
+
+    if (tracked.empty()) {
+        error = "no element with 'transmit' property after '" + attach_name + "'";
+        remove_probes();
+        if (frames > 0) {
+            select_live();
+        }
+        return false;
+    }
+
+    if (frames > 0 && !prepare_frames(error)) {
+        remove_probes();
+        select_live();
+        return false;
+    }
+    return true;
+}
+
+void WarmStart::start() {
+    if (frames == 0 || !pool) {
+        return;
+    }
+    push_frame();
+    push_timer_id = g_timeout_add(WARM_START_FRAME_INTERVAL_MS, push_timeout, this);
+}
+
+void WarmStart::push_frame() {
+    GstBuffer *buffer = nullptr;
+    GstBufferPoolAcquireParams params = {};
+    params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+    // every frame is still in flight, the tracked elements are busy anyway
+    if (gst_buffer_pool_acquire_buffer(pool, &buffer, &params) != GST_FLOW_OK) {
+        return;
+    }
+
+    GstMapInfo map;
+    if (gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+        // black frame, chroma planes are neutral
+        bool yuv = format == "NV12" || format == "I420";
+        gsize luma = yuv ? (gsize)width * height : map.size;
+        memset(map.data, yuv ? 16 : 0, MIN(luma, map.size));
+        if (map.size > luma) {
+            memset(map.data + luma, 128, map.size - luma);
+        }
+        gst_buffer_unmap(buffer, &map);
+    }
+
+    GstSimaaiFrameInfo info = {};
+    info.buffer_id = gst_simaai_segment_memory_get_phys_addr(gst_buffer_peek_memory(buffer, 0));
+    info.frame_id = pushed;
+    info.buffer_name = g_quark_from_string(attach_name.c_str());
+    info.stream_id = stream_quark;
+    gst_buffer_add_simaai_frame_meta(buffer, &info);
+
+    GstFlowReturn ret = GST_FLOW_OK;
+    g_signal_emit_by_name(appsrc, "push-buffer", buffer, &ret);
+    gst_buffer_unref(buffer);
+
+    last_push_us = g_get_monotonic_time();
+    if (pushed++ == 0) {
+        first_push_us = last_push_us;
+    }
+}
+
+gboolean WarmStart::push_timeout(gpointer data) {
+    WarmStart *self = static_cast<WarmStart *>(data);
+
+    if (self->pushed < self->frames) {
+        self->push_frame();
+        return G_SOURCE_CONTINUE;
+    }
+
+    // an element that never produced output must not hold the live source back
+    if (g_get_monotonic_time() - self->last_push_us >= WARM_START_GRACE_MS * 1000) {
+        self->push_timer_id = 0;
+        self->warm_posted = true;
+        self->finish_warm_up(false);
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+void WarmStart::select_live() {
+    if (!selector) {
+        selector = gst_bin_get_by_name(GST_BIN(pipeline), WARM_START_SELECTOR_NAME);
+    }
+    if (selector && !live_pad) {
+        live_pad = gst_element_get_static_pad(selector, "sink_1");
+    }
+    if (selector && live_pad) {
+        switched = true;
+        g_object_set(selector, "active-pad", live_pad, NULL);
+    }
+}
+
+void WarmStart::finish_warm_up(bool complete) {
+    if (warm_done_us) {
+        return;
+    }
+    warm_done_us = g_get_monotonic_time();
+
+    if (push_timer_id) {
+        g_source_remove(push_timer_id);
+        push_timer_id = 0;
+    }
+    select_live();
+    if (pool) {
+        // frames still in flight return to the inactive pool and are freed
+        gst_simaai_free_buffer_pool(pool);
+        pool = nullptr;
+    }
+
+    json elements = json::object();
+    json missing = json::array();
+    for (auto& entry : tracked) {
+        if (entry->warm_us) {
+            elements[entry->name] = elapsed_ms(first_push_us, entry->warm_us);
+        } else if (!entry->live_us) {
+            missing.push_back(entry->name);
+        }
+    }
+
+    json report = { { "event", "warm-start" },
+                    { "complete", complete },
+                    { "frames", pushed },
+                    { "format", format },
+                    { "width", width },
+                    { "height", height },
+                    { "duration_ms", first_push_us ? elapsed_ms(first_push_us, warm_done_us) : 0.0 },
+                    { "elements", elements } };
+    if (!missing.empty()) {
+        report["missing"] = missing;
+    }
+    reporter(report);
+}
+
+void WarmStart::finish_first_result() {
+    gint64 result_us = 0;
+    json elements = json::object();
+    gint64 from_us = live_in_us ? live_in_us.load() : start_us;
+
+    for (auto& entry : tracked) {
+        result_us = MAX(result_us, entry->live_us.load());
+        elements[entry->name] = elapsed_ms(from_us, entry->live_us);
+    }
+    remove_probes();
+
+    json report = { { "event", "first-result" },
+                    { "time_to_first_result_ms", elapsed_ms(start_us, result_us) },
+                    { "warm_start", frames > 0 },
+                    { "elements", elements } };
+    if (live_in_us) {
+        report["first_frame_latency_ms"] = elapsed_ms(live_in_us, result_us);
+    }
+    reporter(report);
+}
+
+void WarmStart::check_done() {
+    bool warm = true, live = true;
+    for (auto& entry : tracked) {
+        warm &= entry->warm_us != 0 || entry->live_us != 0;
+        live &= entry->live_us != 0;
+    }
+
+    // streaming thread, the rest is done on the driver loop
+    if (frames > 0 && warm && !warm_posted.exchange(true)) {
+        g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT, [](gpointer data) -> gboolean {
+            static_cast<WarmStart *>(data)->finish_warm_up(true);
+            return G_SOURCE_REMOVE;
+        }, this, nullptr);
+    }
+    if (live && !result_posted.exchange(true)) {
+        g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT, [](gpointer data) -> gboolean {
+            static_cast<WarmStart *>(data)->finish_first_result();
+            return G_SOURCE_REMOVE;
+        }, this, nullptr);
+    }
+}
+
+GstPadProbeReturn WarmStart::output_probe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+    ProbeData *probe = static_cast<ProbeData *>(data);
+    WarmStart *self = probe->self;
+    Tracked& entry = *self->tracked[probe->index];
+    if (entry.live_us) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+        GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+        buffer = gst_buffer_list_length(list) ? gst_buffer_list_get(list, 0) : nullptr;
+    }
+    if (!buffer) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    bool live;
+    GstSimaaiFrameInfo frame;
+    if (gst_buffer_get_simaai_frame_info(buffer, &frame)) {
+        live = frame.stream_id != self->stream_quark;
+    } else if (entry.upstream >= 0) {
+        live = self->tracked[entry.upstream]->live_us != 0;
+    } else {
+        live = self->live_in_us != 0;
+    }
+
+    gint64 now = g_get_monotonic_time();
+    gint64 none = 0;
+    if (live) {
+        entry.live_us = now;
+    } else if (!entry.warm_us.compare_exchange_strong(none, now)) {
+        return GST_PAD_PROBE_OK;
+    }
+    self->check_done();
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn WarmStart::drop_probe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+    ProbeData *probe = static_cast<ProbeData *>(data);
+    WarmStart *self = probe->self;
+
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+        GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+        buffer = gst_buffer_list_length(list) ? gst_buffer_list_get(list, 0) : nullptr;
+    }
+    if (!buffer) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    // same test as output_probe, the tracked element feeding this pad ran it first
+    GstSimaaiFrameInfo frame;
+    if (gst_buffer_get_simaai_frame_info(buffer, &frame)) {
+        return frame.stream_id == self->stream_quark ? GST_PAD_PROBE_DROP : GST_PAD_PROBE_OK;
+    }
+    return self->tracked[probe->index]->live_us ? GST_PAD_PROBE_OK : GST_PAD_PROBE_DROP;
+}
+
+GstPadProbeReturn WarmStart::live_in_probe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+    WarmStart *self = static_cast<ProbeData *>(data)->self;
+    // live frames are dropped by the selector until it switched
+    gint64 none = 0;
+    if (self->switched) {
+        self->live_in_us.compare_exchange_strong(none, g_get_monotonic_time());
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void WarmStart::remove_probes() {
+    for (auto& [ pad, id ] : probes) {
+        gst_pad_remove_probe(pad, id);
+        gst_object_unref(pad);
+    }
+    probes.clear();
+}
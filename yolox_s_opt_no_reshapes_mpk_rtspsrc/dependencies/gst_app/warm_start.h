@@ -0,0 +1,122 @@
+#ifndef WARM_START_H
+#define WARM_START_H
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gst/gst.h>
+#include <nlohmann/json.hpp>
+
+#define WARM_START_SRC_NAME                 "warmstart_src"
+#define WARM_START_SELECTOR_NAME            "warmstart_selector"
+/// @brief Stream id of synthetic frames in their SiMa frame meta
+#define WARM_START_STREAM_ID                "warm-start"
+/// @brief Factory of the element synthetic frames are injected after
+#define WARM_START_ATTACH_FACTORY           "simaaidecoder"
+
+using json = nlohmann::json;
+
+/// @brief Warm start of the inference path and time to first result.
+///
+/// For warm start an `appsrc` and an `input-selector` are put right after
+/// the decoder. While the live source connects, synthetic frames of the caps
+/// configured for the decoder output are pushed and live frames are dropped
+/// by the selector. Once every element downstream with a `transmit`
+/// property produced output, so caps, pools, configs and the first MLA run
+/// are done, the selector switches to the live source. Synthetic frames are
+/// dropped where they leave the tracked elements, encoder and sink only get
+/// live frames.
+///
+/// The first result is reached when each of those elements produced output
+/// for a live frame. SiMa elements keep the stream id of the frame meta, so
+/// synthetic and live outputs are told apart by it. Output without frame
+/// meta is live once the tracked element feeding it produced live output.
+class WarmStart {
+    public:
+        /// @brief Receives warm start and first result reports, on the driver loop
+        using Reporter = std::function<void(const json& report)>;
+
+        /// @param attach_name name of the WARM_START_ATTACH_FACTORY element
+        /// @param frames synthetic frames to push at most, 0 only measures the
+        ///        time to first result
+        /// @param start_us monotonic time the first result is measured from
+        WarmStart(GstElement *pipeline, const std::string& attach_name, int frames,
+                  gint64 start_us, Reporter reporter);
+        ~WarmStart();
+
+        /// @brief Finds the tracked elements, installs probes and, for warm
+        ///        start, prepares synthetic frames. On failure the live source
+        ///        is selected.
+        /// @return false with error set if nothing can be measured
+        bool setup(std::string& error);
+        /// @brief Starts pushing synthetic frames, once the pipeline is set to PLAYING
+        void start();
+
+        /// @brief Puts appsrc and input-selector after the first WARM_START_ATTACH_FACTORY
+        /// @param attach_name set to the name of that element
+        /// @return rewritten gst string, empty if there is no such named element
+        static std::string insert_selector(const std::string& gst_string, std::string& attach_name);
+        /// @return name of the first WARM_START_ATTACH_FACTORY, empty if none
+        static std::string find_attach_name(const std::string& gst_string);
+
+    private:
+        /// @brief Element with a `transmit` property downstream of the attach point
+        struct Tracked {
+            std::string name;
+            /// @brief Nearest tracked element upstream, -1 if none
+            int upstream;
+            /// @brief Monotonic time of first synthetic and first live output, 0 if none
+            std::atomic<gint64> warm_us { 0 }, live_us { 0 };
+        };
+
+        struct ProbeData {
+            WarmStart *self;
+            int index;
+        };
+
+        GstElement *pipeline;
+        std::string attach_name;
+        int frames;
+        gint64 start_us;
+        Reporter reporter;
+        GQuark stream_quark;
+
+        std::vector<std::unique_ptr<Tracked>> tracked;
+        std::vector<std::pair<GstPad *, gulong>> probes;
+
+        // synthetic frames, only with warm start
+        GstElement *appsrc = nullptr, *selector = nullptr;
+        GstPad *warm_pad = nullptr, *live_pad = nullptr;
+        GstBufferPool *pool = nullptr;
+        std::string format;
+        int width = 0, height = 0;
+        gsize frame_size = 0;
+        guint push_timer_id = 0;
+        int pushed = 0;
+        gint64 first_push_us = 0, last_push_us = 0, warm_done_us = 0;
+
+        /// @brief Monotonic time the first live frame passed the attach point
+        std::atomic<gint64> live_in_us { 0 };
+        std::atomic<bool> switched { false }, warm_posted { false }, result_posted { false };
+
+        int track(GstElement *element, int upstream);
+        void walk(GstElement *element, int upstream, std::set<GstElement *>& visited);
+        bool read_frame_config(std::string& error);
+        bool prepare_frames(std::string& error);
+        void select_live();
+        void push_frame();
+        void check_done();
+        void finish_warm_up(bool complete);
+        void finish_first_result();
+        void remove_probes();
+
+        static gboolean push_timeout(gpointer data);
+        static GstPadProbeReturn output_probe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+        static GstPadProbeReturn drop_probe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+        static GstPadProbeReturn live_in_probe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+};
+
+#endif // WARM_START_H
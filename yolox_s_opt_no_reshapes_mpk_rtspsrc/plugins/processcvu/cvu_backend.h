@@ -0,0 +1,395 @@
+#ifndef EVXX_BACKEND
+#define EVXX_BACKEND
+
+#include <errno.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <simaai/simaai_memory.h>
+#include <simaai/nlohmann/json.hpp>
+
+#include "cvu_host_preproc.h"
+#include "cvu_host_detess_dequant.h"
+#include "job_replay_session.h"
+
+typedef std::pair<std::chrono::steady_clock::time_point,
+                  std::chrono::steady_clock::time_point> CvuKernelTime;
+
+/**
+ * @brief Backend running compiled EVXX jobs. The job is the same for every
+ *        backend: graph id, config manager and segments of graph inputs and
+ *        outputs by dispatcher name.
+ * @tparam Job dispatcher job type with `buffers` map
+ */
+template <typename Job>
+class CvuBackend {
+ public:
+  virtual ~CvuBackend() = default;
+
+  virtual const char * name() const = 0;
+
+  /**
+   * @brief Run job and wait until it is done. Can be called from several
+   *        threads at the same time, backends on a shared device or file
+   *        run one job at a time
+   * @param tp kernel start and end time
+   * @return 0 on success or errno code, same as dispatcher run
+   */
+  virtual int run(Job & job, CvuKernelTime & tp) = 0;
+};
+
+/**
+ * @brief Backend submitting jobs to the EV74 through the dispatcher. The
+ *        dispatcher is not documented as reentrant, so runs are serialized;
+ *        with several jobs in flight the next job is configured and the
+ *        previous one pushed while the EV74 runs.
+ */
+template <typename Job, typename Dispatcher>
+class CvuDispatcherBackend : public CvuBackend<Job> {
+ public:
+  explicit CvuDispatcherBackend(Dispatcher * dispatcher) : dispatcher_(dispatcher) {}
+
+  const char * name() const override { return "evxx"; }
+
+  int run(Job & job, CvuKernelTime & tp) override
+  {
+    const std::lock_guard<std::mutex> lk(mtx_);
+    return dispatcher_->run(job, tp);
+  }
+
+ private:
+  Dispatcher * dispatcher_;
+  std::mutex mtx_;
+};
+
+/**
+ * @brief Backend running jobs on another backend and appending inputs and
+ *        outputs of every job to the record file of the graph
+ */
+template <typename Job>
+class CvuRecordBackend : public CvuBackend<Job> {
+ public:
+  explicit CvuRecordBackend(std::unique_ptr<CvuBackend<Job>> backend)
+    : backend_(std::move(backend)) {}
+
+  const char * name() const override { return "record"; }
+
+  bool open(const JobReplaySettings & settings, const std::string & graph,
+            const std::vector<std::string> & outputs, std::string & error)
+  {
+    return session_.open(settings, graph, outputs, error);
+  }
+
+  int run(Job & job, CvuKernelTime & tp) override
+  {
+    int res = backend_->run(job, tp);
+    if (res == 0) {
+      // jobs are appended to one file
+      const std::lock_guard<std::mutex> lk(mtx_);
+      res = session_.record(job, tp);
+    }
+    return res;
+  }
+
+ private:
+  std::unique_ptr<CvuBackend<Job>> backend_;
+  JobReplaySession<Job> session_;
+  std::mutex mtx_;
+};
+
+/**
+ * @brief Backend writing recorded outputs of the graph, without EV74
+ */
+template <typename Job>
+class CvuReplayBackend : public CvuBackend<Job> {
+ public:
+  const char * name() const override { return "replay"; }
+
+  bool open(const JobReplaySettings & settings, const std::string & graph,
+            const std::vector<std::string> & outputs, std::string & error)
+  {
+    return session_.open(settings, graph, outputs, error);
+  }
+
+  int run(Job & job, CvuKernelTime & tp) override
+  {
+    // recorded jobs are read in order, and stand in for the serialized EV74
+    const std::lock_guard<std::mutex> lk(mtx_);
+    return session_.replay(job, tp);
+  }
+
+ private:
+  JobReplaySession<Job> session_;
+  std::mutex mtx_;
+};
+
+/**
+ * @brief Backend running the graph on the host CPU. Used where there is no
+ *        EV74 and as reference. It is selected with `backend=host`, jobs
+ *        never move between the host and the EV74 at run time.
+ *        Supported graphs: `preproc` (NV12 input, INT8 output) and
+ *        `detessdequant` (INT8 input, fp32 NHWC output).
+ */
+template <typename Job>
+class CvuHostBackend : public CvuBackend<Job> {
+ public:
+  const char * name() const override { return "host"; }
+
+  /**
+   * @brief Configure graph from the plugin config
+   * @param error description of unsupported parameter on failure
+   */
+  bool configure(const nlohmann::json & config, std::string & error)
+  {
+    std::string graph_name = config.value("graph_name", "");
+    if (graph_name == "preproc") {
+      graph_ = Graph::PREPROC;
+      return configure_preproc(config, error);
+    }
+    if (graph_name == "detessdequant") {
+      graph_ = Graph::DETESS_DEQUANT;
+      return configure_detess_dequant(config, error);
+    }
+
+    error = "graph '" + graph_name + "' is not supported";
+    return false;
+  }
+
+  int run(Job & job, CvuKernelTime & tp) override
+  {
+    switch (graph_) {
+      case Graph::PREPROC:
+        return run_preproc(job, tp);
+      case Graph::DETESS_DEQUANT:
+        return run_detess_dequant(job, tp);
+      default:
+        return ENOSYS;
+    }
+  }
+
+ private:
+  enum class Graph { NONE, PREPROC, DETESS_DEQUANT };
+
+  static simaai_memory_t * find_memory(Job & job, const char * name)
+  {
+    auto it = job.buffers.find(name);
+    return it == job.buffers.end() ? nullptr : (simaai_memory_t *)it->second;
+  }
+
+  int run_preproc(Job & job, CvuKernelTime & tp)
+  {
+    simaai_memory_t * input = find_memory(job, "input_image");
+    simaai_memory_t * tessellated = find_memory(job, "output_tessellated_image");
+    // RGB output is optional
+    simaai_memory_t * rgb = find_memory(job, "output_rgb_image");
+
+    if (input == nullptr || tessellated == nullptr)
+      return EINVAL;
+    if (simaai_memory_get_size(input) < preproc_.input_size() ||
+        simaai_memory_get_size(tessellated) < preproc_.tessellated_size() ||
+        (rgb != nullptr && simaai_memory_get_size(rgb) < preproc_.rgb_size()))
+      return EINVAL;
+
+    // segments are mapped per job, the EVXX does the same on its side
+    void * in_ptr = simaai_memory_map(input);
+    void * tess_ptr = simaai_memory_map(tessellated);
+    void * rgb_ptr = rgb ? simaai_memory_map(rgb) : nullptr;
+    int res = 0;
+
+    if (in_ptr == nullptr || tess_ptr == nullptr || (rgb != nullptr && rgb_ptr == nullptr)) {
+      res = EBADFD;
+    } else {
+      simaai_memory_invalidate_cache(input);
+
+      tp.first = std::chrono::steady_clock::now();
+      preproc_.run((const uint8_t *)in_ptr, (int8_t *)tess_ptr, (uint8_t *)rgb_ptr);
+      tp.second = std::chrono::steady_clock::now();
+
+      simaai_memory_flush_cache(tessellated);
+      if (rgb != nullptr)
+        simaai_memory_flush_cache(rgb);
+    }
+
+    if (rgb_ptr)
+      simaai_memory_unmap(rgb);
+    if (tess_ptr)
+      simaai_memory_unmap(tessellated);
+    if (in_ptr)
+      simaai_memory_unmap(input);
+
+    return res;
+  }
+
+  int run_detess_dequant(Job & job, CvuKernelTime & tp)
+  {
+    simaai_memory_t * input = find_memory(job, "input_tensor");
+    simaai_memory_t * output = find_memory(job, "output_tensor");
+
+    if (input == nullptr || output == nullptr)
+      return EINVAL;
+    if (simaai_memory_get_size(input) < detess_dequant_.input_size() ||
+        simaai_memory_get_size(output) < detess_dequant_.output_size())
+      return EINVAL;
+
+    void * in_ptr = simaai_memory_map(input);
+    void * out_ptr = simaai_memory_map(output);
+    int res = 0;
+
+    if (in_ptr == nullptr || out_ptr == nullptr) {
+      res = EBADFD;
+    } else {
+      simaai_memory_invalidate_cache(input);
+
+      tp.first = std::chrono::steady_clock::now();
+      detess_dequant_.run((const int8_t *)in_ptr, (float *)out_ptr);
+      tp.second = std::chrono::steady_clock::now();
+
+      simaai_memory_flush_cache(output);
+    }
+
+    if (out_ptr)
+      simaai_memory_unmap(output);
+    if (in_ptr)
+      simaai_memory_unmap(input);
+
+    return res;
+  }
+
+  bool configure_preproc(const nlohmann::json & config, std::string & error)
+  {
+    if (config.value("input_img_type", "") != "NV12" ||
+        config.value("output_img_type", "") != "RGB") {
+      error = "only NV12 input and RGB output are supported";
+      return false;
+    }
+    if (config.value("scaling_type", "BILINEAR") != "BILINEAR") {
+      error = "only BILINEAR scaling is supported";
+      return false;
+    }
+    if (config.value("output_dtype", "") != "EVXX_INT8") {
+      error = "only EVXX_INT8 output is supported";
+      return false;
+    }
+    if (config.value("batch_size", 1) != 1) {
+      error = "only batch_size 1 is supported";
+      return false;
+    }
+
+    std::string padding = config.value("padding_type", "CENTER");
+    if (padding != "CENTER" && padding != "TOP_LEFT") {
+      error = "padding_type " + padding + " is not supported";
+      return false;
+    }
+
+    CvuPreprocParams params;
+    params.input_width = config.value("input_width", params.input_width);
+    params.input_height = config.value("input_height", params.input_height);
+    params.output_width = config.value("output_width", params.output_width);
+    params.output_height = config.value("output_height", params.output_height);
+    params.scaled_width = config.value("scaled_width", params.output_width);
+    params.scaled_height = config.value("scaled_height", params.output_height);
+    params.aspect_ratio = config.value("aspect_ratio", params.aspect_ratio);
+    params.pad_center = padding == "CENTER";
+    params.normalize = config.value("normalize", params.normalize);
+    params.q_scale = config.value("q_scale", params.q_scale);
+    params.q_zp = config.value("q_zp", params.q_zp);
+    params.tessellate = config.value("tessellate", params.tessellate);
+    params.tile_width = config.value("tile_width", params.tile_width);
+    params.tile_height = config.value("tile_height", params.tile_height);
+    params.tile_depth = config.value("tile_depth", params.tile_depth);
+
+    for (int c = 0; c < 3; c++) {
+      if (config.contains("channel_mean") && config["channel_mean"].size() > (size_t)c)
+        params.channel_mean[c] = config["channel_mean"][c].get<float>();
+      if (config.contains("channel_stddev") && config["channel_stddev"].size() > (size_t)c)
+        params.channel_stddev[c] = config["channel_stddev"][c].get<float>();
+    }
+
+    if (!preproc_.configure(params)) {
+      error = "invalid preproc parameters";
+      return false;
+    }
+
+    return true;
+  }
+
+  /// Per tensor integer array of the config, or empty if it is missing
+  static std::vector<int> int_array(const nlohmann::json & config, const char * key)
+  {
+    std::vector<int> values;
+    if (config.contains(key) && config[key].is_array())
+      for (auto & value : config[key])
+        values.push_back(value.get<int>());
+    return values;
+  }
+
+  bool configure_detess_dequant(const nlohmann::json & config, std::string & error)
+  {
+    if (config.value("batch_size", 1) != 1) {
+      error = "only batch_size 1 is supported";
+      return false;
+    }
+
+    const size_t num = config.value("num_in_tensor", 0);
+    std::vector<int> width = int_array(config, "input_width");
+    std::vector<int> height = int_array(config, "input_height");
+    std::vector<int> depth = int_array(config, "input_depth");
+    std::vector<int> slice_width = int_array(config, "slice_width");
+    std::vector<int> slice_height = int_array(config, "slice_height");
+    std::vector<int> slice_depth = int_array(config, "slice_depth");
+    std::vector<int> zp = int_array(config, "dq_zp");
+
+    if (num == 0 || width.size() != num || height.size() != num || depth.size() != num ||
+        slice_width.size() != num || slice_height.size() != num ||
+        slice_depth.size() != num || zp.size() != num ||
+        !config.contains("dq_scale") || config["dq_scale"].size() != num) {
+      error = "every per tensor array must have num_in_tensor values";
+      return false;
+    }
+    // optional, but indexed per tensor below
+    for (const char * key : { "data_type", "fp16_out_en", "output_format" }) {
+      if (config.contains(key) && (!config[key].is_array() || config[key].size() != num)) {
+        error = std::string(key) + " must have num_in_tensor values";
+        return false;
+      }
+    }
+
+    std::vector<CvuDetessHead> heads;
+    for (size_t i = 0; i < num; i++) {
+      if (config.contains("data_type") && config["data_type"][i] != "INT8") {
+        error = "only INT8 input is supported";
+        return false;
+      }
+      if (config.contains("fp16_out_en") && config["fp16_out_en"][i].get<bool>()) {
+        error = "only fp32 output is supported";
+        return false;
+      }
+      if (config.contains("output_format") && config["output_format"][i] != "NHWC") {
+        error = "only NHWC output is supported";
+        return false;
+      }
+
+      heads.push_back({ width[i], height[i], depth[i],
+                        slice_width[i], slice_height[i], slice_depth[i],
+                        config["dq_scale"][i].get<float>(), zp[i] });
+    }
+
+    if (!detess_dequant_.configure(heads)) {
+      error = "invalid detessdequant tensor shapes";
+      return false;
+    }
+
+    return true;
+  }
+
+  Graph graph_ = Graph::NONE;
+  CvuHostPreproc preproc_;
+  CvuHostDetessDequant detess_dequant_;
+};
+
+#endif //EVXX_BACKEND
@@ -0,0 +1,190 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file cvu_host_detess_dequant.cpp
+ * @brief Host implementation of the `detessdequant` CVU graph
+ * @author SiMa.Ai\TM
+ */
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "cvu_host_detess_dequant.h"
+
+/// MLA pads depth of every pixel in a tile to this number of bytes
+#define DEPTH_ALIGN 16
+
+/**
+ * @brief dst = (src - zp) * inv_scale
+ */
+static void dequant_scalar(const int8_t * src, float * dst, int n, int zp, float inv_scale)
+{
+  for (int i = 0; i < n; i++)
+    dst[i] = (float)(src[i] - zp) * inv_scale;
+}
+
+#if defined(__AVX2__)
+
+static void dequant_simd(const int8_t * src, float * dst, int n, int zp, float inv_scale)
+{
+  const __m256i vzp = _mm256_set1_epi32(zp);
+  const __m256 vscale = _mm256_set1_ps(inv_scale);
+  int i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i q = _mm_loadu_si128((const __m128i *)(src + i));
+    __m256i lo = _mm256_sub_epi32(_mm256_cvtepi8_epi32(q), vzp);
+    __m256i hi = _mm256_sub_epi32(_mm256_cvtepi8_epi32(_mm_srli_si128(q, 8)), vzp);
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), vscale));
+    _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), vscale));
+  }
+
+  dequant_scalar(src + i, dst + i, n - i, zp, inv_scale);
+}
+
+#define SIMD_NAME "avx2"
+
+#elif defined(__ARM_NEON)
+
+static void dequant_simd(const int8_t * src, float * dst, int n, int zp, float inv_scale)
+{
+  const int16x8_t vzp = vdupq_n_s16((int16_t)zp);
+  int i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    int8x16_t q = vld1q_s8(src + i);
+    int16x8_t lo = vsubq_s16(vmovl_s8(vget_low_s8(q)), vzp);
+    int16x8_t hi = vsubq_s16(vmovl_s8(vget_high_s8(q)), vzp);
+    vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo))), inv_scale));
+    vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(lo))), inv_scale));
+    vst1q_f32(dst + i + 8, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi))), inv_scale));
+    vst1q_f32(dst + i + 12, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(hi))), inv_scale));
+  }
+
+  dequant_scalar(src + i, dst + i, n - i, zp, inv_scale);
+}
+
+#define SIMD_NAME "neon"
+
+#else
+
+#define dequant_simd dequant_scalar
+#define SIMD_NAME "none"
+
+#endif
+
+const char * CvuHostDetessDequant::simd_name()
+{
+  return SIMD_NAME;
+}
+
+bool CvuHostDetessDequant::configure(const std::vector<CvuDetessHead> & heads)
+{
+  heads_.clear();
+  runs_.clear();
+  inv_scale_.clear();
+  input_size_ = 0;
+  output_count_ = 0;
+
+  if (heads.empty())
+    return false;
+
+  size_t src_base = 0, dst_base = 0;
+
+  for (size_t h = 0; h < heads.size(); h++) {
+    const CvuDetessHead & head = heads[h];
+
+    if (head.width <= 0 || head.height <= 0 || head.depth <= 0 ||
+        head.slice_width <= 0 || head.slice_height <= 0 || head.slice_depth <= 0 ||
+        head.dq_scale <= 0.0f)
+      return false;
+
+    const size_t depth_stride = (head.slice_depth + DEPTH_ALIGN - 1) & ~(size_t)(DEPTH_ALIGN - 1);
+    const int tiles_w = (head.width + head.slice_width - 1) / head.slice_width;
+    const int tiles_h = (head.height + head.slice_height - 1) / head.slice_height;
+    const int tiles_d = (head.depth + head.slice_depth - 1) / head.slice_depth;
+    const size_t tile_size = (size_t)head.slice_width * head.slice_height * depth_stride;
+
+    for (int ty = 0; ty < tiles_h; ty++) {
+      for (int tx = 0; tx < tiles_w; tx++) {
+        for (int td = 0; td < tiles_d; td++) {
+          const size_t tile = ((size_t)ty * tiles_w + tx) * tiles_d + td;
+          const int d0 = td * head.slice_depth;
+          const int length = std::min(head.slice_depth, head.depth - d0);
+
+          for (int sy = 0; sy < head.slice_height; sy++) {
+            const int y = ty * head.slice_height + sy;
+            if (y >= head.height)
+              break;
+            for (int sx = 0; sx < head.slice_width; sx++) {
+              const int x = tx * head.slice_width + sx;
+              if (x >= head.width)
+                break;
+
+              Run run;
+              run.src = src_base + tile * tile_size +
+                        ((size_t)sy * head.slice_width + sx) * depth_stride;
+              run.dst = dst_base + ((size_t)y * head.width + x) * head.depth + d0;
+              run.length = (uint32_t)length;
+              run.head = (uint32_t)h;
+
+              // merge with previous run if both sides continue it
+              if (!runs_.empty()) {
+                Run & last = runs_.back();
+                if (last.head == run.head &&
+                    last.src + last.length == run.src &&
+                    last.dst + last.length == run.dst) {
+                  last.length += run.length;
+                  continue;
+                }
+              }
+              runs_.push_back(run);
+            }
+          }
+        }
+      }
+    }
+
+    src_base += tile_size * tiles_w * tiles_h * tiles_d;
+    dst_base += (size_t)head.width * head.height * head.depth;
+    inv_scale_.push_back(1.0f / head.dq_scale);
+  }
+
+  heads_ = heads;
+  input_size_ = src_base;
+  output_count_ = dst_base;
+
+  return true;
+}
+
+void CvuHostDetessDequant::run(const int8_t * input, float * output, bool simd) const
+{
+  auto dequant = simd ? dequant_simd : dequant_scalar;
+
+  for (const Run & run : runs_)
+    dequant(input + run.src, output + run.dst, (int)run.length,
+            heads_[run.head].dq_zp, inv_scale_[run.head]);
+}
@@ -0,0 +1,99 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef CVU_HOST_DETESS_DEQUANT_H_
+#define CVU_HOST_DETESS_DEQUANT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+/**
+ * @brief One INT8 input tensor of the `detessdequant` graph, same fields as
+ *        the per tensor arrays of graph config
+ */
+struct CvuDetessHead {
+  int width, height, depth;
+  int slice_width, slice_height, slice_depth;
+  float dq_scale;
+  int dq_zp;
+};
+
+/**
+ * @brief Host implementation of the `detessdequant` CVU graph for INT8 input
+ *        and fp32 NHWC output.
+ *
+ * Input tensors follow each other in MLA output. Every tensor is split into
+ * `slice_height x slice_width x slice_depth` tiles, stored in full in row
+ * major order of (tile row, tile column, depth tile), with the depth of every
+ * pixel padded to 16 bytes. Outputs are dequantized as
+ * `(q - dq_zp) / dq_scale` and follow each other as fp32 NHWC tensors.
+ *
+ * configure() turns the layout into a list of contiguous runs, so run() only
+ * converts runs with SIMD (AVX2 or NEON) kernels. Results of SIMD and scalar
+ * kernels are identical. run() keeps no state and can be called from several
+ * threads at the same time.
+ */
+class CvuHostDetessDequant {
+ public:
+  /**
+   * @brief Build runs of the tiled layout
+   * @return false if a tensor or slice shape is invalid
+   */
+  bool configure(const std::vector<CvuDetessHead> & heads);
+
+  const std::vector<CvuDetessHead> & heads() const { return heads_; }
+
+  /// Bytes of the tiled INT8 input, including tile padding
+  size_t input_size() const { return input_size_; }
+  /// Bytes of all fp32 outputs
+  size_t output_size() const { return output_count_ * sizeof(float); }
+  /// Number of contiguous runs converted per frame
+  size_t num_runs() const { return runs_.size(); }
+
+  /**
+   * @brief Run graph on one frame
+   * @param input tiled tensors of input_size() bytes
+   * @param output fp32 tensors of output_size() bytes
+   * @param simd use SIMD kernels if they are built in
+   */
+  void run(const int8_t * input, float * output, bool simd = true) const;
+
+  /// Name of SIMD kernels built in, "none" if only scalar kernels exist
+  static const char * simd_name();
+
+ private:
+  /// contiguous values with the same dequantization
+  struct Run {
+    size_t src;
+    size_t dst;
+    uint32_t length;
+    uint32_t head;
+  };
+
+  std::vector<CvuDetessHead> heads_;
+  std::vector<Run> runs_;
+  std::vector<float> inv_scale_;
+  size_t input_size_ = 0;
+  size_t output_count_ = 0;
+};
+
+#endif // CVU_HOST_DETESS_DEQUANT_H_
@@ -0,0 +1,390 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file cvu_host_preproc.cpp
+ * @brief Host implementation of the `preproc` CVU graph
+ * @author SiMa.Ai\TM
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "cvu_host_preproc.h"
+
+/// bilinear weights are in 1/128, two passes give 14 fractional bits
+#define WEIGHT_BITS 7
+#define WEIGHT_ONE (1 << WEIGHT_BITS)
+#define BLEND_SHIFT (2 * WEIGHT_BITS)
+
+/**
+ * @brief Source positions of `dst` pixels scaled from `src` pixels, with
+ *        aligned pixel centers
+ */
+static void make_positions(int src, int dst, std::vector<int> & p0,
+                           std::vector<int> & p1, std::vector<uint8_t> & f)
+{
+  const double scale = (double)src / dst;
+
+  p0.resize(dst);
+  p1.resize(dst);
+  f.resize(dst);
+
+  for (int i = 0; i < dst; i++) {
+    double s = std::max((i + 0.5) * scale - 0.5, 0.0);
+    int i0 = (int)s;
+    int w = (int)lround((s - i0) * WEIGHT_ONE);
+    if (w == WEIGHT_ONE) {
+      i0++;
+      w = 0;
+    }
+    if (i0 >= src - 1) {
+      i0 = src - 1;
+      w = 0;
+    }
+    p0[i] = i0;
+    p1[i] = std::min(i0 + 1, src - 1);
+    f[i] = (uint8_t)w;
+  }
+}
+
+/**
+ * @brief dst = a * wa + b * wb, for wa + wb == WEIGHT_ONE the result fits 15 bits
+ */
+static void blend_rows_scalar(const uint8_t * a, const uint8_t * b, int wa, int wb,
+                              uint16_t * dst, int n)
+{
+  for (int i = 0; i < n; i++)
+    dst[i] = (uint16_t)(a[i] * wa + b[i] * wb);
+}
+
+static inline uint8_t clip_u8(int v)
+{
+  return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+/**
+ * @brief BT.601 limited range YUV to RGB of planar rows
+ */
+static void yuv_to_rgb_scalar(const uint8_t * y, const uint8_t * u, const uint8_t * v,
+                              uint8_t * r, uint8_t * g, uint8_t * b, int n)
+{
+  for (int i = 0; i < n; i++) {
+    int c = 298 * (y[i] - 16) + 128;
+    int d = u[i] - 128;
+    int e = v[i] - 128;
+    r[i] = clip_u8((c + 409 * e) >> 8);
+    g[i] = clip_u8((c - 100 * d - 208 * e) >> 8);
+    b[i] = clip_u8((c + 516 * d) >> 8);
+  }
+}
+
+#if defined(__AVX2__)
+
+static void blend_rows_simd(const uint8_t * a, const uint8_t * b, int wa, int wb,
+                            uint16_t * dst, int n)
+{
+  const __m256i va = _mm256_set1_epi16((short)wa);
+  const __m256i vb = _mm256_set1_epi16((short)wb);
+  int i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m256i pa = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(a + i)));
+    __m256i pb = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(b + i)));
+    __m256i res = _mm256_add_epi16(_mm256_mullo_epi16(pa, va), _mm256_mullo_epi16(pb, vb));
+    _mm256_storeu_si256((__m256i *)(dst + i), res);
+  }
+
+  blend_rows_scalar(a + i, b + i, wa, wb, dst + i, n - i);
+}
+
+/// saturate 8 int32 to uint8, same as clip_u8
+static inline void store_u8x8(uint8_t * dst, __m256i v)
+{
+  __m128i v16 = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  _mm_storel_epi64((__m128i *)dst, _mm_packus_epi16(v16, v16));
+}
+
+static void yuv_to_rgb_simd(const uint8_t * y, const uint8_t * u, const uint8_t * v,
+                            uint8_t * r, uint8_t * g, uint8_t * b, int n)
+{
+  const __m256i k16 = _mm256_set1_epi32(16);
+  const __m256i k128 = _mm256_set1_epi32(128);
+  int i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i c = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(y + i))), k16);
+    __m256i d = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(u + i))), k128);
+    __m256i e = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(v + i))), k128);
+
+    c = _mm256_add_epi32(_mm256_mullo_epi32(c, _mm256_set1_epi32(298)), k128);
+
+    __m256i vr = _mm256_add_epi32(c, _mm256_mullo_epi32(e, _mm256_set1_epi32(409)));
+    __m256i vg = _mm256_sub_epi32(c, _mm256_add_epi32(_mm256_mullo_epi32(d, _mm256_set1_epi32(100)),
+                                                      _mm256_mullo_epi32(e, _mm256_set1_epi32(208))));
+    __m256i vb = _mm256_add_epi32(c, _mm256_mullo_epi32(d, _mm256_set1_epi32(516)));
+
+    store_u8x8(r + i, _mm256_srai_epi32(vr, 8));
+    store_u8x8(g + i, _mm256_srai_epi32(vg, 8));
+    store_u8x8(b + i, _mm256_srai_epi32(vb, 8));
+  }
+
+  yuv_to_rgb_scalar(y + i, u + i, v + i, r + i, g + i, b + i, n - i);
+}
+
+#define SIMD_NAME "avx2"
+
+#elif defined(__ARM_NEON)
+
+static void blend_rows_simd(const uint8_t * a, const uint8_t * b, int wa, int wb,
+                            uint16_t * dst, int n)
+{
+  const uint8x8_t va = vdup_n_u8((uint8_t)wa);
+  const uint8x8_t vb = vdup_n_u8((uint8_t)wb);
+  int i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t pa = vld1q_u8(a + i);
+    uint8x16_t pb = vld1q_u8(b + i);
+    uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(pa), va), vget_low_u8(pb), vb);
+    uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(pa), va), vget_high_u8(pb), vb);
+    vst1q_u16(dst + i, lo);
+    vst1q_u16(dst + i + 8, hi);
+  }
+
+  blend_rows_scalar(a + i, b + i, wa, wb, dst + i, n - i);
+}
+
+/// (t + x * k) >> 8 of 8 lanes saturated to uint8, same as clip_u8
+static inline uint8x8_t shift_u8x8(int32x4_t lo, int32x4_t hi)
+{
+  return vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(lo, 8)),
+                                  vqmovn_s32(vshrq_n_s32(hi, 8))));
+}
+
+static void yuv_to_rgb_simd(const uint8_t * y, const uint8_t * u, const uint8_t * v,
+                            uint8_t * r, uint8_t * g, uint8_t * b, int n)
+{
+  const int16x8_t k16 = vdupq_n_s16(16);
+  const int16x8_t k128 = vdupq_n_s16(128);
+  const int32x4_t round = vdupq_n_s32(128);
+  int i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t c = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + i))), k16);
+    int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + i))), k128);
+    int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + i))), k128);
+
+    int32x4_t c_lo = vmlal_n_s16(round, vget_low_s16(c), 298);
+    int32x4_t c_hi = vmlal_n_s16(round, vget_high_s16(c), 298);
+
+    vst1_u8(r + i, shift_u8x8(vmlal_n_s16(c_lo, vget_low_s16(e), 409),
+                              vmlal_n_s16(c_hi, vget_high_s16(e), 409)));
+    vst1_u8(g + i, shift_u8x8(vmlsl_n_s16(vmlsl_n_s16(c_lo, vget_low_s16(d), 100),
+                                          vget_low_s16(e), 208),
+                              vmlsl_n_s16(vmlsl_n_s16(c_hi, vget_high_s16(d), 100),
+                                          vget_high_s16(e), 208)));
+    vst1_u8(b + i, shift_u8x8(vmlal_n_s16(c_lo, vget_low_s16(d), 516),
+                              vmlal_n_s16(c_hi, vget_high_s16(d), 516)));
+  }
+
+  yuv_to_rgb_scalar(y + i, u + i, v + i, r + i, g + i, b + i, n - i);
+}
+
+#define SIMD_NAME "neon"
+
+#else
+
+#define blend_rows_simd blend_rows_scalar
+#define yuv_to_rgb_simd yuv_to_rgb_scalar
+#define SIMD_NAME "none"
+
+#endif
+
+const char * CvuHostPreproc::simd_name()
+{
+  return SIMD_NAME;
+}
+
+bool CvuHostPreproc::configure(const CvuPreprocParams & params)
+{
+  const CvuPreprocParams & p = params;
+
+  if (p.input_width < 2 || p.input_height < 2 ||
+      (p.input_width & 1) || (p.input_height & 1))
+    return false;
+  if (p.output_width < 1 || p.output_height < 1 ||
+      p.scaled_width < 1 || p.scaled_height < 1)
+    return false;
+  if (p.tile_depth != 3)
+    return false;
+  if (p.tessellate &&
+      (p.tile_width < 1 || p.tile_height < 1 ||
+       p.output_width % p.tile_width || p.output_height % p.tile_height))
+    return false;
+  if (p.q_scale <= 0.0f)
+    return false;
+  for (int c = 0; c < 3; c++)
+    if (p.normalize && p.channel_stddev[c] == 0.0f)
+      return false;
+
+  params_ = params;
+
+  int area_w = std::min(p.scaled_width, p.output_width);
+  int area_h = std::min(p.scaled_height, p.output_height);
+
+  if (p.aspect_ratio) {
+    double scale = std::min((double)area_w / p.input_width,
+                            (double)area_h / p.input_height);
+    dst_w_ = std::min(std::max((int)lround(p.input_width * scale), 1), area_w);
+    dst_h_ = std::min(std::max((int)lround(p.input_height * scale), 1), area_h);
+  } else {
+    dst_w_ = area_w;
+    dst_h_ = area_h;
+  }
+
+  off_x_ = p.pad_center ? (p.output_width - dst_w_) / 2 : 0;
+  off_y_ = p.pad_center ? (p.output_height - dst_h_) / 2 : 0;
+
+  make_positions(p.input_width, dst_w_, x0_, x1_, fx_);
+  make_positions(p.input_height, dst_h_, y0_, y1_, fy_);
+  make_positions(p.input_width / 2, dst_w_, cx0_, cx1_, cfx_);
+  make_positions(p.input_height / 2, dst_h_, cy0_, cy1_, cfy_);
+
+  for (int c = 0; c < 3; c++) {
+    for (int pix = 0; pix < 256; pix++) {
+      double value = pix;
+      if (p.normalize)
+        value = (pix / 255.0 - p.channel_mean[c]) / p.channel_stddev[c];
+      long q = lrint(value * p.q_scale) + p.q_zp;
+      lut_[c * 256 + pix] = (int8_t)std::min(std::max(q, -128L), 127L);
+    }
+  }
+
+  return true;
+}
+
+size_t CvuHostPreproc::input_size() const
+{
+  return (size_t)params_.input_width * params_.input_height * 3 / 2;
+}
+
+size_t CvuHostPreproc::tessellated_size() const
+{
+  return (size_t)params_.output_width * params_.output_height * 3;
+}
+
+size_t CvuHostPreproc::rgb_size() const
+{
+  return (size_t)params_.output_width * params_.output_height * 3;
+}
+
+/**
+ * @brief Quantize one RGB output row into its place in the tiles
+ */
+void CvuHostPreproc::write_row(int oy, const uint8_t * rgb_row, int8_t * tessellated) const
+{
+  const int tw = params_.tessellate ? params_.tile_width : params_.output_width;
+  const int th = params_.tessellate ? params_.tile_height : params_.output_height;
+  const int tiles_x = params_.output_width / tw;
+  const int tile_row = oy / th;
+  const int ty = oy % th;
+
+  for (int tc = 0; tc < tiles_x; tc++) {
+    int8_t * dst = tessellated +
+        ((size_t)(tile_row * tiles_x + tc) * th + ty) * tw * 3;
+    const uint8_t * src = rgb_row + (size_t)tc * tw * 3;
+    for (int i = 0; i < tw; i++) {
+      dst[3 * i + 0] = lut_[src[3 * i + 0]];
+      dst[3 * i + 1] = lut_[256 + src[3 * i + 1]];
+      dst[3 * i + 2] = lut_[512 + src[3 * i + 2]];
+    }
+  }
+}
+
+void CvuHostPreproc::run(const uint8_t * nv12, int8_t * tessellated, uint8_t * rgb,
+                         bool simd) const
+{
+  const int in_w = params_.input_width;
+  const int out_w = params_.output_width;
+  const uint8_t * luma = nv12;
+  const uint8_t * chroma = nv12 + (size_t)in_w * params_.input_height;
+
+  auto blend_rows = simd ? blend_rows_simd : blend_rows_scalar;
+  auto yuv_to_rgb = simd ? yuv_to_rgb_simd : yuv_to_rgb_scalar;
+
+  std::vector<uint16_t> vy(in_w), vuv(in_w);
+  std::vector<uint8_t> planes(6 * (size_t)dst_w_);
+  uint8_t * py = planes.data();
+  uint8_t * pu = py + dst_w_;
+  uint8_t * pv = pu + dst_w_;
+  uint8_t * pr = pv + dst_w_;
+  uint8_t * pg = pr + dst_w_;
+  uint8_t * pb = pg + dst_w_;
+  // padding stays black, only the scaled columns are overwritten per row
+  std::vector<uint8_t> row((size_t)out_w * 3, 0);
+  const std::vector<uint8_t> black((size_t)out_w * 3, 0);
+  const int round = 1 << (BLEND_SHIFT - 1);
+
+  for (int oy = 0; oy < params_.output_height; oy++) {
+    const int y = oy - off_y_;
+    const uint8_t * out_row = black.data();
+
+    if (y >= 0 && y < dst_h_) {
+      // vertical pass over the whole source row, horizontal pass per column
+      blend_rows(luma + (size_t)y0_[y] * in_w, luma + (size_t)y1_[y] * in_w,
+                 WEIGHT_ONE - fy_[y], fy_[y], vy.data(), in_w);
+      blend_rows(chroma + (size_t)cy0_[y] * in_w, chroma + (size_t)cy1_[y] * in_w,
+                 WEIGHT_ONE - cfy_[y], cfy_[y], vuv.data(), in_w);
+
+      for (int x = 0; x < dst_w_; x++) {
+        int w = fx_[x];
+        py[x] = (uint8_t)((vy[x0_[x]] * (WEIGHT_ONE - w) + vy[x1_[x]] * w + round) >> BLEND_SHIFT);
+
+        int cw = cfx_[x];
+        int c0 = 2 * cx0_[x], c1 = 2 * cx1_[x];
+        pu[x] = (uint8_t)((vuv[c0] * (WEIGHT_ONE - cw) + vuv[c1] * cw + round) >> BLEND_SHIFT);
+        pv[x] = (uint8_t)((vuv[c0 + 1] * (WEIGHT_ONE - cw) + vuv[c1 + 1] * cw + round) >> BLEND_SHIFT);
+      }
+
+      yuv_to_rgb(py, pu, pv, pr, pg, pb, dst_w_);
+
+      uint8_t * dst = row.data() + (size_t)off_x_ * 3;
+      for (int x = 0; x < dst_w_; x++) {
+        dst[3 * x + 0] = pr[x];
+        dst[3 * x + 1] = pg[x];
+        dst[3 * x + 2] = pb[x];
+      }
+      out_row = row.data();
+    }
+
+    if (rgb != nullptr)
+      memcpy(rgb + (size_t)oy * out_w * 3, out_row, (size_t)out_w * 3);
+    write_row(oy, out_row, tessellated);
+  }
+}
@@ -0,0 +1,123 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef CVU_HOST_PREPROC_H_
+#define CVU_HOST_PREPROC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+/**
+ * @brief Parameters of the `preproc` graph, same fields as in graph config
+ */
+struct CvuPreprocParams {
+  int input_width = 1280;
+  int input_height = 720;
+  int output_width = 640;
+  int output_height = 640;
+  /// area the frame is scaled to, aspect ratio is kept inside of it
+  int scaled_width = 640;
+  int scaled_height = 640;
+  bool aspect_ratio = true;
+  /// CENTER padding if true, TOP_LEFT otherwise
+  bool pad_center = true;
+  bool normalize = false;
+  float channel_mean[3] = { 0.0f, 0.0f, 0.0f };
+  float channel_stddev[3] = { 1.0f, 1.0f, 1.0f };
+  float q_scale = 1.0f;
+  int q_zp = -128;
+  bool tessellate = true;
+  int tile_width = 128;
+  int tile_height = 32;
+  int tile_depth = 3;
+};
+
+/**
+ * @brief Host implementation of the `preproc` CVU graph for NV12 input, RGB
+ *        output and INT8 output type.
+ *
+ * Frame is scaled with bilinear interpolation (pixel centers aligned, 7 bit
+ * weights) into the padded output, converted to RGB with BT.601 limited range
+ * integer coefficients, then normalized and quantized through a per channel
+ * table and tessellated to `tile_height x tile_width x tile_depth` tiles in
+ * row major tile order. Padding is black.
+ *
+ * Source positions, weights and tables are precomputed by configure(). run()
+ * only uses scratch local to the call, so one instance can run several frames
+ * at the same time. SIMD (AVX2 or NEON) and scalar kernels give
+ * identical results.
+ */
+class CvuHostPreproc {
+ public:
+  /**
+   * @brief Precompute scaling positions and quantization table
+   * @return false if parameters are not supported
+   */
+  bool configure(const CvuPreprocParams & params);
+
+  const CvuPreprocParams & params() const { return params_; }
+
+  /// Bytes of the NV12 input frame
+  size_t input_size() const;
+  /// Bytes of `output_tessellated_image`
+  size_t tessellated_size() const;
+  /// Bytes of `output_rgb_image`
+  size_t rgb_size() const;
+
+  /// Size and offset of the scaled frame inside of the output
+  int scaled_width() const { return dst_w_; }
+  int scaled_height() const { return dst_h_; }
+  int offset_x() const { return off_x_; }
+  int offset_y() const { return off_y_; }
+
+  /**
+   * @brief Run graph on one frame
+   * @param nv12 input frame of input_size() bytes
+   * @param tessellated INT8 output of tessellated_size() bytes
+   * @param rgb RGB output of rgb_size() bytes, may be nullptr
+   * @param simd use SIMD kernels if they are built in
+   */
+  void run(const uint8_t * nv12, int8_t * tessellated, uint8_t * rgb,
+           bool simd = true) const;
+
+  /// Name of SIMD kernels built in, "none" if only scalar kernels exist
+  static const char * simd_name();
+
+ private:
+  void write_row(int oy, const uint8_t * rgb_row, int8_t * tessellated) const;
+
+  CvuPreprocParams params_;
+  int dst_w_ = 0, dst_h_ = 0;
+  int off_x_ = 0, off_y_ = 0;
+
+  /// source luma and chroma columns and weights of every scaled column
+  std::vector<int> x0_, x1_, cx0_, cx1_;
+  std::vector<uint8_t> fx_, cfx_;
+  /// source luma and chroma rows and weights of every scaled row
+  std::vector<int> y0_, y1_, cy0_, cy1_;
+  std::vector<uint8_t> fy_, cfy_;
+
+  /// quantized value of every 8 bit pixel, [channel * 256 + pixel]
+  int8_t lut_[3 * 256];
+};
+
+#endif // CVU_HOST_PREPROC_H_
@@ -0,0 +1,124 @@
+#ifndef EVXX_JOB_TEMPLATE
+#define EVXX_JOB_TEMPLATE
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <utils_string.h>
+
+/**
+ * @brief Memory of a graph buffer, mapped to a dispatcher input/output
+ */
+struct CvuTemplateMemory {
+  /// name of segment in buffer memory
+  std::string segment_name;
+  /// name of dispatcher input/output
+  std::string dispatcher_name;
+  /// interned id of segment_name (GstSimaaiSegmentId), resolved once with the template
+  uint32_t segment_id = 0;
+};
+
+/**
+ * @brief Graph input with its comma separated buffer names already split
+ */
+struct CvuTemplateInput {
+  /// valid `buffer-name` values of the upstream buffer
+  std::vector<std::string> valid_names;
+  /// memories of the buffer
+  std::vector<CvuTemplateMemory> memories;
+};
+
+/**
+ * @brief Compiled form of the `input_buffers`/`output_memory_order` blocks.
+ *        Built once at caps time, so per frame the job is configured only by
+ *        patching segment pointers, the frame id and the request id.
+ */
+struct CvuJobTemplate {
+  std::vector<CvuTemplateInput> inputs;
+  std::vector<CvuTemplateMemory> outputs;
+
+  /**
+   * @brief Find the input that accepts buffers with given `buffer-name`
+   * @return input index or -1 if no input accepts this name
+   */
+  int find_input(const char * buffer_name) const
+  {
+    if (buffer_name == nullptr)
+      return -1;
+
+    for (size_t i = 0; i < inputs.size(); i++)
+      for (auto & name : inputs[i].valid_names)
+        if (strcmp(name.c_str(), buffer_name) == 0)
+          return (int)i;
+
+    return -1;
+  }
+};
+
+/**
+ * @brief Job instance created from CvuJobTemplate. Dispatcher buffer entries
+ *        are created once, and their addresses are kept in slots, so frames
+ *        only overwrite the values.
+ * @tparam Job dispatcher job type with `buffers` map and `requestID`
+ */
+template <typename Job>
+struct CvuCompiledJob {
+  using Segment =
+      typename std::remove_reference<decltype(std::declval<Job &>().buffers[std::string()])>::type;
+
+  Job job;
+  /// slots of input memories, [input][memory]
+  std::vector<std::vector<Segment *>> input_slots;
+  /// slots of output memories
+  std::vector<Segment *> output_slots;
+
+  /**
+   * @brief Create dispatcher buffer entries for all memories of template
+   */
+  void compile(const CvuJobTemplate & tmpl)
+  {
+    job.buffers.clear();
+    input_slots.assign(tmpl.inputs.size(), {});
+    output_slots.clear();
+
+    for (size_t i = 0; i < tmpl.inputs.size(); i++) {
+      input_slots[i].reserve(tmpl.inputs[i].memories.size());
+      for (auto & memory : tmpl.inputs[i].memories)
+        input_slots[i].push_back(&job.buffers[memory.dispatcher_name]);
+    }
+
+    output_slots.reserve(tmpl.outputs.size());
+    for (auto & memory : tmpl.outputs)
+      output_slots.push_back(&job.buffers[memory.dispatcher_name]);
+  }
+};
+
+/**
+ * @brief Request id generator. The hash of node name and stream id is only
+ *        recomputed when the stream id changes.
+ */
+struct CvuRequestId {
+  std::string node_name;
+  std::string stream_id;
+  uint64_t base = 0;
+  bool valid = false;
+
+  uint64_t get(const char * stream, int64_t frame_id)
+  {
+    if (!valid || stream != stream_id) {
+      stream_id = stream;
+      std::string combined_id = node_name + stream_id;
+      base = (uint64_t)str_to_uint32_hash(combined_id.c_str()) << 32;
+      valid = true;
+    }
+
+    return base | (uint64_t)frame_id;
+  }
+};
+
+#endif //EVXX_JOB_TEMPLATE
@@ -44,19 +44,27 @@
 #  include "config.h"
 #endif
 
+#include <errno.h>
 #include <inttypes.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <future>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <vector>
 #include <fstream>
@@ -66,6 +74,7 @@
 
 #include <gstsimaaiallocator.h>
 #include <gstsimaaibufferpool.h>
+#include <gstsimaaimeta.h>
 #include <simaai/parser_types.h>
 #include <simaai/parser.h>
 #include <simaai/simaai_memory.h>
@@ -80,7 +89,10 @@
 
 #include "gstsimaaiprocesscvu.h"
 #include "nlohmann_helpers.h"
+#include "cvu_job_template.h"
+#include "cvu_backend.h"
 #include <simaai/trace/pipeline_new_tp.h>
+#include <utils_dispatcher.h>
 #include <utils_string.h>
 
 /**
@@ -100,6 +112,8 @@ enum {
   PROP_TRANSMIT,
   PROP_NO_OF_BUFS,
   PROP_DUMP_DATA,
+  PROP_IN_FLIGHT_JOBS,
+  PROP_BACKEND,
   PROP_UNKNONW,
 };
 
@@ -111,6 +125,8 @@ enum {
   SIMA_CPU_NUM
 };
 
+struct CvuJobContext;
+
 /* All statics go in here */
 static void gst_simaai_processcvu_set_property (GObject * obj, 
                                                 guint prop_id,
@@ -122,7 +138,7 @@ static void gst_simaai_processcvu_get_property (GObject * object,
                                                 GParamSpec * pspec);
 
 static gboolean run_processcvu (GstSimaaiProcesscvu * self, 
-                                simaaidispatcher::JobEVXX & job);
+                                CvuJobContext & ctx);
 static GstStateChangeReturn gst_simaai_processcvu_change_state (GstElement * element,
                                                            GstStateChange transition);
 static void
@@ -133,6 +149,8 @@ static gboolean gst_simaai_processcvu_propose_allocation(
 
 static gboolean gst_simaai_processcvu_decide_allocation(GstAggregator * self, GstQuery * query);
 
+static gboolean gst_simaai_processcvu_switch_pool(GstSimaaiProcesscvu * self);
+
 GST_DEBUG_CATEGORY_STATIC(gst_simaai_processcvu_debug);
 #define GST_CAT_DEFAULT gst_simaai_processcvu_debug
 
@@ -148,6 +166,35 @@ struct GraphMemory {
   size_t size;
 };
 
+/**
+ * @brief Per-frame state of a job submitted to the dispatcher. Everything the
+ *        job needs until its output is pushed downstream lives here, so that
+ *        several frames can be in flight at once.
+ */
+struct CvuJobContext {
+  /// Dispatcher job compiled from the job template
+  CvuCompiledJob<simaaidispatcher::JobEVXX> compiled;
+  /// Output buffer acquired from the pool
+  GstBuffer *outbuf;
+  /// Input buffers of this frame, held until the job is completed. The list
+  /// is owned by the context and swapped with the aggregate list on submit
+  GstBufferList *inputs;
+  /// Output simaai-memlib buffer id (phys_addr)
+  gint64 out_buffer_id;
+  /// Metadata of the input frame, forwarded to the output buffer
+  gint64 frame_id;
+  gint64 in_pcie_buf_id;
+  gboolean is_pcie;
+  GQuark stream_id;
+  guint64 timestamp;
+  /// Kernel start and end time measured in dispatcher
+  std::pair<TimePoint, TimePoint> tp;
+  /// Set by a runner thread once the dispatcher returned
+  bool done;
+  /// Result of the dispatcher run
+  gboolean result;
+};
+
 /**
  * @brief Private member structure for GstSimaaiProcesscvu instances
  */
@@ -177,13 +224,14 @@ struct _GstSimaaiProcesscvuPrivate
   /// Size of output memory chunk
   int output_size;
 
-  gint64 run_count;
+  std::atomic<gint64> run_count;
   /// Input frame id placeholder
   gint64 frame_id;
   /// Metadata fields that are not used internally, but are needed to be passed osn/
   gint64 in_pcie_buf_id;
   gboolean is_pcie;
-  std::string stream_id;
+  /// Interned stream id of the input frame
+  GQuark stream_id;
   guint64 timestamp; 
 
   /// Aggregator input buffers
@@ -194,26 +242,71 @@ struct _GstSimaaiProcesscvuPrivate
 
   /// JSON configuration file
   std::string config_file_path;
+  /// Shared config, holds the parsed view config_json points to
+  GstSimaaiConfig *config;
+  /// Config with negotiated values, the shared view when there are none
+  const nlohmann::json *config_json;
+  /// Copy of the shared view with negotiated values applied
+  nlohmann::json config_merged;
+  /// Negotiated values config_json was built with, serialized
+  std::string config_overrides;
+  /// In-memory file ConfigManager reads a config with negotiated values from
+  int config_fd;
   /// Plugin instance node name
   std::string node_name;
+  /// Interned node name, written as buffer-name of output frames
+  GQuark node_quark;
 
   /// Graph config manager
   std::unique_ptr <ConfigManager> config_manager;
+  /// Key of the config and negotiated layout config_manager and pool were
+  /// built for, 0 if none
+  guint64 layout_key;
+  /// Output pool of a new layout, built off the streaming thread
+  std::future<GstBufferPool *> pending_pool;
   /// Map of graph mempories where key is name of memory, and value is a pair
   /// where first is size and second is type of buffer 
   std::map <std::string, std::pair<unsigned int, enum bufferType>> cm_memories;
   /// Dispatcher handle
   simaaidispatcher::DispatcherBase * dispatcher;
-
-  /// A map of inputs <buffer name, buffer index in GstBufferList>
-  std::map<std::string, guint> buf_name_idx_map;
-
-  /// Start and end point of time measurement
-  std::chrono::time_point<std::chrono::steady_clock> t0, t1;
+  /// Name of backend selected by property
+  std::string backend_name;
+  /// Backend running jobs, dispatcher or host implementation of the graph
+  std::unique_ptr<CvuBackend<simaaidispatcher::JobEVXX>> backend;
+  /// Host backend in backend, possibly wrapped by the recorder, configured
+  /// again when negotiated values change
+  CvuHostBackend<simaaidispatcher::JobEVXX> *host_backend;
+
+  /// Job configuration compiled from graph_buffers at caps time
+  CvuJobTemplate job_template;
+  /// Index of each template input in GstBufferList of current frame, or -1
+  std::vector<gint> input_buffer_idx;
+  /// Request id of current stream
+  CvuRequestId request_id;
+  /// Preallocated job contexts, used in a ring of `in-flight-jobs` entries
+  std::vector<std::unique_ptr<CvuJobContext>> job_contexts;
+  guint next_job_context;
 
   std::mutex event_mtx;
-  /// Time point pair to store the kernel start and end time measured in dispatcher
-  std::pair<TimePoint, TimePoint> tp;
+
+  /// Maximum number of jobs submitted to the dispatcher at the same time
+  guint in_flight_jobs;
+  /// Jobs waiting for a runner thread
+  std::deque<CvuJobContext *> pending_jobs;
+  /// Submitted jobs in frame order, until they are pushed downstream
+  std::deque<CvuJobContext *> submitted_jobs;
+  std::mutex jobs_mtx;
+  std::condition_variable jobs_cv;
+  /// Threads blocking in dispatcher run, one per in-flight job
+  std::vector<std::thread> runner_threads;
+  /// Thread pushing completed jobs downstream in frame order
+  std::thread completion_thread;
+  bool jobs_stop;
+  /// Set from FLUSH_START to flush: jobs not run yet are skipped and outputs
+  /// are dropped
+  bool jobs_flushing;
+  /// Flow return of the last push done by the completion thread
+  GstFlowReturn completion_ret;
 
   GstSimaaiCaps *simaai_caps;
 };
@@ -228,7 +321,9 @@ G_DEFINE_TYPE_WITH_CODE ( GstSimaaiProcesscvu,
 /**
  * @brief Helper API to dump output buffer from CVU
  */
-int32_t cvu_dump_output_buffer (GstSimaaiProcesscvu * self, uint32_t id)
+int32_t cvu_dump_output_buffer (GstSimaaiProcesscvu * self,
+                                GstBuffer * buffer,
+                                uint32_t id)
 {
   FILE *ofp;
   char full_opath[256];
@@ -244,9 +339,9 @@ int32_t cvu_dump_output_buffer (GstSimaaiProcesscvu * self, uint32_t id)
     return -1;
 
   GstMapInfo map;
-  gst_buffer_map(self->priv->outbuf, &map, GST_MAP_READ);
+  gst_buffer_map(buffer, &map, GST_MAP_READ);
   fwrite((char *)(map.data), 1, map.size, ofp);
-  gst_buffer_unmap(self->priv->outbuf, &map);
+  gst_buffer_unmap(buffer, &map);
   
   fclose(ofp);
 
@@ -260,64 +355,44 @@ int32_t cvu_dump_output_buffer (GstSimaaiProcesscvu * self, uint32_t id)
 static gboolean gst_simaai_processcvu_add2list (GstSimaaiProcesscvu * self, 
                                                 GValue * value)
 {
-  gint64 buf_id = 0;
-  gint64 frame_id = 0;
-  gint64 in_buf_offset = 0;
-  gint64 in_pcie_buf_id = 0;
-
   GstAggregatorPad * pad = (GstAggregatorPad *) g_value_get_object (value);
   GstBuffer * buf = gst_aggregator_pad_peek_buffer (pad);
 
   if (buf) {
-    GstCustomMeta * meta;
-    GstStructure * s;
-    std::string buf_name;
-    gchar * stream_id;
-    guint64 timestamp = 0;
+    GstSimaaiFrameInfo info;
 
     buf = gst_aggregator_pad_pop_buffer(pad);
-    meta = gst_buffer_get_custom_meta(buf, SIMAAI_META_STR);
-    if (meta != NULL) {
-      s = gst_custom_meta_get_structure(meta);
-      if (s == NULL) {
-        gst_buffer_unref(buf);
-        GST_OBJECT_UNLOCK (self);
-        return GST_FLOW_ERROR;
-      } else {
-        if ((gst_structure_get_int64(s, "pcie-buffer-id", &in_pcie_buf_id) == TRUE))
-        {
-          self->priv->in_pcie_buf_id = in_pcie_buf_id;
-          self->priv->is_pcie = TRUE;
-          GST_DEBUG_OBJECT(self, 
-                            "pcie-buffer-id = %ld", 
-                            in_pcie_buf_id);
-        }
-        if ((gst_structure_get_int64(s, "buffer-id", &buf_id) == TRUE) &&
-            (gst_structure_get_int64(s, "frame-id", &frame_id) == TRUE) &&
-            (gst_structure_get_int64(s, "buffer-offset", &in_buf_offset) == TRUE) &&
-            (gst_structure_get_uint64(s, "timestamp", &timestamp) == TRUE))
-        {
-          self->priv->stream_id = gst_structure_get_string(s, "stream-id");
-          buf_name = (char *)gst_structure_get_string(s, "buffer-name");
-          self->priv->frame_id = frame_id;
-          self->priv->timestamp = timestamp;
-          gst_buffer_list_add(self->priv->list, buf);
-
-          self->priv->buf_name_idx_map[buf_name] = gst_buffer_list_length(self->priv->list)-1;
-
-          GST_DEBUG_OBJECT(self, 
-                            "Copied metadata, [%s]:[%ld]:[%ld],"
-                            " buffer list length: %d,"
-                            " stream-id: %s, timestamp: %ld",
-                            buf_name.c_str(), 
-                            frame_id, 
-                            in_buf_offset, 
-                            gst_buffer_list_length(self->priv->list),
-                            self->priv->stream_id.c_str(),
-                            self->priv->timestamp);
-        }
+    if (gst_buffer_get_simaai_frame_info(buf, &info)) {
+      if (info.flags & GST_SIMAAI_FRAME_META_FLAG_PCIE) {
+        self->priv->in_pcie_buf_id = info.pcie_buffer_id;
+        self->priv->is_pcie = TRUE;
+        GST_DEBUG_OBJECT(self, 
+                          "pcie-buffer-id = %ld", 
+                          info.pcie_buffer_id);
       }
+
+      self->priv->stream_id = info.stream_id;
+      self->priv->frame_id = info.frame_id;
+      self->priv->timestamp = info.timestamp;
+      gst_buffer_list_add(self->priv->list, buf);
+
+      const gchar * buf_name = gst_simaai_frame_info_get_buffer_name(&info);
+      gint input = self->priv->job_template.find_input(buf_name);
+      if (input >= 0)
+        self->priv->input_buffer_idx[input] = gst_buffer_list_length(self->priv->list)-1;
+
+      GST_DEBUG_OBJECT(self, 
+                        "Copied metadata, [%s]:[%ld]:[%ld],"
+                        " buffer list length: %d,"
+                        " stream-id: %s, timestamp: %ld",
+                        buf_name, 
+                        info.frame_id, 
+                        info.buffer_offset, 
+                        gst_buffer_list_length(self->priv->list),
+                        gst_simaai_frame_info_get_stream_id(&info),
+                        self->priv->timestamp);
     } else {
+      gst_buffer_unref(buf);
       GST_ERROR_OBJECT (self, "Please check readme to use metadata information,"
                         " meta not found");
       return FALSE;
@@ -330,47 +405,54 @@ static gboolean gst_simaai_processcvu_add2list (GstSimaaiProcesscvu * self,
   return TRUE;
 }
 
+/**
+ * @brief Helper API to release input buffers collected by aggregate
+ */
+static void gst_simaai_processcvu_clean_buffer_list (GstBufferList * list)
+{
+  guint no_of_inbufs = gst_buffer_list_length(list);
+  for (guint i = 0; i < no_of_inbufs ; ++i)
+    gst_buffer_unref(gst_buffer_list_get(list, i));
+  gst_buffer_list_remove(list, 0 , no_of_inbufs);
+}
+
 /**
  * @brief Helper API to update output metadata information
  */
 static gboolean gst_simaai_processcvu_buffer_update_metainfo(GstSimaaiProcesscvu * self, 
+                                                             const CvuJobContext & ctx,
                                                              GstBuffer * buffer)
 {
-  GstCustomMeta * meta = gst_buffer_add_custom_meta(buffer, SIMAAI_META_STR);
-  if (meta == NULL) {
-    GST_ERROR_OBJECT (self, "Unable to add metadata info to the buffer");
-    return FALSE;
+  GstSimaaiFrameInfo info = {};
+
+  GST_DEBUG_OBJECT(self, 
+                    "[%s]Adding SiMa metadata to buffer: "
+                    "buffer-id=%ld buffer-name=%s "
+                    "buffer-offset-%d frame-id=%ld",
+                    self->priv->node_name.c_str(), 
+                    ctx.out_buffer_id,
+                    self->priv->node_name.c_str(), 
+                    0, 
+                    ctx.frame_id);
+
+  info.buffer_id = ctx.out_buffer_id;
+  info.buffer_name = self->priv->node_quark;
+  info.buffer_offset = 0;
+  info.frame_id = ctx.frame_id;
+  info.stream_id = ctx.stream_id;
+  info.timestamp = ctx.timestamp;
+
+  // Update PCIe related metadata if exists
+  if (ctx.is_pcie) {
+    GST_DEBUG_OBJECT (self, "[%s]Adding SiMa sPCIe metadata to buffer", 
+                      self->priv->node_name.c_str());
+    info.pcie_buffer_id = ctx.in_pcie_buf_id;
+    info.flags |= GST_SIMAAI_FRAME_META_FLAG_PCIE;
   }
 
-  GstStructure *s = gst_custom_meta_get_structure (meta); 
-
-  if (s != NULL) {
-    GST_DEBUG_OBJECT(self, 
-                      "[%s]Adding SiMa metadata to buffer: "
-                      "buffer-id=%ld buffer-name=%s "
-                      "buffer-offset-%d frame-id=%ld",
-                      self->priv->node_name.c_str(), 
-                      self->priv->out_buffer_id,
-                      self->priv->node_name.c_str(), 
-                      0, 
-                      self->priv->frame_id);
-    gst_structure_set (s,
-                       "buffer-id", G_TYPE_INT64, self->priv->out_buffer_id,
-                       "buffer-name", G_TYPE_STRING, self->priv->node_name.c_str(),
-                       "buffer-offset", G_TYPE_INT64, (gint64)0,
-                       "frame-id", G_TYPE_INT64, self->priv->frame_id,
-                       "stream-id", G_TYPE_STRING, self->priv->stream_id.c_str(),
-                       "timestamp", G_TYPE_UINT64, self->priv->timestamp,
-                       NULL);
-    
-    // Update PCIe related metadata if exists
-    if (self->priv->is_pcie)
-    {
-      GST_DEBUG_OBJECT (self, "[%s]Adding SiMa sPCIe metadata to buffer", 
-                        self->priv->node_name.c_str());
-      gst_structure_set(s, "pcie-buffer-id", G_TYPE_INT64, 
-                        self->priv->in_pcie_buf_id, NULL);
-    }
+  if (gst_buffer_add_simaai_frame_meta(buffer, &info) == NULL) {
+    GST_ERROR_OBJECT (self, "Unable to add metadata info to the buffer");
+    return FALSE;
   }
 
   return TRUE;
@@ -418,106 +500,317 @@ std::vector<std::string> split_string(const std::string &s, char delimiter)
 }
 
 /**
- * @brief Helper API to create EVXX job for particular plugin
+ * @brief Helper API to build job template and job contexts from graph
+ *        buffers. Called when ConfigManager is (re)created.
+ */
+static void gst_simaai_processcvu_compile_job_template (GstSimaaiProcesscvu * self)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+  CvuJobTemplate & tmpl = priv->job_template;
+
+  tmpl.inputs.clear();
+  tmpl.outputs.clear();
+
+  for (auto& [ json_bufname, buf_memories ] : priv->graph_buffers) {
+    std::vector<CvuTemplateMemory> memories;
+    memories.reserve(buf_memories.size());
+    for (auto & memory : buf_memories)
+      memories.push_back({ memory.memory_name, memory.dispatcher_name,
+                           gst_simaai_segment_id_from_name(memory.memory_name.c_str()) });
+
+    if (json_bufname == priv->node_name) {
+      tmpl.outputs = std::move(memories);
+    } else {
+      // parse the valid buffer names provided for this buffer once
+      tmpl.inputs.push_back({ split_string(json_bufname, ','), std::move(memories) });
+    }
+  }
+
+  priv->input_buffer_idx.assign(tmpl.inputs.size(), -1);
+  priv->request_id.node_name = priv->node_name;
+  priv->request_id.valid = false;
+
+  // one context per job that can be in flight, old contexts are not in use
+  for (auto & ctx : priv->job_contexts)
+    gst_buffer_list_unref(ctx->inputs);
+  priv->job_contexts.clear();
+  priv->next_job_context = 0;
+
+  for (guint i = 0; i < MAX(priv->in_flight_jobs, 1u); i++) {
+    std::unique_ptr<CvuJobContext> ctx(new CvuJobContext);
+    ctx->compiled.compile(tmpl);
+    ctx->compiled.job.graphID = priv->config_manager->getPipelineConfig().graphId;
+    ctx->compiled.job.cm = priv->config_manager.get();
+    ctx->compiled.job.timeout = std::chrono::seconds(60);
+    ctx->inputs = gst_buffer_list_new();
+    ctx->outbuf = nullptr;
+    priv->job_contexts.push_back(std::move(ctx));
+  }
+
+  GST_DEBUG_OBJECT(self, "Compiled job template: %zu inputs, %zu outputs, %zu contexts",
+                   tmpl.inputs.size(), tmpl.outputs.size(), priv->job_contexts.size());
+}
+
+/**
+ * @brief Helper API to create EVXX job for particular plugin. Patches the
+ *        segments of current input and output buffers into compiled job.
  */
 bool gst_simaai_processcvu_configure_job (GstSimaaiProcesscvu * self,
-                                          simaaidispatcher::JobEVXX & job)
+                                          CvuCompiledJob<simaaidispatcher::JobEVXX> & compiled,
+                                          GstBuffer * outbuf)
 {
-  // configure a job
-  job.graphID = self->priv->config_manager->getPipelineConfig().graphId;
-  job.cm = self->priv->config_manager.get();
-  job.timeout = std::chrono::seconds(60);
+  const CvuJobTemplate & tmpl = self->priv->job_template;
 
-  std::string combined_id = self->priv->node_name + self->priv->stream_id;
-  job.requestID = ((uint64_t)str_to_uint32_hash(combined_id.c_str()) << 32) | self->priv->frame_id;
+  compiled.job.requestID = self->priv->request_id.get(GST_SIMAAI_QUARK_STR(self->priv->stream_id),
+                                                      self->priv->frame_id);
 
-  // add memories
-  GstBuffer * buffer;
   GstMemory * buffer_mem;
   // add input memories
-  for (auto& [ json_bufname, buf_memories ] : self->priv->graph_buffers) {
-    std::string buf_name;
-
-    // if buffer is output buffer - continue. Only inputs updated here
-    if (json_bufname == self->priv->node_name)
-      continue;
+  for (size_t i = 0; i < tmpl.inputs.size(); i++) {
+    const CvuTemplateInput & input = tmpl.inputs[i];
+    gint idx = self->priv->input_buffer_idx[i];
 
-    // parse the valid buffer names provided for this buffer
-    std::vector<std::string> valid_buf_names = split_string(json_bufname, ',');
-  
-    // find buffer which name correspond to one of valid names provided by json
-    for (auto & name : valid_buf_names) {
-      auto & buf_name_idx_map = self->priv->buf_name_idx_map;
-      if (buf_name_idx_map.find(name) != buf_name_idx_map.end()) {
-        buf_name = name;
-        buffer = gst_buffer_list_get (self->priv->list,
-                                      self->priv->buf_name_idx_map[buf_name]);
-      }
-    }
-
-    if (buf_name.empty()) {
+    if (idx < 0) {
       GST_ERROR_OBJECT(self, "No input buffer, that correspond valid names: %s",
-                              json_bufname.c_str());
+                              input.valid_names.empty() ? "" : input.valid_names[0].c_str());
       return false;
     }
 
-    buffer_mem = gst_buffer_peek_memory(buffer, 0);
+    buffer_mem = gst_buffer_peek_memory(gst_buffer_list_get(self->priv->list, idx), 0);
     if (!buffer_mem) {
-      GST_ERROR_OBJECT (self, "Can not peak a memory from buffer %s", 
-                        buf_name.c_str());
+      GST_ERROR_OBJECT (self, "Can not peak a memory from input buffer %d", idx);
       return false;
     }
 
-    for (auto & memory : buf_memories) {
-      simaai_memory_t * seg_ptr = nullptr;
-      seg_ptr = (simaai_memory_t *) gst_simaai_memory_get_segment(buffer_mem,
-                                          (gchar*)(memory.memory_name.c_str()));
-      if (seg_ptr) {
-        job.buffers[memory.dispatcher_name] = seg_ptr;
-      } else {
-        GST_ERROR_OBJECT (self, "Failed to get memory with name %s from buffer %s. "
+    for (size_t j = 0; j < input.memories.size(); j++) {
+      const CvuTemplateMemory & memory = input.memories[j];
+      simaai_memory_t * seg_ptr = (simaai_memory_t *)
+          gst_simaai_memory_get_segment_by_id(buffer_mem, memory.segment_id);
+      if (seg_ptr == nullptr) {
+        GST_ERROR_OBJECT (self, "Failed to get memory with name %s from input %d. "
                                 "Either segment with requested name is not in "
                                 "input memory, or memory was allocated without "
                                 "using segment allocator",
-                                memory.memory_name.c_str(), buf_name.c_str());
+                                memory.segment_name.c_str(), idx);
         return false;
       }
-      GST_DEBUG_OBJECT (self, "Added memory with name %s as dispatcher input %s "
-                              "from buffer %s (addr: %p)",
-                              memory.memory_name.c_str(),
-                              memory.dispatcher_name.c_str(), 
-                              buf_name.c_str(),
-                              seg_ptr);
+      *compiled.input_slots[i][j] = seg_ptr;
     }
   }
 
   // add output buffer to job
-  buffer_mem = gst_buffer_peek_memory(self->priv->outbuf, 0);
-  auto & buf_memories = self->priv->graph_buffers[self->priv->node_name];
+  buffer_mem = gst_buffer_peek_memory(outbuf, 0);
   if (!buffer_mem) {
     GST_ERROR_OBJECT(self, "Can not peak a memory from output buffer");
     return false;
   }
 
-  for (auto & memory : buf_memories) {        
-    simaai_memory_t * seg_ptr = nullptr;
-      seg_ptr = (simaai_memory_t *) gst_simaai_memory_get_segment(buffer_mem,
-                                          (gchar*)(memory.memory_name.c_str()));
-      if (seg_ptr) {
-        GST_DEBUG_OBJECT (self, "Segment %s addr: %p", 
-                          memory.dispatcher_name.c_str(), seg_ptr);
-        job.buffers[memory.dispatcher_name] = seg_ptr;
-      }
-      GST_DEBUG_OBJECT (self, "Added memory with name %s as dispatcher output %s "
-                              "(addr: %p)",
-                              memory.memory_name.c_str(),
-                              memory.dispatcher_name.c_str(), 
-                              seg_ptr);
+  for (size_t j = 0; j < tmpl.outputs.size(); j++) {
+    simaai_memory_t * seg_ptr = (simaai_memory_t *)
+        gst_simaai_memory_get_segment_by_id(buffer_mem, tmpl.outputs[j].segment_id);
+    // a stale slot would make the graph write into another frame's buffer
+    if (seg_ptr == nullptr) {
+      GST_ERROR_OBJECT (self, "Failed to get memory with name %s from output buffer. "
+                              "Either segment with requested name is not in "
+                              "output memory, or memory was allocated without "
+                              "using segment allocator",
+                              tmpl.outputs[j].segment_name.c_str());
+      return false;
+    }
+    *compiled.output_slots[j] = seg_ptr;
   }
 
   return true;
 }
 
+/**
+ * @brief Runner thread. Takes pending jobs and blocks in the dispatcher until
+ *        the EVXX returns, so up to `in-flight-jobs` frames run concurrently.
+ */
+static void gst_simaai_processcvu_runner_loop (GstSimaaiProcesscvu * self)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+
+  while (true) {
+    CvuJobContext * ctx = nullptr;
+    bool flushing;
+    {
+      std::unique_lock<std::mutex> lk(priv->jobs_mtx);
+      priv->jobs_cv.wait(lk, [priv] {
+        return priv->jobs_stop || !priv->pending_jobs.empty();
+      });
+      if (priv->pending_jobs.empty())
+        return;
+      ctx = priv->pending_jobs.front();
+      priv->pending_jobs.pop_front();
+      flushing = priv->jobs_flushing;
+    }
+
+    gboolean result = flushing ? FALSE : run_processcvu(self, *ctx);
+
+    {
+      const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+      ctx->result = result;
+      ctx->done = true;
+    }
+    priv->jobs_cv.notify_all();
+  }
+}
+
+/**
+ * @brief Completion thread. Waits for the oldest submitted job and pushes its
+ *        output downstream, which keeps the output in frame order regardless
+ *        of the order the dispatcher completes jobs in.
+ */
+static void gst_simaai_processcvu_completion_loop (GstSimaaiProcesscvu * self)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+
+  while (true) {
+    CvuJobContext * ctx = nullptr;
+    bool flushing;
+    {
+      std::unique_lock<std::mutex> lk(priv->jobs_mtx);
+      priv->jobs_cv.wait(lk, [priv] {
+        return (priv->jobs_stop && priv->submitted_jobs.empty()) ||
+               (!priv->submitted_jobs.empty() && priv->submitted_jobs.front()->done);
+      });
+      if (priv->submitted_jobs.empty())
+        return;
+      ctx = priv->submitted_jobs.front();
+      flushing = priv->jobs_flushing;
+    }
+
+    GstFlowReturn ret = GST_FLOW_OK;
+    if (flushing) {
+      gst_buffer_unref(ctx->outbuf);
+      ret = GST_FLOW_FLUSHING;
+    } else if (ctx->result != TRUE) {
+      GST_ERROR_OBJECT (self, "Unable to run processcvu for frame %ld, drop and continue",
+                        ctx->frame_id);
+      gst_buffer_unref(ctx->outbuf);
+      ret = GST_FLOW_ERROR;
+    } else if (!gst_simaai_processcvu_buffer_update_metainfo(self, *ctx, ctx->outbuf)) {
+      GST_ERROR_OBJECT (self, "Unable to update metadata for frame %ld", ctx->frame_id);
+      gst_buffer_unref(ctx->outbuf);
+      ret = GST_FLOW_ERROR;
+    } else {
+      ret = gst_aggregator_finish_buffer (GST_AGGREGATOR (self), ctx->outbuf);
+    }
+
+    gst_simaai_processcvu_clean_buffer_list(ctx->inputs);
+
+    {
+      // job leaves the queue only after its push, so draining waits for it
+      const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+      priv->submitted_jobs.pop_front();
+      if (ret != GST_FLOW_OK && priv->completion_ret == GST_FLOW_OK)
+        priv->completion_ret = ret;
+    }
+    priv->jobs_cv.notify_all();
+  }
+}
+
+/**
+ * @brief Helper API to start runner and completion threads when more than one
+ *        job is allowed in flight
+ */
+static void gst_simaai_processcvu_start_jobs_threads (GstSimaaiProcesscvu * self)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+
+  if (priv->in_flight_jobs <= 1 || priv->completion_thread.joinable())
+    return;
+
+  if (priv->num_of_out_buf < priv->in_flight_jobs + 1)
+    GST_WARNING_OBJECT (self, "num-buffers (%u) should be greater than "
+                              "in-flight-jobs (%u), submission will stall on "
+                              "the buffer pool",
+                              priv->num_of_out_buf, priv->in_flight_jobs);
+
+  priv->jobs_stop = false;
+  priv->jobs_flushing = false;
+  priv->completion_ret = GST_FLOW_OK;
+  for (guint i = 0; i < priv->in_flight_jobs; i++)
+    priv->runner_threads.emplace_back(gst_simaai_processcvu_runner_loop, self);
+  priv->completion_thread = std::thread(gst_simaai_processcvu_completion_loop, self);
+
+  GST_DEBUG_OBJECT (self, "Started %u runner threads", priv->in_flight_jobs);
+}
+
+/**
+ * @brief Helper API to stop runner and completion threads. Jobs that are
+ *        already submitted are run and completed before threads exit.
+ */
+static void gst_simaai_processcvu_stop_jobs_threads (GstSimaaiProcesscvu * self)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+
+  if (!priv->completion_thread.joinable())
+    return;
+
+  {
+    const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+    priv->jobs_stop = true;
+  }
+  priv->jobs_cv.notify_all();
+
+  for (auto & thread : priv->runner_threads)
+    thread.join();
+  priv->runner_threads.clear();
+  priv->completion_thread.join();
+
+  GST_DEBUG_OBJECT (self, "Stopped runner threads");
+}
+
+/**
+ * @brief Helper API to wait until all submitted jobs are pushed downstream
+ */
+static void gst_simaai_processcvu_drain_jobs (GstSimaaiProcesscvu * self)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+
+  std::unique_lock<std::mutex> lk(priv->jobs_mtx);
+  priv->jobs_cv.wait(lk, [priv] { return priv->submitted_jobs.empty(); });
+}
+
+/**
+ * @brief Helper API to wait until less than `in-flight-jobs` jobs are
+ *        submitted. The oldest job context is free after that.
+ * @return FALSE if threads are stopping
+ */
+static gboolean gst_simaai_processcvu_wait_job_slot (GstSimaaiProcesscvu * self)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+
+  std::unique_lock<std::mutex> lk(priv->jobs_mtx);
+  priv->jobs_cv.wait(lk, [priv] {
+    return priv->jobs_stop || priv->submitted_jobs.size() < priv->in_flight_jobs;
+  });
+
+  return priv->jobs_stop ? FALSE : TRUE;
+}
+
+/**
+ * @brief Helper API to submit a configured job to runner threads
+ */
+static GstFlowReturn gst_simaai_processcvu_submit_job (GstSimaaiProcesscvu * self,
+                                                       CvuJobContext * ctx)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+
+  {
+    const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+    priv->pending_jobs.push_back(ctx);
+    priv->submitted_jobs.push_back(ctx);
+    GST_DEBUG_OBJECT (self, "Submitted frame %ld, jobs in flight: %zu",
+                      ctx->frame_id, priv->submitted_jobs.size());
+  }
+  priv->jobs_cv.notify_all();
+
+  return GST_FLOW_OK;
+}
+
 /**
  * @brief Aggregate callback registered to be called when buffers are ready to 
  *        be used by the plugin from different sources
@@ -534,15 +827,16 @@ static GstFlowReturn gst_simaai_processcvu_aggregate (GstAggregator * aggregator
   gint64 frame_id = 0, in_buf_offset = 0;
 
   GstSimaaiProcesscvu *self = GST_SIMAAI_PROCESSCVU (aggregator);
-  
-  auto clean_buffer_list = [](GstBufferList * list) {
-    guint no_of_inbufs = gst_buffer_list_length(list);
-    for (guint i = 0; i < no_of_inbufs ; ++i)
-      gst_buffer_unref(gst_buffer_list_get(list, i));
-    gst_buffer_list_remove(list, 0 , no_of_inbufs);
-  };
 
-  self->priv->buf_name_idx_map.clear();
+  if (self->priv->in_flight_jobs > 1) {
+    // report failures of previously submitted jobs
+    const std::lock_guard<std::mutex> lk(self->priv->jobs_mtx);
+    if (self->priv->completion_ret != GST_FLOW_OK)
+      return self->priv->completion_ret;
+  }
+
+  std::fill(self->priv->input_buffer_idx.begin(),
+            self->priv->input_buffer_idx.end(), -1);
 
   iter = gst_element_iterate_sink_pads (GST_ELEMENT (self));
   while (!done_iterating) {
@@ -573,6 +867,12 @@ static GstFlowReturn gst_simaai_processcvu_aggregate (GstAggregator * aggregator
 
   gst_iterator_free (iter);
 
+  if (G_UNLIKELY (self->priv->pending_pool.valid()) &&
+      !gst_simaai_processcvu_switch_pool(self)) {
+    gst_simaai_processcvu_clean_buffer_list(self->priv->list);
+    return GST_FLOW_ERROR;
+  }
+
   GstFlowReturn ret = gst_buffer_pool_acquire_buffer(self->priv->pool,
                                                      &self->priv->outbuf, NULL);
 
@@ -583,34 +883,67 @@ static GstFlowReturn gst_simaai_processcvu_aggregate (GstAggregator * aggregator
       gst_buffer_peek_memory(self->priv->outbuf, 0));
   } else {
     GST_ERROR_OBJECT (self, "Failed to allocate buffer");
-    clean_buffer_list(self->priv->list);
+    gst_simaai_processcvu_clean_buffer_list(self->priv->list);
     return GST_FLOW_ERROR;
   }
 
-  simaaidispatcher::JobEVXX job;
-  if (!gst_simaai_processcvu_configure_job(self, job)) {
+  if (G_UNLIKELY (self->priv->job_contexts.empty())) {
+    GST_ERROR_OBJECT (self, "Job template is not compiled, caps are not negotiated");
+    gst_simaai_processcvu_clean_buffer_list(self->priv->list);
+    gst_buffer_unref(self->priv->outbuf);
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  if (self->priv->in_flight_jobs > 1 && !gst_simaai_processcvu_wait_job_slot(self)) {
+    gst_simaai_processcvu_clean_buffer_list(self->priv->list);
+    gst_buffer_unref(self->priv->outbuf);
+    return GST_FLOW_FLUSHING;
+  }
+
+  // contexts are completed in order, so the next one in the ring is free
+  CvuJobContext * ctx = self->priv->job_contexts[self->priv->next_job_context].get();
+  self->priv->next_job_context =
+      (self->priv->next_job_context + 1) % self->priv->job_contexts.size();
+
+  if (!gst_simaai_processcvu_configure_job(self, ctx->compiled, self->priv->outbuf)) {
     GST_ERROR_OBJECT (self, "Failed to configure job");
-    clean_buffer_list(self->priv->list);
+    gst_simaai_processcvu_clean_buffer_list(self->priv->list);
+    gst_buffer_unref(self->priv->outbuf);
     return GST_FLOW_ERROR;
   }
 
+  ctx->outbuf = self->priv->outbuf;
+  ctx->out_buffer_id = self->priv->out_buffer_id;
+  ctx->frame_id = self->priv->frame_id;
+  ctx->in_pcie_buf_id = self->priv->in_pcie_buf_id;
+  ctx->is_pcie = self->priv->is_pcie;
+  ctx->stream_id = self->priv->stream_id;
+  ctx->timestamp = self->priv->timestamp;
+  ctx->done = false;
+  ctx->result = FALSE;
+
+  if (self->priv->in_flight_jobs > 1) {
+    // job keeps its inputs, aggregate continues with the emptied list of job
+    std::swap(ctx->inputs, self->priv->list);
+    self->priv->outbuf = nullptr;
+    return gst_simaai_processcvu_submit_job(self, ctx);
+  }
+
   /* Run processcvu here */
-  if (run_processcvu(self, job) != TRUE) {
+  if (run_processcvu(self, *ctx) != TRUE) {
     GST_ERROR_OBJECT (self, "Unable to run processcvu, drop and continue");
     return GST_FLOW_ERROR;
   }
 
-  if (!gst_simaai_processcvu_buffer_update_metainfo(self, self->priv->outbuf)) {
+  if (!gst_simaai_processcvu_buffer_update_metainfo(self, *ctx, ctx->outbuf)) {
     GST_ERROR_OBJECT (self, "Unable to run processcvu, drop and continue");
     return GST_FLOW_ERROR;
   }
 
   /* Clear input buffer list */
-  clean_buffer_list(self->priv->list);
+  gst_simaai_processcvu_clean_buffer_list(self->priv->list);
 
-  gst_aggregator_finish_buffer (aggregator, self->priv->outbuf);
-
-  return GST_FLOW_OK;
+  return gst_aggregator_finish_buffer (aggregator, ctx->outbuf);
 }
 
 /**
@@ -652,6 +985,19 @@ static void gst_simaai_processcvu_set_property (GObject * object,
       GST_DEBUG_OBJECT (self, "DumpData argument was changed to = %s", 
                         bool_res.c_str());
       break;
+    case PROP_BACKEND:
+      self->priv->backend_name = g_value_get_string(value);
+      GST_DEBUG_OBJECT(self, "backend argument was changed to %s",
+                       self->priv->backend_name.c_str());
+      break;
+    case PROP_IN_FLIGHT_JOBS:
+      self->priv->in_flight_jobs = g_value_get_uint(value);
+      GST_DEBUG_OBJECT(self, "InFlightJobs argument was changed to %u",
+                        self->priv->in_flight_jobs);
+      // property is mutable in READY only, so no job context is in use
+      if (!self->priv->job_contexts.empty())
+        gst_simaai_processcvu_compile_job_template(self);
+      break;
     default:
       GST_DEBUG_OBJECT(self, "Default case warning");
       G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -685,6 +1031,12 @@ static void gst_simaai_processcvu_get_property (GObject * object,
     case PROP_DUMP_DATA:
       g_value_set_boolean(value, self->priv->dump_data);
       break;
+    case PROP_BACKEND:
+      g_value_set_string(value, self->priv->backend_name.c_str());
+      break;
+    case PROP_IN_FLIGHT_JOBS:
+      g_value_set_uint(value, self->priv->in_flight_jobs);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
       break;
@@ -752,70 +1104,261 @@ static GstSimaaiMemoryFlags get_mem_target (GstSimaaiProcesscvu * self) {
   return result;
 }
 
+/**
+ * @brief Wait for the pool built in the background and make it current. The
+ *        previous pool stays active until then.
+ */
+static gboolean gst_simaai_processcvu_switch_pool(GstSimaaiProcesscvu * self)
+{
+  if (!self->priv->pending_pool.valid())
+    return self->priv->pool != nullptr;
+
+  GstBufferPool * pool = self->priv->pending_pool.get();
+  if (pool == nullptr) {
+    GST_ERROR_OBJECT (self, "Failed to allocate buffer pool");
+    return FALSE;
+  }
+
+  // outputs of jobs in flight come from the previous pool, it is deactivated
+  // once they are pushed. Buffers still downstream are freed when released
+  gst_simaai_processcvu_drain_jobs(self);
+  if (self->priv->pool != nullptr)
+    gst_simaai_free_buffer_pool(self->priv->pool);
+  self->priv->pool = pool;
+
+  GST_DEBUG_OBJECT (self, "Output buffer pool: %d buffers of size %d",
+                      self->priv->num_of_out_buf, self->priv->output_size);
+  return TRUE;
+}
+
 /**
  * @brief helper function to free allocated output memory
  */
 static void gst_simaai_processcvu_free_memory(GstSimaaiProcesscvu * self)
 {
+  if (self->priv->pending_pool.valid()) {
+    GstBufferPool * pool = self->priv->pending_pool.get();
+    if (pool != nullptr)
+      gst_simaai_free_buffer_pool(pool);
+  }
+
   if (self->priv->pool != nullptr)
     if (gst_simaai_free_buffer_pool(self->priv->pool));
       self->priv->pool = nullptr;
+
+  self->priv->layout_key = 0;
 }
 
 /**
- * @brief helper function to allocate output memory
+ * @brief helper function to allocate output memory. The pool is allocated
+ *        and activated in the background, the first output buffer waits for
+ *        it in gst_simaai_processcvu_switch_pool(), which also retires the
+ *        pool of the previous layout.
  */
 static gboolean gst_simaai_processcvu_allocate_memory(GstSimaaiProcesscvu * self)
 {
-  // if buffer pool is already allocated - deactivate and free
-  if (self->priv->pool)
-    gst_simaai_free_buffer_pool(self->priv->pool);
+  // a pool of a layout never used is not needed anymore
+  if (self->priv->pending_pool.valid()) {
+    GstBufferPool * pool = self->priv->pending_pool.get();
+    if (pool != nullptr)
+      gst_simaai_free_buffer_pool(pool);
+  }
 
   auto & output_memories = self->priv->graph_buffers[self->priv->node_name];
-  int number_of_segments = output_memories.size();
-  // array of segments sizes
-  gsize * segment_sizes = (gsize *) calloc(number_of_segments, sizeof(gsize));
-  // arrary of segments names
-  gchar ** segment_names = (gchar **)calloc(number_of_segments, sizeof(gchar *));
-
-  if (segment_sizes == nullptr || segment_names == nullptr) {
-    GST_ERROR_OBJECT(self, "Failed to allocate intermediate segments buffers");
-    return FALSE;
-  }
-  
+  std::vector<gsize> segment_sizes;
+  std::vector<std::string> segment_names;
+  segment_sizes.reserve(output_memories.size());
+  segment_names.reserve(output_memories.size());
+
   // fill in all memory sizes and names
-  int i = 0;
   for (auto & memory : output_memories) {
-    segment_sizes[i] = memory.size;
-    segment_names[i++] = (gchar *)(memory.dispatcher_name.c_str());
+    segment_sizes.push_back(memory.size);
+    segment_names.push_back(memory.dispatcher_name);
   }
 
   GstMemoryFlags flags = static_cast<GstMemoryFlags>(get_mem_target(self)
                                              | GST_SIMAAI_MEMORY_FLAG_CACHED);
+  guint num_of_out_buf = self->priv->num_of_out_buf;
+
+  self->priv->pending_pool = std::async(std::launch::async,
+      [self, flags, num_of_out_buf, segment_sizes, segment_names]() {
+    std::vector<const gchar *> names;
+    for (auto & name : segment_names)
+      names.push_back(name.c_str());
+
+    return gst_simaai_allocate_buffer_pool2((GstObject*) self,
+                                            gst_simaai_memory_get_segment_allocator(),
+                                            MIN_POOL_SIZE,
+                                            num_of_out_buf,
+                                            flags, segment_sizes.size(),
+                                            segment_sizes.data(),
+                                            names.data());
+  });
 
-  self->priv->pool = 
-      gst_simaai_allocate_buffer_pool2((GstObject*) self, 
-                                        gst_simaai_memory_get_segment_allocator(), 
-                                        MIN_POOL_SIZE, 
-                                        self->priv->num_of_out_buf,
-                                        flags, number_of_segments,
-                                        segment_sizes, 
-                                        const_cast<const char**>(segment_names));
+  return TRUE;
+}
 
-  free (segment_sizes);
-  free (segment_names);
+/**
+ * @brief Key of the negotiated layout: config with negotiated values applied,
+ *        negotiated dims and the number of output buffers.
+ */
+static guint64 gst_simaai_processcvu_layout_key(GstSimaaiProcesscvu * self,
+                                                 GstEvent * event)
+{
+  GstCaps * caps = nullptr;
+  gst_event_parse_caps(event, &caps);
+
+  std::string layout;
+  GstStructure * s = caps ? gst_caps_get_structure(caps, 0) : nullptr;
+  if (s != nullptr) {
+    gint width = 0, height = 0;
+    gst_structure_get_int(s, "width", &width);
+    gst_structure_get_int(s, "height", &height);
+    const gchar * format = gst_structure_get_string(s, "format");
+    layout = std::string(gst_structure_get_name(s)) + ":" + std::to_string(width) +
+             "x" + std::to_string(height) + ":" + (format ? format : "");
+  }
+  layout += ":" + std::to_string(self->priv->num_of_out_buf);
 
-  if (self->priv->pool == nullptr) {
-    GST_ERROR_OBJECT (self, "Failed to allocate buffer pool");
+  // the file is fixed for the element, only negotiated values change
+  layout += ":" + self->priv->config_file_path + ":" + self->priv->config_overrides;
+
+  // FNV-1a
+  guint64 key = 14695981039346656037ull;
+  for (unsigned char c : layout) {
+    key ^= c;
+    key *= 1099511628211ull;
+  }
+
+  return key ? key : 1;
+}
+
+/**
+ * @brief nlohmann view of a shared config, parsed once for all processcvu
+ *        elements using the same file and kept with the config.
+ */
+static const nlohmann::json * gst_simaai_processcvu_config_view(GstSimaaiProcesscvu * self,
+                                                                GstSimaaiConfig * config)
+{
+  static GQuark key = g_quark_from_static_string("simaai-processcvu-json");
+
+  auto * view = static_cast<const nlohmann::json *>(gst_simaai_config_get_view(config, key));
+  if (view != nullptr)
+    return view;
+
+  gsize length = 0;
+  const gchar * text = gst_simaai_config_get_text(config, &length);
+  nlohmann::json * parsed;
+  try {
+    parsed = new nlohmann::json(nlohmann::json::parse(text, text + length));
+  } catch (std::exception & ex) {
+    GST_ERROR_OBJECT(self, "Unable to parse config file: %s", ex.what());
+    return nullptr;
+  }
+
+  return static_cast<const nlohmann::json *>(gst_simaai_config_set_view(config, key, parsed,
+      [](gpointer data) { delete static_cast<nlohmann::json *>(data); }));
+}
+
+/**
+ * @brief Point config_json at the shared view of the config, or at a copy with
+ *        the negotiated values applied if there are any. Called on NULL to
+ *        READY and when negotiated values change.
+ */
+static gboolean gst_simaai_processcvu_load_config(GstSimaaiProcesscvu * self,
+                                                  bool * changed = nullptr)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+  GstSimaaiConfig * config = priv->simaai_caps->parsed;
+  if (config == nullptr) {
+    GST_ERROR_OBJECT(self, "No config parsed");
     return FALSE;
   }
 
-  GST_DEBUG_OBJECT (self, "Output buffer pool: %d buffers of size %d",
-                      self->priv->num_of_out_buf, self->priv->output_size);
+  const nlohmann::json * view = gst_simaai_processcvu_config_view(self, config);
+  if (view == nullptr)
+    return FALSE;
+
+  gsize length = 0;
+  gchar * text = gst_simaai_caps_get_overrides(priv->simaai_caps, &length);
+  std::string overrides = text ? std::string(text, length) : std::string();
+  g_free(text);
+
+  if (changed != nullptr)
+    *changed = false;
+  if (priv->config_json != nullptr && config == priv->config &&
+      overrides == priv->config_overrides)
+    return TRUE;
+
+  if (overrides.empty()) {
+    priv->config_json = view;
+  } else {
+    try {
+      // negotiated values replace top level fields, as in the caps library
+      nlohmann::json fields = nlohmann::json::parse(overrides);
+      priv->config_merged = *view;
+      for (auto & field : fields.items())
+        priv->config_merged[field.key()] = field.value();
+    } catch (std::exception & ex) {
+      GST_ERROR_OBJECT(self, "Unable to apply negotiated values: %s", ex.what());
+      return FALSE;
+    }
+    priv->config_json = &priv->config_merged;
+  }
+
+  gst_simaai_config_ref(config);
+  if (priv->config != nullptr)
+    gst_simaai_config_unref(priv->config);
+  priv->config = config;
+  priv->config_overrides = overrides;
+  if (changed != nullptr)
+    *changed = true;
 
   return TRUE;
 }
 
+/**
+ * @brief Path ConfigManager reads the config from. Negotiated values are kept
+ *        in memory only, so a config with them applied is passed through an
+ *        anonymous in-memory file instead of being written back to storage.
+ */
+static std::string gst_simaai_processcvu_cm_config_path(GstSimaaiProcesscvu * self)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+
+  if (priv->config_fd >= 0) {
+    close(priv->config_fd);
+    priv->config_fd = -1;
+  }
+
+  if (!gst_simaai_caps_has_overrides(priv->simaai_caps))
+    return priv->config_file_path;
+
+  // ConfigManager is in the SDK and only reads files, it gets the config
+  // with negotiated values applied from memory
+  std::string text = priv->config_json->dump(4);
+  gsize length = text.size();
+
+  int fd = memfd_create("simaai-processcvu-config", MFD_CLOEXEC);
+  gsize written = 0;
+  while (fd >= 0 && written < length) {
+    ssize_t res = write(fd, text.data() + written, length - written);
+    if (res < 0) {
+      GST_ERROR_OBJECT(self, "Unable to write in-memory config: %s", g_strerror(errno));
+      close(fd);
+      fd = -1;
+      break;
+    }
+    written += res;
+  }
+
+  if (fd < 0)
+    return std::string();
+
+  priv->config_fd = fd;
+  return "/proc/self/fd/" + std::to_string(fd);
+}
+
 /**
  * @brief helper function to initialize config manager
  */
@@ -824,8 +1367,14 @@ static gboolean gst_simaai_processcvu_init_cm(GstSimaaiProcesscvu * self)
   if (self->priv->config_file_path.empty())
     return FALSE;
 
+  std::string cm_config_path = gst_simaai_processcvu_cm_config_path(self);
+  if (cm_config_path.empty()) {
+    GST_ERROR_OBJECT(self, "Unable to pass negotiated config to CM");
+    return FALSE;
+  }
+
   try {
-    self->priv->config_manager.reset(new ConfigManager(self->priv->config_file_path));
+    self->priv->config_manager.reset(new ConfigManager(cm_config_path));
   } catch (std::exception & ex) {
     GST_ERROR_OBJECT(self, "Error allocating CM: %s", ex.what());
     return FALSE;
@@ -901,14 +1450,12 @@ static gboolean gst_simaai_processcvu_init_cm(GstSimaaiProcesscvu * self)
  */
 bool gst_simaai_processcvu_parse_buffers_memories(GstSimaaiProcesscvu * self)
 {
-  nlohmann::json json;
-  if (!parse_json_from_file(self, self->priv->config_file_path, json))
-    return false;
+  const nlohmann::json & json = *self->priv->config_json;
   if (!json.contains("input_buffers") || !json.contains("output_memory_order"))
     return false;
 
-  nlohmann::json & input_buffers(json["input_buffers"]);
-  nlohmann::json & output_memories(json["output_memory_order"]);
+  const nlohmann::json & input_buffers(json["input_buffers"]);
+  const nlohmann::json & output_memories(json["output_memory_order"]);
 
   std::string buffer_name;
   GraphMemory tmp_mem;
@@ -916,6 +1463,12 @@ bool gst_simaai_processcvu_parse_buffers_memories(GstSimaaiProcesscvu * self)
   // add input buffers
   for (auto &input_it : input_buffers.items()) {
     auto & input = input_it.value();
+    // the config is shared and const, lookups must not add fields
+    if (!input.contains("name") || !input.contains("memories")) {
+      GST_ERROR_OBJECT (self, "Failed to parse input buffer '%s'",
+                        to_string(input).c_str());
+      return false;
+    }
     buffer_name = input["name"];
 
     auto & memories = self->priv->graph_buffers[buffer_name];
@@ -955,6 +1508,86 @@ bool gst_simaai_processcvu_parse_buffers_memories(GstSimaaiProcesscvu * self)
   return true;
 }
 
+/**
+ * @brief Helper API to create backend selected by `backend` property. With
+ *        SIMAAI_REPLAY_MODE set the jobs of the backend are recorded, or
+ *        replayed from the record file, or skipped in dry mode, instead of
+ *        running any backend.
+ */
+static gboolean gst_simaai_processcvu_init_backend(GstSimaaiProcesscvu * self)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+  JobReplaySettings replay = JobReplaySettings::from_env();
+  std::vector<std::string> outputs;
+  std::string error;
+
+  for (auto & memory : priv->graph_buffers[priv->node_name])
+    outputs.push_back(memory.dispatcher_name);
+
+  if (!replay.uses_accelerator()) {
+    std::unique_ptr<CvuReplayBackend<simaaidispatcher::JobEVXX>> player(
+        new CvuReplayBackend<simaaidispatcher::JobEVXX>);
+    if (!player->open(replay, priv->node_name, outputs, error)) {
+      GST_ERROR_OBJECT (self, "Unable to replay jobs: %s", error.c_str());
+      return FALSE;
+    }
+
+    priv->backend = std::move(player);
+    if (replay.mode == JobReplayMode::DRY)
+      GST_INFO_OBJECT (self, "Dry run, jobs are not run");
+    else
+      GST_INFO_OBJECT (self, "Replaying jobs from %s", replay.path(priv->node_name).c_str());
+    return TRUE;
+  }
+
+  if (priv->backend_name == "evxx") {
+    {
+      // elements reach READY in parallel, the factory is not thread safe
+      UtilsDispatcherGuard guard;
+      priv->dispatcher =
+          simaaidispatcher::DispatcherFactory::getDispatcher(
+              simaaidispatcher::DispatcherFactory::EVXX);
+    }
+    if (priv->dispatcher == nullptr) {
+      GST_ERROR_OBJECT (self, "Unable to get dispatcher");
+      return FALSE;
+    }
+
+    priv->backend.reset(
+        new CvuDispatcherBackend<simaaidispatcher::JobEVXX,
+                                 simaaidispatcher::DispatcherBase>(priv->dispatcher));
+  } else if (priv->backend_name == "host") {
+    std::unique_ptr<CvuHostBackend<simaaidispatcher::JobEVXX>> host(
+        new CvuHostBackend<simaaidispatcher::JobEVXX>);
+    if (!host->configure(*priv->config_json, error)) {
+      GST_ERROR_OBJECT (self, "Host backend can not run graph: %s", error.c_str());
+      return FALSE;
+    }
+
+    priv->host_backend = host.get();
+    priv->backend = std::move(host);
+    GST_INFO_OBJECT (self, "Graph runs on host, SIMD: %s", CvuHostPreproc::simd_name());
+  } else {
+    GST_ERROR_OBJECT (self, "Unknown backend '%s', valid values: evxx, host",
+                      priv->backend_name.c_str());
+    return FALSE;
+  }
+
+  if (replay.mode == JobReplayMode::RECORD) {
+    std::unique_ptr<CvuRecordBackend<simaaidispatcher::JobEVXX>> recorder(
+        new CvuRecordBackend<simaaidispatcher::JobEVXX>(std::move(priv->backend)));
+    if (!recorder->open(replay, priv->node_name, outputs, error)) {
+      GST_ERROR_OBJECT (self, "Unable to record jobs: %s", error.c_str());
+      return FALSE;
+    }
+
+    priv->backend = std::move(recorder);
+    GST_INFO_OBJECT (self, "Recording jobs to %s", replay.path(priv->node_name).c_str());
+  }
+
+  return TRUE;
+}
+
 static GstCaps *
 gst_simaai_processcvu_fixate_src_caps(GstAggregator *aggregator, GstCaps *caps)
 {
@@ -1028,6 +1661,7 @@ gst_simaai_processcvu_change_state (GstElement * element,
   case GST_STATE_CHANGE_NULL_TO_READY:
     //get name property
     self->priv->node_name = std::string(gst_element_get_name(element));
+    self->priv->node_quark = g_quark_from_string(self->priv->node_name.c_str());
 
     if (!gst_simaai_caps_parse_config(GST_ELEMENT(self),
       self->priv->simaai_caps, self->priv->config_file_path.c_str())) {
@@ -1035,12 +1669,24 @@ gst_simaai_processcvu_change_state (GstElement * element,
       return GST_STATE_CHANGE_FAILURE;
     }
 
+    if (!gst_simaai_processcvu_load_config(self))
+      return GST_STATE_CHANGE_FAILURE;
+
+    // backend needs no pads, created ahead of start so gst_app can bring
+    // elements to READY in parallel
+    self->priv->graph_buffers.clear();
+    if (!gst_simaai_processcvu_parse_buffers_memories(self))
+      return GST_STATE_CHANGE_FAILURE;
+
+    if (!gst_simaai_processcvu_init_backend(self))
+      return GST_STATE_CHANGE_FAILURE;
+
     GST_DEBUG_OBJECT(self, "GST_STATE_CHANGE_NULL_TO_READY");
     break;
   case GST_STATE_CHANGE_READY_TO_PAUSED:
     GST_DEBUG_OBJECT(self, "GST_STATE_CHANGE_READY_TO_PAUSED");
 
-    stream_start_event = gst_event_new_stream_start(self->priv->stream_id.c_str());
+    stream_start_event = gst_event_new_stream_start(GST_SIMAAI_QUARK_STR(self->priv->stream_id));
 
     it = gst_element_iterate_src_pads(GST_ELEMENT_CAST (element));
     while ((itret = gst_iterator_next(it, &item)) == GST_ITERATOR_OK) {
@@ -1057,20 +1703,19 @@ gst_simaai_processcvu_change_state (GstElement * element,
     gst_event_unref(stream_start_event);
     gst_iterator_free (it);
 
-    if (!gst_simaai_processcvu_parse_buffers_memories(self))
-      return GST_STATE_CHANGE_FAILURE;
-
-    self->priv->dispatcher = 
-        simaaidispatcher::DispatcherFactory::getDispatcher(
-            simaaidispatcher::DispatcherFactory::EVXX);
-    if (self->priv->dispatcher == nullptr) {
-      GST_ERROR_OBJECT (self, "Unable to get dispatcher");
-      return GST_STATE_CHANGE_FAILURE;
-    }
-
+    gst_simaai_processcvu_start_jobs_threads(self);
+    break;
+  case GST_STATE_CHANGE_PAUSED_TO_READY:
+    // src pad is flushing at this point, remaining jobs are dropped on push
+    gst_simaai_processcvu_stop_jobs_threads(self);
+    GST_DEBUG_OBJECT(self, "GST_STATE_CHANGE_PAUSED_TO_READY");
     break;
   case GST_STATE_CHANGE_READY_TO_NULL:
     gst_simaai_processcvu_free_memory(self);
+    self->priv->backend.reset();
+    self->priv->host_backend = nullptr;
+    delete self->priv->dispatcher;
+    self->priv->dispatcher = nullptr;
     GST_DEBUG_OBJECT(self, "GST_STATE_CHANGE_READY_TO_NULL");
     break;
   default:
@@ -1080,6 +1725,40 @@ gst_simaai_processcvu_change_state (GstElement * element,
   return ret;
 }
 
+/**
+ * @brief Apply values negotiated on the sink pad to the state built from the
+ *        config at NULL to READY: config_json, buffers memories and the host
+ *        backend. Dispatcher and replay backends do not read the config.
+ */
+static gboolean gst_simaai_processcvu_refresh_config(GstSimaaiProcesscvu * self)
+{
+  GstSimaaiProcesscvuPrivate * priv = self->priv;
+  bool changed = false;
+
+  if (!gst_simaai_processcvu_load_config(self, &changed))
+    return FALSE;
+  if (!changed)
+    return TRUE;
+
+  GST_DEBUG_OBJECT(self, "Negotiated values changed: %s", priv->config_overrides.c_str());
+
+  priv->graph_buffers.clear();
+  if (!gst_simaai_processcvu_parse_buffers_memories(self)) {
+    GST_ERROR_OBJECT(self, "Unable to parse buffers with negotiated values");
+    return FALSE;
+  }
+
+  if (priv->host_backend != nullptr) {
+    std::string error;
+    if (!priv->host_backend->configure(*priv->config_json, error)) {
+      GST_ERROR_OBJECT(self, "Host backend can not run negotiated graph: %s", error.c_str());
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
 /**
  * @brief Callback for event on the sinkpad
  */
@@ -1087,7 +1766,21 @@ static gboolean
 gst_simaai_processcvu_sink_event (GstAggregator * agg, GstAggregatorPad * bpad, GstEvent * event)
 {
   GstSimaaiProcesscvu *self = GST_SIMAAI_PROCESSCVU (agg);
-  
+
+  // jobs not pushed yet are dropped until flush() after FLUSH_STOP
+  if (GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_START) {
+    {
+      const std::lock_guard<std::mutex> lk(self->priv->jobs_mtx);
+      self->priv->jobs_flushing = true;
+    }
+    self->priv->jobs_cv.notify_all();
+  }
+
+  // serialized events must not overtake outputs of jobs still in flight, for
+  // CAPS job contexts are also rebuilt below
+  if (GST_EVENT_IS_SERIALIZED(event))
+    gst_simaai_processcvu_drain_jobs(self);
+
   if (GST_EVENT_TYPE(event) == GST_EVENT_CAPS) {
     const std::lock_guard<std::mutex> guard(self->priv->event_mtx);
 
@@ -1097,6 +1790,16 @@ gst_simaai_processcvu_sink_event (GstAggregator * agg, GstAggregatorPad * bpad,
       return FALSE;
     }
 
+    if (!gst_simaai_processcvu_refresh_config(self))
+      return FALSE;
+
+    // reconnects renegotiate the same layout, CM and pool stay valid
+    guint64 layout_key = gst_simaai_processcvu_layout_key(self, event);
+    if (layout_key == self->priv->layout_key && self->priv->config_manager) {
+      GST_DEBUG_OBJECT(self, "[SINK CAPS EVENT] layout unchanged, reusing CM and pool");
+      return TRUE;
+    }
+
     if (!gst_simaai_processcvu_init_cm(self))
       return FALSE;
 
@@ -1104,14 +1807,39 @@ gst_simaai_processcvu_sink_event (GstAggregator * agg, GstAggregatorPad * bpad,
       GST_ERROR_OBJECT (self, "Unable to allocate memory");
       return FALSE;
     }
+
+    gst_simaai_processcvu_compile_job_template(self);
+    self->priv->layout_key = layout_key;
     GST_DEBUG_OBJECT( self, "[SINK CAPS EVENT] finished cm update and reallocation");
 
     return TRUE;
   }
-  
+
   return GST_AGGREGATOR_CLASS (parent_class)->sink_event (agg, bpad, event);
 }
 
+/**
+ * @brief Callback for flush, waits for submitted jobs. Since FLUSH_START they
+ *        are not run and their outputs are dropped.
+ */
+static GstFlowReturn
+gst_simaai_processcvu_flush (GstAggregator * agg)
+{
+  GstSimaaiProcesscvu *self = GST_SIMAAI_PROCESSCVU (agg);
+
+  gst_simaai_processcvu_drain_jobs(self);
+  {
+    const std::lock_guard<std::mutex> lk(self->priv->jobs_mtx);
+    self->priv->jobs_flushing = false;
+    self->priv->completion_ret = GST_FLOW_OK;
+  }
+
+  if (GST_AGGREGATOR_CLASS (parent_class)->flush)
+    return GST_AGGREGATOR_CLASS (parent_class)->flush (agg);
+
+  return GST_FLOW_OK;
+}
+
 /**
  * @brief Callback to request new sink pad, when a new link is created from the child proxy
  */
@@ -1185,6 +1913,8 @@ gst_simaai_processcvu_finalize (GObject * object)
 {
   GstSimaaiProcesscvu * self = GST_SIMAAI_PROCESSCVU (object);
 
+  gst_simaai_processcvu_stop_jobs_threads(self);
+
   /* Clean up current input buffer list */
   guint buf_len = gst_buffer_list_length(self->priv->list);
   if (buf_len) {
@@ -1195,7 +1925,15 @@ gst_simaai_processcvu_finalize (GObject * object)
   }
   gst_buffer_list_unref(self->priv->list);
 
+  for (auto & ctx : self->priv->job_contexts)
+    gst_buffer_list_unref(ctx->inputs);
+  self->priv->job_contexts.clear();
+
   gst_simaai_caps_free(self->priv->simaai_caps);
+  if (self->priv->config != nullptr)
+    gst_simaai_config_unref(self->priv->config);
+  if (self->priv->config_fd >= 0)
+    close(self->priv->config_fd);
 
   delete self->priv;
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -1277,6 +2015,8 @@ gst_simaai_processcvu_class_init (GstSimaaiProcesscvuClass * klass)
 
   base_aggregator_class->sink_event =
       GST_DEBUG_FUNCPTR (gst_simaai_processcvu_sink_event);
+  base_aggregator_class->flush =
+      GST_DEBUG_FUNCPTR (gst_simaai_processcvu_flush);
   base_aggregator_class->sink_query =
       GST_DEBUG_FUNCPTR(gst_simaai_processcvu_sink_query);
 
@@ -1314,6 +2054,25 @@ gst_simaai_processcvu_class_init (GstSimaaiProcesscvuClass * klass)
                                                          "in /tmp/{node-name}-:03{frame_id}.out",
                                                          DEFAULT_SILENT,
                                                          (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+  /* This property is used to overlap configuration of next frames with execution on EVXX */
+  g_object_class_install_property(gobj_class, PROP_IN_FLIGHT_JOBS,
+                                  g_param_spec_uint("in-flight-jobs",
+                                                    "In Flight Jobs",
+                                                    "Number of jobs submitted to the dispatcher at "
+                                                    "the same time. Outputs are pushed in frame order",
+                                                    1, MAX_IN_FLIGHT_JOBS,
+                                                    DEFAULT_IN_FLIGHT_JOBS,
+                                                    (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                  GST_PARAM_MUTABLE_READY)));
+  /* This property is used to run the graph on the host CPU instead of EVXX */
+  g_object_class_install_property(gobj_class, PROP_BACKEND,
+                                  g_param_spec_string("backend",
+                                                      "Backend",
+                                                      "Backend running the graph: 'evxx' - CVU through the "
+                                                      "dispatcher, 'host' - CPU implementation of the graph",
+                                                      DEFAULT_BACKEND,
+                                                      (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                    GST_PARAM_MUTABLE_READY)));
   /* This property is used by cvu to enable/disable debugging messages */
   g_object_class_install_property (gobj_class, PROP_SILENT,
                                    g_param_spec_boolean ("silent",
@@ -1384,17 +2143,18 @@ void gst_simaai_processcvu_print_dispatcher_error(GstSimaaiProcesscvu * self,
 }
 
 /**
- * @brief Helper API to run the graph on the CVU
+ * @brief Helper API to run the graph on the CVU. Called from the aggregate
+ *        thread, or from runner threads when several jobs are in flight.
  */
 gboolean 
-run_processcvu (GstSimaaiProcesscvu * self, simaaidispatcher::JobEVXX & job)
+run_processcvu (GstSimaaiProcesscvu * self, CvuJobContext & ctx)
 {
-  self->priv->t0 = std::chrono::steady_clock::now();
+  auto t0 = std::chrono::steady_clock::now();
   if (self->transmit) {
-    tracepoint_pipeline_cvu_start(self->priv->frame_id, (char *)self->priv->node_name.c_str(), (char *)self->priv->stream_id.c_str());
+    tracepoint_pipeline_cvu_start(ctx.frame_id, (char *)self->priv->node_name.c_str(), (char *)GST_SIMAAI_QUARK_STR(ctx.stream_id));
   }
 
-  int res = self->priv->dispatcher->run(job, self->priv->tp);
+  int res = self->priv->backend->run(ctx.compiled.job, ctx.tp);
 
   if (res) {
     gst_simaai_processcvu_print_dispatcher_error(self, res);
@@ -1402,25 +2162,26 @@ run_processcvu (GstSimaaiProcesscvu * self, simaaidispatcher::JobEVXX & job)
   }
 
   if (self->transmit) {
-    tracepoint_pipeline_cvu_end(self->priv->frame_id, (char *)self->priv->node_name.c_str(), (char *)self->priv->stream_id.c_str());
+    tracepoint_pipeline_cvu_end(ctx.frame_id, (char *)self->priv->node_name.c_str(), (char *)GST_SIMAAI_QUARK_STR(ctx.stream_id));
   }
 
-  self->priv->t1 = std::chrono::steady_clock::now();
-  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(self->priv->t1 - self->priv->t0);
+  auto t1 = std::chrono::steady_clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
   auto duration = elapsed.count() / 1000.0 ;
 
   if (!self->silent) {
-    self->priv->run_count++;
+    gint64 run_count = ++self->priv->run_count;
 
     GST_DEBUG_OBJECT(self, "run count[%ld], frame_id[%ld], run time in ms: %f", 
-                     self->priv->run_count, self->priv->frame_id, duration);
+                     run_count, ctx.frame_id, duration);
   }
-  auto kernel_rt = std::chrono::duration_cast<std::chrono::microseconds>(self->priv->tp.second - self->priv->tp.first);
+  auto kernel_rt = std::chrono::duration_cast<std::chrono::microseconds>(ctx.tp.second - ctx.tp.first);
   auto kernel_duration = kernel_rt.count() / 1000.0 ;
-  GST_DEBUG_OBJECT(self, "EVXX Graph ID %d run time is :  %f ms", job.graphID, kernel_duration);
+  GST_DEBUG_OBJECT(self, "EVXX Graph ID %d run time on %s is :  %f ms", ctx.compiled.job.graphID,
+                   self->priv->backend->name(), kernel_duration);
 
   if (self->priv->dump_data) {
-    if (cvu_dump_output_buffer (self, self->priv->frame_id) !=0 ) {
+    if (cvu_dump_output_buffer (self, ctx.outbuf, ctx.frame_id) !=0 ) {
       GST_ERROR_OBJECT (self, "Dumping of buffers failed");
       return FALSE;
     }
@@ -1444,6 +2205,10 @@ gst_simaai_processcvu_init (GstSimaaiProcesscvu * self)
   gst_simaai_segment_memory_init_once();
   self->priv = new GstSimaaiProcesscvuPrivate;
   self->priv->config_file_path = DEFAULT_CONFIG_FILE;
+  self->priv->config_fd = -1;
+  self->priv->config = nullptr;
+  self->priv->config_json = nullptr;
+  self->priv->layout_key = 0;
 
   self->priv->pool = nullptr;
   self->priv->mem_type = GST_SIMAAI_MEMORY_TARGET_EV74;
@@ -1455,11 +2220,21 @@ gst_simaai_processcvu_init (GstSimaaiProcesscvu * self)
   self->priv->frame_id = -1;
   self->priv->in_pcie_buf_id = 0;
   self->priv->is_pcie = FALSE;
+  self->priv->stream_id = 0;
+  self->priv->node_quark = 0;
   self->priv->output_size = 0;
   self->priv->dump_data = false;
 
   self->priv->list = gst_buffer_list_new();
   self->priv->run_count = 0;
+  self->priv->in_flight_jobs = DEFAULT_IN_FLIGHT_JOBS;
+  self->priv->backend_name = DEFAULT_BACKEND;
+  self->priv->host_backend = nullptr;
+  self->priv->dispatcher = nullptr;
+  self->priv->jobs_stop = false;
+  self->priv->jobs_flushing = false;
+  self->priv->completion_ret = GST_FLOW_OK;
+  self->priv->next_job_context = 0;
 
   self->priv->mem_type = GST_SIMAAI_MEMORY_TARGET_EV74;
   self->priv->mem_flag = GST_SIMAAI_MEMORY_FLAG_CACHED;
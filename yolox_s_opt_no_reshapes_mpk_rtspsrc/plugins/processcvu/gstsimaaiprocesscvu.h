@@ -30,6 +30,9 @@
 #define DEFAULT_IN_BUFFER_LIST "a65-topk"
 #define DEFAULT_NUM_BUFFERS 5
 #define MIN_POOL_SIZE 2
+#define DEFAULT_IN_FLIGHT_JOBS 1
+#define MAX_IN_FLIGHT_JOBS 16
+#define DEFAULT_BACKEND "evxx"
 
 #define PAD_TEMPLATE_NAME_SINK  "sink_%u"
 #define PAD_TEMPLATE_NAME_SRC   "src"
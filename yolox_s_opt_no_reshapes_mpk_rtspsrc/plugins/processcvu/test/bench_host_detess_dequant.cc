@@ -0,0 +1,142 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * Throughput benchmark of the host `detessdequant` graph across tile shapes.
+ *
+ * Tensors are the three YOLOX-s heads of 0_postproc.json (80x80, 40x40 and
+ * 20x20, depth 85). For every slice shape the output of SIMD and scalar
+ * kernels is checked against a direct per value computation of the tiled
+ * layout, then time per frame and input throughput of both kernels are
+ * printed.
+ *
+ * Usage: bench_host_detess_dequant [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <vector>
+
+#include "cvu_host_detess_dequant.h"
+
+struct SliceShape {
+  const char * name;
+  /// slice width of 0 means the width of the head
+  int slice_height, slice_width, slice_depth;
+};
+
+static const SliceShape shapes[] = {
+  { "1 x W x 85 (0_postproc.json)", 1, 0, 85 },
+  { "1 x W x 32", 1, 0, 32 },
+  { "1 x W x 16", 1, 0, 16 },
+  { "2 x W x 85", 2, 0, 85 },
+  { "8 x 8 x 85", 8, 8, 85 },
+  { "16 x 16 x 32", 16, 16, 32 },
+  { "4 x 32 x 48", 4, 32, 48 },
+};
+
+static std::vector<CvuDetessHead> make_heads(const SliceShape & shape)
+{
+  const int sizes[3] = { 80, 40, 20 };
+  const float scales[3] = { 45.888838373387166f, 46.92204034273037f, 54.058788618785044f };
+  const int zps[3] = { -29, -25, -35 };
+
+  std::vector<CvuDetessHead> heads;
+  for (int h = 0; h < 3; h++)
+    heads.push_back({ sizes[h], sizes[h], 85,
+                      shape.slice_width ? shape.slice_width : sizes[h],
+                      shape.slice_height, shape.slice_depth,
+                      scales[h], zps[h] });
+  return heads;
+}
+
+/**
+ * @brief Reference: every output value looked up by its tile coordinates
+ */
+static bool check(const std::vector<CvuDetessHead> & heads, const int8_t * input,
+                  const float * output)
+{
+  size_t src_base = 0, dst = 0;
+
+  for (const CvuDetessHead & head : heads) {
+    const size_t depth_stride = (head.slice_depth + 15) / 16 * 16;
+    const int tiles_w = (head.width + head.slice_width - 1) / head.slice_width;
+    const int tiles_h = (head.height + head.slice_height - 1) / head.slice_height;
+    const int tiles_d = (head.depth + head.slice_depth - 1) / head.slice_depth;
+    const size_t tile_size = (size_t)head.slice_width * head.slice_height * depth_stride;
+
+    for (int y = 0; y < head.height; y++) {
+      for (int x = 0; x < head.width; x++) {
+        for (int d = 0; d < head.depth; d++, dst++) {
+          size_t tile = ((size_t)(y / head.slice_height) * tiles_w + x / head.slice_width) *
+                        tiles_d + d / head.slice_depth;
+          size_t src = src_base + tile * tile_size +
+                       ((size_t)(y % head.slice_height) * head.slice_width +
+                        x % head.slice_width) * depth_stride + d % head.slice_depth;
+          float expected = (float)(input[src] - head.dq_zp) * (1.0f / head.dq_scale);
+          if (output[dst] != expected) {
+            fprintf(stderr, "mismatch at y %d x %d d %d: %f != %f\n",
+                    y, x, d, output[dst], expected);
+            return false;
+          }
+        }
+      }
+    }
+    src_base += tile_size * tiles_w * tiles_h * tiles_d;
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  int iterations = argc > 1 ? atoi(argv[1]) : 200;
+  if (iterations < 1)
+    iterations = 1;
+
+  printf("SIMD kernels: %s, %d iterations\n", CvuHostDetessDequant::simd_name(), iterations);
+  printf("%-30s %8s %10s %12s %12s %12s\n", "slice h x w x d", "runs", "input KiB",
+         "scalar ms", "simd ms", "simd MB/s");
+
+  for (const SliceShape & shape : shapes) {
+    std::vector<CvuDetessHead> heads = make_heads(shape);
+    CvuHostDetessDequant graph;
+    if (!graph.configure(heads)) {
+      fprintf(stderr, "Failed to configure %s\n", shape.name);
+      return 1;
+    }
+
+    std::vector<int8_t> input(graph.input_size());
+    uint32_t state = 7;
+    for (auto & q : input) {
+      state = state * 1664525u + 1013904223u;
+      q = (int8_t)(state >> 24);
+    }
+    std::vector<float> output(graph.output_size() / sizeof(float));
+
+    double ms[2];
+    for (int simd = 0; simd < 2; simd++) {
+      graph.run(input.data(), output.data(), simd);
+      if (!check(heads, input.data(), output.data())) {
+        fprintf(stderr, "%s: %s output is wrong\n", shape.name, simd ? "SIMD" : "scalar");
+        return 1;
+      }
+
+      auto t0 = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; i++)
+        graph.run(input.data(), output.data(), simd);
+      auto t1 = std::chrono::steady_clock::now();
+      ms[simd] = std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+    }
+
+    printf("%-30s %8zu %10zu %12.3f %12.3f %12.1f\n", shape.name, graph.num_runs(),
+           graph.input_size() / 1024, ms[0], ms[1],
+           graph.input_size() / (ms[1] * 1e3));
+  }
+
+  return 0;
+}
@@ -0,0 +1,196 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * Microbenchmark of per-frame host overhead of processcvu job configuration.
+ *
+ * "legacy" reproduces what configure_job did per frame before job templates:
+ * split of buffer names, std::map name->index lookup, dispatcher buffer map
+ * refill and request-id hash of concatenated strings. "template" is the
+ * compiled path from cvu_job_template.h. Legacy resolves segments by name on
+ * a mock segment memory, the same way gst_simaai_memory_get_segment does, and
+ * template by interned id like gst_simaai_memory_get_segment_by_id.
+ *
+ * Usage: bench_job_template [iterations]
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cvu_job_template.h"
+
+struct BenchJob {
+  std::map<std::string, void *> buffers;
+  uint64_t requestID;
+};
+
+/// Mock of the segment name registry, ids start after the parent id
+static uint32_t segment_id_from_name(const std::string &name)
+{
+  static std::map<std::string, uint32_t> ids;
+  auto it = ids.emplace(name, (uint32_t)ids.size() + 2).first;
+  return it->second;
+}
+
+struct BenchSegment {
+  std::string name;
+  void *memory;
+  uint32_t id;
+
+  BenchSegment(const char *n, void *m) : name(n), memory(m), id(segment_id_from_name(n)) {}
+};
+
+/// Mock of GstSimaaiSegmentMemory segment list
+struct BenchMemory {
+  std::vector<BenchSegment> segments;
+
+  void *get_segment(const char *name) const
+  {
+    if (name == NULL)
+      return segments[0].memory;
+    for (const auto &s : segments)
+      if (s.name == name)
+        return s.memory;
+    return NULL;
+  }
+
+  void *get_segment_by_id(uint32_t id) const
+  {
+    for (const auto &s : segments)
+      if (s.id == id)
+        return s.memory;
+    return NULL;
+  }
+};
+
+struct BenchGraphMemory {
+  std::string memory_name;
+  std::string dispatcher_name;
+};
+
+static std::vector<std::string> split_string(const std::string &s, char delimiter)
+{
+  std::vector<std::string> res;
+  std::string token;
+  std::istringstream tokenStream(s);
+  while (std::getline(tokenStream, token, delimiter)) {
+    token.erase(0, token.find_first_not_of(' '));
+    token.erase(token.find_last_not_of(' ') + 1);
+    if (!token.empty())
+      res.push_back(token);
+  }
+  return res;
+}
+
+int main(int argc, char **argv)
+{
+  const long iterations = (argc > 1) ? atol(argv[1]) : 1000000;
+  const std::string node_name = "simaai_preproc_1";
+  const std::string stream_id = "rtsp-stream-0";
+
+  // layout of 0_preproc.json
+  std::map<std::string, std::vector<BenchGraphMemory>> graph_buffers;
+  graph_buffers["decoder, decoder_1"] = { { "parent", "input_image" } };
+  graph_buffers[node_name] = { { "output_tessellated_image", "output_tessellated_image" },
+                               { "output_rgb_image", "output_rgb_image" } };
+
+  static char storage[4];
+  BenchMemory input = { { { "parent", &storage[0] } } };
+  BenchMemory output = { { { "parent", &storage[1] },
+                           { "output_tessellated_image", &storage[2] },
+                           { "output_rgb_image", &storage[3] } } };
+  std::vector<const BenchMemory *> list = { &input };
+  const char *in_buf_name = "decoder";
+
+  uint64_t check_legacy = 0, check_template = 0;
+
+  // legacy per-frame path
+  auto t0 = std::chrono::steady_clock::now();
+  for (long frame = 0; frame < iterations; frame++) {
+    std::map<std::string, unsigned> buf_name_idx_map;
+    buf_name_idx_map[in_buf_name] = 0;
+
+    BenchJob job;
+    std::string combined_id = node_name + stream_id;
+    job.requestID = ((uint64_t)str_to_uint32_hash(combined_id.c_str()) << 32) | frame;
+
+    for (auto &[json_bufname, buf_memories] : graph_buffers) {
+      if (json_bufname == node_name)
+        continue;
+      const BenchMemory *buffer = NULL;
+      for (auto &name : split_string(json_bufname, ','))
+        if (buf_name_idx_map.find(name) != buf_name_idx_map.end())
+          buffer = list[buf_name_idx_map[name]];
+      for (auto &memory : buf_memories)
+        job.buffers[memory.dispatcher_name] = buffer->get_segment(memory.memory_name.c_str());
+    }
+    for (auto &memory : graph_buffers[node_name])
+      job.buffers[memory.dispatcher_name] = output.get_segment(memory.memory_name.c_str());
+
+    check_legacy += job.requestID + (uintptr_t)job.buffers["output_rgb_image"];
+  }
+  auto t1 = std::chrono::steady_clock::now();
+
+  // compiled template path, built once
+  CvuJobTemplate tmpl;
+  for (auto &[json_bufname, buf_memories] : graph_buffers) {
+    std::vector<CvuTemplateMemory> memories;
+    for (auto &memory : buf_memories)
+      memories.push_back({ memory.memory_name, memory.dispatcher_name,
+                           segment_id_from_name(memory.memory_name) });
+    if (json_bufname == node_name)
+      tmpl.outputs = memories;
+    else
+      tmpl.inputs.push_back({ split_string(json_bufname, ','), memories });
+  }
+  CvuCompiledJob<BenchJob> compiled;
+  compiled.compile(tmpl);
+  CvuRequestId request_id;
+  request_id.node_name = node_name;
+  std::vector<int> input_buffer_idx(tmpl.inputs.size(), -1);
+
+  auto t2 = std::chrono::steady_clock::now();
+  for (long frame = 0; frame < iterations; frame++) {
+    std::fill(input_buffer_idx.begin(), input_buffer_idx.end(), -1);
+    int idx = tmpl.find_input(in_buf_name);
+    if (idx >= 0)
+      input_buffer_idx[idx] = 0;
+
+    compiled.job.requestID = request_id.get(stream_id.c_str(), frame);
+    for (size_t i = 0; i < tmpl.inputs.size(); i++) {
+      const BenchMemory *buffer = list[input_buffer_idx[i]];
+      for (size_t j = 0; j < tmpl.inputs[i].memories.size(); j++)
+        *compiled.input_slots[i][j] =
+            buffer->get_segment_by_id(tmpl.inputs[i].memories[j].segment_id);
+    }
+    for (size_t j = 0; j < tmpl.outputs.size(); j++)
+      *compiled.output_slots[j] = output.get_segment_by_id(tmpl.outputs[j].segment_id);
+
+    check_template += compiled.job.requestID + (uintptr_t)*compiled.output_slots[1];
+  }
+  auto t3 = std::chrono::steady_clock::now();
+
+  if (check_legacy != check_template) {
+    fprintf(stderr, "Mismatch between legacy and template jobs\n");
+    return 1;
+  }
+
+  double legacy_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+  double template_ns = std::chrono::duration<double, std::nano>(t3 - t2).count() / iterations;
+
+  printf("iterations: %ld\n", iterations);
+  printf("legacy   configure_job: %8.1f ns/frame\n", legacy_ns);
+  printf("template configure_job: %8.1f ns/frame\n", template_ns);
+  printf("speedup: %.1fx\n", legacy_ns / template_ns);
+
+  return 0;
+}
@@ -0,0 +1,194 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * Test of the host `preproc` graph with parameters of 0_preproc.json: SIMD and
+ * scalar kernels are bit exact, scaling, color conversion, padding,
+ * quantization and tile layout match hand computed values. Prints time per
+ * frame of both kernels.
+ *
+ * Usage: test_host_preproc [iterations]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "cvu_host_preproc.h"
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      return 1;                                                         \
+    }                                                                   \
+  } while (0)
+
+/// RGB pixel of BT.601 limited range YUV, same formula as the graph
+static int bt601(int y, int u, int v, int ch)
+{
+  int c = 298 * (y - 16) + 128, d = u - 128, e = v - 128;
+  int val = ch == 0 ? (c + 409 * e) >> 8 :
+            ch == 1 ? (c - 100 * d - 208 * e) >> 8 : (c + 516 * d) >> 8;
+  return val < 0 ? 0 : (val > 255 ? 255 : val);
+}
+
+/// Offset of pixel (x, y) channel c in 128x32x3 tiles of a 640 wide output
+static size_t tile_offset(int x, int y, int c)
+{
+  int tile = (y / 32) * 5 + x / 128;
+  return ((size_t)tile * 32 + y % 32) * 128 * 3 + (x % 128) * 3 + c;
+}
+
+static int test_layout()
+{
+  CvuPreprocParams params;
+  CvuHostPreproc preproc;
+  CHECK(preproc.configure(params));
+
+  // 1280x720 keeps aspect ratio in 640x360, centered vertically
+  CHECK(preproc.scaled_width() == 640 && preproc.scaled_height() == 360);
+  CHECK(preproc.offset_x() == 0 && preproc.offset_y() == 140);
+  CHECK(preproc.input_size() == 1280 * 720 * 3 / 2);
+  CHECK(preproc.tessellated_size() == 640 * 640 * 3);
+
+  // luma is a horizontal ramp, chroma is neutral
+  std::vector<uint8_t> frame(preproc.input_size(), 128);
+  for (int y = 0; y < 720; y++)
+    for (int x = 0; x < 1280; x++)
+      frame[y * 1280 + x] = (uint8_t)(16 + x / 8);
+
+  std::vector<int8_t> tess(preproc.tessellated_size());
+  std::vector<uint8_t> rgb(preproc.rgb_size());
+  preproc.run(frame.data(), tess.data(), rgb.data());
+
+  // pixel x of output samples source 2x + 0.5 between equal luma values
+  for (int x : { 0, 3, 100, 639 }) {
+    int luma = 16 + (2 * x) / 8;
+    for (int c = 0; c < 3; c++)
+      CHECK(rgb[(200 * 640 + x) * 3 + c] == bt601(luma, 128, 128, c));
+  }
+
+  // padding rows are black, -128 after quantization
+  for (int y : { 0, 139, 500, 639 })
+    for (int c = 0; c < 3; c++) {
+      CHECK(rgb[(y * 640 + 320) * 3 + c] == 0);
+      CHECK(tess[tile_offset(320, y, c)] == -128);
+    }
+  CHECK(rgb[(140 * 640 + 320) * 3] != 0);
+
+  // tessellated output is the RGB output shifted by q_zp in 128x32x3 tiles
+  for (int y = 0; y < 640; y++)
+    for (int x = 0; x < 640; x++)
+      for (int c = 0; c < 3; c++)
+        CHECK(tess[tile_offset(x, y, c)] == (int8_t)(rgb[(y * 640 + x) * 3 + c] - 128));
+
+  // without tessellation the output is plain HWC
+  params.tessellate = false;
+  CHECK(preproc.configure(params));
+  std::vector<int8_t> plain(preproc.tessellated_size());
+  preproc.run(frame.data(), plain.data(), nullptr);
+  for (size_t i = 0; i < plain.size(); i++)
+    CHECK(plain[i] == (int8_t)(rgb[i] - 128));
+
+  params.tessellate = true;
+  params.tile_width = 100;
+  CHECK(!preproc.configure(params));
+
+  return 0;
+}
+
+static int test_color_and_quant()
+{
+  CvuPreprocParams params;
+  params.normalize = true;
+  params.channel_mean[0] = 0.5f;
+  params.channel_stddev[0] = 0.25f;
+  params.q_scale = 32.0f;
+  params.q_zp = 3;
+
+  CvuHostPreproc preproc;
+  CHECK(preproc.configure(params));
+
+  // flat frame with a color
+  std::vector<uint8_t> frame(preproc.input_size());
+  memset(frame.data(), 120, 1280 * 720);
+  for (size_t i = 1280 * 720; i < frame.size(); i += 2) {
+    frame[i] = 90;
+    frame[i + 1] = 200;
+  }
+
+  std::vector<int8_t> tess(preproc.tessellated_size());
+  std::vector<uint8_t> rgb(preproc.rgb_size());
+  preproc.run(frame.data(), tess.data(), rgb.data());
+
+  for (int c = 0; c < 3; c++) {
+    int pix = bt601(120, 90, 200, c);
+    CHECK(rgb[(300 * 640 + 17) * 3 + c] == pix);
+
+    float mean = c == 0 ? 0.5f : 0.0f;
+    float stddev = c == 0 ? 0.25f : 1.0f;
+    long q = lrint((pix / 255.0 - mean) / stddev * 32.0) + 3;
+    q = q < -128 ? -128 : (q > 127 ? 127 : q);
+    CHECK(tess[tile_offset(17, 300, c)] == q);
+  }
+
+  return 0;
+}
+
+static int test_simd(int iterations)
+{
+  CvuPreprocParams params;
+  CvuHostPreproc preproc;
+  CHECK(preproc.configure(params));
+
+  std::vector<uint8_t> frame(preproc.input_size());
+  uint32_t state = 1;
+  for (auto & pix : frame) {
+    state = state * 1664525u + 1013904223u;
+    pix = (uint8_t)(state >> 24);
+  }
+
+  std::vector<int8_t> tess_simd(preproc.tessellated_size()), tess_scalar(preproc.tessellated_size());
+  std::vector<uint8_t> rgb_simd(preproc.rgb_size()), rgb_scalar(preproc.rgb_size());
+
+  preproc.run(frame.data(), tess_simd.data(), rgb_simd.data(), true);
+  preproc.run(frame.data(), tess_scalar.data(), rgb_scalar.data(), false);
+  CHECK(tess_simd == tess_scalar);
+  CHECK(rgb_simd == rgb_scalar);
+
+  for (bool simd : { false, true }) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+      preproc.run(frame.data(), tess_simd.data(), rgb_simd.data(), simd);
+    auto t1 = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+    printf("%-8s 1280x720 NV12 -> 640x640 tessellated: %.3f ms/frame\n",
+           simd ? CvuHostPreproc::simd_name() : "scalar", ms);
+  }
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  int iterations = argc > 1 ? atoi(argv[1]) : 100;
+  if (iterations < 1)
+    iterations = 1;
+
+  if (test_layout())
+    return 1;
+  if (test_color_and_quant())
+    return 1;
+  if (test_simd(iterations))
+    return 1;
+
+  printf("test_host_preproc: OK\n");
+  return 0;
+}
@@ -50,13 +50,16 @@
 #include <stdio.h>
 
 #include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <gst/gst.h>
@@ -65,12 +68,15 @@
 #include <gstsimaaibufferpool.h>
 #include <simaai/trace/pipeline_tp.h>
 #include <gstsimaaicaps.h>
+#include <gstsimaaimeta.h>
 
 #include "gstsimaaiprocessmla.h"
 #include <dispatcherfactory.hh>
+#include <job_replay_session.h>
 #include <simaai/nlohmann/json.hpp>
 #include <simaai/trace/pipeline_new_tp.h>
 #include <simaai/trace/remote_core_tp.h>
+#include <utils_dispatcher.h>
 #include <utils_string.h>
 
 /**
@@ -107,6 +113,9 @@ enum {
   PROP_NO_OF_BUFS,
   PROP_DUMP_DATA,
   PROP_SILENT,
+  PROP_IN_FLIGHT_JOBS,
+  PROP_BATCH_FRAMES,
+  PROP_BATCH_TIMEOUT,
   PROP_LAST,
 };
 
@@ -116,6 +125,44 @@ enum SEG_NAME_STATE {
   HAS_NAME
 };
 
+/**
+ * @brief Frame of a temporal batch. The output buffer is mapped when the frame
+ *        is queued, while it is still writable
+ */
+struct MlaBatchFrame {
+  GstBuffer *inbuf;
+  GstBuffer *outbuf;
+  GstMapInfo out_meminfo;
+  gint64 frame_id;
+};
+
+/**
+ * @brief State of a single MLA job, from submission until its output buffer
+ *        is pushed downstream
+ */
+struct MlaJobContext {
+  simaaidispatcher::JobMLA job;
+  /// Input and output buffers, referenced while the job is in flight
+  GstBuffer *inbuf;
+  GstBuffer *outbuf;
+  GstMapInfo in_meminfo;
+  GstMapInfo out_meminfo;
+  gint64 frame_id;
+  GQuark stream_id;
+  /// Frames of a temporal batch in frame order, empty for single frame jobs.
+  /// inbuf and outbuf of a batch job are the contiguous batch buffers
+  std::vector<MlaBatchFrame> batch;
+  /// Frames the batch job runs, batch size rounded up to a multiple of
+  /// batch_sz_model by repeating the last frame
+  size_t batch_run;
+  /// Kernel start and end time measured in dispatcher
+  std::pair<TimePoint, TimePoint> tp;
+  /// Set by a runner thread once the dispatcher returned
+  bool done;
+  /// Result of the dispatcher run
+  gboolean result;
+};
+
 /**
  * @brief Private member structure for GstSimaaiTopk2 instances
  */
@@ -123,6 +170,7 @@ struct _GstSimaaiProcessMLA_Private
 {
   gboolean dump_data;
   std::string node_name;
+  GQuark node_quark; /**< Interned node name, buffer-name of output frames */
 
   GstBufferPool *pool; /**< Buffer pool */
   int no_of_obufs; /**< number of output memory chuncks to allocate */
@@ -130,6 +178,8 @@ struct _GstSimaaiProcessMLA_Private
 
   simaaidispatcher::DispatcherBase *dispatcher;
   simaaidispatcher::DispatcherFactory::HWType MLA_dispatcher_type;
+  /// Jobs recorded or replayed instead of the dispatcher, SIMAAI_REPLAY_MODE
+  JobReplaySession<simaaidispatcher::JobMLA> replay;
 
   std::string model_path;
   void *model_handle;
@@ -137,6 +187,8 @@ struct _GstSimaaiProcessMLA_Private
   /// @brief state of input segment name. Is is specified, or not
   SEG_NAME_STATE in_segment_name_state;
   std::string input_seg_name;
+  /// @brief interned id of input segment, parent segment if there is no name
+  GstSimaaiSegmentId input_seg_id;
   gint32 timeout;
   std::string config_path;
   nlohmann::json config;
@@ -145,7 +197,7 @@ struct _GstSimaaiProcessMLA_Private
 
   gint64 frame_id; /**< Input frame id placeholder */
   guint64 timestamp;
-  std::string stream_id;
+  GQuark stream_id; /**< Interned stream id of the input frame */
   gint64 in_pcie_buf_id;
   gboolean is_pcie;
 
@@ -155,8 +207,37 @@ struct _GstSimaaiProcessMLA_Private
   std::vector<std::string> segment_names;
   std::vector<size_t> segment_sizes;
 
-  /// Time point pair to store the kernel start and end time measured in dispatcher
-  std::pair<TimePoint, TimePoint> tp;
+  /// Maximum number of MLA jobs submitted at the same time
+  guint in_flight_jobs;
+  /// Jobs waiting for a runner thread
+  std::deque<std::shared_ptr<MlaJobContext>> pending_jobs;
+  /// Submitted jobs in frame order, until they are pushed downstream
+  std::deque<std::shared_ptr<MlaJobContext>> submitted_jobs;
+  std::mutex jobs_mtx;
+  std::condition_variable jobs_cv;
+  std::vector<std::thread> runner_threads;
+  std::thread completion_thread;
+  bool jobs_stop;
+  /// Flow return of the last push done by the completion thread
+  GstFlowReturn completion_ret;
+  /// Held by a runner for dispatcher run, record and replay
+  std::mutex run_mtx;
+
+  /// Frames collected into one MLA run, 1 disables temporal batching
+  guint batch_frames;
+  /// Max wait in ms from the first frame of a batch, 0 waits for a full batch
+  guint batch_timeout;
+  /// Batch collecting frames and its deadline, guarded by jobs_mtx
+  std::shared_ptr<MlaJobContext> open_batch;
+  TimePoint batch_deadline;
+  /// Pools of contiguous batch input and output buffers
+  GstBufferPool *batch_in_pool;
+  GstBufferPool *batch_out_pool;
+  /// Size of the input segment of one frame, stride of the batch input
+  gsize batch_in_size;
+  /// Submits a partial batch when its deadline expires
+  std::thread batch_thread;
+
   GstSimaaiMemoryFlags mem_type;
   GstSimaaiMemoryFlags mem_flag;
 
@@ -176,6 +257,15 @@ static void gst_simaai_process_mla_get_property (GObject * obj, guint prop_id,
                                            GValue * value, GParamSpec * pspec);
 
 static gboolean run_process_mla (GstSimaaiProcessMLA * self, GstBuffer * inbuf, GstBuffer * outbuf);
+static gboolean gst_simaai_process_mla_prepare_job (GstSimaaiProcessMLA * self,
+                                                    MlaJobContext & ctx);
+static gboolean gst_simaai_process_mla_run_job (GstSimaaiProcessMLA * self,
+                                                MlaJobContext & ctx);
+static void gst_simaai_process_mla_resolve_input_segment (GstSimaaiProcessMLA * self);
+static int32_t dump_output_buffer (GstSimaaiProcessMLA * self, void * vaddr,
+                                   gint64 frame_id);
+static void gst_simaai_process_mla_start_jobs_threads (GstSimaaiProcessMLA * self);
+static void gst_simaai_process_mla_stop_jobs_threads (GstSimaaiProcessMLA * self);
 static gboolean gst_simaai_process_mla_extract_meta_info(GstSimaaiProcessMLA * self,
                                                             GstBuffer * inbuf);
 static GstCaps * gst_simaai_process_mla_transform_caps (
@@ -242,6 +332,25 @@ static void gst_simaai_process_mla_set_property (GObject * object,
       GST_DEBUG_OBJECT(self, "Number of buffers argument was changed to %d", 
                        self->priv->no_of_obufs);
       break;
+    case PROP_IN_FLIGHT_JOBS:
+      self->priv->in_flight_jobs = g_value_get_uint(value);
+      GST_DEBUG_OBJECT(self, "In flight jobs argument was changed to %u",
+                       self->priv->in_flight_jobs);
+      break;
+    case PROP_BATCH_FRAMES:
+      self->priv->batch_frames = g_value_get_uint(value);
+      GST_DEBUG_OBJECT(self, "Batch frames argument was changed to %u",
+                       self->priv->batch_frames);
+      break;
+    case PROP_BATCH_TIMEOUT: {
+      // read by the batch thread and when a batch is opened
+      const std::lock_guard<std::mutex> lk(self->priv->jobs_mtx);
+      self->priv->batch_timeout = g_value_get_uint(value);
+      GST_DEBUG_OBJECT(self, "Batch timeout argument was changed to %u ms",
+                       self->priv->batch_timeout);
+      self->priv->jobs_cv.notify_all();
+      break;
+    }
     default:
       GST_DEBUG_OBJECT(self, "Default case warning");
       G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -282,6 +391,15 @@ static void gst_simaai_process_mla_get_property (GObject * object,
     case PROP_NO_OF_BUFS:
       g_value_set_ulong(value, self->priv->no_of_obufs);
       break;
+    case PROP_IN_FLIGHT_JOBS:
+      g_value_set_uint(value, self->priv->in_flight_jobs);
+      break;
+    case PROP_BATCH_FRAMES:
+      g_value_set_uint(value, self->priv->batch_frames);
+      break;
+    case PROP_BATCH_TIMEOUT:
+      g_value_set_uint(value, self->priv->batch_timeout);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
       break;
@@ -365,26 +483,60 @@ static gboolean
 gst_simaai_process_mla_stop (GstBaseTransform *trans)
 {
   GstSimaaiProcessMLA *self = GST_SIMAAI_PROCESS_MLA(trans);
+  // pads are flushing here, outputs of remaining jobs are dropped on push
+  gst_simaai_process_mla_stop_jobs_threads(self);
   gst_simaai_free_buffer_pool(self->priv->pool);
   self->priv->pool = NULL;
+  if (self->priv->batch_in_pool)
+    gst_simaai_free_buffer_pool(self->priv->batch_in_pool);
+  if (self->priv->batch_out_pool)
+    gst_simaai_free_buffer_pool(self->priv->batch_out_pool);
+  self->priv->batch_in_pool = NULL;
+  self->priv->batch_out_pool = NULL;
   return TRUE;
 }
 
-bool parse_json_from_file(GstSimaaiProcessMLA * plugin,
-                          const std::string config_file_path, 
-                          nlohmann::json &json) 
+/**
+ * @brief simaai__params of the config shared through the caps library, with
+ *        negotiated values applied. The file is parsed once for all processmla
+ *        elements using it, the parsed tree is kept with the shared config.
+ */
+bool parse_json_from_config(GstSimaaiProcessMLA * plugin,
+                            GstSimaaiCaps * simaai_caps,
+                            nlohmann::json &params)
 {
+  static GQuark key = g_quark_from_static_string("simaai-processmla-json");
+
+  GstSimaaiConfig * config = simaai_caps->parsed;
+  if (config == nullptr) {
+    GST_ERROR_OBJECT(plugin, "No config parsed");
+    return false;
+  }
+
   try {
-    //parse file to nlohmann::json objects
-    std::ifstream input_file(config_file_path.c_str());
-    if (!input_file) 
-      throw std::runtime_error( std::string("Error opening file ") +
-                                config_file_path );
-    std::ostringstream string_stream;
-    string_stream << input_file.rdbuf();
+    auto * view = static_cast<const nlohmann::json *>(gst_simaai_config_get_view(config, key));
+    if (view == nullptr) {
+      gsize length = 0;
+      const gchar * text = gst_simaai_config_get_text(config, &length);
+      view = static_cast<const nlohmann::json *>(gst_simaai_config_set_view(config, key,
+          new nlohmann::json(nlohmann::json::parse(text, text + length)),
+          [](gpointer data) { delete static_cast<nlohmann::json *>(data); }));
+    }
 
-    json = nlohmann::json::parse(string_stream.str());
+    // negotiated values replace top level fields
+    gsize length = 0;
+    gchar * text = gst_simaai_caps_get_overrides(simaai_caps, &length);
+    if (text != nullptr) {
+      std::string serialized(text, length);
+      g_free(text);
+      nlohmann::json overrides = nlohmann::json::parse(serialized);
+      if (overrides.contains("simaai__params")) {
+        params = overrides["simaai__params"];
+        return true;
+      }
+    }
 
+    params = view->at("simaai__params");
     return true;
 
   } catch (std::exception & ex) {
@@ -418,48 +570,89 @@ bool parse_output_segments(GstSimaaiProcessMLA *self)
 }
 
 /**
- * @brief Callback called when element starts processing
+ * @brief Helper to load the model and parse the config, at NULL to READY.
+ *        Done before the pipeline starts, so gst_app can bring elements to
+ *        READY in parallel.
  *
- * @param trans the gobject for the base class GstBaseTransform
  * @return TRUE on success or FALSE on Failure
  */
 static gboolean
-gst_simaai_process_mla_start (GstBaseTransform * trans)
+gst_simaai_process_mla_load_model (GstSimaaiProcessMLA * self)
 {
-  GstSimaaiProcessMLA *self = GST_SIMAAI_PROCESS_MLA(trans);
-
-  GstCaps * sink_caps = gst_pad_get_allowed_caps(trans->sinkpad);
-  GstCaps * src_caps = gst_pad_get_allowed_caps(trans->srcpad);
-  GST_INFO_OBJECT(self, "Allowed caps on sinkpad = %" GST_PTR_FORMAT, sink_caps);
-  GST_INFO_OBJECT(self, "Allowed caps on srcpad = %" GST_PTR_FORMAT, src_caps);
-
-  auto dispatcher_type = self->priv->MLA_dispatcher_type;
-  self->priv->dispatcher =
-      simaaidispatcher::DispatcherFactory::getDispatcher(dispatcher_type);
-
   //get node name
-  self->priv->node_name = std::string(gst_element_get_name(trans));
+  self->priv->node_name = std::string(GST_ELEMENT_NAME(self));
+  self->priv->node_quark = g_quark_from_string(self->priv->node_name.c_str());
+
+  // replayed jobs need no MLA, the model is not loaded
+  JobReplaySettings replay = JobReplaySettings::from_env();
+  std::string replay_error;
+  if (!self->priv->replay.open(replay, self->priv->node_name, { "ofm0" }, replay_error)) {
+    GST_ERROR_OBJECT(self, "Unable to open job record: %s", replay_error.c_str());
+    return FALSE;
+  }
+  if (replay.mode == JobReplayMode::DRY)
+    GST_INFO_OBJECT(self, "Dry run, jobs are not run");
+  else if (replay.mode != JobReplayMode::OFF)
+    GST_INFO_OBJECT(self, "%s jobs, file %s",
+                    replay.mode == JobReplayMode::RECORD ? "Recording" : "Replaying",
+                    replay.path(self->priv->node_name).c_str());
+
+  if (replay.uses_accelerator() && self->priv->dispatcher == nullptr) {
+    auto dispatcher_type = self->priv->MLA_dispatcher_type;
+    // elements reach READY in parallel, the factory is not thread safe
+    UtilsDispatcherGuard guard;
+    self->priv->dispatcher =
+        simaaidispatcher::DispatcherFactory::getDispatcher(dispatcher_type);
+  }
+  if (replay.uses_accelerator() && self->priv->dispatcher == nullptr) {
+    GST_ELEMENT_ERROR(self, RESOURCE, OPEN_READ_WRITE,
+                      ("Unable to get MLA dispatcher"), (NULL));
+    return FALSE;
+  }
 
   //parse config file
-  nlohmann::json json;
-  if (!parse_json_from_file(self, self->priv->config_path, json))
+  if (!parse_json_from_config(self, self->priv->simaai_caps, self->priv->config))
     return FALSE;
 
-  self->priv->config = json["simaai__params"];
-
   self->priv->model_path = self->priv->config["model_path"];
-  self->priv->model_handle = self->priv->dispatcher->load(
-                               self->priv->model_path.c_str());
+  if (self->priv->dispatcher && self->priv->model_handle == nullptr) {
+    // every element loads into its own dispatcher, loads run in parallel
+    self->priv->model_handle = self->priv->dispatcher->load(
+                                 self->priv->model_path.c_str());
+    if (self->priv->model_handle == nullptr) {
+      GST_ELEMENT_ERROR(self, RESOURCE, OPEN_READ,
+                        ("Unable to load model %s", self->priv->model_path.c_str()),
+                        (NULL));
+      return FALSE;
+    }
+  }
   self->priv->batch_size = self->priv->config["batch_size"];
-  if (self->priv->batch_size != 1)
-    self->priv->batch_model = self->priv->config["batch_sz_model"];
+  self->priv->batch_model = self->priv->config.value("batch_sz_model", 1);
+
+  // temporal batching builds the batch itself from single frame inputs
+  if (self->priv->batch_frames > 1 && self->priv->batch_size != 1) {
+    GST_WARNING_OBJECT(self, "batch-frames is ignored, config batch_size is %d",
+                       self->priv->batch_size);
+    self->priv->batch_frames = 1;
+  }
 
+  // batch jobs are padded up to the compiled batch, never cut below it
+  if (self->priv->batch_frames > 1 && self->priv->batch_model > 1 &&
+      self->priv->batch_frames % self->priv->batch_model != 0) {
+    GST_ERROR_OBJECT(self, "batch-frames %u is not a multiple of config batch_sz_model %d",
+                     self->priv->batch_frames, self->priv->batch_model);
+    return FALSE;
+  }
+
+  self->priv->segment_names.clear();
+  self->priv->segment_sizes.clear();
+  self->priv->out_size = 0;
   if (!parse_output_segments(self)) {
     GST_ERROR_OBJECT(self, "Failed to get output segment information from config!");
     return FALSE;
   }
 
-  //allocate output memory
+  //allocate output memory ahead of start, freed again by stop
   if (!gst_simaai_process_mla_allocate_memory(self)) {
     GST_ERROR_OBJECT(self, "Unable to allocate memory");
     return FALSE;
@@ -468,6 +661,53 @@ gst_simaai_process_mla_start (GstBaseTransform * trans)
   return TRUE;
 }
 
+/**
+ * @brief Helper to release the model loaded at NULL to READY
+ */
+static void
+gst_simaai_process_mla_release_model (GstSimaaiProcessMLA * self)
+{
+  if (self->priv->pool) {
+    gst_simaai_free_buffer_pool(self->priv->pool);
+    self->priv->pool = NULL;
+  }
+
+  if (self->priv->dispatcher) {
+    if (self->priv->model_handle)
+      self->priv->dispatcher->release(self->priv->model_handle);
+    delete self->priv->dispatcher;
+  }
+  self->priv->dispatcher = nullptr;
+  self->priv->model_handle = nullptr;
+}
+
+/**
+ * @brief Callback called when element starts processing
+ *
+ * @param trans the gobject for the base class GstBaseTransform
+ * @return TRUE on success or FALSE on Failure
+ */
+static gboolean
+gst_simaai_process_mla_start (GstBaseTransform * trans)
+{
+  GstSimaaiProcessMLA *self = GST_SIMAAI_PROCESS_MLA(trans);
+
+  GstCaps * sink_caps = gst_pad_get_allowed_caps(trans->sinkpad);
+  GstCaps * src_caps = gst_pad_get_allowed_caps(trans->srcpad);
+  GST_INFO_OBJECT(self, "Allowed caps on sinkpad = %" GST_PTR_FORMAT, sink_caps);
+  GST_INFO_OBJECT(self, "Allowed caps on srcpad = %" GST_PTR_FORMAT, src_caps);
+
+  // pool is freed by stop, so a restart from READY allocates it again
+  if (self->priv->pool == NULL && !gst_simaai_process_mla_allocate_memory(self)) {
+    GST_ERROR_OBJECT(self, "Unable to allocate memory");
+    return FALSE;
+  }
+
+  gst_simaai_process_mla_start_jobs_threads(self);
+
+  return TRUE;
+}
+
 /**
  * @brief Finalize/Cleanup process mla callback
  */
@@ -476,11 +716,8 @@ gst_simaai_process_mla_finalize (GObject * object)
 {
   GstSimaaiProcessMLA * process_mla = GST_SIMAAI_PROCESS_MLA (object);
 
-  if (process_mla->priv->dispatcher) {
-    if (process_mla->priv->model_handle)
-      process_mla->priv->dispatcher->release(process_mla->priv->model_handle);
-    delete process_mla->priv->dispatcher;
-  }
+  gst_simaai_process_mla_stop_jobs_threads(process_mla);
+  gst_simaai_process_mla_release_model(process_mla);
 
   gst_simaai_caps_free(process_mla->priv->simaai_caps);
 
@@ -493,42 +730,632 @@ static gboolean
 gst_simaai_process_mla_extract_meta_info (GstSimaaiProcessMLA * self,
                                           GstBuffer * inbuf)
 {
-  GstCustomMeta * meta;
-  GstStructure * s;
-  gchar * buf_name;
-  gint64 buf_id = 0, frame_id = 0, in_buf_off = 0, pcie_buf_id = 0;
-  guint64 timestamp = 0;
-
-  meta = gst_buffer_get_custom_meta(inbuf, SIMAAI_META_STR);
-  if (meta != NULL) {
-    s = gst_custom_meta_get_structure(meta);
-    if (s == NULL) {
-      gst_buffer_unref(inbuf);
-      return FALSE;
+  GstSimaaiFrameInfo info;
+
+  // buffers without SiMa metadata are processed with the previous frame info
+  if (!gst_buffer_get_simaai_frame_info(inbuf, &info))
+    return TRUE;
+
+  if (info.flags & GST_SIMAAI_FRAME_META_FLAG_PCIE) {
+    self->priv->in_pcie_buf_id = info.pcie_buffer_id;
+    self->priv->is_pcie = TRUE;
+    GST_INFO_OBJECT(self, "Is PCIe. pcie-buffer-id = %ld", info.pcie_buffer_id);
+  }
+
+  self->priv->stream_id = info.stream_id;
+  self->priv->timestamp = info.timestamp;
+  self->priv->frame_id = info.frame_id;
+  self->priv->in_buf_id = info.buffer_id;
+
+  return TRUE;
+}
+
+/**
+ * @brief Helper to attach SiMa metadata of the current frame to output buffer
+ */
+static gboolean
+gst_simaai_process_mla_update_metainfo (GstSimaaiProcessMLA * self,
+                                        GstBuffer * outbuf)
+{
+  GstSimaaiFrameInfo info = {};
+
+  info.buffer_id = self->priv->out_buffer_id;
+  info.buffer_name = self->priv->node_quark;
+  info.buffer_offset = 0;
+  info.frame_id = self->priv->frame_id;
+  info.stream_id = self->priv->stream_id;
+  info.timestamp = self->priv->timestamp;
+  if (self->priv->is_pcie) {
+    GST_INFO_OBJECT (self, "Adding SiMa sPCIe metadata to buffer");
+    info.pcie_buffer_id = self->priv->in_pcie_buf_id;
+    info.flags |= GST_SIMAAI_FRAME_META_FLAG_PCIE;
+  }
+
+  if (gst_buffer_add_simaai_frame_meta(outbuf, &info) == NULL) {
+    GST_ERROR_OBJECT(self, "Unable to add metadata to the buffer");
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+ * @brief Helper to release frames of a batch that is not going to be pushed
+ */
+static void
+gst_simaai_process_mla_release_batch_frames (MlaJobContext & ctx)
+{
+  for (auto & frame : ctx.batch) {
+    gst_buffer_unmap(frame.outbuf, &frame.out_meminfo);
+    gst_buffer_unref(frame.outbuf);
+    gst_buffer_unref(frame.inbuf);
+  }
+  ctx.batch.clear();
+}
+
+/**
+ * @brief Helper to copy input segments of the batch frames back to back into
+ *        the batch input buffer, the last one repeated up to `batch_run`
+ *        frames. Only the used part of it is flushed.
+ */
+static gboolean
+gst_simaai_process_mla_batch_copy_in (GstSimaaiProcessMLA * self,
+                                      MlaJobContext & ctx)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+  const gsize in_size = priv->batch_in_size;
+  const gchar * seg_name = gst_simaai_segment_id_to_name(priv->input_seg_id);
+  GstSimaaiRangeMapInfo dst;
+  gboolean res = TRUE;
+
+  if (!gst_simaai_memory_map_range(gst_buffer_peek_memory(ctx.inbuf, 0), NULL,
+                                   0, ctx.batch_run * in_size, &dst, GST_MAP_WRITE)) {
+    GST_ERROR_OBJECT(self, "Batch input buffer map failed");
+    return FALSE;
+  }
+
+  for (size_t i = 0; i < ctx.batch.size(); i++) {
+    GstSimaaiRangeMapInfo src;
+    if (!gst_simaai_memory_map_range(gst_buffer_peek_memory(ctx.batch[i].inbuf, 0),
+                                     seg_name, 0, in_size, &src, GST_MAP_READ)) {
+      GST_ERROR_OBJECT(self, "Input buffer map failed");
+      res = FALSE;
+      break;
+    }
+    memcpy(dst.data + i * in_size, src.data, in_size);
+    gst_simaai_memory_unmap_range(&src);
+  }
+
+  const guint8 * last = dst.data + (ctx.batch.size() - 1) * in_size;
+  for (size_t i = ctx.batch.size(); res && i < ctx.batch_run; i++)
+    memcpy(dst.data + i * in_size, last, in_size);
+
+  gst_simaai_memory_unmap_range(&dst);
+  return res;
+}
+
+/**
+ * @brief Helper to split the batch output into output buffers of the frames.
+ *        Results of a frame are `out_size` bytes at its index in the batch.
+ */
+static gboolean
+gst_simaai_process_mla_batch_copy_out (GstSimaaiProcessMLA * self,
+                                       MlaJobContext & ctx)
+{
+  const gsize out_size = self->priv->out_size;
+  GstSimaaiRangeMapInfo src;
+
+  if (!gst_simaai_memory_map_range(gst_buffer_peek_memory(ctx.outbuf, 0), NULL,
+                                   0, ctx.batch.size() * out_size, &src, GST_MAP_READ)) {
+    GST_ERROR_OBJECT(self, "Batch output buffer map failed");
+    return FALSE;
+  }
+
+  for (size_t i = 0; i < ctx.batch.size(); i++)
+    memcpy(ctx.batch[i].out_meminfo.data, src.data + i * out_size, out_size);
+
+  gst_simaai_memory_unmap_range(&src);
+  return TRUE;
+}
+
+/**
+ * @brief Helper to run a batch job: gathers the frames into the batch input,
+ *        runs the model once for all of them and splits the batch output
+ */
+static gboolean
+gst_simaai_process_mla_run_batch (GstSimaaiProcessMLA * self, MlaJobContext & ctx)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+  gboolean res = FALSE;
+
+  // the runtime gets whole multiples of the compiled batch, so a partial
+  // batch of the timeout path is padded with its last frame
+  const size_t model = priv->batch_model > 1 ? priv->batch_model : 1;
+  ctx.batch_run = (ctx.batch.size() + model - 1) / model * model;
+
+  ctx.inbuf = NULL;
+  ctx.outbuf = NULL;
+  if (gst_buffer_pool_acquire_buffer(priv->batch_in_pool, &ctx.inbuf, NULL) != GST_FLOW_OK ||
+      gst_buffer_pool_acquire_buffer(priv->batch_out_pool, &ctx.outbuf, NULL) != GST_FLOW_OK) {
+    GST_ERROR_OBJECT(self, "Failed to acquire batch buffers");
+  } else if (gst_simaai_process_mla_batch_copy_in(self, ctx) &&
+             gst_simaai_process_mla_prepare_job(self, ctx) &&
+             gst_simaai_process_mla_run_job(self, ctx)) {
+    res = gst_simaai_process_mla_batch_copy_out(self, ctx);
+  }
+
+  if (res && priv->dump_data) {
+    // frame ids of a batch need not be consecutive, dump names follow the meta
+    for (const auto & frame : ctx.batch)
+      if (dump_output_buffer(self, frame.out_meminfo.data, frame.frame_id) < 0)
+        GST_INFO_OBJECT(self, "Error while dumping frame with ID: %ld", frame.frame_id);
+  }
+
+  if (ctx.inbuf)
+    gst_buffer_unref(ctx.inbuf);
+  if (ctx.outbuf)
+    gst_buffer_unref(ctx.outbuf);
+  ctx.inbuf = NULL;
+  ctx.outbuf = NULL;
+
+  return res;
+}
+
+/**
+ * @brief Helper to push outputs of a finished batch job in frame order
+ */
+static GstFlowReturn
+gst_simaai_process_mla_push_batch (GstSimaaiProcessMLA * self, MlaJobContext & ctx)
+{
+  GstPad * srcpad = GST_BASE_TRANSFORM_SRC_PAD (self);
+  GstFlowReturn ret = ctx.result == TRUE ? GST_FLOW_OK : GST_FLOW_ERROR;
+
+  if (ret != GST_FLOW_OK)
+    GST_ERROR_OBJECT(self, "Failed to run MLA for batch of %zu frames from frame %ld",
+                     ctx.batch.size(), ctx.frame_id);
+
+  for (auto & frame : ctx.batch) {
+    gst_buffer_unmap(frame.outbuf, &frame.out_meminfo);
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_push(srcpad, frame.outbuf);
+    else
+      gst_buffer_unref(frame.outbuf);
+    gst_buffer_unref(frame.inbuf);
+  }
+  ctx.batch.clear();
+
+  return ret;
+}
+
+/**
+ * @brief Helper to submit the open batch to runner threads. Called with
+ *        jobs_mtx held, batches are submitted in the order they were opened.
+ */
+static void
+gst_simaai_process_mla_close_batch_locked (GstSimaaiProcessMLA * self)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+  std::shared_ptr<MlaJobContext> ctx = std::move(priv->open_batch);
+
+  priv->open_batch.reset();
+  priv->pending_jobs.push_back(ctx);
+  priv->submitted_jobs.push_back(ctx);
+  SILENT_GST_DEBUG(self, "Submitted batch of %zu frames from frame %ld, "
+                   "jobs in flight: %zu", ctx->batch.size(), ctx->frame_id,
+                   priv->submitted_jobs.size());
+}
+
+/**
+ * @brief Batch thread. Submits the open batch with the frames collected so far
+ *        once `batch-timeout` passed since its first frame.
+ */
+static void
+gst_simaai_process_mla_batch_loop (GstSimaaiProcessMLA * self)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+  std::unique_lock<std::mutex> lk(priv->jobs_mtx);
+
+  while (!priv->jobs_stop) {
+    if (!priv->open_batch || priv->batch_timeout == 0) {
+      priv->jobs_cv.wait(lk);
+      continue;
+    }
+
+    std::shared_ptr<MlaJobContext> batch = priv->open_batch;
+    if (priv->jobs_cv.wait_until(lk, priv->batch_deadline) == std::cv_status::timeout &&
+        priv->open_batch == batch && !priv->jobs_stop) {
+      SILENT_GST_DEBUG(self, "Batch deadline expired with %zu of %u frames",
+                       batch->batch.size(), priv->batch_frames);
+      gst_simaai_process_mla_close_batch_locked(self);
+      priv->jobs_cv.notify_all();
+    }
+  }
+}
+
+/**
+ * @brief Runner thread. Blocks in the dispatcher for one job at a time, so
+ *        `in-flight-jobs` runners keep that many jobs queued on the MLA.
+ */
+static void
+gst_simaai_process_mla_runner_loop (GstSimaaiProcessMLA * self)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+
+  while (true) {
+    std::shared_ptr<MlaJobContext> ctx;
+    {
+      std::unique_lock<std::mutex> lk(priv->jobs_mtx);
+      priv->jobs_cv.wait(lk, [priv] {
+        return priv->jobs_stop || !priv->pending_jobs.empty();
+      });
+      if (priv->pending_jobs.empty())
+        return;
+      ctx = priv->pending_jobs.front();
+      priv->pending_jobs.pop_front();
+    }
+
+    gboolean result = ctx->batch.empty() ?
+        gst_simaai_process_mla_run_job(self, *ctx) :
+        gst_simaai_process_mla_run_batch(self, *ctx);
+
+    {
+      const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+      ctx->result = result;
+      ctx->done = true;
+    }
+    priv->jobs_cv.notify_all();
+  }
+}
+
+/**
+ * @brief Completion thread. Pushes outputs of finished jobs downstream in the
+ *        order they were submitted.
+ */
+static void
+gst_simaai_process_mla_completion_loop (GstSimaaiProcessMLA * self)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+  GstPad * srcpad = GST_BASE_TRANSFORM_SRC_PAD (self);
+
+  while (true) {
+    std::shared_ptr<MlaJobContext> ctx;
+    {
+      std::unique_lock<std::mutex> lk(priv->jobs_mtx);
+      priv->jobs_cv.wait(lk, [priv] {
+        return (priv->jobs_stop && priv->submitted_jobs.empty()) ||
+               (!priv->submitted_jobs.empty() && priv->submitted_jobs.front()->done);
+      });
+      if (priv->submitted_jobs.empty())
+        return;
+      ctx = priv->submitted_jobs.front();
+    }
+
+    GstFlowReturn ret;
+    if (!ctx->batch.empty()) {
+      ret = gst_simaai_process_mla_push_batch(self, *ctx);
+    } else if (ctx->result != TRUE) {
+      GST_ERROR_OBJECT(self, "Failed to run MLA for frame %ld", ctx->frame_id);
+      gst_buffer_unref(ctx->outbuf);
+      gst_buffer_unref(ctx->inbuf);
+      ret = GST_FLOW_ERROR;
     } else {
-      if ((gst_structure_get_int64(s, "pcie-buffer-id", &pcie_buf_id) == TRUE)){
-        self->priv->in_pcie_buf_id = pcie_buf_id;
-        self->priv->is_pcie = TRUE;
-        GST_INFO_OBJECT(self, "Is PCIe. pcie-buffer-id = %ld", pcie_buf_id);
-      }
-      if ((gst_structure_get_int64(s, "buffer-id", &buf_id) == TRUE) &&
-          (gst_structure_get_int64(s, "frame-id", &frame_id) == TRUE) &&
-          (gst_structure_get_int64(s, "buffer-offset", &in_buf_off) == TRUE) &&
-          (gst_structure_get_uint64(s, "timestamp", &timestamp) == TRUE)) {
-        self->priv->stream_id = gst_structure_get_string(s, "stream-id");
-        self->priv->timestamp = timestamp;
-        buf_name = (gchar *)gst_structure_get_string(s, "buffer-name");
-        self->priv->frame_id = frame_id;
-        self->priv->in_buf_id = buf_id;
-      } else {
-        return FALSE;
-      }
+      ret = gst_pad_push(srcpad, ctx->outbuf);
+      gst_buffer_unref(ctx->inbuf);
+    }
+
+    {
+      // job leaves the queue only after its push, so draining waits for it
+      const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+      priv->submitted_jobs.pop_front();
+      if (ret != GST_FLOW_OK && priv->completion_ret == GST_FLOW_OK)
+        priv->completion_ret = ret;
     }
+    priv->jobs_cv.notify_all();
+  }
+}
+
+/**
+ * @brief Helper to start runner and completion threads in async or batching
+ *        mode
+ */
+static void
+gst_simaai_process_mla_start_jobs_threads (GstSimaaiProcessMLA * self)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+
+  if ((priv->in_flight_jobs <= 1 && priv->batch_frames <= 1) ||
+      priv->completion_thread.joinable())
+    return;
+
+  if (priv->no_of_obufs < (int)priv->in_flight_jobs + 1)
+    GST_WARNING_OBJECT(self, "num-buffers (%d) should be greater than "
+                             "in-flight-jobs (%u), submission will stall on "
+                             "the buffer pool",
+                             priv->no_of_obufs, priv->in_flight_jobs);
+
+  if (priv->batch_frames > 1 && priv->no_of_obufs < (int)priv->batch_frames + 1)
+    GST_WARNING_OBJECT(self, "num-buffers (%d) should be greater than "
+                             "batch-frames (%u), batches will be cut short "
+                             "by batch-timeout",
+                             priv->no_of_obufs, priv->batch_frames);
+
+  priv->jobs_stop = false;
+  priv->completion_ret = GST_FLOW_OK;
+  for (guint i = 0; i < priv->in_flight_jobs; i++)
+    priv->runner_threads.emplace_back(gst_simaai_process_mla_runner_loop, self);
+  priv->completion_thread = std::thread(gst_simaai_process_mla_completion_loop, self);
+  if (priv->batch_frames > 1)
+    priv->batch_thread = std::thread(gst_simaai_process_mla_batch_loop, self);
+
+  GST_DEBUG_OBJECT(self, "Started %u runner threads", priv->in_flight_jobs);
+}
+
+/**
+ * @brief Helper to stop runner and completion threads. Jobs that are already
+ *        submitted are completed before threads exit.
+ */
+static void
+gst_simaai_process_mla_stop_jobs_threads (GstSimaaiProcessMLA * self)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+
+  if (!priv->completion_thread.joinable())
+    return;
+
+  std::shared_ptr<MlaJobContext> open_batch;
+  {
+    const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+    priv->jobs_stop = true;
+    open_batch = std::move(priv->open_batch);
+    priv->open_batch.reset();
+  }
+  priv->jobs_cv.notify_all();
+
+  // frames that were not submitted yet are dropped
+  if (open_batch)
+    gst_simaai_process_mla_release_batch_frames(*open_batch);
+
+  if (priv->batch_thread.joinable())
+    priv->batch_thread.join();
+  for (auto & thread : priv->runner_threads)
+    thread.join();
+  priv->runner_threads.clear();
+  priv->completion_thread.join();
+
+  GST_DEBUG_OBJECT(self, "Stopped runner threads");
+}
+
+/**
+ * @brief Helper to wait until all submitted jobs are pushed downstream
+ */
+static void
+gst_simaai_process_mla_drain_jobs (GstSimaaiProcessMLA * self)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+
+  std::unique_lock<std::mutex> lk(priv->jobs_mtx);
+  priv->jobs_cv.wait(lk, [priv] { return priv->submitted_jobs.empty(); });
+}
+
+/**
+ * @brief Helper to submit the open batch without waiting for more frames
+ */
+static void
+gst_simaai_process_mla_flush_batch (GstSimaaiProcessMLA * self)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+
+  {
+    const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+    if (!priv->open_batch)
+      return;
+    gst_simaai_process_mla_close_batch_locked(self);
+  }
+  priv->jobs_cv.notify_all();
+}
+
+/**
+ * @brief Helper to drop frames of the open batch on flush
+ */
+static void
+gst_simaai_process_mla_drop_batch (GstSimaaiProcessMLA * self)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+  std::shared_ptr<MlaJobContext> open_batch;
+
+  {
+    const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+    open_batch = std::move(priv->open_batch);
+    priv->open_batch.reset();
+  }
+
+  if (open_batch) {
+    GST_DEBUG_OBJECT(self, "Dropping %zu frames of the open batch",
+                     open_batch->batch.size());
+    gst_simaai_process_mla_release_batch_frames(*open_batch);
+  }
+}
+
+/**
+ * @brief Helper to create pools of batch buffers, sized by the input segment
+ *        of the first frame
+ */
+static gboolean
+gst_simaai_process_mla_ensure_batch_pools (GstSimaaiProcessMLA * self,
+                                           GstBuffer * inbuf)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+
+  if (priv->batch_in_pool != NULL)
+    return TRUE;
+
+  gst_simaai_process_mla_resolve_input_segment(self);
+  priv->batch_in_size = gst_simaai_memory_get_segment_size(
+      gst_buffer_peek_memory(inbuf, 0), priv->input_seg_id);
+  if (priv->batch_in_size == 0) {
+    GST_ERROR_OBJECT(self, "Input buffer was not allocated by segment allocator "
+                           "or has no input segment");
+    return FALSE;
+  }
+
+  GstSimaaiMemoryFlags mem_target = get_mem_target(SIMA_CPU_MLA);
+  mem_target =
+      (mem_target < priv->mem_type) ? priv->mem_type : mem_target;
+  GstMemoryFlags flags = (GstMemoryFlags)(mem_target | GST_SIMAAI_MEMORY_FLAG_CACHED);
+  GstAllocator *allocator = gst_simaai_memory_get_segment_allocator();
+
+  // every runner holds one input and one output batch buffer at most
+  priv->batch_in_pool = gst_simaai_allocate_buffer_pool((GstObject *) self,
+      allocator, priv->batch_frames * priv->batch_in_size,
+      1, priv->in_flight_jobs, flags);
+  priv->batch_out_pool = gst_simaai_allocate_buffer_pool((GstObject *) self,
+      allocator, priv->batch_frames * priv->out_size,
+      1, priv->in_flight_jobs, flags);
+  if (priv->batch_in_pool == NULL || priv->batch_out_pool == NULL) {
+    GST_ERROR_OBJECT(self, "Unable to allocate batch buffers");
+    return FALSE;
   }
 
+  GST_DEBUG_OBJECT(self, "Batch buffers: %u frames, input %zu bytes, output %zu bytes",
+                   priv->batch_frames, priv->batch_frames * priv->batch_in_size,
+                   priv->batch_frames * priv->out_size);
   return TRUE;
 }
 
+/**
+ * @brief Helper to add a frame to the open batch in batching mode. The batch is
+ *        submitted when it is full, or by the batch thread on its deadline.
+ */
+static GstFlowReturn
+gst_simaai_process_mla_batch_frame (GstSimaaiProcessMLA * self,
+                                    GstBuffer * inbuf,
+                                    GstBuffer * outbuf)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+  MlaBatchFrame frame;
+
+  {
+    const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+    if (priv->completion_ret != GST_FLOW_OK)
+      return priv->completion_ret;
+  }
+
+  if (!gst_simaai_process_mla_update_metainfo(self, outbuf))
+    return GST_FLOW_ERROR;
+
+  if (!gst_simaai_process_mla_ensure_batch_pools(self, inbuf))
+    return GST_FLOW_ERROR;
+
+  gsize in_size = gst_simaai_memory_get_segment_size(gst_buffer_peek_memory(inbuf, 0),
+                                                     priv->input_seg_id);
+  if (in_size != priv->batch_in_size) {
+    GST_ERROR_OBJECT(self, "Input size %zu of frame %ld differs from batch "
+                           "slot size %zu", in_size, priv->frame_id,
+                           priv->batch_in_size);
+    return GST_FLOW_ERROR;
+  }
+
+  // outbuf is writable only until it is shared
+  if (!gst_buffer_map(outbuf, &frame.out_meminfo, GST_MAP_WRITE)) {
+    GST_ERROR_OBJECT(self, "Output buffer map failed");
+    return GST_FLOW_ERROR;
+  }
+  frame.inbuf = gst_buffer_ref(inbuf);
+  frame.outbuf = gst_buffer_ref(outbuf);
+  frame.frame_id = priv->frame_id;
+
+  {
+    const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+    if (priv->jobs_stop) {
+      gst_buffer_unmap(outbuf, &frame.out_meminfo);
+      gst_buffer_unref(outbuf);
+      gst_buffer_unref(inbuf);
+      return GST_FLOW_FLUSHING;
+    }
+
+    if (!priv->open_batch) {
+      auto ctx = std::make_shared<MlaJobContext>();
+      ctx->inbuf = NULL;
+      ctx->outbuf = NULL;
+      ctx->frame_id = priv->frame_id;
+      ctx->stream_id = priv->stream_id;
+      ctx->done = false;
+      ctx->result = FALSE;
+      ctx->batch.reserve(priv->batch_frames);
+      priv->open_batch = ctx;
+      priv->batch_deadline = std::chrono::steady_clock::now() +
+          std::chrono::milliseconds(priv->batch_timeout);
+    }
+
+    priv->open_batch->batch.push_back(frame);
+    if (priv->open_batch->batch.size() >= priv->batch_frames)
+      gst_simaai_process_mla_close_batch_locked(self);
+  }
+  priv->jobs_cv.notify_all();
+
+  return GST_BASE_TRANSFORM_FLOW_DROPPED;
+}
+
+/**
+ * @brief Helper to submit a job in async mode. Buffers are referenced by the
+ *        job, base transform gets GST_BASE_TRANSFORM_FLOW_DROPPED and the output
+ *        is pushed later by the completion thread.
+ */
+static GstFlowReturn
+gst_simaai_process_mla_submit_job (GstSimaaiProcessMLA * self,
+                                   GstBuffer * inbuf,
+                                   GstBuffer * outbuf)
+{
+  GstSimaaiProcessMLA_Private * priv = self->priv;
+
+  {
+    const std::lock_guard<std::mutex> lk(priv->jobs_mtx);
+    if (priv->completion_ret != GST_FLOW_OK)
+      return priv->completion_ret;
+  }
+
+  // metadata is known upfront, and outbuf is writable only until it is shared
+  if (!gst_simaai_process_mla_update_metainfo(self, outbuf))
+    return GST_FLOW_ERROR;
+
+  auto ctx = std::make_shared<MlaJobContext>();
+  ctx->inbuf = inbuf;
+  ctx->outbuf = outbuf;
+  ctx->frame_id = priv->frame_id;
+  ctx->stream_id = priv->stream_id;
+  ctx->done = false;
+  ctx->result = FALSE;
+
+  if (!gst_simaai_process_mla_prepare_job(self, *ctx))
+    return GST_FLOW_ERROR;
+
+  gst_buffer_ref(inbuf);
+  gst_buffer_ref(outbuf);
+
+  {
+    std::unique_lock<std::mutex> lk(priv->jobs_mtx);
+    priv->jobs_cv.wait(lk, [priv] {
+      return priv->jobs_stop || priv->submitted_jobs.size() < priv->in_flight_jobs;
+    });
+
+    if (priv->jobs_stop) {
+      lk.unlock();
+      gst_buffer_unmap(outbuf, &ctx->out_meminfo);
+      gst_buffer_unmap(inbuf, &ctx->in_meminfo);
+      gst_buffer_unref(outbuf);
+      gst_buffer_unref(inbuf);
+      return GST_FLOW_FLUSHING;
+    }
+
+    priv->pending_jobs.push_back(ctx);
+    priv->submitted_jobs.push_back(ctx);
+    SILENT_GST_DEBUG(self, "Submitted frame %ld, jobs in flight: %zu",
+                     ctx->frame_id, priv->submitted_jobs.size());
+  }
+  priv->jobs_cv.notify_all();
+
+  return GST_BASE_TRANSFORM_FLOW_DROPPED;
+}
+
 /**
  * @brief Virtual call to do transformation of input buffer to an output buffer, 
  * this is not inplace
@@ -551,6 +1378,12 @@ gst_simaai_process_mla_transform (GstBaseTransform *trans, GstBuffer *inbuf,
 
   GST_DEBUG_OBJECT(self, "MLA frame_cnt[%ld]", self->priv->frame_id);
 
+  if (self->priv->batch_frames > 1)
+    return gst_simaai_process_mla_batch_frame(self, inbuf, outbuf);
+
+  if (self->priv->in_flight_jobs > 1)
+    return gst_simaai_process_mla_submit_job(self, inbuf, outbuf);
+
   if (!self->silent)
     self->priv->t0 = std::chrono::steady_clock::now();
   
@@ -572,27 +1405,9 @@ gst_simaai_process_mla_transform (GstBaseTransform *trans, GstBuffer *inbuf,
   // TO DO: KPI needs to be updated here
 
   // Update metadata
-  GstCustomMeta * meta = gst_buffer_add_custom_meta(outbuf, SIMAAI_META_STR);
-  if (meta == NULL) {
-    GST_ERROR_OBJECT(self, "Unable to add metadata to the buffer");
+  if (!gst_simaai_process_mla_update_metainfo(self, outbuf))
     return GST_FLOW_ERROR;
-  }
-  GstStructure *s = gst_custom_meta_get_structure (meta);
-  if (s != NULL) {
-    gst_structure_set (s,
-                       "buffer-id", G_TYPE_INT64, self->priv->out_buffer_id,
-                       "buffer-name", G_TYPE_STRING, self->priv->node_name.c_str(),
-                       "buffer-offset", G_TYPE_INT64, (gint64)0,
-                       "frame-id", G_TYPE_INT64, self->priv->frame_id, 
-                       "stream-id", G_TYPE_STRING, self->priv->stream_id.c_str(),
-                       "timestamp", G_TYPE_UINT64, self->priv->timestamp,
-                       NULL);
-    if (self->priv->is_pcie) {
-      GST_INFO_OBJECT (self, "Adding SiMa sPCIe metadata to buffer");
-      gst_structure_set(s, "pcie-buffer-id", G_TYPE_INT64, 
-                        self->priv->in_pcie_buf_id, NULL);
-    }
-  }
+
   return GST_FLOW_OK;
 }
 
@@ -676,7 +1491,22 @@ gst_simaai_process_mla_sink_eventfunc(GstBaseTransform *trans, GstEvent *event)
 {
   GstSimaaiProcessMLA *processmla = GST_SIMAAI_PROCESS_MLA(trans);
 
+  if (GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_START)
+    gst_simaai_process_mla_drop_batch(processmla);
+
+  // serialized events must not overtake buffers of jobs still in flight, a
+  // partial batch is run right away
+  if (GST_EVENT_IS_SERIALIZED(event)) {
+    gst_simaai_process_mla_flush_batch(processmla);
+    gst_simaai_process_mla_drain_jobs(processmla);
+  }
+
   switch (GST_EVENT_TYPE(event)) {
+    case GST_EVENT_FLUSH_STOP: {
+      const std::lock_guard<std::mutex> lk(processmla->priv->jobs_mtx);
+      processmla->priv->completion_ret = GST_FLOW_OK;
+      break;
+    }
     case GST_EVENT_CAPS:
       if (!gst_simaai_caps_negotiate(GST_ELEMENT(processmla),
         processmla->priv->simaai_caps)) {
@@ -710,6 +1540,14 @@ gst_simaai_process_mla_change_state(GstElement *element,
         GST_ERROR_OBJECT(processmla, "<%s>: Error parsing config", G_STRFUNC);
         return GST_STATE_CHANGE_FAILURE;
       }
+      if (!gst_simaai_process_mla_load_model(processmla)) {
+        GST_ERROR_OBJECT(processmla, "<%s>: Error loading model", G_STRFUNC);
+        gst_simaai_process_mla_release_model(processmla);
+        return GST_STATE_CHANGE_FAILURE;
+      }
+      break;
+    case GST_STATE_CHANGE_READY_TO_NULL:
+      gst_simaai_process_mla_release_model(processmla);
       break;
     default:
       break;
@@ -829,6 +1667,34 @@ gst_simaai_process_mla_class_init (GstSimaaiProcessMLAClass * klass)
                                                         "Save binary outputs to /tmp/[node-name]",
                                                         FALSE,
                                                         (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+  g_object_class_install_property(gobject_class, PROP_IN_FLIGHT_JOBS,
+                                  g_param_spec_uint("in-flight-jobs",
+                                                    "In Flight Jobs",
+                                                    "Number of MLA jobs submitted at the same time. "
+                                                    "Values above 1 enable async mode, outputs are "
+                                                    "pushed in frame order",
+                                                    1, MAX_IN_FLIGHT_JOBS,
+                                                    DEFAULT_IN_FLIGHT_JOBS,
+                                                    (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                  GST_PARAM_MUTABLE_READY)));
+  g_object_class_install_property(gobject_class, PROP_BATCH_FRAMES,
+                                  g_param_spec_uint("batch-frames",
+                                                    "Batch Frames",
+                                                    "Number of consecutive frames collected into one "
+                                                    "batched MLA run. Values above 1 enable temporal "
+                                                    "batching, outputs are split back per frame",
+                                                    1, MAX_BATCH_FRAMES,
+                                                    DEFAULT_BATCH_FRAMES,
+                                                    (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                  GST_PARAM_MUTABLE_READY)));
+  g_object_class_install_property(gobject_class, PROP_BATCH_TIMEOUT,
+                                  g_param_spec_uint("batch-timeout",
+                                                    "Batch Timeout",
+                                                    "Max wait in ms from the first frame of a batch "
+                                                    "until a partial batch is run. 0 waits for a full batch",
+                                                    0, G_MAXUINT,
+                                                    DEFAULT_BATCH_TIMEOUT,
+                                                    (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
   g_object_class_install_property(gobject_class, PROP_SILENT,
                                   g_param_spec_boolean ("silent",
                                                         "Silent",
@@ -881,7 +1747,8 @@ gst_simaai_process_mla_class_init (GstSimaaiProcessMLAClass * klass)
     GST_DEBUG_FUNCPTR(gst_simaai_process_mla_change_state);
 
   static const gchar *tags[] = { NULL };
-  gst_meta_register_custom ("GstSimaMeta", tags, NULL, NULL, NULL);
+  if (gst_meta_get_info (SIMAAI_META_STR) == NULL)
+    gst_meta_register_custom (SIMAAI_META_STR, tags, NULL, NULL, NULL);
 }
 
 /**
@@ -889,7 +1756,7 @@ gst_simaai_process_mla_class_init (GstSimaaiProcessMLAClass * klass)
  * @todo move to utils
  */
 static int32_t
-dump_output_buffer(GstSimaaiProcessMLA * self, void * vaddr)
+dump_output_buffer(GstSimaaiProcessMLA * self, void * vaddr, gint64 frame_id)
 {
   FILE *ofp;
   size_t wosz;
@@ -900,7 +1767,7 @@ dump_output_buffer(GstSimaaiProcessMLA * self, void * vaddr)
 
   snprintf(full_opath, sizeof(full_opath) - 1, "/tmp/%s-%ld.out",
            self->priv->node_name.c_str(),
-           self->priv->frame_id);
+           frame_id);
 
   ofp = fopen(full_opath, "w");
   if(ofp == NULL) {
@@ -944,116 +1811,197 @@ std::chrono::system_clock::time_point steady_to_system(
 }
 
 /**
- * @brief The entry point function to running process_mla
+ * @brief Helper to resolve the input segment of frames once, from the
+ *        optional `input_segment_name` of the config
  */
-static gboolean
-run_process_mla(GstSimaaiProcessMLA *self, GstBuffer *inbuf, GstBuffer * outbuf)
+static void
+gst_simaai_process_mla_resolve_input_segment(GstSimaaiProcessMLA *self)
 {
-  simaaidispatcher::JobMLA job;
-  GstMapInfo in_meminfo, out_meminfo;
-  int retval;
+  nlohmann::json & cfg = self->priv->config;
+  if (self->priv->in_segment_name_state != SEG_NAME_STATE::UNDEFINED)
+    return;
 
-  if (self->transmit) {
-    tracepoint_pipeline_mla_start(self->priv->frame_id, (char *)self->priv->node_name.c_str(), (char *)self->priv->stream_id.c_str());
+  self->priv->in_segment_name_state = cfg.contains("input_segment_name") ? 
+      SEG_NAME_STATE::HAS_NAME : SEG_NAME_STATE::NO_NAME;
+  
+  if (self->priv->in_segment_name_state == SEG_NAME_STATE::HAS_NAME) {
+    self->priv->input_seg_name = cfg["input_segment_name"];
   }
-  self->priv->t0 = std::chrono::steady_clock::now();
+
+  // NULL == parent segment == full buffer
+  self->priv->input_seg_id = gst_simaai_segment_id_from_name(
+      (self->priv->in_segment_name_state == SEG_NAME_STATE::HAS_NAME) ?
+          self->priv->input_seg_name.c_str() : NULL);
+}
+
+/**
+ * @brief Helper to unmap buffers of a job, see prepare_job
+ */
+static void
+gst_simaai_process_mla_unmap_job(MlaJobContext & ctx)
+{
+  if (!ctx.batch.empty())
+    return;
+
+  gst_buffer_unmap(ctx.outbuf, &ctx.out_meminfo);
+  gst_buffer_unmap(ctx.inbuf, &ctx.in_meminfo);
+}
+
+/**
+ * @brief Helper to map buffers of a job and fill in the MLA job structure.
+ *        Buffers of a batch job are the contiguous batch buffers, they are
+ *        not mapped here: the used part of them is range mapped where the
+ *        frames are copied, a full map would invalidate and flush all of it.
+ */
+static gboolean
+gst_simaai_process_mla_prepare_job(GstSimaaiProcessMLA *self, MlaJobContext & ctx)
+{
+  simaaidispatcher::JobMLA & job = ctx.job;
+  GstSimaaiSegmentId in_seg_id = GST_SIMAAI_SEGMENT_ID_PARENT;
 
   job.path = self->priv->model_path;
   job.handle = self->priv->model_handle;
-  job.batchSize = self->priv->batch_size;
+  job.batchSize = ctx.batch.empty() ? self->priv->batch_size : (gint32)ctx.batch_run;
   if (job.batchSize != 1)
     job.batchModel = self->priv->batch_model;
   job.timeout = std::chrono::seconds(self->priv->timeout);
 
-  std::string combined_id = self->priv->node_name + self->priv->stream_id;
-  uint64_t request_id = ((uint64_t)str_to_uint32_hash(combined_id.c_str()) << 32) | self->priv->frame_id;
-  job.requestID = request_id;
+  std::string combined_id = self->priv->node_name + GST_SIMAAI_QUARK_STR(ctx.stream_id);
+  job.requestID = ((uint64_t)str_to_uint32_hash(combined_id.c_str()) << 32) | ctx.frame_id;
 
-  if (!gst_buffer_map(inbuf, &in_meminfo, GST_MAP_READ)) {
-    GST_ERROR_OBJECT(self, "Input buffer map failed");
-    return FALSE;
-  }
-
-  if (!gst_buffer_map(outbuf, &out_meminfo, GST_MAP_WRITE)) {
-    GST_ERROR_OBJECT(self, "Output buffer map failed");
-    return FALSE;
-  }
+  GstMemory * in_mem, * out_mem;
+  if (ctx.batch.empty()) {
+    if (!gst_buffer_map(ctx.inbuf, &ctx.in_meminfo, GST_MAP_READ)) {
+      GST_ERROR_OBJECT(self, "Input buffer map failed");
+      return FALSE;
+    }
 
-  nlohmann::json & cfg = self->priv->config;
-  if (self->priv->in_segment_name_state == SEG_NAME_STATE::UNDEFINED) {
-    self->priv->in_segment_name_state = cfg.contains("input_segment_name") ? 
-        SEG_NAME_STATE::HAS_NAME : SEG_NAME_STATE::NO_NAME;
-    
-    if (self->priv->in_segment_name_state == SEG_NAME_STATE::HAS_NAME) {
-      self->priv->input_seg_name = cfg["input_segment_name"];
+    if (!gst_buffer_map(ctx.outbuf, &ctx.out_meminfo, GST_MAP_WRITE)) {
+      GST_ERROR_OBJECT(self, "Output buffer map failed");
+      gst_buffer_unmap(ctx.inbuf, &ctx.in_meminfo);
+      return FALSE;
     }
+
+    gst_simaai_process_mla_resolve_input_segment(self);
+    in_seg_id = self->priv->input_seg_id;
+    in_mem = ctx.in_meminfo.memory;
+    out_mem = ctx.out_meminfo.memory;
+  } else {
+    // batch input holds frame input segments back to back
+    in_mem = gst_buffer_peek_memory(ctx.inbuf, 0);
+    out_mem = gst_buffer_peek_memory(ctx.outbuf, 0);
   }
-  
-  // NULL == parent segment == full buffer
-  const gchar *seg_name =
-      (self->priv->in_segment_name_state == SEG_NAME_STATE::HAS_NAME) ?
-          self->priv->input_seg_name.c_str() : NULL;
 
   if ((job.buffers["ifm0"] =
-      (simaai_memory_t *)gst_simaai_memory_get_segment(in_meminfo.memory,
-      seg_name)) == nullptr) {
+      (simaai_memory_t *)gst_simaai_memory_get_segment_by_id(in_mem,
+      in_seg_id)) == nullptr) {
         GST_ERROR_OBJECT(self, "Attach to the input memory chunk failed. Either "
                                "segment with requested name is not in input memory, "
                                "or memory was allocated without using segment allocator");
+    gst_simaai_process_mla_unmap_job(ctx);
     return FALSE;
   }
 
   if ((job.buffers["ofm0"] =
-      (simaai_memory_t *)gst_simaai_memory_get_segment(out_meminfo.memory,
-      NULL)) == nullptr) {
+      (simaai_memory_t *)gst_simaai_memory_get_segment_by_id(out_mem,
+      GST_SIMAAI_SEGMENT_ID_PARENT)) == nullptr) {
     GST_ERROR_OBJECT(self, "Attach to the output memory chunk failed");
+    gst_simaai_process_mla_unmap_job(ctx);
     return FALSE;
   }
-  retval = self->priv->dispatcher->run(job, self->priv->tp);
+
+  return TRUE;
+}
+
+/**
+ * @brief Helper to run a prepared job on the MLA. Buffers of the job are
+ *        unmapped when it returns.
+ */
+static gboolean
+gst_simaai_process_mla_run_job(GstSimaaiProcessMLA *self, MlaJobContext & ctx)
+{
+  simaaidispatcher::JobMLA & job = ctx.job;
+  gboolean res = TRUE;
+  int retval;
+
+  if (self->transmit) {
+    tracepoint_pipeline_mla_start(ctx.frame_id, (char *)self->priv->node_name.c_str(), (char *)GST_SIMAAI_QUARK_STR(ctx.stream_id));
+  }
+  auto t0 = std::chrono::steady_clock::now();
+
+  {
+    // the dispatcher is not documented as reentrant and the replay file is
+    // read in order, runners take turns here while mapping, copies and
+    // pushes of other jobs go on
+    const std::lock_guard<std::mutex> lk(self->priv->run_mtx);
+    if (!self->priv->replay.uses_accelerator()) {
+      retval = self->priv->replay.replay(job, ctx.tp);
+    } else {
+      retval = self->priv->dispatcher->run(job, ctx.tp);
+      if (retval == 0 && self->priv->replay.mode() == JobReplayMode::RECORD)
+        retval = self->priv->replay.record(job, ctx.tp);
+    }
+  }
   if (retval != 0) {
     GST_ERROR_OBJECT(self, "Dispatcher returned error: %d", retval);
+    gst_simaai_process_mla_unmap_job(ctx);
     return FALSE;
   }
 
   if (self->transmit) {
     auto boot_time = get_boot_time().time_since_epoch();
-    auto start_time = boot_time + self->priv->tp.first;
+    auto start_time = boot_time + ctx.tp.first;
     uint64_t kernel_start = std::chrono::duration_cast<std::chrono::microseconds>(start_time.time_since_epoch()).count();
-    tracepoint_mla_kernel_start(kernel_start, request_id);
+    tracepoint_mla_kernel_start(kernel_start, job.requestID);
 
-    auto end_time = boot_time + self->priv->tp.second;
+    auto end_time = boot_time + ctx.tp.second;
     uint64_t kernel_end = std::chrono::duration_cast<std::chrono::microseconds>(end_time.time_since_epoch()).count();
-    tracepoint_mla_kernel_end(kernel_end, request_id);
+    tracepoint_mla_kernel_end(kernel_end, job.requestID);
 
-    tracepoint_pipeline_mla_end(self->priv->frame_id, (char *)self->priv->node_name.c_str(), (char *)self->priv->stream_id.c_str());
+    tracepoint_pipeline_mla_end(ctx.frame_id, (char *)self->priv->node_name.c_str(), (char *)GST_SIMAAI_QUARK_STR(ctx.stream_id));
   }
 
-  self->priv->t1 = std::chrono::steady_clock::now();
-  auto elapsed = 
-      std::chrono::duration_cast<std::chrono::microseconds>(self->priv->t1 - 
-                                                            self->priv->t0);
+  auto t1 = std::chrono::steady_clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
   auto duration = elapsed.count() / 1000.0 ;
   auto kernel_rt = 
-      std::chrono::duration_cast<std::chrono::microseconds>(self->priv->tp.second - 
-                                                            self->priv->tp.first);
+      std::chrono::duration_cast<std::chrono::microseconds>(ctx.tp.second - 
+                                                            ctx.tp.first);
   auto kernel_duration = kernel_rt.count() / 1000.0 ;
   GST_DEBUG_OBJECT(self, "MLA model  %s run time is :  %f ms", 
                           job.path.c_str(), kernel_duration);
 
-  if (self->priv->dump_data) {
-    retval = dump_output_buffer(self, out_meminfo.data);
+  // frames of a batch are dumped by run_batch once split
+  if (self->priv->dump_data && ctx.batch.empty()) {
+    retval = dump_output_buffer(self, ctx.out_meminfo.data, ctx.frame_id);
     if (retval < 0) {
       GST_INFO_OBJECT(self, "Error(%d) while dumping frame with ID: %ld",
-        retval, self->priv->frame_id);
-      gst_buffer_unmap(outbuf, &out_meminfo);
-      gst_buffer_unmap(inbuf, &in_meminfo);
-      return FALSE;
+        retval, ctx.frame_id);
+      res = FALSE;
     }
   }
-  gst_buffer_unmap(outbuf, &out_meminfo);
-  gst_buffer_unmap(inbuf, &in_meminfo);
+  gst_simaai_process_mla_unmap_job(ctx);
 
-  return TRUE;
+  return res;
+}
+
+/**
+ * @brief The entry point function to running process_mla
+ */
+static gboolean
+run_process_mla(GstSimaaiProcessMLA *self, GstBuffer *inbuf, GstBuffer * outbuf)
+{
+  MlaJobContext ctx;
+
+  ctx.inbuf = inbuf;
+  ctx.outbuf = outbuf;
+  ctx.frame_id = self->priv->frame_id;
+  ctx.stream_id = self->priv->stream_id;
+
+  if (!gst_simaai_process_mla_prepare_job(self, ctx))
+    return FALSE;
+
+  return gst_simaai_process_mla_run_job(self, ctx);
 }
 
 /**
@@ -1069,6 +2017,7 @@ gst_simaai_process_mla_init (GstSimaaiProcessMLA * self)
   self->priv->pool = NULL;
   self->priv->MLA_dispatcher_type = simaaidispatcher::DispatcherFactory::MLA;
   self->priv->in_segment_name_state = SEG_NAME_STATE::UNDEFINED;
+  self->priv->input_seg_id = GST_SIMAAI_SEGMENT_ID_PARENT;
   self->priv->in_pcie_buf_id = 0;
   self->priv->is_pcie = FALSE;
   self->priv->timeout = 60;
@@ -1076,6 +2025,8 @@ gst_simaai_process_mla_init (GstSimaaiProcessMLA * self)
   self->priv->dump_data = false;
   self->priv->no_of_obufs = MIN_POOL_SIZE;
   self->priv->timestamp = 0;
+  self->priv->stream_id = 0;
+  self->priv->node_quark = 0;
   self->priv->dispatcher = nullptr;
   self->priv->model_handle = nullptr;
 
@@ -1084,6 +2035,16 @@ gst_simaai_process_mla_init (GstSimaaiProcessMLA * self)
 
   self->priv->out_size = 0;
 
+  self->priv->in_flight_jobs = DEFAULT_IN_FLIGHT_JOBS;
+  self->priv->jobs_stop = false;
+  self->priv->completion_ret = GST_FLOW_OK;
+
+  self->priv->batch_frames = DEFAULT_BATCH_FRAMES;
+  self->priv->batch_timeout = DEFAULT_BATCH_TIMEOUT;
+  self->priv->batch_in_pool = NULL;
+  self->priv->batch_out_pool = NULL;
+  self->priv->batch_in_size = 0;
+
   self->priv->simaai_caps = gst_simaai_caps_init();
 }
 
@@ -14,6 +14,11 @@
 #define DEFAULT_BATCH_SIZE 1
 #define SIMAAI_META_STR "GstSimaMeta"
 #define MIN_POOL_SIZE 2
+#define DEFAULT_IN_FLIGHT_JOBS 1
+#define MAX_IN_FLIGHT_JOBS 16
+#define DEFAULT_BATCH_FRAMES 1
+#define MAX_BATCH_FRAMES 32
+#define DEFAULT_BATCH_TIMEOUT 50
 
 #define PAD_TEMPLATE_NAME_SINK  "sink"
 #define PAD_TEMPLATE_NAME_SRC   "src"
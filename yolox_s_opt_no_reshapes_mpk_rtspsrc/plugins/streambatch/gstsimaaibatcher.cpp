@@ -0,0 +1,687 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+/**
+ * @file gstsimaaibatcher.cpp
+ * @brief Gstreamer plugin to gather frames of many streams into one batch
+ * @author SiMa.Ai\TM
+ * @bug Currently no known bugs
+ */
+
+/**
+ * SECTION: element-simaaibatcher
+ *
+ * Gathers frames of N streams, one stream per sink pad, into one batch buffer
+ * for a model compiled with a batch size. Slots are served round robin, each
+ * stream gets at most `max-per-stream` slots of a batch. The layout of the
+ * batch is kept for simaaiunbatcher, which splits the results back per stream.
+ *
+ * <refsect2>
+ * <title> Example Launch line </title>
+ * |[
+ * ... ! simaaiprocesscvu name=preproc_0 ! batcher.sink_0
+ * ... ! simaaiprocesscvu name=preproc_1 ! batcher.sink_1
+ * simaaibatcher name=batcher batch-size=2 ! simaaiprocessmla config=mla_batch2.json
+ * ! simaaiprocesscvu config=detess_batch2.json ! simaaiunbatcher name=unbatcher
+ * unbatcher.src_0 ! ...
+ * unbatcher.src_1 ! ...
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gst/gst.h>
+#include <gst/base/gstaggregator.h>
+
+#include <gstsimaaiallocator.h>
+#include <gstsimaaibufferpool.h>
+#include <gstsimaaimeta.h>
+
+#include "gstsimaaibatcher.h"
+#include "stream_batch.h"
+
+/**
+ * @brief Flag to print minimized log.
+ */
+#define DEFAULT_SILENT TRUE
+
+/**
+ * @brief batcher properties
+ */
+enum {
+  PROP_0,
+  PROP_BATCH_SIZE,
+  PROP_MAX_PER_STREAM,
+  PROP_BATCH_TIMEOUT,
+  PROP_SEGMENT_NAME,
+  PROP_NO_OF_BUFS,
+  PROP_SILENT,
+  PROP_UNKNONW,
+};
+
+GST_DEBUG_CATEGORY_STATIC(gst_simaai_batcher_debug);
+#define GST_CAT_DEFAULT gst_simaai_batcher_debug
+
+/**
+ * @brief Private fields of batcher
+ */
+struct _GstSimaaiBatcherPrivate
+{
+  /// Name of the node, used as `buffer-name` and `stream-id` of output
+  std::string node_name;
+  GQuark node_quark;
+
+  guint batch_size;
+  guint max_per_stream;
+  /// Max wait in ms for frames of all streams, applied as aggregator latency
+  guint batch_timeout;
+  /// Segment of the input frames copied into a slot, empty for whole buffer
+  std::string segment_name;
+  GstSimaaiSegmentId segment_id;
+
+  StreamBatchScheduler scheduler;
+  /// Size of a slot, taken from the first frame
+  gsize frame_size;
+
+  GstBufferPool * pool;
+  guint num_of_out_buf;
+  GstSimaaiMemoryFlags mem_type;
+  GstSimaaiMemoryFlags mem_flag;
+
+  /// Frame id of the next batch, key of its layout
+  gint64 batch_id;
+};
+
+#define gst_simaai_batcher_parent_class parent_class
+G_DEFINE_TYPE (GstSimaaiBatcher, gst_simaai_batcher, GST_TYPE_AGGREGATOR);
+
+/**
+ * @brief helper function to free output buffer pool
+ */
+static void gst_simaai_batcher_free_memory (GstSimaaiBatcher * self)
+{
+  if (self->priv->pool != nullptr) {
+    gst_simaai_free_buffer_pool(self->priv->pool);
+    self->priv->pool = nullptr;
+  }
+}
+
+/**
+ * @brief helper function to allocate batch buffers, slots are sized by the
+ *        first frame
+ */
+static gboolean gst_simaai_batcher_allocate_memory (GstSimaaiBatcher * self,
+                                                    GstBuffer * frame)
+{
+  GstSimaaiBatcherPrivate * priv = self->priv;
+
+  if (priv->pool != nullptr)
+    return TRUE;
+
+  priv->frame_size = gst_simaai_memory_get_segment_size(gst_buffer_peek_memory(frame, 0),
+                                                        priv->segment_id);
+  if (priv->frame_size == 0) {
+    GST_ERROR_OBJECT (self, "Input buffer was not allocated by segment allocator "
+                      "or has no segment '%s'", priv->segment_name.c_str());
+    return FALSE;
+  }
+
+  gsize segment_sizes[1] = { priv->batch_size * priv->frame_size };
+  const gchar * segment_names[1] = { priv->node_name.c_str() };
+
+  GstMemoryFlags flags = static_cast<GstMemoryFlags>(priv->mem_type | priv->mem_flag);
+
+  priv->pool = gst_simaai_allocate_buffer_pool2((GstObject *) self,
+                                                gst_simaai_memory_get_segment_allocator(),
+                                                MIN_POOL_SIZE,
+                                                priv->num_of_out_buf,
+                                                flags, 1,
+                                                segment_sizes,
+                                                segment_names);
+
+  if (priv->pool == nullptr) {
+    GST_ERROR_OBJECT (self, "Failed to allocate buffer pool");
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (self, "Batch buffer pool: %u buffers of %u slots of %zu bytes",
+                    priv->num_of_out_buf, priv->batch_size, priv->frame_size);
+
+  return TRUE;
+}
+
+/**
+ * @brief Helper API to get sink pads ordered by pad index, so round robin
+ *        order does not depend on the order pads were requested in
+ */
+static void gst_simaai_batcher_get_pads (GstSimaaiBatcher * self,
+                                         std::vector<std::pair<guint, GstAggregatorPad *>> & pads)
+{
+  pads.clear();
+
+  GST_OBJECT_LOCK (self);
+  for (GList * l = GST_ELEMENT (self)->sinkpads; l != NULL; l = l->next) {
+    GstPad * pad = GST_PAD (l->data);
+    // pad names follow the "sink_%u" template
+    guint index = (guint) g_ascii_strtoull(GST_PAD_NAME (pad) + strlen("sink_"), NULL, 10);
+    pads.emplace_back(index, GST_AGGREGATOR_PAD (gst_object_ref (pad)));
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  std::sort(pads.begin(), pads.end(),
+            [](const std::pair<guint, GstAggregatorPad *> & a,
+               const std::pair<guint, GstAggregatorPad *> & b) {
+              return a.first < b.first;
+            });
+}
+
+/**
+ * @brief Helper API to copy a frame into its slot and record it in the layout
+ */
+static gboolean gst_simaai_batcher_copy_frame (GstSimaaiBatcher * self,
+                                               GstBuffer * frame,
+                                               std::pair<guint, GstAggregatorPad *> & pad,
+                                               guint8 * slot,
+                                               StreamBatchSlot & slot_info)
+{
+  GstSimaaiBatcherPrivate * priv = self->priv;
+  GstMemory * mem = gst_buffer_peek_memory(frame, 0);
+  GstSimaaiRangeMapInfo src;
+
+  gsize size = gst_simaai_memory_get_segment_size(mem, priv->segment_id);
+  if (size != priv->frame_size) {
+    GST_ERROR_OBJECT (self, "Frame of %s has %zu bytes, slot size is %zu",
+                      GST_PAD_NAME (pad.second), size, priv->frame_size);
+    return FALSE;
+  }
+
+  if (!gst_simaai_memory_map_range(mem, gst_simaai_segment_id_to_name(priv->segment_id),
+                                   0, size, &src, GST_MAP_READ)) {
+    GST_ERROR_OBJECT (self, "Failed to map frame of %s", GST_PAD_NAME (pad.second));
+    return FALSE;
+  }
+  memcpy(slot, src.data, size);
+  gst_simaai_memory_unmap_range(&src);
+
+  GstSimaaiFrameInfo info = {};
+  if (!gst_buffer_get_simaai_frame_info(frame, &info))
+    GST_WARNING_OBJECT (self, "Frame of %s has no metadata", GST_PAD_NAME (pad.second));
+
+  slot_info.pad_index = pad.first;
+  // streams are told apart by pad if upstream did not name them
+  slot_info.stream_id = info.stream_id ? info.stream_id :
+                        g_quark_from_string(GST_PAD_NAME (pad.second));
+  slot_info.frame_id = info.frame_id;
+  slot_info.timestamp = info.timestamp;
+  slot_info.pts = GST_BUFFER_PTS (frame);
+  slot_info.dts = GST_BUFFER_DTS (frame);
+  slot_info.duration = GST_BUFFER_DURATION (frame);
+
+  return TRUE;
+}
+
+/**
+ * @brief Helper API to build the batch buffer from frames taken by scheduler
+ */
+static GstFlowReturn gst_simaai_batcher_process (GstSimaaiBatcher * self,
+                                                 std::vector<std::pair<guint, GstAggregatorPad *>> & pads,
+                                                 std::vector<GstBuffer *> & frames)
+{
+  GstSimaaiBatcherPrivate * priv = self->priv;
+  const std::vector<uint32_t> & plan = priv->scheduler.plan();
+  GstBuffer * outbuf = NULL;
+  GstSimaaiRangeMapInfo dst;
+  StreamBatchLayout layout;
+
+  if (!gst_simaai_batcher_allocate_memory(self, frames[0]))
+    return GST_FLOW_ERROR;
+
+  if (gst_buffer_pool_acquire_buffer(priv->pool, &outbuf, NULL) != GST_FLOW_OK) {
+    GST_ERROR_OBJECT (self, "Failed to allocate buffer");
+    return GST_FLOW_ERROR;
+  }
+
+  // only filled slots are written, padding slots keep stale data and their
+  // results are dropped by the unbatcher
+  if (!gst_simaai_memory_map_range(gst_buffer_peek_memory(outbuf, 0), NULL, 0,
+                                   frames.size() * priv->frame_size, &dst, GST_MAP_WRITE)) {
+    GST_ERROR_OBJECT (self, "Failed to map batch buffer");
+    gst_buffer_unref(outbuf);
+    return GST_FLOW_ERROR;
+  }
+
+  layout.batch_size = priv->batch_size;
+  layout.slots.resize(frames.size());
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (!gst_simaai_batcher_copy_frame(self, frames[i], pads[plan[i]],
+                                       dst.data + i * priv->frame_size,
+                                       layout.slots[i])) {
+      gst_simaai_memory_unmap_range(&dst);
+      gst_buffer_unref(outbuf);
+      return GST_FLOW_ERROR;
+    }
+  }
+  gst_simaai_memory_unmap_range(&dst);
+
+  GstSimaaiFrameInfo info = {};
+  info.buffer_id = gst_simaai_segment_memory_get_phys_addr(gst_buffer_peek_memory(outbuf, 0));
+  info.buffer_offset = 0;
+  info.frame_id = priv->batch_id;
+  info.timestamp = layout.slots[0].timestamp;
+  info.buffer_name = priv->node_quark;
+  info.stream_id = priv->node_quark;
+
+  if (gst_buffer_add_simaai_frame_meta(outbuf, &info) == NULL) {
+    GST_ERROR_OBJECT (self, "Unable to add metadata info to the buffer");
+    gst_buffer_unref(outbuf);
+    return GST_FLOW_ERROR;
+  }
+
+  GST_BUFFER_PTS (outbuf) = layout.slots[0].pts;
+  GST_BUFFER_DTS (outbuf) = layout.slots[0].dts;
+  GST_BUFFER_DURATION (outbuf) = layout.slots[0].duration;
+
+  if (!self->silent)
+    GST_DEBUG_OBJECT (self, "batch[%ld]: %zu of %u slots filled",
+                      priv->batch_id, frames.size(), priv->batch_size);
+
+  // layout has to be there before downstream can see the batch
+  StreamBatchRegistry::instance().put(priv->node_quark, priv->batch_id, std::move(layout));
+  priv->batch_id++;
+
+  return gst_aggregator_finish_buffer (GST_AGGREGATOR (self), outbuf);
+}
+
+static GstFlowReturn gst_simaai_batcher_aggregate (GstAggregator * aggregator,
+                                                   gboolean timeout)
+{
+  GstSimaaiBatcher * self = GST_SIMAAI_BATCHER (aggregator);
+  GstSimaaiBatcherPrivate * priv = self->priv;
+  std::vector<std::pair<guint, GstAggregatorPad *>> pads;
+  std::vector<GstBuffer *> frames;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  gst_simaai_batcher_get_pads(self, pads);
+
+  frames.reserve(priv->batch_size);
+  priv->scheduler.fill(pads.size(), [&pads, &frames](uint32_t stream) {
+    GstBuffer * buf = gst_aggregator_pad_pop_buffer (pads[stream].second);
+    if (buf == NULL)
+      return false;
+    frames.push_back(buf);
+    return true;
+  });
+
+  if (!frames.empty()) {
+    ret = gst_simaai_batcher_process(self, pads, frames);
+  } else {
+    // on timeout no stream had a frame, otherwise all of them are done
+    gboolean all_eos = !pads.empty();
+    for (auto & pad : pads)
+      all_eos &= gst_aggregator_pad_is_eos (pad.second);
+    if (all_eos)
+      ret = GST_FLOW_EOS;
+  }
+
+  for (GstBuffer * frame : frames)
+    gst_buffer_unref(frame);
+  for (auto & pad : pads)
+    gst_object_unref(pad.second);
+
+  return ret;
+}
+
+/**
+ * @brief Batch has the caps of the stream frames, model input is negotiated
+ *        by simaaiprocessmla config
+ */
+static GstFlowReturn
+gst_simaai_batcher_update_src_caps (GstAggregator * aggregator,
+                                    GstCaps * caps, GstCaps ** ret)
+{
+  GstSimaaiBatcher * self = GST_SIMAAI_BATCHER (aggregator);
+  GstCaps * sink_caps = NULL;
+
+  GST_OBJECT_LOCK (self);
+  for (GList * l = GST_ELEMENT (self)->sinkpads; l != NULL && sink_caps == NULL; l = l->next)
+    sink_caps = gst_pad_get_current_caps (GST_PAD (l->data));
+  GST_OBJECT_UNLOCK (self);
+
+  if (sink_caps == NULL)
+    return GST_AGGREGATOR_FLOW_NEED_DATA;
+
+  *ret = gst_caps_intersect(caps, sink_caps);
+  gst_caps_unref(sink_caps);
+
+  if (gst_caps_is_empty(*ret)) {
+    GST_ERROR_OBJECT (self, "Downstream does not accept caps of the streams");
+    gst_caps_replace(ret, NULL);
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  return GST_FLOW_OK;
+}
+
+static gboolean gst_simaai_batcher_decide_allocation (GstAggregator * aggregator,
+                                                      GstQuery * query)
+{
+  GstSimaaiBatcher * self = GST_SIMAAI_BATCHER (aggregator);
+
+  GstSimaaiMemoryFlags mem_type;
+  GstSimaaiMemoryFlags mem_flag;
+
+  if (!gst_simaai_allocation_query_parse(query, &mem_type, &mem_flag)) {
+    GST_WARNING_OBJECT(self, "Can't find allocation meta!");
+  } else {
+    self->priv->mem_type = mem_type;
+    self->priv->mem_flag = mem_flag;
+  }
+
+  GST_DEBUG_OBJECT(self, "Memory flags to allocate: [ %s ] [ %s ]",
+    gst_simaai_allocation_query_sima_mem_type_to_str(self->priv->mem_type),
+    gst_simaai_allocation_query_sima_mem_flag_to_str(self->priv->mem_flag));
+
+  // pool is sized by the first frame, a renegotiation reallocates it
+  gst_simaai_batcher_free_memory(self);
+
+  return TRUE;
+}
+
+static gboolean gst_simaai_batcher_propose_allocation (GstAggregator * aggregator,
+                                                       GstAggregatorPad * pad,
+                                                       GstQuery * decide_query,
+                                                       GstQuery * query)
+{
+  // frames are copied on A65
+  GstStructure *allocation_meta =
+      gst_simaai_allocation_query_create_meta(GST_SIMAAI_MEMORY_TARGET_GENERIC,
+                                              GST_SIMAAI_MEMORY_FLAG_CACHED);
+
+  gst_simaai_allocation_query_add_meta(query, allocation_meta);
+
+  return TRUE;
+}
+
+/**
+ * @brief Called to perform state change.
+ */
+static GstStateChangeReturn
+gst_simaai_batcher_change_state (GstElement * element,
+                                 GstStateChange transition)
+{
+  GstSimaaiBatcher * self = GST_SIMAAI_BATCHER (element);
+  GstSimaaiBatcherPrivate * priv = self->priv;
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+  case GST_STATE_CHANGE_NULL_TO_READY: {
+    gchar * name = gst_element_get_name(element);
+    priv->node_name = name;
+    priv->node_quark = g_quark_from_string(name);
+    g_free(name);
+    GST_DEBUG_OBJECT(self, "GST_STATE_CHANGE_NULL_TO_READY");
+    break;
+  }
+  case GST_STATE_CHANGE_READY_TO_PAUSED:
+    priv->segment_id = gst_simaai_segment_id_from_name(
+        priv->segment_name.empty() ? NULL : priv->segment_name.c_str());
+    priv->scheduler.configure(priv->batch_size, priv->max_per_stream);
+    priv->batch_id = 0;
+    GST_DEBUG_OBJECT(self, "GST_STATE_CHANGE_READY_TO_PAUSED");
+    break;
+  default:
+    break;
+  }
+
+  ret = GST_ELEMENT_CLASS(parent_class)->change_state(element, transition);
+  if (ret == GST_STATE_CHANGE_FAILURE)
+    return ret;
+
+  switch (transition) {
+  case GST_STATE_CHANGE_PAUSED_TO_READY:
+    StreamBatchRegistry::instance().clear(priv->node_quark);
+    gst_simaai_batcher_free_memory(self);
+    GST_DEBUG_OBJECT(self, "GST_STATE_CHANGE_PAUSED_TO_READY");
+    break;
+  default:
+    break;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief Setter for batcher properties.
+ */
+static void gst_simaai_batcher_set_property (GObject * object,
+                                             guint prop_id,
+                                             const GValue * value,
+                                             GParamSpec * pspec)
+{
+  GstSimaaiBatcher * self = GST_SIMAAI_BATCHER (object);
+  GstSimaaiBatcherPrivate * priv = self->priv;
+
+  switch (prop_id) {
+    case PROP_BATCH_SIZE:
+      priv->batch_size = g_value_get_uint(value);
+      break;
+    case PROP_MAX_PER_STREAM:
+      priv->max_per_stream = g_value_get_uint(value);
+      break;
+    case PROP_BATCH_TIMEOUT:
+      priv->batch_timeout = g_value_get_uint(value);
+      // aggregator produces an incomplete batch once latency expired
+      g_object_set(object, "latency", (guint64) priv->batch_timeout * GST_MSECOND, NULL);
+      break;
+    case PROP_SEGMENT_NAME: {
+      const gchar * name = g_value_get_string(value);
+      priv->segment_name = name ? name : "";
+      break;
+    }
+    case PROP_NO_OF_BUFS:
+      priv->num_of_out_buf = g_value_get_ulong(value);
+      break;
+    case PROP_SILENT:
+      self->silent = g_value_get_boolean(value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+}
+
+/**
+ * @brief Getter for batcher properties.
+ */
+static void gst_simaai_batcher_get_property (GObject * object,
+                                             guint prop_id,
+                                             GValue * value,
+                                             GParamSpec * pspec)
+{
+  GstSimaaiBatcher * self = GST_SIMAAI_BATCHER (object);
+  GstSimaaiBatcherPrivate * priv = self->priv;
+
+  switch (prop_id) {
+    case PROP_BATCH_SIZE:
+      g_value_set_uint(value, priv->batch_size);
+      break;
+    case PROP_MAX_PER_STREAM:
+      g_value_set_uint(value, priv->max_per_stream);
+      break;
+    case PROP_BATCH_TIMEOUT:
+      g_value_set_uint(value, priv->batch_timeout);
+      break;
+    case PROP_SEGMENT_NAME:
+      g_value_set_string(value, priv->segment_name.c_str());
+      break;
+    case PROP_NO_OF_BUFS:
+      g_value_set_ulong(value, priv->num_of_out_buf);
+      break;
+    case PROP_SILENT:
+      g_value_set_boolean(value, self->silent);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+}
+
+/**
+ * @brief Finalize/Cleanup batcher callback
+ */
+static void
+gst_simaai_batcher_finalize (GObject * object)
+{
+  GstSimaaiBatcher * self = GST_SIMAAI_BATCHER (object);
+
+  gst_simaai_batcher_free_memory(self);
+
+  delete self->priv;
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+/**
+ * @brief Callback to batcher class init
+ */
+static void
+gst_simaai_batcher_class_init (GstSimaaiBatcherClass * klass)
+{
+  GObjectClass *gobj_class = G_OBJECT_CLASS(klass);
+  GstElementClass *gstelement_class = (GstElementClass *) klass;
+  GstAggregatorClass *base_aggregator_class = (GstAggregatorClass *) klass;
+
+  GstPadTemplate *sink_pad_template =
+      gst_pad_template_new_with_gtype(BATCHER_PAD_TEMPLATE_NAME_SINK, GST_PAD_SINK,
+      GST_PAD_REQUEST, gst_caps_new_any(), GST_TYPE_AGGREGATOR_PAD);
+  gst_element_class_add_pad_template(gstelement_class, sink_pad_template);
+
+  GstPadTemplate *src_pad_template =
+      gst_pad_template_new_with_gtype(BATCHER_PAD_TEMPLATE_NAME_SRC, GST_PAD_SRC,
+      GST_PAD_ALWAYS, gst_caps_new_any(), GST_TYPE_AGGREGATOR_PAD);
+  gst_element_class_add_pad_template(gstelement_class, src_pad_template);
+
+  gobj_class->finalize = gst_simaai_batcher_finalize;
+  gobj_class->set_property = gst_simaai_batcher_set_property;
+  gobj_class->get_property = gst_simaai_batcher_get_property;
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_simaai_batcher_change_state);
+
+  base_aggregator_class->aggregate =
+      GST_DEBUG_FUNCPTR (gst_simaai_batcher_aggregate);
+  base_aggregator_class->update_src_caps =
+      GST_DEBUG_FUNCPTR (gst_simaai_batcher_update_src_caps);
+  base_aggregator_class->decide_allocation =
+      GST_DEBUG_FUNCPTR (gst_simaai_batcher_decide_allocation);
+  base_aggregator_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_simaai_batcher_propose_allocation);
+
+  g_object_class_install_property (gobj_class, PROP_BATCH_SIZE,
+                                   g_param_spec_uint ("batch-size",
+                                                      "Batch Size",
+                                                      "Slots in a batch buffer, batch size of the model",
+                                                      1, MAX_BATCH_SIZE, DEFAULT_BATCH_SIZE,
+                                                      (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                    GST_PARAM_MUTABLE_READY)));
+  g_object_class_install_property (gobj_class, PROP_MAX_PER_STREAM,
+                                   g_param_spec_uint ("max-per-stream",
+                                                      "Max Per Stream",
+                                                      "Max slots of a batch taken by frames of one stream",
+                                                      1, MAX_BATCH_SIZE, DEFAULT_MAX_PER_STREAM,
+                                                      (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                    GST_PARAM_MUTABLE_READY)));
+  g_object_class_install_property (gobj_class, PROP_BATCH_TIMEOUT,
+                                   g_param_spec_uint ("batch-timeout",
+                                                      "Batch Timeout",
+                                                      "Max time in ms to wait for frames of all streams in live "
+                                                      "pipelines, an incomplete batch is sent after it",
+                                                      0, G_MAXUINT, DEFAULT_BATCH_TIMEOUT,
+                                                      (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                    GST_PARAM_MUTABLE_READY)));
+  g_object_class_install_property (gobj_class, PROP_SEGMENT_NAME,
+                                   g_param_spec_string ("segment-name",
+                                                        "Segment Name",
+                                                        "Segment of the input frames copied into the batch, "
+                                                        "whole buffer if not set",
+                                                        NULL,
+                                                        (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                      GST_PARAM_MUTABLE_READY)));
+  /* This property is used to allocate output buffers memory */
+  g_object_class_install_property(gobj_class, PROP_NO_OF_BUFS,
+                                  g_param_spec_ulong("num-buffers",
+                                                     "Number Of Buffers",
+                                                     "Number of buffers to be allocated of size of buffer",
+                                                     1, G_MAXUINT,
+                                                     DEFAULT_NUM_BUFFERS,
+                                                     (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+  g_object_class_install_property (gobj_class, PROP_SILENT,
+                                   g_param_spec_boolean ("silent",
+                                                         "Silent",
+                                                         "Produce verbose output",
+                                                         DEFAULT_SILENT,
+                                                         (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+                                         "SiMa.AI Stream Batcher Plugin",
+                                         "Filter/Muxer",
+                                         "Gathers frames of many streams into one batch buffer",
+                                         "SiMa.AI");
+
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT,
+                           "simaaibatcher", 0, "Batcher");
+}
+
+static void
+gst_simaai_batcher_init (GstSimaaiBatcher * self)
+{
+  GstAggregator *agg = GST_AGGREGATOR (self);
+  gst_segment_init (&GST_AGGREGATOR_PAD (agg->srcpad)->segment,
+                    GST_FORMAT_TIME);
+
+  self->silent = DEFAULT_SILENT;
+  gst_simaai_segment_memory_init_once();
+  self->priv = new GstSimaaiBatcherPrivate;
+
+  self->priv->node_quark = 0;
+  self->priv->batch_size = DEFAULT_BATCH_SIZE;
+  self->priv->max_per_stream = DEFAULT_MAX_PER_STREAM;
+  self->priv->batch_timeout = DEFAULT_BATCH_TIMEOUT;
+  g_object_set(self, "latency", (guint64) DEFAULT_BATCH_TIMEOUT * GST_MSECOND, NULL);
+  self->priv->segment_id = GST_SIMAAI_SEGMENT_ID_PARENT;
+  self->priv->frame_size = 0;
+
+  self->priv->pool = nullptr;
+  self->priv->num_of_out_buf = DEFAULT_NUM_BUFFERS;
+  self->priv->mem_type = GST_SIMAAI_MEMORY_TARGET_GENERIC;
+  self->priv->mem_flag = GST_SIMAAI_MEMORY_FLAG_CACHED;
+  self->priv->batch_id = 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef GST_SIMAAIBATCHER_H_
+#define GST_SIMAAIBATCHER_H_
+
+#include <gst/gst.h>
+#include <gst/base/gstaggregator.h>
+
+#define DEFAULT_BATCH_SIZE 4
+#define MAX_BATCH_SIZE 32
+#define DEFAULT_MAX_PER_STREAM 1
+#define DEFAULT_BATCH_TIMEOUT 33
+#define DEFAULT_NUM_BUFFERS 5
+#define MIN_POOL_SIZE 2
+
+#define BATCHER_PAD_TEMPLATE_NAME_SINK  "sink_%u"
+#define BATCHER_PAD_TEMPLATE_NAME_SRC   "src"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_SIMAAI_BATCHER            (gst_simaai_batcher_get_type ())
+#define GST_SIMAAI_BATCHER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_SIMAAI_BATCHER, GstSimaaiBatcher))
+#define GST_SIMAAI_BATCHER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GST_TYPE_SIMAAI_BATCHER, GstSimaaiBatcherClass))
+#define GST_SIMAAI_BATCHER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GST_TYPE_SIMAAI_BATCHER, GstSimaaiBatcherClass))
+
+typedef struct _GstSimaaiBatcher GstSimaaiBatcher;
+typedef struct _GstSimaaiBatcherClass GstSimaaiBatcherClass;
+typedef struct _GstSimaaiBatcherPrivate GstSimaaiBatcherPrivate;
+
+struct _GstSimaaiBatcher
+{
+  GstAggregator parent;
+  gboolean silent; /**< true to print minimized log */
+  GstSimaaiBatcherPrivate *priv;
+};
+
+struct _GstSimaaiBatcherClass
+{
+  GstAggregatorClass parent_class;
+};
+
+GType gst_simaai_batcher_get_type (void);
+
+G_END_DECLS
+
+#endif // GST_SIMAAIBATCHER_H_
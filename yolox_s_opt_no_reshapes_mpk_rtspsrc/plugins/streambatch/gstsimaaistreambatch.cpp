@@ -0,0 +1,67 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+/**
+ * @file gstsimaaistreambatch.cpp
+ * @brief Registers simaaibatcher and simaaiunbatcher. Both elements share the
+ *        batch layout registry, so they are built into one plugin.
+ * @author SiMa.Ai\TM
+ * @bug Currently no known bugs
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <gst/gst.h>
+
+#include "gstsimaaibatcher.h"
+#include "gstsimaaiunbatcher.h"
+
+static gboolean
+plugin_init (GstPlugin * plugin)
+{
+  if (!gst_element_register(plugin, "simaaibatcher", GST_RANK_NONE,
+                            GST_TYPE_SIMAAI_BATCHER)) {
+    GST_ERROR("Unable to register simaaibatcher plugin");
+    return FALSE;
+  }
+
+  if (!gst_element_register(plugin, "simaaiunbatcher", GST_RANK_NONE,
+                            GST_TYPE_SIMAAI_UNBATCHER)) {
+    GST_ERROR("Unable to register simaaiunbatcher plugin");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+GST_PLUGIN_DEFINE(
+    GST_VERSION_MAJOR,
+    GST_VERSION_MINOR,
+    PLUGIN_NAME_LOWER,
+    "GStreamer SiMa.ai Stream Batch Plugin",
+    plugin_init,
+    VERSION,
+    GST_LICENSE,
+    GST_PACKAGE_NAME,
+    GST_PACKAGE_ORIGIN
+     );
@@ -0,0 +1,638 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+/**
+ * @file gstsimaaiunbatcher.cpp
+ * @brief Gstreamer plugin to split batch results of simaaibatcher per stream
+ * @author SiMa.Ai\TM
+ * @bug Currently no known bugs
+ */
+
+/**
+ * SECTION: element-simaaiunbatcher
+ *
+ * Splits a frame-major batch buffer, e.g. the detess dequant output of a batch
+ * built by simaaibatcher, into one buffer per filled slot. A slot is pushed on
+ * `src_%u` with the index of the batcher sink pad the frame came from, with
+ * frame metadata and timestamps of that frame.
+ *
+ * <refsect2>
+ * <title> Example Launch line </title>
+ * |[
+ * ... ! simaaiprocesscvu config=detess_batch2.json ! simaaiunbatcher name=unbatcher
+ * unbatcher.src_0 ! overlay_0.
+ * unbatcher.src_1 ! overlay_1.
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+
+#include <gst/gst.h>
+#include <gst/base/gstflowcombiner.h>
+
+#include <gstsimaaiallocator.h>
+#include <gstsimaaibufferpool.h>
+#include <gstsimaaimeta.h>
+
+#include "gstsimaaiunbatcher.h"
+#include "stream_batch.h"
+
+/**
+ * @brief Flag to print minimized log.
+ */
+#define DEFAULT_SILENT TRUE
+
+/**
+ * @brief unbatcher properties
+ */
+enum {
+  PROP_0,
+  PROP_NO_OF_BUFS,
+  PROP_SILENT,
+  PROP_UNKNONW,
+};
+
+GST_DEBUG_CATEGORY_STATIC(gst_simaai_unbatcher_debug);
+#define GST_CAT_DEFAULT gst_simaai_unbatcher_debug
+
+/**
+ * @brief Private fields of unbatcher
+ */
+struct _GstSimaaiUnbatcherPrivate
+{
+  /// Src pads by index, guarded by the object lock
+  std::map<guint, GstPad *> srcpads;
+  GstFlowCombiner * flow_combiner;
+
+  /// Size of one slot of the batch results, taken from the first batch
+  gsize slot_size;
+  GstBufferPool * pool;
+  guint num_of_out_buf;
+  GstSimaaiMemoryFlags mem_type;
+  GstSimaaiMemoryFlags mem_flag;
+};
+
+#define gst_simaai_unbatcher_parent_class parent_class
+G_DEFINE_TYPE (GstSimaaiUnbatcher, gst_simaai_unbatcher, GST_TYPE_ELEMENT);
+
+/**
+ * @brief helper function to free output buffer pool
+ */
+static void gst_simaai_unbatcher_free_memory (GstSimaaiUnbatcher * self)
+{
+  if (self->priv->pool != nullptr) {
+    gst_simaai_free_buffer_pool(self->priv->pool);
+    self->priv->pool = nullptr;
+  }
+  self->priv->slot_size = 0;
+}
+
+/**
+ * @brief helper function to allocate output buffers of one slot. Memory type
+ *        is queried on the pad the first slot goes to.
+ */
+static gboolean gst_simaai_unbatcher_allocate_memory (GstSimaaiUnbatcher * self,
+                                                      GstPad * srcpad,
+                                                      gsize slot_size)
+{
+  GstSimaaiUnbatcherPrivate * priv = self->priv;
+
+  if (priv->pool != nullptr) {
+    if (slot_size == priv->slot_size)
+      return TRUE;
+    GST_INFO_OBJECT (self, "Slot size changed from %zu to %zu", priv->slot_size, slot_size);
+    gst_simaai_unbatcher_free_memory(self);
+  }
+
+  GstCaps * caps = gst_pad_get_current_caps(self->sinkpad);
+  GstSimaaiMemoryFlags mem_type;
+  GstSimaaiMemoryFlags mem_flag;
+  if (caps != NULL && gst_simaai_allocation_query_send(srcpad, caps, &mem_type, &mem_flag)) {
+    priv->mem_type = mem_type;
+    priv->mem_flag = mem_flag;
+  } else {
+    GST_WARNING_OBJECT(self, "Can't find allocation meta!");
+  }
+  if (caps != NULL)
+    gst_caps_unref(caps);
+
+  gchar * name = gst_element_get_name(self);
+  gsize segment_sizes[1] = { slot_size };
+  const gchar * segment_names[1] = { name };
+  GstMemoryFlags flags = static_cast<GstMemoryFlags>(priv->mem_type | priv->mem_flag);
+
+  priv->pool = gst_simaai_allocate_buffer_pool2((GstObject *) self,
+                                                gst_simaai_memory_get_segment_allocator(),
+                                                MIN_POOL_SIZE,
+                                                priv->num_of_out_buf,
+                                                flags, 1,
+                                                segment_sizes,
+                                                segment_names);
+  g_free(name);
+
+  if (priv->pool == nullptr) {
+    GST_ERROR_OBJECT (self, "Failed to allocate buffer pool");
+    return FALSE;
+  }
+
+  priv->slot_size = slot_size;
+  GST_DEBUG_OBJECT (self, "Output buffer pool: %u buffers of size %zu",
+                    priv->num_of_out_buf, slot_size);
+
+  return TRUE;
+}
+
+/**
+ * @brief Helper API to get the src pad of a stream, NULL if it was not requested
+ */
+static GstPad * gst_simaai_unbatcher_get_srcpad (GstSimaaiUnbatcher * self,
+                                                 guint pad_index)
+{
+  GstPad * srcpad = NULL;
+
+  GST_OBJECT_LOCK (self);
+  auto it = self->priv->srcpads.find(pad_index);
+  if (it != self->priv->srcpads.end())
+    srcpad = GST_PAD (gst_object_ref (it->second));
+  GST_OBJECT_UNLOCK (self);
+
+  return srcpad;
+}
+
+/**
+ * @brief Helper API to push the results of one slot on its stream pad
+ */
+static GstFlowReturn gst_simaai_unbatcher_push_slot (GstSimaaiUnbatcher * self,
+                                                     GstPad * srcpad,
+                                                     const GstSimaaiFrameInfo & batch_info,
+                                                     const StreamBatchSlot & slot,
+                                                     const guint8 * data)
+{
+  GstSimaaiUnbatcherPrivate * priv = self->priv;
+  GstBuffer * outbuf = NULL;
+  GstMapInfo out_map;
+
+  if (gst_buffer_pool_acquire_buffer(priv->pool, &outbuf, NULL) != GST_FLOW_OK) {
+    GST_ERROR_OBJECT (self, "Failed to allocate buffer");
+    return GST_FLOW_ERROR;
+  }
+
+  if (!gst_buffer_map(outbuf, &out_map, GST_MAP_WRITE)) {
+    GST_ERROR_OBJECT (self, "Failed to map output buffer");
+    gst_buffer_unref(outbuf);
+    return GST_FLOW_ERROR;
+  }
+  memcpy(out_map.data, data, priv->slot_size);
+  gst_buffer_unmap(outbuf, &out_map);
+
+  // output looks like the batch results were produced for this frame alone
+  GstSimaaiFrameInfo info = batch_info;
+  info.buffer_id = gst_simaai_segment_memory_get_phys_addr(gst_buffer_peek_memory(outbuf, 0));
+  info.buffer_offset = 0;
+  info.frame_id = slot.frame_id;
+  info.stream_id = slot.stream_id;
+  info.timestamp = slot.timestamp;
+
+  if (gst_buffer_add_simaai_frame_meta(outbuf, &info) == NULL) {
+    GST_ERROR_OBJECT (self, "Unable to add metadata info to the buffer");
+    gst_buffer_unref(outbuf);
+    return GST_FLOW_ERROR;
+  }
+
+  GST_BUFFER_PTS (outbuf) = slot.pts;
+  GST_BUFFER_DTS (outbuf) = slot.dts;
+  GST_BUFFER_DURATION (outbuf) = slot.duration;
+
+  GstFlowReturn ret = gst_pad_push(srcpad, outbuf);
+
+  GST_OBJECT_LOCK (self);
+  // pad released while pushing is a stream removed at runtime, its flushing
+  // or not-linked result must not stop the other streams
+  if (priv->srcpads.count(slot.pad_index) && priv->srcpads[slot.pad_index] == srcpad)
+    ret = gst_flow_combiner_update_pad_flow(priv->flow_combiner, srcpad, ret);
+  else
+    ret = GST_FLOW_OK;
+  GST_OBJECT_UNLOCK (self);
+
+  return ret;
+}
+
+static GstFlowReturn gst_simaai_unbatcher_chain (GstPad * pad,
+                                                 GstObject * parent,
+                                                 GstBuffer * buf)
+{
+  GstSimaaiUnbatcher * self = GST_SIMAAI_UNBATCHER (parent);
+  GstSimaaiFrameInfo info = {};
+  StreamBatchLayout layout;
+  GstSimaaiRangeMapInfo src;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  if (!gst_buffer_get_simaai_frame_info(buf, &info)) {
+    GST_ERROR_OBJECT (self, "Please check readme to use metadata information,"
+                      " meta not found");
+    gst_buffer_unref(buf);
+    return GST_FLOW_ERROR;
+  }
+
+  // batch keeps stream id of the batcher and its batch id as frame id
+  if (!StreamBatchRegistry::instance().take(info.stream_id, info.frame_id, layout)) {
+    GST_WARNING_OBJECT (self, "No batch layout for frame %ld of %s, dropping it",
+                        info.frame_id, GST_SIMAAI_QUARK_STR(info.stream_id));
+    gst_buffer_unref(buf);
+    return GST_FLOW_OK;
+  }
+
+  gsize size = gst_buffer_get_size(buf);
+  if (layout.batch_size == 0 || size % layout.batch_size != 0) {
+    GST_ERROR_OBJECT (self, "Buffer of %zu bytes can't be split into %u slots",
+                      size, layout.batch_size);
+    gst_buffer_unref(buf);
+    return GST_FLOW_ERROR;
+  }
+  const gsize slot_size = size / layout.batch_size;
+
+  if (!gst_simaai_memory_map_range(gst_buffer_peek_memory(buf, 0), NULL, 0,
+                                   layout.slots.size() * slot_size, &src, GST_MAP_READ)) {
+    GST_ERROR_OBJECT (self, "Failed to map batch buffer");
+    gst_buffer_unref(buf);
+    return GST_FLOW_ERROR;
+  }
+
+  for (size_t i = 0; i < layout.slots.size() && ret == GST_FLOW_OK; i++) {
+    GstPad * srcpad = gst_simaai_unbatcher_get_srcpad(self, layout.slots[i].pad_index);
+    if (srcpad == NULL) {
+      GST_LOG_OBJECT (self, "No src_%u, dropping frame %ld", layout.slots[i].pad_index,
+                      layout.slots[i].frame_id);
+      continue;
+    }
+
+    if (!gst_simaai_unbatcher_allocate_memory(self, srcpad, slot_size))
+      ret = GST_FLOW_ERROR;
+    else
+      ret = gst_simaai_unbatcher_push_slot(self, srcpad, info, layout.slots[i],
+                                           src.data + i * slot_size);
+    gst_object_unref(srcpad);
+  }
+
+  if (!self->silent)
+    GST_DEBUG_OBJECT (self, "batch[%ld]: %zu of %u slots pushed, %s",
+                      info.frame_id, layout.slots.size(), layout.batch_size,
+                      gst_flow_get_name(ret));
+
+  gst_simaai_memory_unmap_range(&src);
+  gst_buffer_unref(buf);
+
+  return ret;
+}
+
+/**
+ * @brief Helper API to create stream start of a src pad, every stream gets
+ *        its own stream id in the group of the batch stream
+ */
+static GstEvent * gst_simaai_unbatcher_stream_start (GstSimaaiUnbatcher * self,
+                                                     GstPad * srcpad,
+                                                     GstEvent * upstream)
+{
+  gchar * stream_id = gst_pad_create_stream_id(srcpad, GST_ELEMENT (self),
+                                               GST_PAD_NAME (srcpad));
+  GstEvent * event = gst_event_new_stream_start(stream_id);
+  guint group_id;
+
+  if (gst_event_parse_group_id(upstream, &group_id))
+    gst_event_set_group_id(event, group_id);
+  g_free(stream_id);
+
+  return event;
+}
+
+/**
+ * @brief Src pad that gets sticky events of the sink pad
+ */
+struct UnbatcherNewPad {
+  GstSimaaiUnbatcher * self;
+  GstPad * srcpad;
+};
+
+static gboolean gst_simaai_unbatcher_forward_sticky_event (GstPad * pad,
+                                                           GstEvent ** event,
+                                                           gpointer user_data)
+{
+  UnbatcherNewPad * new_pad = (UnbatcherNewPad *) user_data;
+  GstSimaaiUnbatcher * self = new_pad->self;
+  GstPad * srcpad = new_pad->srcpad;
+
+  if (GST_EVENT_TYPE (*event) == GST_EVENT_STREAM_START) {
+    GstEvent * stream_start = gst_simaai_unbatcher_stream_start(self, srcpad, *event);
+    gst_pad_store_sticky_event(srcpad, stream_start);
+    gst_event_unref(stream_start);
+  } else if (GST_EVENT_TYPE (*event) != GST_EVENT_EOS) {
+    gst_pad_store_sticky_event(srcpad, *event);
+  }
+
+  return TRUE;
+}
+
+static gboolean gst_simaai_unbatcher_sink_event (GstPad * pad,
+                                                 GstObject * parent,
+                                                 GstEvent * event)
+{
+  GstSimaaiUnbatcher * self = GST_SIMAAI_UNBATCHER (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_STREAM_START: {
+      GstIterator * iter = gst_element_iterate_src_pads (GST_ELEMENT (self));
+      GValue value = { 0, };
+      while (gst_iterator_next (iter, &value) == GST_ITERATOR_OK) {
+        GstPad * srcpad = GST_PAD (g_value_get_object (&value));
+        gst_pad_push_event(srcpad, gst_simaai_unbatcher_stream_start(self, srcpad, event));
+        g_value_reset (&value);
+      }
+      g_value_unset (&value);
+      gst_iterator_free (iter);
+      gst_event_unref(event);
+      return TRUE;
+    }
+    case GST_EVENT_FLUSH_STOP:
+      GST_OBJECT_LOCK (self);
+      gst_flow_combiner_reset(self->priv->flow_combiner);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      break;
+  }
+
+  return gst_pad_event_default(pad, parent, event);
+}
+
+static gboolean gst_simaai_unbatcher_sink_query (GstPad * pad,
+                                                 GstObject * parent,
+                                                 GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_ALLOCATION) {
+    // batch results are copied on A65
+    GstStructure *allocation_meta =
+        gst_simaai_allocation_query_create_meta(GST_SIMAAI_MEMORY_TARGET_GENERIC,
+                                                GST_SIMAAI_MEMORY_FLAG_CACHED);
+
+    gst_simaai_allocation_query_add_meta(query, allocation_meta);
+    return TRUE;
+  }
+
+  return gst_pad_query_default(pad, parent, query);
+}
+
+static GstPad * gst_simaai_unbatcher_request_new_pad (GstElement * element,
+                                                      GstPadTemplate * templ,
+                                                      const gchar * name,
+                                                      const GstCaps * caps)
+{
+  GstSimaaiUnbatcher * self = GST_SIMAAI_UNBATCHER (element);
+  guint index = 0;
+
+  GST_OBJECT_LOCK (self);
+  if (name != NULL && sscanf(name, "src_%u", &index) == 1) {
+    if (self->priv->srcpads.count(index)) {
+      GST_OBJECT_UNLOCK (self);
+      GST_ERROR_OBJECT (self, "Pad %s already exists", name);
+      return NULL;
+    }
+  } else {
+    // first free index
+    while (self->priv->srcpads.count(index))
+      index++;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  gchar * pad_name = g_strdup_printf("src_%u", index);
+  GstPad * srcpad = gst_pad_new_from_template(templ, pad_name);
+  g_free(pad_name);
+
+  gst_pad_use_fixed_caps(srcpad);
+  gst_pad_set_active(srcpad, TRUE);
+  // stream may already be running, new pad gets caps and segment of the batch
+  UnbatcherNewPad new_pad = { self, srcpad };
+  gst_pad_sticky_events_foreach(self->sinkpad,
+                                gst_simaai_unbatcher_forward_sticky_event, &new_pad);
+
+  GST_OBJECT_LOCK (self);
+  self->priv->srcpads[index] = srcpad;
+  gst_flow_combiner_add_pad(self->priv->flow_combiner, srcpad);
+  GST_OBJECT_UNLOCK (self);
+
+  gst_element_add_pad(element, srcpad);
+
+  return srcpad;
+}
+
+static void gst_simaai_unbatcher_release_pad (GstElement * element, GstPad * pad)
+{
+  GstSimaaiUnbatcher * self = GST_SIMAAI_UNBATCHER (element);
+
+  GST_OBJECT_LOCK (self);
+  for (auto it = self->priv->srcpads.begin(); it != self->priv->srcpads.end(); ++it) {
+    if (it->second == pad) {
+      self->priv->srcpads.erase(it);
+      break;
+    }
+  }
+  gst_flow_combiner_remove_pad(self->priv->flow_combiner, pad);
+  GST_OBJECT_UNLOCK (self);
+
+  gst_pad_set_active(pad, FALSE);
+  gst_element_remove_pad(element, pad);
+}
+
+/**
+ * @brief Called to perform state change.
+ */
+static GstStateChangeReturn
+gst_simaai_unbatcher_change_state (GstElement * element,
+                                   GstStateChange transition)
+{
+  GstSimaaiUnbatcher * self = GST_SIMAAI_UNBATCHER (element);
+  GstStateChangeReturn ret;
+
+  ret = GST_ELEMENT_CLASS(parent_class)->change_state(element, transition);
+  if (ret == GST_STATE_CHANGE_FAILURE)
+    return ret;
+
+  switch (transition) {
+  case GST_STATE_CHANGE_PAUSED_TO_READY:
+    GST_OBJECT_LOCK (self);
+    gst_flow_combiner_reset(self->priv->flow_combiner);
+    GST_OBJECT_UNLOCK (self);
+    gst_simaai_unbatcher_free_memory(self);
+    GST_DEBUG_OBJECT(self, "GST_STATE_CHANGE_PAUSED_TO_READY");
+    break;
+  default:
+    break;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief Setter for unbatcher properties.
+ */
+static void gst_simaai_unbatcher_set_property (GObject * object,
+                                               guint prop_id,
+                                               const GValue * value,
+                                               GParamSpec * pspec)
+{
+  GstSimaaiUnbatcher * self = GST_SIMAAI_UNBATCHER (object);
+
+  switch (prop_id) {
+    case PROP_NO_OF_BUFS:
+      self->priv->num_of_out_buf = g_value_get_ulong(value);
+      break;
+    case PROP_SILENT:
+      self->silent = g_value_get_boolean(value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+}
+
+/**
+ * @brief Getter for unbatcher properties.
+ */
+static void gst_simaai_unbatcher_get_property (GObject * object,
+                                               guint prop_id,
+                                               GValue * value,
+                                               GParamSpec * pspec)
+{
+  GstSimaaiUnbatcher * self = GST_SIMAAI_UNBATCHER (object);
+
+  switch (prop_id) {
+    case PROP_NO_OF_BUFS:
+      g_value_set_ulong(value, self->priv->num_of_out_buf);
+      break;
+    case PROP_SILENT:
+      g_value_set_boolean(value, self->silent);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+}
+
+/**
+ * @brief Finalize/Cleanup unbatcher callback
+ */
+static void
+gst_simaai_unbatcher_finalize (GObject * object)
+{
+  GstSimaaiUnbatcher * self = GST_SIMAAI_UNBATCHER (object);
+
+  gst_simaai_unbatcher_free_memory(self);
+  gst_flow_combiner_free(self->priv->flow_combiner);
+
+  delete self->priv;
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+/**
+ * @brief Callback to unbatcher class init
+ */
+static void
+gst_simaai_unbatcher_class_init (GstSimaaiUnbatcherClass * klass)
+{
+  GObjectClass *gobj_class = G_OBJECT_CLASS(klass);
+  GstElementClass *gstelement_class = (GstElementClass *) klass;
+
+  gst_element_class_add_pad_template(gstelement_class,
+      gst_pad_template_new(UNBATCHER_PAD_TEMPLATE_NAME_SINK, GST_PAD_SINK,
+                           GST_PAD_ALWAYS, gst_caps_new_any()));
+  gst_element_class_add_pad_template(gstelement_class,
+      gst_pad_template_new(UNBATCHER_PAD_TEMPLATE_NAME_SRC, GST_PAD_SRC,
+                           GST_PAD_REQUEST, gst_caps_new_any()));
+
+  gobj_class->finalize = gst_simaai_unbatcher_finalize;
+  gobj_class->set_property = gst_simaai_unbatcher_set_property;
+  gobj_class->get_property = gst_simaai_unbatcher_get_property;
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_simaai_unbatcher_change_state);
+  gstelement_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_simaai_unbatcher_request_new_pad);
+  gstelement_class->release_pad =
+      GST_DEBUG_FUNCPTR (gst_simaai_unbatcher_release_pad);
+
+  /* This property is used to allocate output buffers memory */
+  g_object_class_install_property(gobj_class, PROP_NO_OF_BUFS,
+                                  g_param_spec_ulong("num-buffers",
+                                                     "Number Of Buffers",
+                                                     "Number of buffers to be allocated of size of buffer",
+                                                     1, G_MAXUINT,
+                                                     DEFAULT_NUM_BUFFERS,
+                                                     (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+  g_object_class_install_property (gobj_class, PROP_SILENT,
+                                   g_param_spec_boolean ("silent",
+                                                         "Silent",
+                                                         "Produce verbose output",
+                                                         DEFAULT_SILENT,
+                                                         (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+                                         "SiMa.AI Stream Unbatcher Plugin",
+                                         "Demuxer",
+                                         "Splits results of a simaaibatcher batch per stream",
+                                         "SiMa.AI");
+
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT,
+                           "simaaiunbatcher", 0, "Unbatcher");
+}
+
+static void
+gst_simaai_unbatcher_init (GstSimaaiUnbatcher * self)
+{
+  GstPadTemplate * templ =
+      gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS (self),
+                                         UNBATCHER_PAD_TEMPLATE_NAME_SINK);
+
+  self->sinkpad = gst_pad_new_from_template(templ, UNBATCHER_PAD_TEMPLATE_NAME_SINK);
+  gst_pad_set_chain_function(self->sinkpad, GST_DEBUG_FUNCPTR (gst_simaai_unbatcher_chain));
+  gst_pad_set_event_function(self->sinkpad, GST_DEBUG_FUNCPTR (gst_simaai_unbatcher_sink_event));
+  gst_pad_set_query_function(self->sinkpad, GST_DEBUG_FUNCPTR (gst_simaai_unbatcher_sink_query));
+  gst_element_add_pad(GST_ELEMENT (self), self->sinkpad);
+
+  self->silent = DEFAULT_SILENT;
+  gst_simaai_segment_memory_init_once();
+  self->priv = new GstSimaaiUnbatcherPrivate;
+
+  self->priv->flow_combiner = gst_flow_combiner_new();
+  self->priv->slot_size = 0;
+  self->priv->pool = nullptr;
+  self->priv->num_of_out_buf = DEFAULT_NUM_BUFFERS;
+  self->priv->mem_type = GST_SIMAAI_MEMORY_TARGET_GENERIC;
+  self->priv->mem_flag = GST_SIMAAI_MEMORY_FLAG_CACHED;
+}
@@ -0,0 +1,61 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef GST_SIMAAIUNBATCHER_H_
+#define GST_SIMAAIUNBATCHER_H_
+
+#include <gst/gst.h>
+
+#define DEFAULT_NUM_BUFFERS 5
+#define MIN_POOL_SIZE 2
+
+#define UNBATCHER_PAD_TEMPLATE_NAME_SINK  "sink"
+#define UNBATCHER_PAD_TEMPLATE_NAME_SRC   "src_%u"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_SIMAAI_UNBATCHER            (gst_simaai_unbatcher_get_type ())
+#define GST_SIMAAI_UNBATCHER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_SIMAAI_UNBATCHER, GstSimaaiUnbatcher))
+#define GST_SIMAAI_UNBATCHER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GST_TYPE_SIMAAI_UNBATCHER, GstSimaaiUnbatcherClass))
+#define GST_SIMAAI_UNBATCHER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GST_TYPE_SIMAAI_UNBATCHER, GstSimaaiUnbatcherClass))
+
+typedef struct _GstSimaaiUnbatcher GstSimaaiUnbatcher;
+typedef struct _GstSimaaiUnbatcherClass GstSimaaiUnbatcherClass;
+typedef struct _GstSimaaiUnbatcherPrivate GstSimaaiUnbatcherPrivate;
+
+struct _GstSimaaiUnbatcher
+{
+  GstElement parent;
+  gboolean silent; /**< true to print minimized log */
+  GstPad *sinkpad;
+  GstSimaaiUnbatcherPrivate *priv;
+};
+
+struct _GstSimaaiUnbatcherClass
+{
+  GstElementClass parent_class;
+};
+
+GType gst_simaai_unbatcher_get_type (void);
+
+G_END_DECLS
+
+#endif // GST_SIMAAIUNBATCHER_H_
@@ -0,0 +1,102 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+#include "stream_batch.h"
+
+void StreamBatchScheduler::configure(uint32_t batch_size, uint32_t max_per_stream)
+{
+  batch_size_ = batch_size ? batch_size : 1;
+  max_per_stream_ = max_per_stream ? max_per_stream : 1;
+  plan_.reserve(batch_size_);
+  next_ = 0;
+}
+
+uint32_t StreamBatchScheduler::fill(uint32_t n_streams,
+                                    const std::function<bool(uint32_t)> & take)
+{
+  plan_.clear();
+  if (n_streams == 0)
+    return 0;
+
+  drained_.assign(n_streams, false);
+  const uint32_t first = next_ % n_streams;
+
+  for (uint32_t round = 0; round < max_per_stream_; round++) {
+    bool took = false;
+    for (uint32_t i = 0; i < n_streams && plan_.size() < batch_size_; i++) {
+      const uint32_t stream = (first + i) % n_streams;
+      if (drained_[stream])
+        continue;
+      if (!take(stream)) {
+        drained_[stream] = true;
+        continue;
+      }
+      plan_.push_back(stream);
+      took = true;
+    }
+    if (!took || plan_.size() == batch_size_)
+      break;
+  }
+
+  if (!plan_.empty())
+    next_ = (plan_.back() + 1) % n_streams;
+
+  return plan_.size();
+}
+
+StreamBatchRegistry & StreamBatchRegistry::instance()
+{
+  static StreamBatchRegistry registry;
+  return registry;
+}
+
+void StreamBatchRegistry::put(uint32_t batcher_id, int64_t batch_id,
+                              StreamBatchLayout layout)
+{
+  const std::lock_guard<std::mutex> lk(mtx_);
+
+  layouts_[{batcher_id, batch_id}] = std::move(layout);
+
+  auto first = layouts_.lower_bound({batcher_id, INT64_MIN});
+  auto last = layouts_.upper_bound({batcher_id, INT64_MAX});
+  size_t count = 0;
+  for (auto it = first; it != last; ++it)
+    count++;
+  while (count-- > kMaxPending)
+    first = layouts_.erase(first);
+}
+
+bool StreamBatchRegistry::take(uint32_t batcher_id, int64_t batch_id,
+                               StreamBatchLayout & layout)
+{
+  const std::lock_guard<std::mutex> lk(mtx_);
+
+  auto it = layouts_.find({batcher_id, batch_id});
+  if (it == layouts_.end())
+    return false;
+
+  layout = std::move(it->second);
+  layouts_.erase(it);
+  return true;
+}
+
+void StreamBatchRegistry::clear(uint32_t batcher_id)
+{
+  const std::lock_guard<std::mutex> lk(mtx_);
+
+  layouts_.erase(layouts_.lower_bound({batcher_id, INT64_MIN}),
+                 layouts_.upper_bound({batcher_id, INT64_MAX}));
+}
+
+size_t StreamBatchRegistry::pending(uint32_t batcher_id)
+{
+  const std::lock_guard<std::mutex> lk(mtx_);
+
+  size_t count = 0;
+  for (auto it = layouts_.lower_bound({batcher_id, INT64_MIN});
+       it != layouts_.upper_bound({batcher_id, INT64_MAX}); ++it)
+    count++;
+  return count;
+}
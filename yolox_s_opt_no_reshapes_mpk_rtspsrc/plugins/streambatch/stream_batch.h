@@ -0,0 +1,102 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * @file stream_batch.h
+ * @brief Slot scheduling and batch layouts shared by simaaibatcher and
+ *        simaaiunbatcher. No GStreamer dependency, so it is unit tested.
+ */
+
+#ifndef STREAM_BATCH_H_
+#define STREAM_BATCH_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Frame of one stream in a slot of a batch buffer
+ */
+struct StreamBatchSlot {
+  /// Index of the batcher sink pad, frame is pushed on unbatcher src pad with
+  /// the same index
+  uint32_t pad_index = 0;
+  /// Frame metadata of the stream, restored on the unbatched output
+  uint32_t stream_id = 0;
+  int64_t frame_id = 0;
+  uint64_t timestamp = 0;
+  /// GstClockTime values of the frame
+  uint64_t pts = UINT64_MAX;
+  uint64_t dts = UINT64_MAX;
+  uint64_t duration = UINT64_MAX;
+};
+
+/**
+ * @brief Layout of a batch buffer. Slots are frame-major, in buffer order.
+ *        Slots past `slots.size()` are padding and carry no frame.
+ */
+struct StreamBatchLayout {
+  uint32_t batch_size = 0;
+  std::vector<StreamBatchSlot> slots;
+};
+
+/**
+ * @brief Round robin slot scheduler. Every stream gets one slot per round, up
+ *        to `max_per_stream` rounds, so a busy stream cannot take the batch
+ *        from the others. The next batch starts after the stream that got the
+ *        last slot, so streams left out of a full batch go first next time.
+ */
+class StreamBatchScheduler {
+public:
+  void configure(uint32_t batch_size, uint32_t max_per_stream);
+  void reset() { next_ = 0; }
+
+  /**
+   * @brief Fills the next batch
+   * @param n_streams number of streams
+   * @param take takes a frame of a stream into the next slot, returns false
+   *        if the stream has no frame queued
+   * @return number of filled slots, streams of the slots are in `plan()`
+   */
+  uint32_t fill(uint32_t n_streams, const std::function<bool(uint32_t)> & take);
+
+  const std::vector<uint32_t> & plan() const { return plan_; }
+
+private:
+  uint32_t batch_size_ = 1;
+  uint32_t max_per_stream_ = 1;
+  uint32_t next_ = 0;
+  std::vector<uint32_t> plan_;
+  std::vector<bool> drained_;
+};
+
+/**
+ * @brief Process wide layouts of batches in flight between a batcher and the
+ *        unbatcher, keyed by batcher id and batch id. The batch buffer keeps
+ *        only frame id and stream id through processmla and processcvu, so the
+ *        layout cannot travel as buffer metadata.
+ */
+class StreamBatchRegistry {
+public:
+  /// Layouts kept per batcher, the oldest is dropped when a batch was lost
+  static const size_t kMaxPending = 64;
+
+  static StreamBatchRegistry & instance();
+
+  void put(uint32_t batcher_id, int64_t batch_id, StreamBatchLayout layout);
+  bool take(uint32_t batcher_id, int64_t batch_id, StreamBatchLayout & layout);
+  void clear(uint32_t batcher_id);
+  size_t pending(uint32_t batcher_id);
+
+private:
+  std::mutex mtx_;
+  std::map<std::pair<uint32_t, int64_t>, StreamBatchLayout> layouts_;
+};
+
+#endif // STREAM_BATCH_H_
@@ -0,0 +1,129 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * Test of the batcher slot scheduler and the batch layout registry.
+ */
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "stream_batch.h"
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      return 1;                                                         \
+    }                                                                   \
+  } while (0)
+
+/// Fills a batch from per stream queue depths, taken frames are removed
+static std::vector<uint32_t> fill(StreamBatchScheduler & scheduler,
+                                  std::vector<uint32_t> & queued)
+{
+  scheduler.fill(queued.size(), [&queued](uint32_t stream) {
+    if (queued[stream] == 0)
+      return false;
+    queued[stream]--;
+    return true;
+  });
+  return scheduler.plan();
+}
+
+static int test_round_robin()
+{
+  StreamBatchScheduler scheduler;
+  scheduler.configure(2, 1);
+
+  // three streams with one frame each, the left out stream goes first next
+  std::vector<uint32_t> queued = {1, 1, 1};
+  CHECK((fill(scheduler, queued) == std::vector<uint32_t>{0, 1}));
+  CHECK((queued == std::vector<uint32_t>{0, 0, 1}));
+  queued = {1, 1, 1};
+  CHECK((fill(scheduler, queued) == std::vector<uint32_t>{2, 0}));
+  queued = {1, 1, 1};
+  CHECK((fill(scheduler, queued) == std::vector<uint32_t>{1, 2}));
+
+  // empty streams are skipped
+  queued = {0, 0, 3};
+  CHECK((fill(scheduler, queued) == std::vector<uint32_t>{2}));
+  queued = {0, 0, 0};
+  CHECK(fill(scheduler, queued).empty());
+
+  return 0;
+}
+
+static int test_max_per_stream()
+{
+  StreamBatchScheduler scheduler;
+  scheduler.configure(4, 2);
+
+  // busy stream gets at most two slots, interleaved with the other stream
+  std::vector<uint32_t> queued = {5, 1};
+  CHECK((fill(scheduler, queued) == std::vector<uint32_t>{0, 1, 0}));
+  CHECK((queued == std::vector<uint32_t>{3, 0}));
+
+  // full batch in the first round
+  scheduler.configure(4, 4);
+  queued = {4, 4, 4, 4, 4};
+  CHECK((fill(scheduler, queued) == std::vector<uint32_t>{0, 1, 2, 3}));
+  CHECK((fill(scheduler, queued) == std::vector<uint32_t>{4, 0, 1, 2}));
+
+  // single stream fills the batch alone
+  scheduler.configure(3, 4);
+  queued = {8};
+  CHECK((fill(scheduler, queued) == std::vector<uint32_t>{0, 0, 0}));
+
+  return 0;
+}
+
+static int test_registry()
+{
+  StreamBatchRegistry & registry = StreamBatchRegistry::instance();
+  StreamBatchLayout layout;
+
+  layout.batch_size = 4;
+  layout.slots.resize(2);
+  layout.slots[1].pad_index = 3;
+  layout.slots[1].frame_id = 42;
+  registry.put(1, 7, layout);
+  registry.put(2, 7, StreamBatchLayout());
+
+  StreamBatchLayout out;
+  CHECK(!registry.take(1, 8, out));
+  CHECK(registry.take(1, 7, out));
+  CHECK(out.batch_size == 4 && out.slots.size() == 2);
+  CHECK(out.slots[1].pad_index == 3 && out.slots[1].frame_id == 42);
+  CHECK(!registry.take(1, 7, out));
+
+  // lost batches do not pile up
+  for (int64_t i = 0; i < (int64_t)StreamBatchRegistry::kMaxPending + 10; i++)
+    registry.put(1, i, layout);
+  CHECK(registry.pending(1) == StreamBatchRegistry::kMaxPending);
+  CHECK(!registry.take(1, 0, out));
+  CHECK(registry.take(1, StreamBatchRegistry::kMaxPending + 9, out));
+
+  registry.clear(1);
+  CHECK(registry.pending(1) == 0);
+  CHECK(registry.pending(2) == 1);
+  registry.clear(2);
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  if (test_round_robin())
+    return 1;
+  if (test_max_per_stream())
+    return 1;
+  if (test_registry())
+    return 1;
+
+  printf("test_stream_batch: OK\n");
+  return 0;
+}
@@ -40,6 +40,47 @@ class MetadataStruct(ctypes.Structure):
         ("buffer_name_len", ctypes.c_uint32), # Length of buffer_name string
     ]
 
+class SimaaiFrameInfo(ctypes.Structure):
+    """Mirror of GstSimaaiFrameInfo from core/metadata/gstsimaaimeta.h"""
+    _fields_ = [
+        ("buffer_id", ctypes.c_int64),
+        ("buffer_offset", ctypes.c_int64),
+        ("frame_id", ctypes.c_int64),
+        ("pcie_buffer_id", ctypes.c_int64),
+        ("timestamp", ctypes.c_uint64),
+        ("buffer_name", ctypes.c_uint32),  # GQuark
+        ("stream_id", ctypes.c_uint32),    # GQuark
+        ("flags", ctypes.c_uint32),
+    ]
+
+SIMAAI_FRAME_META_FLAG_PCIE = 1 << 0
+
+def _load_frame_meta_lib():
+    """Typed frame meta accessors, None if the library is not installed"""
+    try:
+        meta_lib = ctypes.CDLL("libgstsimaaimeta.so")
+        glib = ctypes.CDLL("libglib-2.0.so.0")
+    except OSError:
+        return None, None
+    meta_lib.gst_buffer_get_simaai_frame_info.argtypes = [ctypes.c_void_p, ctypes.POINTER(SimaaiFrameInfo)]
+    meta_lib.gst_buffer_get_simaai_frame_info.restype = ctypes.c_int
+    meta_lib.gst_buffer_add_simaai_frame_meta.argtypes = [ctypes.c_void_p, ctypes.POINTER(SimaaiFrameInfo)]
+    meta_lib.gst_buffer_add_simaai_frame_meta.restype = ctypes.c_void_p
+    glib.g_quark_from_string.argtypes = [ctypes.c_char_p]
+    glib.g_quark_from_string.restype = ctypes.c_uint32
+    glib.g_quark_to_string.argtypes = [ctypes.c_uint32]
+    glib.g_quark_to_string.restype = ctypes.c_char_p
+    return meta_lib, glib
+
+FRAME_META_LIB, GLIB_LIB = _load_frame_meta_lib()
+
+ctypes.pythonapi.PyCapsule_GetPointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+ctypes.pythonapi.PyCapsule_GetPointer.restype = ctypes.c_void_p
+
+def _gst_buffer_ptr(buffer: Gst.Buffer):
+    """GstBuffer pointer of a Gst.Buffer, held in the unnamed capsule __gpointer__"""
+    return ctypes.pythonapi.PyCapsule_GetPointer(buffer.__gpointer__, None)
+
 SIMAAI_META_STR = "GstSimaMeta"
 PLUGIN_CPU_TYPE = "APU"
 
@@ -264,6 +305,9 @@ class AggregatorTemplate(GstBase.Aggregator):
         self.buffer_name = "default"
         self.buffer_id = 0
         self.plugin_id = "python-agg-template"
+        self.plugin_quark = 0
+        self.stream_quark = 0
+        self.quark_strings = {}
         self.t0 = None
         self.t1 = None
         self.manifest_json = manifest_config
@@ -410,6 +454,7 @@ class AggregatorTemplate(GstBase.Aggregator):
         Handle start even for the aggregator. 
         """
         self.plugin_id = self.get_name()
+        self.plugin_quark = 0
         for pad in self.iterate_sink_pads():
         #Get the direct upstream plugin (parent)
             parent_element = self._get_upstream_element(pad)
@@ -472,8 +517,45 @@ class AggregatorTemplate(GstBase.Aggregator):
         else:
             raise AttributeError(f"Unknown property {property_id}")
 
+    def quark_to_string(self, quark: int) -> str:
+        """Interned strings are cached, so a frame does not decode them again"""
+        value = self.quark_strings.get(quark)
+        if value is None:
+            raw = GLIB_LIB.g_quark_to_string(quark) if quark else None
+            value = raw.decode('utf-8') if raw else ""
+            self.quark_strings[quark] = value
+        return value
+
+    def extract_frame_info(self, buffer: Gst.Buffer):
+        """Read the typed frame meta"""
+        info = SimaaiFrameInfo()
+        if not FRAME_META_LIB.gst_buffer_get_simaai_frame_info(_gst_buffer_ptr(buffer), ctypes.byref(info)):
+            logger.err("No metadata found in buffer")
+            return None
+
+        if info.flags & SIMAAI_FRAME_META_FLAG_PCIE:
+            self.is_pcie = True
+            self.in_pcie_buf_id = info.pcie_buffer_id
+        self.buffer_id = info.buffer_id
+        self.frame_id = info.frame_id
+        self.buffer_offset = info.buffer_offset
+        self.timestamp = info.timestamp
+        self.stream_quark = info.stream_id
+        self.stream_id = self.quark_to_string(info.stream_id)
+        self.buffer_name = self.quark_to_string(info.buffer_name)
+
+        return MetaStruct(
+            frame_id=self.frame_id,
+            buffer_name=self.buffer_name,
+            timestamp=self.timestamp,
+            stream_id=self.stream_id
+        )
+
     def extract_metadata(self, buffer: Gst.Buffer) -> None:
         """Input: buffer Gst.Buffer: Input buffer from which metadata will be extracted."""
+        if FRAME_META_LIB is not None:
+            return self.extract_frame_info(buffer)
+
         meta = buffer.get_custom_meta(SIMAAI_META_STR)
         if not meta or not (s := meta.get_structure()):
             logger.err("No metadata structure found in buffer")
@@ -583,11 +665,34 @@ class AggregatorTemplate(GstBase.Aggregator):
             traceback.print_exc()
             return False
 
+    def insert_frame_info(self, buffer: Gst.Buffer) -> bool:
+        """Attach the typed frame meta, stream id is forwarded as the interned quark"""
+        info = SimaaiFrameInfo()
+        info.buffer_id = self.buffer_id
+        info.buffer_offset = 0
+        info.frame_id = self.frame_id
+        info.timestamp = self.timestamp
+        if self.plugin_quark == 0:
+            self.plugin_quark = GLIB_LIB.g_quark_from_string(self.plugin_id.encode('utf-8'))
+        info.buffer_name = self.plugin_quark
+        info.stream_id = self.stream_quark or GLIB_LIB.g_quark_from_string(self.stream_id.encode('utf-8'))
+        if self.is_pcie:
+            info.pcie_buffer_id = self.in_pcie_buf_id
+            info.flags = SIMAAI_FRAME_META_FLAG_PCIE
+
+        if not FRAME_META_LIB.gst_buffer_add_simaai_frame_meta(_gst_buffer_ptr(buffer), ctypes.byref(info)):
+            logger.err("Failed to add frame meta to buffer")
+            return False
+        return True
+
     def insert_metadata(self, buffer: Gst.Buffer) -> bool:
         """
         Insert metadata into buffer using GstMeta and verify the attachment.
         Returns: True if successful, False if failed
         """
+        if FRAME_META_LIB is not None:
+            return self.insert_frame_info(buffer)
+
         try:
             # Create new structure
             meta = Gst.Structure.new_empty(SIMAAI_META_STR)
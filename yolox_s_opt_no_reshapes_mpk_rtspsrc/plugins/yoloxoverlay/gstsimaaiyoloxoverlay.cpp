@@ -0,0 +1,1014 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file gstsimaaiyoloxoverlay.cpp
+ * @brief Gstreamer plugin to decode YOLOX outputs and draw boxes on NV12 frame
+ * @author SiMa.Ai\TM
+ * @bug Currently no known bugs
+ */
+
+/**
+ * SECTION: element-simaaiyoloxoverlay
+ *
+ * Native replacement of the yolox_postproc_overlay python plugin. Aggregates
+ * the dequantized YOLOX-s tensor and the decoded NV12 frame, runs decode and
+ * NMS and pushes a copy of the frame with detection boxes drawn.
+ *
+ * <refsect2>
+ * <title> Example Launch line </title>
+ * |[
+ * ... ! simaaiprocesscvu name=simaaiprocessdetess_dequant_1 ! overlay.
+ * decoder. ! queue2 ! overlay.
+ * simaaiyoloxoverlay name=overlay ! 'video/x-raw,format=NV12,width=1280,height=720'
+ * ! simaaiencoder ! ...
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gst/gst.h>
+#include <gst/base/gstaggregator.h>
+
+#include <gstsimaaiallocator.h>
+#include <gstsimaaibufferpool.h>
+#include <gstsimaaimeta.h>
+#include <simaai/nlohmann/json.hpp>
+
+#include "gstsimaaiyoloxoverlay.h"
+#include "yolox_decode.h"
+
+/**
+ * @brief Flag to print minimized log.
+ */
+#define DEFAULT_SILENT TRUE
+#define DEFAULT_TRANSMIT FALSE
+#define PLUGIN_CPU_TYPE "APU"
+
+/**
+ * @brief yoloxoverlay properties
+ */
+enum {
+  PROP_0,
+  PROP_TENSOR_NAME,
+  PROP_FRAME_NAME,
+  PROP_SCORE_THRESHOLD,
+  PROP_NMS_THRESHOLD,
+  PROP_FRAME_WIDTH,
+  PROP_FRAME_HEIGHT,
+  PROP_MODEL_WIDTH,
+  PROP_MODEL_HEIGHT,
+  PROP_NUM_CLASSES,
+  PROP_LINE_THICKNESS,
+  PROP_QUANTIZED_INPUT,
+  PROP_CONF_F,
+  PROP_NO_OF_BUFS,
+  PROP_SILENT,
+  PROP_TRANSMIT,
+  PROP_UNKNONW,
+};
+
+GST_DEBUG_CATEGORY_STATIC(gst_simaai_yoloxoverlay_debug);
+#define GST_CAT_DEFAULT gst_simaai_yoloxoverlay_debug
+
+/**
+ * @brief Private fields of yoloxoverlay
+ */
+struct _GstSimaaiYoloxoverlayPrivate
+{
+  /// Name of the node, used as `buffer-name` of output
+  std::string node_name;
+  GQuark node_quark;
+  /// `buffer-name` of the tensor and frame inputs
+  std::string tensor_name;
+  std::string frame_name;
+
+  YoloxDecodeParams params;
+  guint line_thickness;
+  /// Tensor input is the INT8 MLA output, dequantization from config_file_path
+  gboolean quantized_input;
+  std::string config_file_path;
+  /// Decoder and palette are rebuilt when params change. Properties above
+  /// and configured are guarded by the object lock
+  YoloxDecoder decoder;
+  std::vector<YoloxColor> palette;
+  gboolean configured;
+  /// Properties the decoder was built with, used by the streaming thread
+  YoloxDecodeParams active_params;
+  gboolean active_quantized_input;
+  guint active_line_thickness;
+
+  GstBufferPool * pool;
+  guint num_of_out_buf;
+  GstSimaaiMemoryFlags mem_type;
+  GstSimaaiMemoryFlags mem_flag;
+
+  gint64 run_count;
+};
+
+#define gst_simaai_yoloxoverlay_parent_class parent_class
+G_DEFINE_TYPE (GstSimaaiYoloxoverlay, gst_simaai_yoloxoverlay, GST_TYPE_AGGREGATOR);
+
+/**
+ * @brief Helper API to read layout and dequantization of the MLA output heads
+ *        from the detess dequant config
+ */
+static gboolean gst_simaai_yoloxoverlay_parse_quant_config (GstSimaaiYoloxoverlay * self,
+                                                            const std::string & config_file_path,
+                                                            std::vector<YoloxQuantHead> & heads)
+{
+  try {
+    std::ifstream input_file(config_file_path);
+    if (!input_file)
+      throw std::runtime_error("Error opening file " + config_file_path);
+    std::ostringstream string_stream;
+    string_stream << input_file.rdbuf();
+
+    nlohmann::json json = nlohmann::json::parse(string_stream.str());
+
+    heads.clear();
+    for (size_t i = 0; i < json.at("dq_scale").size(); i++) {
+      YoloxQuantHead head;
+      head.scale = json.at("dq_scale").at(i).get<float>();
+      head.zp = json.at("dq_zp").at(i).get<int>();
+      head.width = json.at("input_width").at(i).get<int>();
+      head.height = json.at("input_height").at(i).get<int>();
+      head.depth = json.at("input_depth").at(i).get<int>();
+      head.slice_width = json.at("slice_width").at(i).get<int>();
+      head.slice_height = json.at("slice_height").at(i).get<int>();
+      head.slice_depth = json.at("slice_depth").at(i).get<int>();
+      heads.push_back(head);
+    }
+  } catch (std::exception & ex) {
+    GST_ERROR_OBJECT (self, "Unable to parse config file: %s", ex.what());
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * @brief Helper API to build decoder and palette for @params
+ */
+static gboolean gst_simaai_yoloxoverlay_build_decoder (GstSimaaiYoloxoverlay * self,
+                                                       const YoloxDecodeParams & params,
+                                                       gboolean quantized_input,
+                                                       const std::string & config_file_path)
+{
+  GstSimaaiYoloxoverlayPrivate * priv = self->priv;
+
+  if (!priv->decoder.configure(params)) {
+    GST_ERROR_OBJECT (self, "Model size %dx%d is not divisible by YOLOX strides",
+                      params.model_width, params.model_height);
+    return FALSE;
+  }
+
+  if (quantized_input) {
+    std::vector<YoloxQuantHead> heads;
+    if (!gst_simaai_yoloxoverlay_parse_quant_config(self, config_file_path, heads))
+      return FALSE;
+
+    if (!priv->decoder.configure_quantized(heads)) {
+      GST_ERROR_OBJECT (self, "Output heads in %s do not match YOLOX model %dx%d "
+                        "with %d classes, or depth is sliced",
+                        config_file_path.c_str(), params.model_width,
+                        params.model_height, params.num_classes);
+      return FALSE;
+    }
+
+    GST_DEBUG_OBJECT (self, "Quantized input: %zu bytes", priv->decoder.quantized_tensor_size());
+  }
+
+  priv->palette = yolox_make_palette(params.num_classes);
+  return TRUE;
+}
+
+/**
+ * @brief Helper API to (re)configure decoder for current properties. They
+ *        may be set from the application thread while streaming, so they
+ *        are copied under the object lock
+ */
+static gboolean gst_simaai_yoloxoverlay_configure (GstSimaaiYoloxoverlay * self)
+{
+  GstSimaaiYoloxoverlayPrivate * priv = self->priv;
+
+  GST_OBJECT_LOCK (self);
+  priv->active_line_thickness = priv->line_thickness;
+  if (priv->configured) {
+    GST_OBJECT_UNLOCK (self);
+    return TRUE;
+  }
+  YoloxDecodeParams params = priv->params;
+  gboolean quantized_input = priv->quantized_input;
+  std::string config_file_path = priv->config_file_path;
+  // a property set from now on clears it again for the next frame
+  priv->configured = TRUE;
+  GST_OBJECT_UNLOCK (self);
+
+  if (!gst_simaai_yoloxoverlay_build_decoder(self, params, quantized_input,
+                                             config_file_path)) {
+    GST_OBJECT_LOCK (self);
+    priv->configured = FALSE;
+    GST_OBJECT_UNLOCK (self);
+    return FALSE;
+  }
+
+  priv->active_params = params;
+  priv->active_quantized_input = quantized_input;
+
+  GST_DEBUG_OBJECT (self, "Configured decoder: %zu anchors, tensor of %zu floats",
+                    priv->decoder.num_anchors(), priv->decoder.tensor_size());
+
+  return TRUE;
+}
+
+/**
+ * @brief helper function to free output buffer pool
+ */
+static void gst_simaai_yoloxoverlay_free_memory (GstSimaaiYoloxoverlay * self)
+{
+  if (self->priv->pool != nullptr) {
+    gst_simaai_free_buffer_pool(self->priv->pool);
+    self->priv->pool = nullptr;
+  }
+}
+
+/**
+ * @brief helper function to allocate output NV12 frames
+ */
+static gboolean gst_simaai_yoloxoverlay_allocate_memory (GstSimaaiYoloxoverlay * self)
+{
+  gst_simaai_yoloxoverlay_free_memory(self);
+
+  GST_OBJECT_LOCK (self);
+  gsize segment_sizes[1] = { (gsize)self->priv->params.frame_width *
+                             self->priv->params.frame_height * 3 / 2 };
+  GST_OBJECT_UNLOCK (self);
+  const gchar * segment_names[1] = { self->priv->node_name.c_str() };
+
+  GstMemoryFlags flags = static_cast<GstMemoryFlags>(self->priv->mem_type
+                                                     | self->priv->mem_flag);
+
+  self->priv->pool =
+      gst_simaai_allocate_buffer_pool2((GstObject *) self,
+                                       gst_simaai_memory_get_segment_allocator(),
+                                       MIN_POOL_SIZE,
+                                       self->priv->num_of_out_buf,
+                                       flags, 1,
+                                       segment_sizes,
+                                       segment_names);
+
+  if (self->priv->pool == nullptr) {
+    GST_ERROR_OBJECT (self, "Failed to allocate buffer pool");
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (self, "Output buffer pool: %u buffers of size %zu",
+                    self->priv->num_of_out_buf, segment_sizes[0]);
+
+  return TRUE;
+}
+
+/**
+ * @brief Helper API to read frame metadata of an input buffer
+ * @return buffer name or NULL if metadata is missing
+ */
+static const gchar * gst_simaai_yoloxoverlay_parse_meta (GstSimaaiYoloxoverlay * self,
+                                                         GstBuffer * buf,
+                                                         GstSimaaiFrameInfo & info)
+{
+  if (!gst_buffer_get_simaai_frame_info(buf, &info))
+    return NULL;
+
+  return gst_simaai_frame_info_get_buffer_name(&info);
+}
+
+/**
+ * @brief Helper API to update output metadata information
+ */
+static gboolean gst_simaai_yoloxoverlay_update_metainfo (GstSimaaiYoloxoverlay * self,
+                                                         const GstSimaaiFrameInfo & info,
+                                                         GstBuffer * buffer)
+{
+  // output inherits frame id, stream id, timestamp and PCIe id of the frame
+  GstSimaaiFrameInfo out_info = info;
+  out_info.buffer_id = gst_simaai_segment_memory_get_phys_addr(
+      gst_buffer_peek_memory(buffer, 0));
+  out_info.buffer_name = self->priv->node_quark;
+  out_info.buffer_offset = 0;
+
+  if (gst_buffer_add_simaai_frame_meta(buffer, &out_info) == NULL) {
+    GST_ERROR_OBJECT (self, "Unable to add metadata info to the buffer");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * @brief Helper API to post KPI message, same fields as python plugins
+ */
+static void gst_simaai_yoloxoverlay_post_kpi (GstSimaaiYoloxoverlay * self,
+                                             const GstSimaaiFrameInfo & info,
+                                             guint64 start, guint64 end)
+{
+  GstStructure * kpi = gst_structure_new("kpi",
+                                         "plugin_start", G_TYPE_UINT64, start,
+                                         "plugin_end", G_TYPE_UINT64, end,
+                                         "duration", G_TYPE_DOUBLE, (end - start) / 1000.0,
+                                         "kernel_start", G_TYPE_UINT64, (guint64)0,
+                                         "kernel_end", G_TYPE_UINT64, (guint64)0,
+                                         "frame_id", G_TYPE_INT64, info.frame_id,
+                                         "plugin_id", G_TYPE_STRING, self->priv->node_name.c_str(),
+                                         "plugin_type", G_TYPE_STRING, PLUGIN_CPU_TYPE,
+                                         "stream_id", G_TYPE_STRING, GST_SIMAAI_QUARK_STR(info.stream_id),
+                                         NULL);
+
+  gst_element_post_message(GST_ELEMENT(self),
+                           gst_message_new_application(GST_OBJECT(self), kpi));
+}
+
+/**
+ * @brief Helper API to decode tensor and draw detections to output frame
+ */
+static gboolean gst_simaai_yoloxoverlay_process (GstSimaaiYoloxoverlay * self,
+                                                 GstBuffer * tensor,
+                                                 GstBuffer * frame,
+                                                 GstBuffer * outbuf)
+{
+  GstSimaaiYoloxoverlayPrivate * priv = self->priv;
+  const YoloxDecodeParams & params = priv->active_params;
+  const gsize y_size = (gsize)params.frame_width * params.frame_height;
+  const gsize frame_size = y_size * 3 / 2;
+  const gsize tensor_size = priv->active_quantized_input ?
+                            priv->decoder.quantized_tensor_size() :
+                            priv->decoder.tensor_size() * sizeof(float);
+  GstMapInfo tensor_map, frame_map, out_map;
+  gboolean ret = FALSE;
+
+  if (!gst_buffer_map(tensor, &tensor_map, GST_MAP_READ)) {
+    GST_ERROR_OBJECT (self, "Failed to map tensor buffer");
+    return FALSE;
+  }
+
+  if (!gst_buffer_map(frame, &frame_map, GST_MAP_READ)) {
+    GST_ERROR_OBJECT (self, "Failed to map frame buffer");
+    gst_buffer_unmap(tensor, &tensor_map);
+    return FALSE;
+  }
+
+  if (!gst_buffer_map(outbuf, &out_map, GST_MAP_WRITE)) {
+    GST_ERROR_OBJECT (self, "Failed to map output buffer");
+    gst_buffer_unmap(frame, &frame_map);
+    gst_buffer_unmap(tensor, &tensor_map);
+    return FALSE;
+  }
+
+  if (tensor_map.size < tensor_size || frame_map.size < frame_size ||
+      out_map.size < frame_size) {
+    GST_ERROR_OBJECT (self, "Unexpected buffer sizes: tensor %zu (expected %zu), "
+                      "frame %zu, output %zu (expected %zu)",
+                      tensor_map.size, tensor_size, frame_map.size,
+                      out_map.size, frame_size);
+    goto unmap;
+  }
+
+  {
+    const std::vector<YoloxDetection> & detections = priv->active_quantized_input ?
+        priv->decoder.decode_quantized((const int8_t *)tensor_map.data) :
+        priv->decoder.decode((const float *)tensor_map.data);
+
+    memcpy(out_map.data, frame_map.data, frame_size);
+    yolox_draw_nv12(out_map.data, params.frame_width,
+                    out_map.data + y_size, params.frame_width,
+                    params.frame_width, params.frame_height,
+                    detections, priv->palette, priv->active_line_thickness);
+
+    GST_DEBUG_OBJECT (self, "Frame decoded, %zu detections", detections.size());
+  }
+
+  ret = TRUE;
+
+unmap:
+  gst_buffer_unmap(outbuf, &out_map);
+  gst_buffer_unmap(frame, &frame_map);
+  gst_buffer_unmap(tensor, &tensor_map);
+
+  return ret;
+}
+
+static GstFlowReturn gst_simaai_yoloxoverlay_aggregate (GstAggregator * aggregator,
+                                                        gboolean timeout)
+{
+  GstSimaaiYoloxoverlay * self = GST_SIMAAI_YOLOXOVERLAY (aggregator);
+  GstBuffer * tensor = NULL;
+  GstBuffer * frame = NULL;
+  GstBuffer * outbuf = NULL;
+  GstSimaaiFrameInfo info = {};
+  GstFlowReturn ret = GST_FLOW_ERROR;
+  gboolean done_iterating = FALSE;
+
+  auto t0 = std::chrono::steady_clock::now();
+
+  GstIterator * iter = gst_element_iterate_sink_pads (GST_ELEMENT (self));
+  while (!done_iterating) {
+    GValue value = { 0, };
+
+    switch (gst_iterator_next (iter, &value)) {
+      case GST_ITERATOR_OK: {
+        GstAggregatorPad * pad = (GstAggregatorPad *) g_value_get_object (&value);
+        GstBuffer * buf = gst_aggregator_pad_pop_buffer (pad);
+        g_value_unset (&value);
+        if (buf == NULL)
+          break;
+
+        GstSimaaiFrameInfo buf_info = {};
+        const gchar * buf_name = gst_simaai_yoloxoverlay_parse_meta(self, buf, buf_info);
+        if (buf_name == NULL) {
+          GST_ERROR_OBJECT (self, "Please check readme to use metadata information,"
+                            " meta not found");
+          gst_buffer_unref(buf);
+        } else if (self->priv->tensor_name == buf_name && tensor == NULL) {
+          tensor = buf;
+        } else if (self->priv->frame_name == buf_name && frame == NULL) {
+          // output inherits metadata of the frame
+          frame = buf;
+          info = buf_info;
+        } else {
+          GST_WARNING_OBJECT (self, "Dropping unexpected input buffer %s", buf_name);
+          gst_buffer_unref(buf);
+        }
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (iter);
+        break;
+      case GST_ITERATOR_ERROR:
+        GST_WARNING_OBJECT (self, "Sinkpads iteration error");
+        done_iterating = TRUE;
+        break;
+      case GST_ITERATOR_DONE:
+        done_iterating = TRUE;
+        break;
+    }
+  }
+  gst_iterator_free (iter);
+
+  if (tensor == NULL || frame == NULL) {
+    GST_ERROR_OBJECT (self, "Missing input: tensor %s, frame %s",
+                      tensor ? "found" : "not found",
+                      frame ? "found" : "not found");
+    goto out;
+  }
+
+  if (!gst_simaai_yoloxoverlay_configure(self))
+    goto out;
+
+  if (gst_buffer_pool_acquire_buffer(self->priv->pool, &outbuf, NULL) != GST_FLOW_OK) {
+    GST_ERROR_OBJECT (self, "Failed to allocate buffer");
+    goto out;
+  }
+
+  if (!gst_simaai_yoloxoverlay_process(self, tensor, frame, outbuf) ||
+      !gst_simaai_yoloxoverlay_update_metainfo(self, info, outbuf)) {
+    gst_buffer_unref(outbuf);
+    goto out;
+  }
+
+  GST_BUFFER_PTS (outbuf) = GST_BUFFER_PTS (frame);
+  GST_BUFFER_DTS (outbuf) = GST_BUFFER_DTS (frame);
+  GST_BUFFER_DURATION (outbuf) = GST_BUFFER_DURATION (frame);
+
+  {
+    auto t1 = std::chrono::steady_clock::now();
+    guint64 start = std::chrono::duration_cast<std::chrono::microseconds>(
+        t0.time_since_epoch()).count();
+    guint64 end = std::chrono::duration_cast<std::chrono::microseconds>(
+        t1.time_since_epoch()).count();
+
+    if (!self->silent) {
+      gint64 run_count = ++self->priv->run_count;
+      GST_DEBUG_OBJECT(self, "run count[%ld], frame_id[%ld], run time in ms: %f",
+                       run_count, info.frame_id, (end - start) / 1000.0);
+    }
+
+    if (self->transmit)
+      gst_simaai_yoloxoverlay_post_kpi(self, info, start, end);
+  }
+
+  ret = gst_aggregator_finish_buffer (aggregator, outbuf);
+
+out:
+  if (tensor)
+    gst_buffer_unref(tensor);
+  if (frame)
+    gst_buffer_unref(frame);
+
+  return ret;
+}
+
+/**
+ * @brief Source caps are NV12 frames of `frame-width`x`frame-height`
+ */
+static GstFlowReturn
+gst_simaai_yoloxoverlay_update_src_caps (GstAggregator * aggregator,
+                                         GstCaps * caps, GstCaps ** ret)
+{
+  GstSimaaiYoloxoverlay * self = GST_SIMAAI_YOLOXOVERLAY (aggregator);
+
+  GST_OBJECT_LOCK (self);
+  gint frame_width = self->priv->params.frame_width;
+  gint frame_height = self->priv->params.frame_height;
+  GST_OBJECT_UNLOCK (self);
+
+  GstCaps * frame_caps = gst_caps_new_simple("video/x-raw",
+                                             "format", G_TYPE_STRING, "NV12",
+                                             "width", G_TYPE_INT, frame_width,
+                                             "height", G_TYPE_INT, frame_height,
+                                             NULL);
+
+  *ret = gst_caps_intersect(caps, frame_caps);
+  gst_caps_unref(frame_caps);
+
+  if (gst_caps_is_empty(*ret)) {
+    GST_ERROR_OBJECT (self, "Downstream does not accept NV12 %dx%d",
+                      frame_width, frame_height);
+    gst_caps_replace(ret, NULL);
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  return GST_FLOW_OK;
+}
+
+static gboolean gst_simaai_yoloxoverlay_decide_allocation (GstAggregator * aggregator,
+                                                           GstQuery * query)
+{
+  GstSimaaiYoloxoverlay * self = GST_SIMAAI_YOLOXOVERLAY (aggregator);
+
+  GstSimaaiMemoryFlags mem_type;
+  GstSimaaiMemoryFlags mem_flag;
+
+  if (!gst_simaai_allocation_query_parse(query, &mem_type, &mem_flag)) {
+    GST_WARNING_OBJECT(self, "Can't find allocation meta!");
+  } else {
+    self->priv->mem_type = mem_type;
+    self->priv->mem_flag = mem_flag;
+  }
+
+  GST_DEBUG_OBJECT(self, "Memory flags to allocate: [ %s ] [ %s ]",
+    gst_simaai_allocation_query_sima_mem_type_to_str(self->priv->mem_type),
+    gst_simaai_allocation_query_sima_mem_flag_to_str(self->priv->mem_flag));
+
+  return gst_simaai_yoloxoverlay_allocate_memory(self);
+}
+
+static gboolean gst_simaai_yoloxoverlay_propose_allocation (GstAggregator * aggregator,
+                                                            GstAggregatorPad * pad,
+                                                            GstQuery * decide_query,
+                                                            GstQuery * query)
+{
+  // inputs are read on A65
+  GstStructure *allocation_meta =
+      gst_simaai_allocation_query_create_meta(GST_SIMAAI_MEMORY_TARGET_GENERIC,
+                                              GST_SIMAAI_MEMORY_FLAG_CACHED);
+
+  gst_simaai_allocation_query_add_meta(query, allocation_meta);
+
+  return TRUE;
+}
+
+/**
+ * @brief Called to perform state change.
+ */
+static GstStateChangeReturn
+gst_simaai_yoloxoverlay_change_state (GstElement * element,
+                                      GstStateChange transition)
+{
+  GstSimaaiYoloxoverlay * self = GST_SIMAAI_YOLOXOVERLAY (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+  case GST_STATE_CHANGE_NULL_TO_READY: {
+    gchar * name = gst_element_get_name(element);
+    self->priv->node_name = name;
+    self->priv->node_quark = g_quark_from_string(name);
+    g_free(name);
+    GST_DEBUG_OBJECT(self, "GST_STATE_CHANGE_NULL_TO_READY");
+    break;
+  }
+  case GST_STATE_CHANGE_READY_TO_PAUSED:
+    if (!gst_simaai_yoloxoverlay_configure(self))
+      return GST_STATE_CHANGE_FAILURE;
+    GST_DEBUG_OBJECT(self, "GST_STATE_CHANGE_READY_TO_PAUSED");
+    break;
+  default:
+    break;
+  }
+
+  ret = GST_ELEMENT_CLASS(parent_class)->change_state(element, transition);
+  if (ret == GST_STATE_CHANGE_FAILURE)
+    return ret;
+
+  switch (transition) {
+  case GST_STATE_CHANGE_READY_TO_NULL:
+    gst_simaai_yoloxoverlay_free_memory(self);
+    GST_DEBUG_OBJECT(self, "GST_STATE_CHANGE_READY_TO_NULL");
+    break;
+  default:
+    break;
+  }
+
+  return ret;
+}
+
+/**
+ * @brief Setter for yoloxoverlay properties.
+ */
+static void gst_simaai_yoloxoverlay_set_property (GObject * object,
+                                                  guint prop_id,
+                                                  const GValue * value,
+                                                  GParamSpec * pspec)
+{
+  GstSimaaiYoloxoverlay * self = GST_SIMAAI_YOLOXOVERLAY (object);
+  GstSimaaiYoloxoverlayPrivate * priv = self->priv;
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_TENSOR_NAME:
+      priv->tensor_name = g_value_get_string(value);
+      break;
+    case PROP_FRAME_NAME:
+      priv->frame_name = g_value_get_string(value);
+      break;
+    case PROP_SCORE_THRESHOLD:
+      priv->params.score_threshold = g_value_get_float(value);
+      priv->configured = FALSE;
+      break;
+    case PROP_NMS_THRESHOLD:
+      priv->params.nms_threshold = g_value_get_float(value);
+      priv->configured = FALSE;
+      break;
+    case PROP_FRAME_WIDTH:
+      priv->params.frame_width = g_value_get_int(value);
+      priv->configured = FALSE;
+      break;
+    case PROP_FRAME_HEIGHT:
+      priv->params.frame_height = g_value_get_int(value);
+      priv->configured = FALSE;
+      break;
+    case PROP_MODEL_WIDTH:
+      priv->params.model_width = g_value_get_int(value);
+      priv->configured = FALSE;
+      break;
+    case PROP_MODEL_HEIGHT:
+      priv->params.model_height = g_value_get_int(value);
+      priv->configured = FALSE;
+      break;
+    case PROP_NUM_CLASSES:
+      priv->params.num_classes = g_value_get_int(value);
+      priv->configured = FALSE;
+      break;
+    case PROP_LINE_THICKNESS:
+      priv->line_thickness = g_value_get_uint(value);
+      break;
+    case PROP_QUANTIZED_INPUT:
+      priv->quantized_input = g_value_get_boolean(value);
+      priv->configured = FALSE;
+      break;
+    case PROP_CONF_F:
+      priv->config_file_path = g_value_get_string(value);
+      priv->configured = FALSE;
+      break;
+    case PROP_NO_OF_BUFS:
+      priv->num_of_out_buf = g_value_get_ulong(value);
+      break;
+    case PROP_SILENT:
+      self->silent = g_value_get_boolean(value);
+      break;
+    case PROP_TRANSMIT:
+      self->transmit = g_value_get_boolean(value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+/**
+ * @brief Getter for yoloxoverlay properties.
+ */
+static void gst_simaai_yoloxoverlay_get_property (GObject * object,
+                                                  guint prop_id,
+                                                  GValue * value,
+                                                  GParamSpec * pspec)
+{
+  GstSimaaiYoloxoverlay * self = GST_SIMAAI_YOLOXOVERLAY (object);
+  GstSimaaiYoloxoverlayPrivate * priv = self->priv;
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_TENSOR_NAME:
+      g_value_set_string(value, priv->tensor_name.c_str());
+      break;
+    case PROP_FRAME_NAME:
+      g_value_set_string(value, priv->frame_name.c_str());
+      break;
+    case PROP_SCORE_THRESHOLD:
+      g_value_set_float(value, priv->params.score_threshold);
+      break;
+    case PROP_NMS_THRESHOLD:
+      g_value_set_float(value, priv->params.nms_threshold);
+      break;
+    case PROP_FRAME_WIDTH:
+      g_value_set_int(value, priv->params.frame_width);
+      break;
+    case PROP_FRAME_HEIGHT:
+      g_value_set_int(value, priv->params.frame_height);
+      break;
+    case PROP_MODEL_WIDTH:
+      g_value_set_int(value, priv->params.model_width);
+      break;
+    case PROP_MODEL_HEIGHT:
+      g_value_set_int(value, priv->params.model_height);
+      break;
+    case PROP_NUM_CLASSES:
+      g_value_set_int(value, priv->params.num_classes);
+      break;
+    case PROP_LINE_THICKNESS:
+      g_value_set_uint(value, priv->line_thickness);
+      break;
+    case PROP_QUANTIZED_INPUT:
+      g_value_set_boolean(value, priv->quantized_input);
+      break;
+    case PROP_CONF_F:
+      g_value_set_string(value, priv->config_file_path.c_str());
+      break;
+    case PROP_NO_OF_BUFS:
+      g_value_set_ulong(value, priv->num_of_out_buf);
+      break;
+    case PROP_SILENT:
+      g_value_set_boolean(value, self->silent);
+      break;
+    case PROP_TRANSMIT:
+      g_value_set_boolean(value, self->transmit);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+/**
+ * @brief Finalize/Cleanup yoloxoverlay callback
+ */
+static void
+gst_simaai_yoloxoverlay_finalize (GObject * object)
+{
+  GstSimaaiYoloxoverlay * self = GST_SIMAAI_YOLOXOVERLAY (object);
+
+  gst_simaai_yoloxoverlay_free_memory(self);
+
+  delete self->priv;
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+/**
+ * @brief Callback to yoloxoverlay class init
+ */
+static void
+gst_simaai_yoloxoverlay_class_init (GstSimaaiYoloxoverlayClass * klass)
+{
+  GObjectClass *gobj_class = G_OBJECT_CLASS(klass);
+  GstElementClass *gstelement_class = (GstElementClass *) klass;
+  GstAggregatorClass *base_aggregator_class = (GstAggregatorClass *) klass;
+
+  GstPadTemplate *sink_pad_template =
+      gst_pad_template_new_with_gtype(PAD_TEMPLATE_NAME_SINK, GST_PAD_SINK,
+      GST_PAD_REQUEST, gst_caps_new_any(), GST_TYPE_AGGREGATOR_PAD);
+  gst_element_class_add_pad_template(gstelement_class, sink_pad_template);
+
+  GstPadTemplate *src_pad_template =
+      gst_pad_template_new_with_gtype(PAD_TEMPLATE_NAME_SRC, GST_PAD_SRC,
+      GST_PAD_ALWAYS, gst_caps_from_string("video/x-raw, format=(string)NV12"),
+      GST_TYPE_AGGREGATOR_PAD);
+  gst_element_class_add_pad_template(gstelement_class, src_pad_template);
+
+  gobj_class->finalize = gst_simaai_yoloxoverlay_finalize;
+  gobj_class->set_property = gst_simaai_yoloxoverlay_set_property;
+  gobj_class->get_property = gst_simaai_yoloxoverlay_get_property;
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_simaai_yoloxoverlay_change_state);
+
+  base_aggregator_class->aggregate =
+      GST_DEBUG_FUNCPTR (gst_simaai_yoloxoverlay_aggregate);
+  base_aggregator_class->update_src_caps =
+      GST_DEBUG_FUNCPTR (gst_simaai_yoloxoverlay_update_src_caps);
+  base_aggregator_class->decide_allocation =
+      GST_DEBUG_FUNCPTR (gst_simaai_yoloxoverlay_decide_allocation);
+  base_aggregator_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_simaai_yoloxoverlay_propose_allocation);
+
+  g_object_class_install_property (gobj_class, PROP_TENSOR_NAME,
+                                   g_param_spec_string ("tensor-name",
+                                                        "Tensor Buffer Name",
+                                                        "buffer-name of the dequantized YOLOX tensor input",
+                                                        DEFAULT_TENSOR_BUFFER_NAME,
+                                                        (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+  g_object_class_install_property (gobj_class, PROP_FRAME_NAME,
+                                   g_param_spec_string ("frame-name",
+                                                        "Frame Buffer Name",
+                                                        "buffer-name of the NV12 frame input",
+                                                        DEFAULT_FRAME_BUFFER_NAME,
+                                                        (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+  g_object_class_install_property (gobj_class, PROP_SCORE_THRESHOLD,
+                                   g_param_spec_float ("score-threshold",
+                                                       "Score Threshold",
+                                                       "Minimal objectness * class score of a detection",
+                                                       0.0, 1.0, DEFAULT_SCORE_THRESHOLD,
+                                                       (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+  g_object_class_install_property (gobj_class, PROP_NMS_THRESHOLD,
+                                   g_param_spec_float ("nms-threshold",
+                                                       "NMS Threshold",
+                                                       "Maximal IoU of detections kept by NMS",
+                                                       0.0, 1.0, DEFAULT_NMS_THRESHOLD,
+                                                       (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+  g_object_class_install_property (gobj_class, PROP_FRAME_WIDTH,
+                                   g_param_spec_int ("frame-width",
+                                                     "Frame Width",
+                                                     "Width of the NV12 frame",
+                                                     2, 8192, DEFAULT_FRAME_WIDTH,
+                                                     (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                   GST_PARAM_MUTABLE_READY)));
+  g_object_class_install_property (gobj_class, PROP_FRAME_HEIGHT,
+                                   g_param_spec_int ("frame-height",
+                                                     "Frame Height",
+                                                     "Height of the NV12 frame",
+                                                     2, 8192, DEFAULT_FRAME_HEIGHT,
+                                                     (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                   GST_PARAM_MUTABLE_READY)));
+  g_object_class_install_property (gobj_class, PROP_MODEL_WIDTH,
+                                   g_param_spec_int ("model-width",
+                                                     "Model Width",
+                                                     "Width of the model input, multiple of 32",
+                                                     32, 8192, DEFAULT_MODEL_WIDTH,
+                                                     (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                   GST_PARAM_MUTABLE_READY)));
+  g_object_class_install_property (gobj_class, PROP_MODEL_HEIGHT,
+                                   g_param_spec_int ("model-height",
+                                                     "Model Height",
+                                                     "Height of the model input, multiple of 32",
+                                                     32, 8192, DEFAULT_MODEL_HEIGHT,
+                                                     (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                   GST_PARAM_MUTABLE_READY)));
+  g_object_class_install_property (gobj_class, PROP_NUM_CLASSES,
+                                   g_param_spec_int ("num-classes",
+                                                     "Number Of Classes",
+                                                     "Number of classes of the model",
+                                                     1, 1024, DEFAULT_NUM_CLASSES,
+                                                     (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                   GST_PARAM_MUTABLE_READY)));
+  g_object_class_install_property (gobj_class, PROP_LINE_THICKNESS,
+                                   g_param_spec_uint ("line-thickness",
+                                                      "Line Thickness",
+                                                      "Thickness of box lines in pixels",
+                                                      1, 16, DEFAULT_LINE_THICKNESS,
+                                                      (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+  /* These properties are used to decode the MLA output without detess dequant CVU */
+  g_object_class_install_property (gobj_class, PROP_QUANTIZED_INPUT,
+                                   g_param_spec_boolean ("quantized-input",
+                                                         "Quantized Input",
+                                                         "Tensor input is the INT8 MLA output. Only anchors "
+                                                         "passing objectness threshold are dequantized",
+                                                         FALSE,
+                                                         (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                       GST_PARAM_MUTABLE_READY)));
+  g_object_class_install_property (gobj_class, PROP_CONF_F,
+                                   g_param_spec_string ("config",
+                                                        "ConfigFile",
+                                                        "Detess dequant config JSON with dq_scale, dq_zp "
+                                                        "and slice shapes of the MLA output",
+                                                        DEFAULT_CONFIG_FILE,
+                                                        (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+                                                                      GST_PARAM_MUTABLE_READY)));
+  /* This property is used to allocate output buffers memory */
+  g_object_class_install_property(gobj_class, PROP_NO_OF_BUFS,
+                                  g_param_spec_ulong("num-buffers",
+                                                     "Number Of Buffers",
+                                                     "Number of buffers to be allocated of size of buffer",
+                                                     1, G_MAXUINT,
+                                                     DEFAULT_NUM_BUFFERS,
+                                                     (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+  g_object_class_install_property (gobj_class, PROP_SILENT,
+                                   g_param_spec_boolean ("silent",
+                                                         "Silent",
+                                                         "Produce verbose output",
+                                                         DEFAULT_SILENT,
+                                                         (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+  g_object_class_install_property (gobj_class, PROP_TRANSMIT,
+                                   g_param_spec_boolean ("transmit",
+                                                         "Transmit",
+                                                         "Transmit KPI Message",
+                                                         DEFAULT_TRANSMIT,
+                                                         (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+                                         "SiMa.AI YOLOX Overlay Plugin",
+                                         "Filter/Effect/Video",
+                                         "Decodes YOLOX-s outputs and draws detections on NV12 frame",
+                                         "SiMa.AI");
+
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT,
+                           "simaaiyoloxoverlay", 0, "YoloxOverlay");
+}
+
+static void
+gst_simaai_yoloxoverlay_init (GstSimaaiYoloxoverlay * self)
+{
+  GstAggregator *agg = GST_AGGREGATOR (self);
+  gst_segment_init (&GST_AGGREGATOR_PAD (agg->srcpad)->segment,
+                    GST_FORMAT_TIME);
+
+  self->silent = DEFAULT_SILENT;
+  self->transmit = DEFAULT_TRANSMIT;
+  gst_simaai_segment_memory_init_once();
+  self->priv = new GstSimaaiYoloxoverlayPrivate;
+
+  self->priv->node_quark = 0;
+  self->priv->tensor_name = DEFAULT_TENSOR_BUFFER_NAME;
+  self->priv->frame_name = DEFAULT_FRAME_BUFFER_NAME;
+  self->priv->params.score_threshold = DEFAULT_SCORE_THRESHOLD;
+  self->priv->params.nms_threshold = DEFAULT_NMS_THRESHOLD;
+  self->priv->params.frame_width = DEFAULT_FRAME_WIDTH;
+  self->priv->params.frame_height = DEFAULT_FRAME_HEIGHT;
+  self->priv->params.model_width = DEFAULT_MODEL_WIDTH;
+  self->priv->params.model_height = DEFAULT_MODEL_HEIGHT;
+  self->priv->params.num_classes = DEFAULT_NUM_CLASSES;
+  self->priv->line_thickness = DEFAULT_LINE_THICKNESS;
+  self->priv->quantized_input = FALSE;
+  self->priv->config_file_path = DEFAULT_CONFIG_FILE;
+  self->priv->configured = FALSE;
+
+  self->priv->pool = nullptr;
+  self->priv->num_of_out_buf = DEFAULT_NUM_BUFFERS;
+  self->priv->mem_type = GST_SIMAAI_MEMORY_TARGET_GENERIC;
+  self->priv->mem_flag = GST_SIMAAI_MEMORY_FLAG_CACHED;
+  self->priv->run_count = 0;
+}
+
+static gboolean
+plugin_init (GstPlugin * plugin)
+{
+  if (!gst_element_register(plugin, "simaaiyoloxoverlay", GST_RANK_NONE,
+                            GST_TYPE_SIMAAI_YOLOXOVERLAY)) {
+    GST_ERROR("Unable to register simaaiyoloxoverlay plugin");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+GST_PLUGIN_DEFINE(
+    GST_VERSION_MAJOR,
+    GST_VERSION_MINOR,
+    PLUGIN_NAME_LOWER,
+    "GStreamer SiMa.ai YOLOX Overlay Plugin",
+    plugin_init,
+    VERSION,
+    GST_LICENSE,
+    GST_PACKAGE_NAME,
+    GST_PACKAGE_ORIGIN
+     );
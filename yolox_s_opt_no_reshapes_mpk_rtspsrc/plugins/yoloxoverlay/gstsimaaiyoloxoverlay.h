@@ -0,0 +1,74 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef GST_SIMAAIYOLOXOVERLAY_H_
+#define GST_SIMAAIYOLOXOVERLAY_H_
+
+#include <gst/gst.h>
+#include <gst/base/gstaggregator.h>
+
+#define DEFAULT_TENSOR_BUFFER_NAME "simaaiprocessdetess_dequant_1"
+#define DEFAULT_FRAME_BUFFER_NAME "decoder"
+#define DEFAULT_SCORE_THRESHOLD 0.5
+#define DEFAULT_NMS_THRESHOLD 0.5
+#define DEFAULT_FRAME_WIDTH 1280
+#define DEFAULT_FRAME_HEIGHT 720
+#define DEFAULT_MODEL_WIDTH 640
+#define DEFAULT_MODEL_HEIGHT 640
+#define DEFAULT_NUM_CLASSES 80
+#define DEFAULT_LINE_THICKNESS 2
+#define DEFAULT_CONFIG_FILE "/data/simaai/applications/yolox_s_opt_no_reshapes_mpk_rtspsrc/etc/0_postproc.json"
+#define DEFAULT_NUM_BUFFERS 5
+#define MIN_POOL_SIZE 2
+
+#define PAD_TEMPLATE_NAME_SINK  "sink_%u"
+#define PAD_TEMPLATE_NAME_SRC   "src"
+
+#define SIMAAI_META_STR "GstSimaMeta"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_SIMAAI_YOLOXOVERLAY            (gst_simaai_yoloxoverlay_get_type ())
+#define GST_SIMAAI_YOLOXOVERLAY(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_SIMAAI_YOLOXOVERLAY, GstSimaaiYoloxoverlay))
+#define GST_SIMAAI_YOLOXOVERLAY_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GST_TYPE_SIMAAI_YOLOXOVERLAY, GstSimaaiYoloxoverlayClass))
+#define GST_SIMAAI_YOLOXOVERLAY_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GST_TYPE_SIMAAI_YOLOXOVERLAY, GstSimaaiYoloxoverlayClass))
+
+typedef struct _GstSimaaiYoloxoverlay GstSimaaiYoloxoverlay;
+typedef struct _GstSimaaiYoloxoverlayClass GstSimaaiYoloxoverlayClass;
+typedef struct _GstSimaaiYoloxoverlayPrivate GstSimaaiYoloxoverlayPrivate;
+
+struct _GstSimaaiYoloxoverlay
+{
+  GstAggregator parent;
+  gboolean silent; /**< true to print minimized log */
+  GstSimaaiYoloxoverlayPrivate *priv;
+  gboolean transmit;
+};
+
+struct _GstSimaaiYoloxoverlayClass
+{
+  GstAggregatorClass parent_class;
+};
+
+GType gst_simaai_yoloxoverlay_get_type (void);
+
+G_END_DECLS
+
+#endif // GST_SIMAAIYOLOXOVERLAY_H_
@@ -0,0 +1,209 @@
+//**************************************************************************
+//||                        SiMa.ai CONFIDENTIAL                          ||
+//||   Unpublished Copyright (c) 2022-2023 SiMa.ai, All Rights Reserved.  ||
+//**************************************************************************
+
+/**
+ * Test of YOLOX decode, NMS and NV12 drawing on a synthetic model output.
+ * Expected values are computed the same way payload.py does.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "yolox_decode.h"
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      return 1;                                                         \
+    }                                                                   \
+  } while (0)
+
+static bool near(float a, float b)
+{
+  return fabsf(a - b) < 1e-3f;
+}
+
+static void set_anchor(std::vector<float> & tensor, size_t idx, int channels,
+                       float x, float y, float w, float h, float obj,
+                       int class_id, float cls)
+{
+  float * anchor = &tensor[idx * channels];
+  anchor[0] = x;
+  anchor[1] = y;
+  anchor[2] = logf(w);
+  anchor[3] = logf(h);
+  anchor[4] = obj;
+  anchor[5 + class_id] = cls;
+}
+
+static int test_decode()
+{
+  YoloxDecodeParams params;
+  YoloxDecoder decoder;
+
+  CHECK(decoder.configure(params));
+  CHECK(decoder.num_anchors() == 80 * 80 + 40 * 40 + 20 * 20);
+
+  const int channels = 5 + params.num_classes;
+  std::vector<float> tensor(decoder.tensor_size(), 0.0f);
+
+  // stride 8, grid (10, 20): box 32x32 centered at (84, 164) in model input
+  set_anchor(tensor, 20 * 80 + 10, channels, 0.5f, 0.5f, 4.0f, 4.0f, 0.9f, 2, 0.9f);
+  // neighbour anchor with the same box shifted by 8, IoU 49/81 in frame
+  set_anchor(tensor, 20 * 80 + 11, channels, 0.5f, 0.5f, 4.0f, 4.0f, 0.8f, 2, 0.9f);
+  // stride 32, grid (5, 5), other class
+  set_anchor(tensor, 6400 + 1600 + 5 * 20 + 5, channels, 0.5f, 0.5f, 2.0f, 3.0f, 0.95f, 7, 0.7f);
+  // under score threshold
+  set_anchor(tensor, 100, channels, 0.5f, 0.5f, 2.0f, 2.0f, 0.6f, 1, 0.6f);
+
+  const std::vector<YoloxDetection> & dets = decoder.decode(tensor.data());
+  CHECK(dets.size() == 2);
+
+  CHECK(dets[0].class_id == 2);
+  CHECK(near(dets[0].score, 0.81f));
+  CHECK(near(dets[0].x1, 136.0f));
+  CHECK(near(dets[0].y1, 166.5f));
+  CHECK(near(dets[0].x2, 200.0f));
+  CHECK(near(dets[0].y2, 202.5f));
+
+  // center (176, 176), size 64x96 in model input
+  CHECK(dets[1].class_id == 7);
+  CHECK(near(dets[1].score, 0.665f));
+  CHECK(near(dets[1].x1, 288.0f));
+  CHECK(near(dets[1].y1, 144.0f));
+  CHECK(near(dets[1].x2, 416.0f));
+  CHECK(near(dets[1].y2, 252.0f));
+
+  // looser NMS keeps the overlapping box
+  params.nms_threshold = 0.7f;
+  CHECK(decoder.configure(params));
+  CHECK(decoder.decode(tensor.data()).size() == 3);
+
+  // nothing over threshold
+  std::vector<float> empty(decoder.tensor_size(), 0.0f);
+  CHECK(decoder.decode(empty.data()).empty());
+
+  params.model_width = 100;
+  CHECK(!decoder.configure(params));
+
+  return 0;
+}
+
+/**
+ * INT8 output with layout of 0_postproc.json: decode_quantized() must give the
+ * same detections as decode() of the dequantized tensor
+ */
+static int test_decode_quantized()
+{
+  YoloxDecodeParams params;
+  YoloxDecoder decoder;
+  CHECK(decoder.configure(params));
+
+  const int channels = 5 + params.num_classes;
+  const float scales[3] = { 45.888838373387166f, 46.92204034273037f, 54.058788618785044f };
+  const int zps[3] = { -29, -25, -35 };
+  const int sizes[3] = { 80, 40, 20 };
+
+  std::vector<YoloxQuantHead> heads;
+  for (int h = 0; h < 3; h++)
+    heads.push_back({ scales[h], zps[h], sizes[h], sizes[h], channels,
+                      sizes[h], 1, channels });
+  CHECK(decoder.configure_quantized(heads));
+  CHECK(decoder.quantized_tensor_size() == 806400);
+
+  std::vector<int8_t> qtensor(decoder.quantized_tensor_size(), 0);
+  std::vector<float> tensor(decoder.tensor_size());
+  uint32_t state = 12345;
+  size_t anchor = 0, offset = 0;
+
+  for (int h = 0; h < 3; h++) {
+    for (int i = 0; i < sizes[h] * sizes[h]; i++, anchor++, offset += 96) {
+      for (int c = 0; c < channels; c++) {
+        state = state * 1664525u + 1013904223u;
+        int q;
+        if (c == 4)
+          // objectness: mostly background, some objects
+          q = ((state >> 8) % 100 < 3) ? zps[h] + (int)(scales[h] * 0.9f) : zps[h] + 2;
+        else if (c > 4)
+          q = zps[h] + (int)((state >> 8) % (unsigned)scales[h]);
+        else
+          q = zps[h] + (int)((state >> 8) % 64) - 32;
+        qtensor[offset + c] = (int8_t)q;
+        tensor[anchor * channels + c] = (q - zps[h]) * (1.0f / scales[h]);
+      }
+    }
+  }
+
+  std::vector<YoloxDetection> reference = decoder.decode(tensor.data());
+  const std::vector<YoloxDetection> & dets = decoder.decode_quantized(qtensor.data());
+
+  CHECK(!reference.empty());
+  CHECK(dets.size() == reference.size());
+  for (size_t i = 0; i < dets.size(); i++) {
+    CHECK(dets[i].class_id == reference[i].class_id);
+    CHECK(dets[i].score == reference[i].score);
+    CHECK(dets[i].x1 == reference[i].x1 && dets[i].y2 == reference[i].y2);
+  }
+
+  // depth split over several slices is not supported
+  heads[0].slice_depth = 16;
+  CHECK(!decoder.configure_quantized(heads));
+
+  return 0;
+}
+
+static int test_draw()
+{
+  const int width = 64, height = 32;
+  std::vector<uint8_t> frame(width * height * 3 / 2, 0);
+  uint8_t * y = frame.data();
+  uint8_t * uv = frame.data() + width * height;
+
+  std::vector<YoloxColor> palette = { { 200, 100, 50 } };
+  std::vector<YoloxDetection> dets = {
+    { 10.0f, 8.0f, 30.0f, 20.0f, 0.9f, 0 },
+    // partially outside of frame
+    { -20.0f, -5.0f, 1000.0f, 1e30f, 0.8f, 0 },
+  };
+
+  yolox_draw_nv12(y, width, uv, width, width, height, dets, palette, 2);
+
+  // left edge of first box covers columns 9 and 10
+  CHECK(y[12 * width + 9] == 200);
+  CHECK(y[12 * width + 10] == 200);
+  CHECK(y[12 * width + 11] == 0);
+  CHECK(y[12 * width + 8] == 0);
+  // top edge covers rows 7 and 8
+  CHECK(y[7 * width + 20] == 200);
+  CHECK(y[8 * width + 20] == 200);
+  CHECK(y[9 * width + 20] == 0);
+  // chroma of the left edge at column 5 (x1 / 2)
+  CHECK(uv[6 * width + 5 * 2] == 100);
+  CHECK(uv[6 * width + 5 * 2 + 1] == 50);
+  // interior untouched
+  CHECK(y[14 * width + 20] == 0);
+
+  // second box is clipped, only its right and bottom edges hit the border
+  CHECK(y[15 * width + (width - 1)] == 200);
+  CHECK(y[(height - 1) * width + 40] == 200);
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  if (test_decode())
+    return 1;
+  if (test_decode_quantized())
+    return 1;
+  if (test_draw())
+    return 1;
+
+  printf("test_yolox_decode: OK\n");
+  return 0;
+}
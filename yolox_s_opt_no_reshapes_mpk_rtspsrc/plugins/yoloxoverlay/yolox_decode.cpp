@@ -0,0 +1,403 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file yolox_decode.cpp
+ * @brief YOLOX-s decode, NMS and NV12 overlay, native port of payload.py
+ * @author SiMa.Ai\TM
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "yolox_decode.h"
+
+static const int yolox_strides[YOLOX_NUM_STRIDES] = { 8, 16, 32 };
+
+bool YoloxDecoder::configure(const YoloxDecodeParams & params)
+{
+  if (params.num_classes <= 0 || params.model_width <= 0 || params.model_height <= 0)
+    return false;
+
+  for (int stride : yolox_strides)
+    if (params.model_width % stride || params.model_height % stride)
+      return false;
+
+  params_ = params;
+  channels_ = YOLOX_BOX_CHANNELS + params.num_classes;
+  x_scale_ = (float)params.frame_width / params.model_width;
+  y_scale_ = (float)params.frame_height / params.model_height;
+
+  anchor_x_.clear();
+  anchor_y_.clear();
+  anchor_stride_.clear();
+  // anchors change, quantized layout has to be configured again
+  anchor_offset_.clear();
+  quant_size_ = 0;
+
+  // same anchor order as the concatenated model outputs
+  for (int stride : yolox_strides) {
+    int hsize = params.model_height / stride;
+    int wsize = params.model_width / stride;
+    for (int gy = 0; gy < hsize; gy++) {
+      for (int gx = 0; gx < wsize; gx++) {
+        anchor_x_.push_back((float)gx);
+        anchor_y_.push_back((float)gy);
+        anchor_stride_.push_back((float)stride);
+      }
+    }
+  }
+
+  detections_.reserve(256);
+
+  return true;
+}
+
+void YoloxDecoder::add_candidate(const float * anchor, size_t idx)
+{
+  const float * cls = anchor + YOLOX_BOX_CHANNELS;
+  const float obj = anchor[4];
+
+  // score is objectness * class score, its argmax over classes depends on
+  // the sign of objectness
+  int best = 0;
+  float best_cls = cls[0];
+  if (obj >= 0.0f) {
+    for (int c = 1; c < params_.num_classes; c++)
+      if (cls[c] > best_cls) {
+        best_cls = cls[c];
+        best = c;
+      }
+  } else {
+    for (int c = 1; c < params_.num_classes; c++)
+      if (cls[c] < best_cls) {
+        best_cls = cls[c];
+        best = c;
+      }
+  }
+
+  const float score = obj * best_cls;
+  if (!(score > params_.score_threshold))
+    return;
+
+  const float stride = anchor_stride_[idx];
+  const float cx = (anchor[0] + anchor_x_[idx]) * stride;
+  const float cy = (anchor[1] + anchor_y_[idx]) * stride;
+  const float w = expf(anchor[2]) * stride;
+  const float h = expf(anchor[3]) * stride;
+
+  const float x1 = (cx - w / 2.0f) * x_scale_;
+  const float y1 = (cy - h / 2.0f) * y_scale_;
+  const float x2 = (cx + w / 2.0f) * x_scale_;
+  const float y2 = (cy + h / 2.0f) * y_scale_;
+
+  cand_x1_.push_back(x1);
+  cand_y1_.push_back(y1);
+  cand_x2_.push_back(x2);
+  cand_y2_.push_back(y2);
+  cand_area_.push_back((x2 - x1 + 1.0f) * (y2 - y1 + 1.0f));
+  cand_score_.push_back(score);
+  cand_class_.push_back(best);
+}
+
+void YoloxDecoder::run_nms()
+{
+  const size_t n = cand_score_.size();
+
+  order_.resize(n);
+  for (size_t i = 0; i < n; i++)
+    order_[i] = (int)i;
+  std::sort(order_.begin(), order_.end(), [this](int a, int b) {
+    return cand_score_[a] > cand_score_[b] ||
+           (cand_score_[a] == cand_score_[b] && a < b);
+  });
+
+  // reorder candidates by score, so suppression loop runs over contiguous
+  // arrays
+  std::vector<float> * arrays[] = { &cand_x1_, &cand_y1_, &cand_x2_, &cand_y2_,
+                                    &cand_area_, &cand_score_ };
+  std::vector<float> tmp(n);
+  for (auto * array : arrays) {
+    for (size_t i = 0; i < n; i++)
+      tmp[i] = (*array)[order_[i]];
+    array->swap(tmp);
+    tmp.resize(n);
+  }
+  std::vector<int> tmp_class(n);
+  for (size_t i = 0; i < n; i++)
+    tmp_class[i] = cand_class_[order_[i]];
+  cand_class_.swap(tmp_class);
+
+  suppressed_.assign(n, 0);
+
+  const float * x1 = cand_x1_.data();
+  const float * y1 = cand_y1_.data();
+  const float * x2 = cand_x2_.data();
+  const float * y2 = cand_y2_.data();
+  const float * area = cand_area_.data();
+  uint8_t * suppressed = suppressed_.data();
+  const float nms_thr = params_.nms_threshold;
+
+  for (size_t i = 0; i < n; i++) {
+    if (suppressed[i])
+      continue;
+
+    detections_.push_back({ x1[i], y1[i], x2[i], y2[i], cand_score_[i], cand_class_[i] });
+
+    // branch free body, so the loop is vectorized
+    for (size_t j = i + 1; j < n; j++) {
+      float w = std::max(0.0f, std::min(x2[i], x2[j]) - std::max(x1[i], x1[j]) + 1.0f);
+      float h = std::max(0.0f, std::min(y2[i], y2[j]) - std::max(y1[i], y1[j]) + 1.0f);
+      float inter = w * h;
+      float ovr = inter / (area[i] + area[j] - inter);
+      suppressed[j] |= (uint8_t)!(ovr <= nms_thr);
+    }
+  }
+}
+
+void YoloxDecoder::clear_candidates()
+{
+  cand_x1_.clear();
+  cand_y1_.clear();
+  cand_x2_.clear();
+  cand_y2_.clear();
+  cand_area_.clear();
+  cand_score_.clear();
+  cand_class_.clear();
+  detections_.clear();
+}
+
+const std::vector<YoloxDetection> & YoloxDecoder::decode(const float * tensor)
+{
+  clear_candidates();
+
+  const size_t anchors = num_anchors();
+  for (size_t i = 0; i < anchors; i++)
+    add_candidate(tensor + i * channels_, i);
+
+  if (!cand_score_.empty())
+    run_nms();
+
+  return detections_;
+}
+
+bool YoloxDecoder::configure_quantized(const std::vector<YoloxQuantHead> & heads)
+{
+  anchor_offset_.clear();
+  quant_size_ = 0;
+
+  if (heads.size() != YOLOX_NUM_STRIDES || channels_ == 0)
+    return false;
+
+  anchor_offset_.reserve(num_anchors());
+  size_t offset = 0;
+
+  for (int h = 0; h < YOLOX_NUM_STRIDES; h++) {
+    const YoloxQuantHead & head = heads[h];
+
+    if (head.width != params_.model_width / yolox_strides[h] ||
+        head.height != params_.model_height / yolox_strides[h] ||
+        head.depth != channels_ || head.scale <= 0.0f ||
+        head.slice_width <= 0 || head.slice_height <= 0)
+      return false;
+
+    // channels of an anchor have to be contiguous to scan objectness
+    if (head.slice_depth != head.depth)
+      return false;
+
+    // MLA tiles are stored in full, with depth aligned to 16 bytes
+    const size_t depth_stride = (head.depth + 15) & ~15;
+    const int tiles_w = (head.width + head.slice_width - 1) / head.slice_width;
+    const int tiles_h = (head.height + head.slice_height - 1) / head.slice_height;
+    const size_t tile_size = (size_t)head.slice_width * head.slice_height * depth_stride;
+
+    head_begin_[h] = (int)anchor_offset_.size();
+    for (int y = 0; y < head.height; y++) {
+      for (int x = 0; x < head.width; x++) {
+        size_t tile = (size_t)(y / head.slice_height) * tiles_w + x / head.slice_width;
+        size_t in_tile = (size_t)(y % head.slice_height) * head.slice_width +
+                         x % head.slice_width;
+        anchor_offset_.push_back((uint32_t)(offset + tile * tile_size +
+                                            in_tile * depth_stride));
+      }
+    }
+    offset += tile_size * tiles_w * tiles_h;
+
+    head_scale_[h] = head.scale;
+    head_zp_[h] = head.zp;
+
+    // Class scores are sigmoid outputs, so the largest quantized value they
+    // can have is the one of 1.0. score > threshold then requires
+    // objectness > threshold / max_cls, converted once to the quantized
+    // domain. Margin keeps the bound conservative against float rounding,
+    // exact check is done on dequantized values of the anchors passing it.
+    int q_one = std::min(127, (int)lrintf(head.scale + head.zp));
+    float max_cls = (q_one - head.zp) / head.scale;
+    if (params_.score_threshold <= 0.0f || max_cls <= 0.0f) {
+      head_obj_threshold_[h] = -129;
+    } else {
+      float q = head.zp + head.scale * params_.score_threshold / max_cls;
+      head_obj_threshold_[h] = std::max(-129, (int)floorf(q - 1e-3f));
+    }
+  }
+  head_begin_[YOLOX_NUM_STRIDES] = (int)anchor_offset_.size();
+
+  quant_size_ = offset;
+  dequant_anchor_.resize(channels_);
+
+  return true;
+}
+
+const std::vector<YoloxDetection> & YoloxDecoder::decode_quantized(const int8_t * tensor)
+{
+  clear_candidates();
+
+  if (quant_size_ == 0)
+    return detections_;
+
+  const uint32_t * offsets = anchor_offset_.data();
+  float * anchor = dequant_anchor_.data();
+
+  for (int h = 0; h < YOLOX_NUM_STRIDES; h++) {
+    const int threshold = head_obj_threshold_[h];
+    const float inv_scale = 1.0f / head_scale_[h];
+    const int zp = head_zp_[h];
+
+    for (int i = head_begin_[h]; i < head_begin_[h + 1]; i++) {
+      const int8_t * q = tensor + offsets[i];
+      if (q[4] <= threshold)
+        continue;
+
+      for (int c = 0; c < channels_; c++)
+        anchor[c] = (q[c] - zp) * inv_scale;
+      add_candidate(anchor, i);
+    }
+  }
+
+  if (!cand_score_.empty())
+    run_nms();
+
+  return detections_;
+}
+
+std::vector<YoloxColor> yolox_make_palette(int num_classes)
+{
+  std::vector<YoloxColor> palette;
+  uint32_t state = 0x9e3779b9;
+
+  for (int i = 0; i < num_classes; i++) {
+    uint8_t rgb[3];
+    for (auto & c : rgb) {
+      state = state * 1664525u + 1013904223u;
+      // keep colors bright enough to be visible on video
+      c = (uint8_t)(64 + ((state >> 24) % 192));
+    }
+
+    float r = rgb[0], g = rgb[1], b = rgb[2];
+    float y = 16.0f + 0.257f * r + 0.504f * g + 0.098f * b;
+    float u = 128.0f - 0.148f * r - 0.291f * g + 0.439f * b;
+    float v = 128.0f + 0.439f * r - 0.368f * g - 0.071f * b;
+    palette.push_back({ (uint8_t)y, (uint8_t)u, (uint8_t)v });
+  }
+
+  return palette;
+}
+
+/**
+ * @brief Fill clipped rectangle [x0, x1] x [y0, y1] of a plane with
+ *        `channels` interleaved bytes per pixel
+ */
+static void yolox_fill_rect(uint8_t * plane, size_t stride, int width, int height,
+                            int channels, const uint8_t * value,
+                            int x0, int y0, int x1, int y1)
+{
+  x0 = std::max(x0, 0);
+  y0 = std::max(y0, 0);
+  x1 = std::min(x1, width - 1);
+  y1 = std::min(y1, height - 1);
+  if (x0 > x1 || y0 > y1)
+    return;
+
+  for (int y = y0; y <= y1; y++) {
+    uint8_t * row = plane + y * stride + x0 * channels;
+    if (channels == 1) {
+      memset(row, value[0], x1 - x0 + 1);
+    } else {
+      for (int x = x0; x <= x1; x++, row += channels)
+        memcpy(row, value, channels);
+    }
+  }
+}
+
+/**
+ * @brief Draw rectangle outline with lines of `thickness` pixels centered on
+ *        the edges
+ */
+static void yolox_draw_rect(uint8_t * plane, size_t stride, int width, int height,
+                            int channels, const uint8_t * value,
+                            int x1, int y1, int x2, int y2, int thickness)
+{
+  const int lo = thickness / 2;
+  const int hi = thickness - lo - 1;
+
+  yolox_fill_rect(plane, stride, width, height, channels, value,
+                  x1 - lo, y1 - lo, x2 + hi, y1 + hi);
+  yolox_fill_rect(plane, stride, width, height, channels, value,
+                  x1 - lo, y2 - lo, x2 + hi, y2 + hi);
+  yolox_fill_rect(plane, stride, width, height, channels, value,
+                  x1 - lo, y1 - lo, x1 + hi, y2 + hi);
+  yolox_fill_rect(plane, stride, width, height, channels, value,
+                  x2 - lo, y1 - lo, x2 + hi, y2 + hi);
+}
+
+/**
+ * @brief Truncate coordinate to pixel, out of frame values are clamped to
+ *        one pixel outside, so the cast is always defined
+ */
+static int yolox_to_pixel(float v, int size)
+{
+  if (!(v > -1.0f))
+    return -1;
+  if (v > (float)size)
+    return size;
+  return (int)v;
+}
+
+void yolox_draw_nv12(uint8_t * y, size_t stride_y, uint8_t * uv, size_t stride_uv,
+                     int width, int height,
+                     const std::vector<YoloxDetection> & detections,
+                     const std::vector<YoloxColor> & palette, int thickness)
+{
+  for (auto & det : detections) {
+    const YoloxColor & color = palette[det.class_id % palette.size()];
+    const uint8_t luma[1] = { color.y };
+    const uint8_t chroma[2] = { color.u, color.v };
+
+    int x1 = yolox_to_pixel(det.x1, width), y1 = yolox_to_pixel(det.y1, height);
+    int x2 = yolox_to_pixel(det.x2, width), y2 = yolox_to_pixel(det.y2, height);
+
+    yolox_draw_rect(y, stride_y, width, height, 1, luma,
+                    x1, y1, x2, y2, thickness);
+    yolox_draw_rect(uv, stride_uv, width / 2, height / 2, 2, chroma,
+                    x1 / 2, y1 / 2, x2 / 2, y2 / 2, thickness);
+  }
+}
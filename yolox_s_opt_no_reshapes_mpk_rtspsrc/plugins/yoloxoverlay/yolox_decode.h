@@ -0,0 +1,179 @@
+/*
+ * GStreamer
+ * Copyright (C) 2023 SiMa.ai
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef YOLOX_DECODE_H_
+#define YOLOX_DECODE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#define YOLOX_NUM_STRIDES 3
+#define YOLOX_BOX_CHANNELS 5
+
+/**
+ * @brief YOLOX postprocessing parameters
+ */
+struct YoloxDecodeParams {
+  /// model input size
+  int model_width = 640;
+  int model_height = 640;
+  /// size of frame boxes are scaled and drawn to
+  int frame_width = 1280;
+  int frame_height = 720;
+  int num_classes = 80;
+  /// minimal objectness * class score of a detection
+  float score_threshold = 0.5f;
+  /// maximal IoU of boxes kept by NMS
+  float nms_threshold = 0.5f;
+};
+
+/**
+ * @brief Layout and dequantization of one INT8 model output head, as
+ *        described by `0_postproc.json`. Value is `(q - zp) / scale`
+ */
+struct YoloxQuantHead {
+  float scale;
+  int zp;
+  int width, height, depth;
+  int slice_width, slice_height, slice_depth;
+};
+
+/**
+ * @brief Detection in frame coordinates
+ */
+struct YoloxDetection {
+  float x1, y1, x2, y2;
+  float score;
+  int class_id;
+};
+
+/**
+ * @brief Color of a class in NV12 planes
+ */
+struct YoloxColor {
+  uint8_t y, u, v;
+};
+
+/**
+ * @brief YOLOX-s decoder of the dequantized model outputs.
+ *
+ * Input tensor is float32 outputs of strides 8/16/32 one after another, each
+ * `(H/stride, W/stride, 5 + num_classes)` with channels
+ * `x, y, w, h, objectness, classes...`. Grids and strides of all anchors are
+ * precomputed by configure(), decode() runs class agnostic NMS on anchors
+ * over the score threshold. All buffers are reused between frames.
+ */
+class YoloxDecoder {
+ public:
+  /**
+   * @brief Precompute anchor grids for given parameters
+   * @return false if model size is not divisible by strides
+   */
+  bool configure(const YoloxDecodeParams & params);
+
+  const YoloxDecodeParams & params() const { return params_; }
+
+  /// Number of anchors of all strides
+  size_t num_anchors() const { return anchor_x_.size(); }
+
+  /// Number of floats in the model output
+  size_t tensor_size() const { return num_anchors() * channels_; }
+
+  /**
+   * @brief Decode a frame
+   * @param tensor model output of tensor_size() floats
+   * @return detections sorted by score, valid until next call
+   */
+  const std::vector<YoloxDetection> & decode(const float * tensor);
+
+  /**
+   * @brief Prepare decoding of the INT8 MLA output. Score threshold is
+   *        converted to an objectness threshold in the quantized domain of
+   *        every head. Must be called after configure()
+   * @return false if heads do not match the model strides or the layout is
+   *         not supported
+   */
+  bool configure_quantized(const std::vector<YoloxQuantHead> & heads);
+
+  /// Number of bytes of the INT8 model output, including tile padding
+  size_t quantized_tensor_size() const { return quant_size_; }
+
+  /**
+   * @brief Decode a frame from the INT8 MLA output. Only the objectness
+   *        channel is scanned, anchors over the quantized threshold are
+   *        dequantized and decoded as in decode()
+   */
+  const std::vector<YoloxDetection> & decode_quantized(const int8_t * tensor);
+
+ private:
+  /// Add anchor to candidates if its best class is over the threshold
+  void add_candidate(const float * anchor, size_t idx);
+  void clear_candidates();
+  void run_nms();
+
+  YoloxDecodeParams params_;
+  int channels_ = 0;
+  float x_scale_ = 1.0f;
+  float y_scale_ = 1.0f;
+
+  /// precomputed grid and stride of every anchor
+  std::vector<float> anchor_x_;
+  std::vector<float> anchor_y_;
+  std::vector<float> anchor_stride_;
+
+  /// INT8 output: byte offset of every anchor, first anchor of every head,
+  /// quantized objectness threshold and dequantization of every head
+  std::vector<uint32_t> anchor_offset_;
+  int head_begin_[YOLOX_NUM_STRIDES + 1] = {};
+  int head_obj_threshold_[YOLOX_NUM_STRIDES] = {};
+  float head_scale_[YOLOX_NUM_STRIDES] = {};
+  int head_zp_[YOLOX_NUM_STRIDES] = {};
+  size_t quant_size_ = 0;
+  std::vector<float> dequant_anchor_;
+
+  /// candidates over the score threshold, as separate arrays for IoU loop
+  std::vector<float> cand_x1_, cand_y1_, cand_x2_, cand_y2_, cand_area_;
+  std::vector<float> cand_score_;
+  std::vector<int> cand_class_;
+  std::vector<int> order_;
+  std::vector<uint8_t> suppressed_;
+
+  std::vector<YoloxDetection> detections_;
+};
+
+/**
+ * @brief Deterministic per class palette, converted to BT.601 YUV
+ */
+std::vector<YoloxColor> yolox_make_palette(int num_classes);
+
+/**
+ * @brief Draw detection rectangles to NV12 planes in place
+ * @param y luma plane, `stride_y` bytes per row
+ * @param uv interleaved chroma plane of half height, `stride_uv` bytes per row
+ * @param thickness line thickness in luma pixels
+ */
+void yolox_draw_nv12(uint8_t * y, size_t stride_y, uint8_t * uv, size_t stride_uv,
+                     int width, int height,
+                     const std::vector<YoloxDetection> & detections,
+                     const std::vector<YoloxColor> & palette, int thickness);
+
+#endif // YOLOX_DECODE_H_